@@ -31,6 +31,7 @@
 
 //#include <vlGraphics/Actor.hpp>
 #include "Actor.hpp"
+#include <atomic>
 
 using namespace vl;
 
@@ -93,6 +94,12 @@ bool Actor::boundsDirty() const
   return dirty;
 }
 //-----------------------------------------------------------------------------
+unsigned long long Actor::nextBoundsVersion()
+{
+  static std::atomic<unsigned long long> version(0);
+  return ++version;
+}
+//-----------------------------------------------------------------------------
 void Actor::computeBounds()
 {
   if ( ! lod(0) ) {
@@ -107,6 +114,7 @@ void Actor::computeBounds()
     mTransformUpdateTick = transform()->worldMatrixUpdateTick();
     mSphere = mAABB.isNull() ? Sphere() : mAABB;
     mBoundsUpdateTick = lod(0)->boundsUpdateTick();
+    mBoundsVersion = nextBoundsVersion();
   }
   else
   if (geom_update)
@@ -114,6 +122,7 @@ void Actor::computeBounds()
     mAABB   = lod(0)->boundingBox();
     mSphere = mAABB.isNull() ? Sphere() : mAABB;
     mBoundsUpdateTick = lod(0)->boundsUpdateTick();
+    mBoundsVersion = nextBoundsVersion();
   }
 }
 //-----------------------------------------------------------------------------
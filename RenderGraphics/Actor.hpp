@@ -86,7 +86,9 @@ namespace vl
     \param cam The camera used for the current rendering.
     \param renderable The currently selected Actor LOD.
     \param shader The currently active Shader.
-    \param pass The current Actor[s] rendering pass. */
+    \param pass The current Actor[s] rendering pass.
+    \note Buffers and textures updated through VL keep the OpenGLContext's binding shadow up to date, a callback binding objects
+    with direct OpenGL calls must call forgetBufferTarget() and forgetActiveTextureUnit() or OpenGLContext::invalidateStateShadow(). */
     virtual void onActorRenderStarted(Actor* actor, real frame_clock, const Camera* cam, Renderable* renderable, const Shader* shader, int pass) = 0;
 
     /** Event notifying that an Actor is being deleted. */
@@ -141,7 +143,8 @@ namespace vl
     */
     Actor(Renderable* renderable = NULL, Effect* effect = NULL, Transform* transform = NULL, int block = 0, int rank = 0):
       mEffect(effect), mTransform(transform), mRenderBlock(block), mRenderRank(rank),
-      mTransformUpdateTick(-1), mBoundsUpdateTick(-1), mEnableMask(0xFFFFFFFF), mOcclusionQuery(0), mOcclusionQueryTick(0xFFFFFFFF), mIsOccludee(true), mEnabled(true)
+      mTransformUpdateTick(-1), mBoundsUpdateTick(-1), mEnableMask(0xFFFFFFFF), mOcclusionQuery(0), mOcclusionQueryTick(0xFFFFFFFF), mIsOccludee(true), mEnabled(true),
+      mBoundsVersion(nextBoundsVersion())
     {
       VL_DEBUG_SET_OBJECT_NAME()
       mActorEventCallbacks.setAutomaticDelete(false);
@@ -166,6 +169,7 @@ namespace vl
         mBoundsUpdateTick = -1;
         mAABB.setNull();
         mSphere.setNull();
+        mBoundsVersion = nextBoundsVersion();
       }
     }
 
@@ -444,6 +448,12 @@ namespace vl
     /** For internal use only. */
     unsigned occlusionQueryTick() const { return mOcclusionQueryTick; }
 
+    /** Globally unique number that changes every time boundingBox() and boundingSphere() change, see computeBounds() and ActorBoundsStore. */
+    unsigned long long boundsVersion() const { return mBoundsVersion; }
+
+  protected:
+    static unsigned long long nextBoundsVersion();
+
 #ifdef VL_USER_DATA_ACTOR
   public:
     const Object* actorUserData() const { return mActorUserData.get(); }
@@ -473,6 +483,7 @@ namespace vl
     unsigned mOcclusionQueryTick;
     bool mIsOccludee;
     bool mEnabled;
+    unsigned long long mBoundsVersion;
   };
   //---------------------------------------------------------------------------
   /** Defined as a simple subclass of Collection<Actor>, see Collection for more information. */
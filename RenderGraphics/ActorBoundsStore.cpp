@@ -0,0 +1,395 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include <vlGraphics/ActorBoundsStore.hpp>
+#include <vlGraphics/Actor.hpp>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX__)
+  #define VL_CULL_AVX
+  #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define VL_CULL_SSE
+  #include <emmintrin.h>
+#endif
+
+using namespace vl;
+
+namespace
+{
+  typedef ActorBoundsStore::Planes::PlaneF PlaneF;
+
+  // relative error bound of the single precision plane distance, including the rounding of the double precision inputs
+  const double CullEpsilon = 8.0 * FLT_EPSILON;
+
+  // number of slots tested at once
+#if defined(VL_CULL_AVX)
+  const size_t BatchSize = 8;
+#elif defined(VL_CULL_SSE)
+  const size_t BatchSize = 4;
+#else
+  const size_t BatchSize = 1;
+#endif
+
+  // number of elements of the SoA arrays: whole batches plus one more, so that a range starting anywhere can be read in whole batches
+  inline size_t paddedSize(size_t count) { return ( ( count + 7 ) & ~size_t(7) ) + 8; }
+
+  // single precision bounds, enlarged so that the single precision tests never cull what the double precision ones keep
+  struct BoundsF
+  {
+    float cx, cy, cz, r;
+    float min[3], max[3];
+  };
+
+  void convertBounds(const AABB& aabb, const Sphere& sphere, BoundsF& out)
+  {
+    if ( sphere.isNull() )
+    {
+      out.cx = out.cy = out.cz = 0;
+      out.r  = FLT_MAX;
+    }
+    else
+    {
+      out.cx = (float)sphere.center().x();
+      out.cy = (float)sphere.center().y();
+      out.cz = (float)sphere.center().z();
+      // the radius is enlarged by a bound of the single precision error of the plane distance,
+      // so that a sphere kept by the double precision Frustum::cull() is never culled
+      double slack = CullEpsilon * ( fabs( sphere.center().x() ) + fabs( sphere.center().y() ) + fabs( sphere.center().z() ) + sphere.radius() );
+      out.r  = (float)std::min( (double)sphere.radius() + slack, (double)FLT_MAX );
+    }
+
+    if ( aabb.isNull() )
+    {
+      out.min[0] = out.min[1] = out.min[2] = -FLT_MAX;
+      out.max[0] = out.max[1] = out.max[2] = +FLT_MAX;
+    }
+    else
+    {
+      // moving every face out by the slack moves the nearest corner's plane distance by at least the slack, since |n| = 1
+      double slack = 0;
+      for( int i = 0; i < 3; ++i ) {
+        slack += std::max( fabs( aabb.minCorner()[i] ), fabs( aabb.maxCorner()[i] ) );
+      }
+      slack *= CullEpsilon;
+      for( int i = 0; i < 3; ++i )
+      {
+        out.min[i] = (float)std::max( aabb.minCorner()[i] - slack, -(double)FLT_MAX );
+        out.max[i] = (float)std::min( aabb.maxCorner()[i] + slack, +(double)FLT_MAX );
+      }
+    }
+  }
+
+  // a sphere is culled if it lies completely in front of any plane: dot(n, c) - o > r
+  // a box is culled if its corner nearest to the inside of any plane lies in front of it, see Plane::isOutside():
+  // the nearest corner is selected per plane by picking either the min or max arrays according to the normal's sign
+  // both kernels return one visibility bit per slot of the batch starting at slot i
+
+#if defined(VL_CULL_AVX)
+  inline unsigned int cullSphereBatch(const ActorBoundsStore::Planes& planes, const float* cx, const float* cy, const float* cz, const float* r, size_t i)
+  {
+    __m256 x = _mm256_loadu_ps( cx + i );
+    __m256 y = _mm256_loadu_ps( cy + i );
+    __m256 z = _mm256_loadu_ps( cz + i );
+    __m256 rad = _mm256_loadu_ps( r + i );
+    __m256 outside = _mm256_setzero_ps();
+    for( int p = 0; p < planes.count(); ++p )
+    {
+      __m256 d = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( planes[p].nx ), x ),
+                                               _mm256_mul_ps( _mm256_set1_ps( planes[p].ny ), y ) ),
+                                               _mm256_mul_ps( _mm256_set1_ps( planes[p].nz ), z ) );
+      d = _mm256_sub_ps( d, _mm256_set1_ps( planes[p].o ) );
+      outside = _mm256_or_ps( outside, _mm256_cmp_ps( d, rad, _CMP_GT_OQ ) );
+    }
+    return ~(unsigned int)_mm256_movemask_ps( outside ) & 0xFF;
+  }
+
+  inline unsigned int cullBoxBatch(const ActorBoundsStore::Planes& planes, const float* const* mins, const float* const* maxs, size_t i)
+  {
+    __m256 outside = _mm256_setzero_ps();
+    for( int p = 0; p < planes.count(); ++p )
+    {
+      const PlaneF& pl = planes[p];
+      __m256 x = _mm256_loadu_ps( ( pl.nx >= 0 ? mins[0] : maxs[0] ) + i );
+      __m256 y = _mm256_loadu_ps( ( pl.ny >= 0 ? mins[1] : maxs[1] ) + i );
+      __m256 z = _mm256_loadu_ps( ( pl.nz >= 0 ? mins[2] : maxs[2] ) + i );
+      __m256 d = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( pl.nx ), x ),
+                                               _mm256_mul_ps( _mm256_set1_ps( pl.ny ), y ) ),
+                                               _mm256_mul_ps( _mm256_set1_ps( pl.nz ), z ) );
+      d = _mm256_sub_ps( d, _mm256_set1_ps( pl.o ) );
+      outside = _mm256_or_ps( outside, _mm256_cmp_ps( d, _mm256_setzero_ps(), _CMP_GT_OQ ) );
+    }
+    return ~(unsigned int)_mm256_movemask_ps( outside ) & 0xFF;
+  }
+#elif defined(VL_CULL_SSE)
+  inline unsigned int cullSphereBatch(const ActorBoundsStore::Planes& planes, const float* cx, const float* cy, const float* cz, const float* r, size_t i)
+  {
+    __m128 x = _mm_loadu_ps( cx + i );
+    __m128 y = _mm_loadu_ps( cy + i );
+    __m128 z = _mm_loadu_ps( cz + i );
+    __m128 rad = _mm_loadu_ps( r + i );
+    __m128 outside = _mm_setzero_ps();
+    for( int p = 0; p < planes.count(); ++p )
+    {
+      __m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( planes[p].nx ), x ),
+                                         _mm_mul_ps( _mm_set1_ps( planes[p].ny ), y ) ),
+                                         _mm_mul_ps( _mm_set1_ps( planes[p].nz ), z ) );
+      d = _mm_sub_ps( d, _mm_set1_ps( planes[p].o ) );
+      outside = _mm_or_ps( outside, _mm_cmpgt_ps( d, rad ) );
+    }
+    return ~(unsigned int)_mm_movemask_ps( outside ) & 0xF;
+  }
+
+  inline unsigned int cullBoxBatch(const ActorBoundsStore::Planes& planes, const float* const* mins, const float* const* maxs, size_t i)
+  {
+    __m128 outside = _mm_setzero_ps();
+    for( int p = 0; p < planes.count(); ++p )
+    {
+      const PlaneF& pl = planes[p];
+      __m128 x = _mm_loadu_ps( ( pl.nx >= 0 ? mins[0] : maxs[0] ) + i );
+      __m128 y = _mm_loadu_ps( ( pl.ny >= 0 ? mins[1] : maxs[1] ) + i );
+      __m128 z = _mm_loadu_ps( ( pl.nz >= 0 ? mins[2] : maxs[2] ) + i );
+      __m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( pl.nx ), x ),
+                                         _mm_mul_ps( _mm_set1_ps( pl.ny ), y ) ),
+                                         _mm_mul_ps( _mm_set1_ps( pl.nz ), z ) );
+      d = _mm_sub_ps( d, _mm_set1_ps( pl.o ) );
+      outside = _mm_or_ps( outside, _mm_cmpgt_ps( d, _mm_setzero_ps() ) );
+    }
+    return ~(unsigned int)_mm_movemask_ps( outside ) & 0xF;
+  }
+#else
+  inline unsigned int cullSphereBatch(const ActorBoundsStore::Planes& planes, const float* cx, const float* cy, const float* cz, const float* r, size_t i)
+  {
+    for( int p = 0; p < planes.count(); ++p ) {
+      if ( planes[p].nx * cx[i] + planes[p].ny * cy[i] + planes[p].nz * cz[i] - planes[p].o > r[i] ) {
+        return 0;
+      }
+    }
+    return 1;
+  }
+
+  inline unsigned int cullBoxBatch(const ActorBoundsStore::Planes& planes, const float* const* mins, const float* const* maxs, size_t i)
+  {
+    for( int p = 0; p < planes.count(); ++p )
+    {
+      const PlaneF& pl = planes[p];
+      float x = ( pl.nx >= 0 ? mins[0] : maxs[0] )[i];
+      float y = ( pl.ny >= 0 ? mins[1] : maxs[1] )[i];
+      float z = ( pl.nz >= 0 ? mins[2] : maxs[2] )[i];
+      if ( pl.nx * x + pl.ny * y + pl.nz * z - pl.o > 0 ) {
+        return 0;
+      }
+    }
+    return 1;
+  }
+#endif
+}
+//-----------------------------------------------------------------------------
+// ActorBoundsStore::Planes
+//-----------------------------------------------------------------------------
+ActorBoundsStore::Planes::Planes(const Frustum& frustum): mCount( (int)frustum.planes().size() ), mPlanes( mFixed )
+{
+  // avoids heap allocations for the common frustums
+  if ( mCount > FixedCount )
+  {
+    mDynamic.resize( mCount );
+    mPlanes = &mDynamic[0];
+  }
+  // the plane origins are enlarged by their rounding error bound, see convertBounds()
+  for( int i = 0; i < mCount; ++i )
+  {
+    const Plane& plane = frustum.plane( i );
+    mPlanes[i].nx = (float)plane.normal().x();
+    mPlanes[i].ny = (float)plane.normal().y();
+    mPlanes[i].nz = (float)plane.normal().z();
+    mPlanes[i].o  = (float)( plane.origin() + CullEpsilon * fabs( plane.origin() ) );
+  }
+}
+//-----------------------------------------------------------------------------
+// ActorBoundsStore
+//-----------------------------------------------------------------------------
+ActorBoundsStore::ActorBoundsStore()
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+}
+//-----------------------------------------------------------------------------
+const char* ActorBoundsStore::simdPath()
+{
+#if defined(VL_CULL_AVX)
+  return "AVX";
+#elif defined(VL_CULL_SSE)
+  return "SSE";
+#else
+  return "scalar";
+#endif
+}
+//-----------------------------------------------------------------------------
+void ActorBoundsStore::resize(int count)
+{
+  mActors.resize( count, NULL );
+  mVersions.resize( count, 0 );
+
+  // padding slots hold infinite bounds
+  size_t padded = paddedSize( count );
+  mCenterX.resize( padded, 0 );
+  mCenterY.resize( padded, 0 );
+  mCenterZ.resize( padded, 0 );
+  mRadius.resize( padded, FLT_MAX );
+  mMinX.resize( padded, -FLT_MAX );
+  mMinY.resize( padded, -FLT_MAX );
+  mMinZ.resize( padded, -FLT_MAX );
+  mMaxX.resize( padded, +FLT_MAX );
+  mMaxY.resize( padded, +FLT_MAX );
+  mMaxZ.resize( padded, +FLT_MAX );
+}
+//-----------------------------------------------------------------------------
+bool ActorBoundsStore::sync(int slot, const Actor* actor)
+{
+  VL_CHECK( slot >= 0 && slot < size() )
+
+  if ( mActors[slot] == actor && mVersions[slot] == actor->boundsVersion() ) {
+    return false;
+  }
+
+  setBounds( slot, actor->boundingBox(), actor->boundingSphere() );
+  mActors[slot] = actor;
+  mVersions[slot] = actor->boundsVersion();
+  return true;
+}
+//-----------------------------------------------------------------------------
+void ActorBoundsStore::setBounds(int slot, const AABB& aabb, const Sphere& sphere)
+{
+  VL_CHECK( slot >= 0 && slot < size() )
+
+  mActors[slot] = NULL;
+  mVersions[slot] = 0;
+
+  BoundsF bounds;
+  convertBounds( aabb, sphere, bounds );
+  mCenterX[slot] = bounds.cx;
+  mCenterY[slot] = bounds.cy;
+  mCenterZ[slot] = bounds.cz;
+  mRadius[slot]  = bounds.r;
+  mMinX[slot] = bounds.min[0];
+  mMinY[slot] = bounds.min[1];
+  mMinZ[slot] = bounds.min[2];
+  mMaxX[slot] = bounds.max[0];
+  mMaxY[slot] = bounds.max[1];
+  mMaxZ[slot] = bounds.max[2];
+}
+//-----------------------------------------------------------------------------
+void ActorBoundsStore::cullRange(const Planes& planes, size_t first, size_t count, unsigned int* visible, bool spheres, bool boxes) const
+{
+  VL_CHECK( first + count <= mActors.size() )
+
+  std::fill( visible, visible + ( count + 31 ) / 32, 0u );
+
+  const float* mins[] = { &mMinX[0], &mMinY[0], &mMinZ[0] };
+  const float* maxs[] = { &mMaxX[0], &mMaxY[0], &mMaxZ[0] };
+  const unsigned int batch_mask = ~0u >> ( 32 - BatchSize );
+
+  // BatchSize divides 32 so that a batch never straddles two words of the mask
+  for( size_t k = 0; k < count; k += BatchSize )
+  {
+    const size_t i = first + k;
+    unsigned int mask = batch_mask;
+    if ( spheres ) {
+      mask &= cullSphereBatch( planes, &mCenterX[0], &mCenterY[0], &mCenterZ[0], &mRadius[0], i );
+    }
+    // the boxes are tested only if some of the spheres of the batch are visible
+    if ( boxes && mask ) {
+      mask &= cullBoxBatch( planes, mins, maxs, i );
+    }
+    if ( count - k < BatchSize ) {
+      mask &= ( 1u << ( count - k ) ) - 1;
+    }
+    visible[k >> 5] |= mask << ( k & 31 );
+  }
+}
+//-----------------------------------------------------------------------------
+void ActorBoundsStore::cullSpheres(const Frustum& frustum, std::vector<unsigned int>& visible) const
+{
+  visible.resize( ( mActors.size() + 31 ) / 32 );
+  if ( ! mActors.empty() ) {
+    cullRange( Planes( frustum ), 0, mActors.size(), &visible[0], true, false );
+  }
+}
+//-----------------------------------------------------------------------------
+void ActorBoundsStore::cullBoxes(const Frustum& frustum, std::vector<unsigned int>& visible) const
+{
+  visible.resize( ( mActors.size() + 31 ) / 32 );
+  if ( ! mActors.empty() ) {
+    cullRange( Planes( frustum ), 0, mActors.size(), &visible[0], false, true );
+  }
+}
+//-----------------------------------------------------------------------------
+void ActorBoundsStore::cull(const Frustum& frustum, std::vector<unsigned int>& visible) const
+{
+  visible.resize( ( mActors.size() + 31 ) / 32 );
+  if ( ! mActors.empty() ) {
+    cullRange( Planes( frustum ), 0, mActors.size(), &visible[0], true, true );
+  }
+}
+//-----------------------------------------------------------------------------
+void ActorBoundsStore::cull(const Planes& planes, int first, int count, unsigned int* visible) const
+{
+  if ( count > 0 ) {
+    cullRange( planes, first, count, visible, true, true );
+  }
+}
+//-----------------------------------------------------------------------------
+bool ActorBoundsStore::cull(const Planes& planes, const AABB& aabb, const Sphere& sphere)
+{
+  BoundsF bounds;
+  convertBounds( aabb, sphere, bounds );
+  for( int p = 0; p < planes.count(); ++p )
+  {
+    const PlaneF& pl = planes[p];
+    if ( pl.nx * bounds.cx + pl.ny * bounds.cy + pl.nz * bounds.cz - pl.o > bounds.r ) {
+      return true;
+    }
+  }
+  for( int p = 0; p < planes.count(); ++p )
+  {
+    const PlaneF& pl = planes[p];
+    float x = pl.nx >= 0 ? bounds.min[0] : bounds.max[0];
+    float y = pl.ny >= 0 ? bounds.min[1] : bounds.max[1];
+    float z = pl.nz >= 0 ? bounds.min[2] : bounds.max[2];
+    if ( pl.nx * x + pl.ny * y + pl.nz * z - pl.o > 0 ) {
+      return true;
+    }
+  }
+  return false;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,163 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef ActorBoundsStore_INCLUDE_ONCE
+#define ActorBoundsStore_INCLUDE_ONCE
+
+#include <vlGraphics/link_config.hpp>
+#include <vlGraphics/Frustum.hpp>
+#include <vlCore/AABB.hpp>
+#include <vlCore/Sphere.hpp>
+#include <vector>
+
+namespace vl
+{
+  class Actor;
+
+  /**
+   * The ActorBoundsStore class keeps the bounding spheres and bounding boxes of a set of Actors in a contiguous
+   * structure-of-arrays layout so that they can be frustum culled several at a time using SIMD instructions.
+   *
+   * Each slot mirrors the bounds of an Actor and is refreshed by sync() only when Actor::computeBounds() has changed them,
+   * as tracked by Actor::boundsVersion(). Bounds are stored in single precision, enlarged by the rounding error bound,
+   * so that a sphere or a box kept by Frustum::cull() is never culled, even at large world coordinates.
+   * Null spheres and boxes are stored as infinite ones and are thus never culled.
+   *
+   * \sa ActorTreeAbstract::extractVisibleActors(), ActorLBVH::extractVisibleActors(), Frustum
+   */
+  class VLGRAPHICS_EXPORT ActorBoundsStore: public Object
+  {
+    VL_INSTRUMENT_CLASS(vl::ActorBoundsStore, Object)
+
+  public:
+    //! The planes of a Frustum converted to the single precision format used by the culling functions.
+    //! Converting them once allows culling many small ranges of slots, like the leaves of a hierarchy, against the same Frustum.
+    class VLGRAPHICS_EXPORT Planes
+    {
+    public:
+      struct PlaneF
+      {
+        float nx, ny, nz, o;
+      };
+
+      Planes(const Frustum& frustum);
+
+      int count() const { return mCount; }
+
+      const PlaneF& operator[](int i) const { return mPlanes[i]; }
+
+    private:
+      Planes(const Planes&);
+      Planes& operator=(const Planes&);
+
+    private:
+      enum { FixedCount = 16 };
+      int mCount;
+      PlaneF* mPlanes;
+      PlaneF mFixed[FixedCount];
+      std::vector<PlaneF> mDynamic;
+    };
+
+  public:
+    ActorBoundsStore();
+
+    //! Sets the number of slots.
+    void resize(int count);
+
+    //! The number of slots.
+    int size() const { return (int)mActors.size(); }
+
+    //! Copies the bounds of \p actor into the given slot if the slot refers to another Actor or to an older version of its bounds.
+    //! Returns \p true if the slot has been updated.
+    bool sync(int slot, const Actor* actor);
+
+    //! Sets the bounds of the given slot, which is not associated to any Actor anymore.
+    void setBounds(int slot, const AABB& aabb, const Sphere& sphere);
+
+    /** Frustum culls all the bounding spheres.
+      * Bit \p i of \p visible is set if the sphere of slot \p i is not culled by the \p frustum.
+      * The test is conservative: spheres within the rounding error bound of a plane are kept. */
+    void cullSpheres(const Frustum& frustum, std::vector<unsigned int>& visible) const;
+
+    /** Frustum culls all the bounding boxes.
+      * Bit \p i of \p visible is set if the box of slot \p i is not culled by the \p frustum.
+      * The test is conservative: boxes within the rounding error bound of a plane are kept. */
+    void cullBoxes(const Frustum& frustum, std::vector<unsigned int>& visible) const;
+
+    /** Frustum culls all the bounding spheres and then the bounding boxes of the spheres not culled.
+      * Bit \p i of \p visible is set if neither the sphere nor the box of slot \p i is culled by the \p frustum. */
+    void cull(const Frustum& frustum, std::vector<unsigned int>& visible) const;
+
+    /** Same as cull() for the slots in [first, first + count) only.
+      * Bit \p i of \p visible refers to slot first + \p i, \p visible must hold (count + 31) / 32 words. */
+    void cull(const Planes& planes, int first, int count, unsigned int* visible) const;
+
+    /** Culls a single sphere and box with the same single precision test used by cull(), for the Actors that are not
+      * mirrored in a store. Returns \p true if either the sphere or the box is culled. */
+    static bool cull(const Planes& planes, const AABB& aabb, const Sphere& sphere);
+
+    //! Returns \p true if bit \p i of the given mask is set.
+    static bool isVisible(const std::vector<unsigned int>& visible, int i) { return ( visible[i >> 5] >> ( i & 31 ) ) & 1; }
+
+    //! Returns the SIMD instruction set used by the culling functions: "AVX", "SSE" or "scalar".
+    static const char* simdPath();
+
+    // SoA data, each array holds size() rounded up to a multiple of 8 elements plus 8 padding elements.
+
+    const float* centerX() const { return &mCenterX[0]; }
+    const float* centerY() const { return &mCenterY[0]; }
+    const float* centerZ() const { return &mCenterZ[0]; }
+    //! The enlarged radii, see setBounds().
+    const float* radius() const { return &mRadius[0]; }
+    const float* minX() const { return &mMinX[0]; }
+    const float* minY() const { return &mMinY[0]; }
+    const float* minZ() const { return &mMinZ[0]; }
+    const float* maxX() const { return &mMaxX[0]; }
+    const float* maxY() const { return &mMaxY[0]; }
+    const float* maxZ() const { return &mMaxZ[0]; }
+
+  private:
+    ActorBoundsStore(const ActorBoundsStore&);
+    ActorBoundsStore& operator=(const ActorBoundsStore&);
+
+    void cullRange(const Planes& planes, size_t first, size_t count, unsigned int* visible, bool spheres, bool boxes) const;
+
+  private:
+    // the Actors are used only as keys and never dereferenced: they might not exist anymore
+    std::vector<const Actor*> mActors;
+    std::vector<unsigned long long> mVersions;
+    std::vector<float> mCenterX, mCenterY, mCenterZ, mRadius;
+    std::vector<float> mMinX, mMinY, mMinZ, mMaxX, mMaxY, mMaxZ;
+  };
+}
+
+#endif
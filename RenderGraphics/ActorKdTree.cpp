@@ -32,6 +32,11 @@
 #include <vlGraphics/ActorKdTree.hpp>
 #include <vlCore/Log.hpp>
 #include <algorithm>
+#include <vector>
+#include <limits>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace vl;
 
@@ -64,8 +69,147 @@ namespace
     VL_CHECK(a2->lod(0))
     return a1->boundingBox().minCorner().z() < a2->boundingBox().minCorner().z();
   }
+
+  //-----------------------------------------------------------------------------
+  // SAH build utilities
+  //-----------------------------------------------------------------------------
+  // number of bins per axis
+  const int SAHBinCount = 32;
+  // cost of culling a node relative to the cost of culling an Actor
+  const real SAHTraversalCost = 1;
+  // the minimum number of Actors handed to a thread pool task
+  const int SAHMinParallelRange = 8 * 1024;
+
+  struct SAHBins
+  {
+    SAHBins()
+    {
+      memset( mStart, 0, sizeof(mStart) );
+      memset( mEnd, 0, sizeof(mEnd) );
+    }
+
+    void operator+=(const SAHBins& other)
+    {
+      for( int a = 0; a < 3; ++a ) {
+        for( int k = 0; k < SAHBinCount; ++k )
+        {
+          mStart[a][k] += other.mStart[a][k];
+          mEnd[a][k]   += other.mEnd[a][k];
+        }
+      }
+    }
+
+    // number of boxes whose min/max corner falls in each bin
+    int mStart[3][SAHBinCount];
+    int mEnd[3][SAHBinCount];
+  };
+
+  struct SAHBounds
+  {
+    SAHBounds(): mNull(true)
+    {
+      for( int a = 0; a < 3; ++a )
+      {
+        mMin[a] = +std::numeric_limits<real>::max();
+        mMax[a] = -std::numeric_limits<real>::max();
+      }
+    }
+
+    void operator+=(const SAHBounds& other)
+    {
+      if ( other.mNull ) {
+        return;
+      }
+      for( int a = 0; a < 3; ++a )
+      {
+        mMin[a] = other.mMin[a] < mMin[a] ? other.mMin[a] : mMin[a];
+        mMax[a] = other.mMax[a] > mMax[a] ? other.mMax[a] : mMax[a];
+      }
+      mNull = false;
+    }
+
+    real mMin[3];
+    real mMax[3];
+    bool mNull;
+  };
+
+  inline real halfArea(real x, real y, real z) { return x*y + y*z + z*x; }
 }
 
+struct ActorKdTree::SAHItem
+{
+  Actor* mActor;
+  real mMin[3];
+  real mMax[3];
+  int mSide;
+  bool mNull;
+};
+
+struct ActorKdTree::RefitState
+{
+  // an Actor of the tree, its node and the version of its bounds seen by the last refit
+  struct ActorEntry
+  {
+    ref<Actor> mActor;
+    ActorKdTree* mNode;
+    unsigned long long mBoundsVersion;
+  };
+
+  RefitState(): mIndexed(false), mIndexTick(0), mLiftedCount(0), mMaxDepth(100), mMinimumVolume(0) {}
+
+  void reset(int max_depth, float minimum_volume)
+  {
+    mEntries.clear();
+    mActorEntry.clear();
+    mIndexed       = false;
+    mLiftedCount   = 0;
+    mMaxDepth      = max_depth;
+    mMinimumVolume = minimum_volume;
+  }
+
+  // marks the node for refitNodes()
+  void markNode(ActorKdTree* node)
+  {
+    if ( ! mDirtyNodeSet.insert( node ).second ) {
+      return;
+    }
+    size_t depth = 0;
+    for( const ActorTreeAbstract* n = node->parent(); n; n = n->parent() ) {
+      ++depth;
+    }
+    if ( mDirtyNodes.size() <= depth ) {
+      mDirtyNodes.resize( depth + 1 );
+    }
+    mDirtyNodes[depth].push_back( node );
+  }
+
+  std::vector<ActorEntry> mEntries;
+  std::unordered_map<const Actor*, size_t> mActorEntry;
+  std::vector< std::vector<ActorKdTree*> > mDirtyNodes; // by depth
+  std::unordered_set<ActorKdTree*> mDirtyNodeSet;
+  bool mIndexed;
+  // the root's updateTick() matching the index, any other edit of the tree requires re-indexing
+  long long mIndexTick;
+  size_t mLiftedCount;
+  // last build parameters
+  int mMaxDepth;
+  float mMinimumVolume;
+};
+
+struct ActorKdTree::SAHTask
+{
+  SAHTask(ActorKdTree* node, size_t begin, size_t end, int max_depth): mNode(node), mBegin(begin), mEnd(end), mMaxDepth(max_depth) {}
+  ActorKdTree* mNode;
+  size_t mBegin;
+  size_t mEnd;
+  int mMaxDepth;
+};
+
+//-----------------------------------------------------------------------------
+ActorKdTree::~ActorKdTree()
+{
+  delete mRefitState;
+}
 //-----------------------------------------------------------------------------
 ref<ActorKdTree> ActorKdTree::kdtreeFromNonLeafyActors(int max_depth, float minimum_volume)
 {
@@ -85,6 +229,7 @@ void ActorKdTree::harvestNonLeafActors(ActorCollection& acts)
     for(int i=0; i<(int)actors()->size(); ++i)
       acts.push_back(actors()->at(i));
     actors()->clear();
+    incrementUpdateTick();
   }
 
   if(mChildN) childN()->harvestNonLeafActors( acts );
@@ -103,9 +248,62 @@ void ActorKdTree::computeLocalAABB(const ActorCollection& acts)
 //-----------------------------------------------------------------------------
 void ActorKdTree::buildKdTree(ActorCollection& acts, int max_depth, float minimum_volume)
 {
-  int counter = 0;
   prepareActors(acts);
-  compileTree_internal(acts, counter, max_depth, minimum_volume);
+
+  if ( ! parent() ) {
+    refitState()->reset( max_depth, minimum_volume );
+  }
+
+  if ( buildMode() == KDB_Median )
+  {
+    int counter = 0;
+    compileTree_internal(acts, counter, max_depth, minimum_volume);
+  }
+  else
+  {
+    compileTreeSAH(acts, max_depth, minimum_volume);
+  }
+
+  incrementUpdateTick();
+
+  // the node bounds match the current bounds of the Actors
+  if ( ! parent() ) {
+    indexActors( refitState(), false );
+  }
+}
+//-----------------------------------------------------------------------------
+void ActorKdTree::compileTreeSAH(ActorCollection& acts, int max_depth, float minimum_volume)
+{
+  // cache the bounds of the Actors
+  std::vector<SAHItem> items( acts.size() );
+  ThreadPool* thread_pool = buildThreadPool();
+  const int count = (int)items.size();
+  ThreadPool::parallelFor( thread_pool, count, ThreadPool::rangeCount( thread_pool, count, SAHMinParallelRange ), [&](int, int begin, int end) {
+    for( int i = begin; i < end; ++i )
+    {
+      VL_CHECK(acts[i]->lod(0))
+      const AABB& aabb = acts[i]->boundingBox();
+      items[i].mActor = acts[i].get();
+      for( int a = 0; a < 3; ++a )
+      {
+        items[i].mMin[a] = aabb.minCorner()[a];
+        items[i].mMax[a] = aabb.maxCorner()[a];
+      }
+      items[i].mSide = 0;
+      items[i].mNull = aabb.isNull();
+    }
+  } );
+
+  // split the top levels, collecting the subtrees to be built in parallel
+  std::vector<SAHTask> tasks;
+  compileTreeSAH_internal( items, 0, items.size(), max_depth, minimum_volume, thread_pool, thread_pool ? parallelBuildDepth() : -1, thread_pool ? &tasks : NULL );
+
+  if ( ! tasks.empty() )
+  {
+    thread_pool->parallelFor( (int)tasks.size(), [&](int i) {
+      tasks[i].mNode->compileTreeSAH_internal( items, tasks[i].mBegin, tasks[i].mEnd, tasks[i].mMaxDepth, minimum_volume, NULL, -1, NULL );
+    } );
+  }
 }
 //-----------------------------------------------------------------------------
 void ActorKdTree::rebuildKdTree(int max_depth, float minimum_volume)
@@ -172,6 +370,216 @@ void ActorKdTree::compileTree_internal(ActorCollection& acts, int& counter, int
 
 }
 //-----------------------------------------------------------------------------
+void ActorKdTree::compileTreeSAH_internal(std::vector<SAHItem>& items, size_t begin, size_t end, int max_depth, float minimum_volume, ThreadPool* thread_pool, int parallel_depth, std::vector<SAHTask>* tasks)
+{
+  if ( tasks && parallel_depth == 0 )
+  {
+    tasks->push_back( SAHTask( this, begin, end, max_depth ) );
+    return;
+  }
+
+  mChildN = NULL;
+  mChildP = NULL;
+  actors()->clear();
+  mAABB.setNull();
+  mPlane = Plane();
+
+  const size_t count = end - begin;
+  if ( count == 0 )
+    return;
+
+  const int chunks = ThreadPool::rangeCount( thread_pool, (int)count, SAHMinParallelRange );
+
+  // compute the node's bounds from the cached ones
+  const auto bound = [&](size_t b, size_t e, SAHBounds& bounds) {
+    for( size_t i = b; i < e; ++i )
+    {
+      if ( items[i].mNull ) {
+        continue;
+      }
+      for( int a = 0; a < 3; ++a )
+      {
+        bounds.mMin[a] = items[i].mMin[a] < bounds.mMin[a] ? items[i].mMin[a] : bounds.mMin[a];
+        bounds.mMax[a] = items[i].mMax[a] > bounds.mMax[a] ? items[i].mMax[a] : bounds.mMax[a];
+      }
+      bounds.mNull = false;
+    }
+  };
+
+  SAHBounds bounds;
+  if ( chunks == 1 ) {
+    bound( begin, end, bounds );
+  }
+  else
+  {
+    std::vector<SAHBounds> chunk_bounds( chunks );
+    ThreadPool::parallelFor( thread_pool, (int)count, chunks, [&](int chunk, int b, int e) {
+      bound( begin + b, begin + e, chunk_bounds[chunk] );
+    } );
+    for( int i = 0; i < chunks; ++i ) {
+      bounds += chunk_bounds[i];
+    }
+  }
+
+  if ( ! bounds.mNull )
+  {
+    mAABB.setMinCorner( bounds.mMin[0], bounds.mMin[1], bounds.mMin[2] );
+    mAABB.setMaxCorner( bounds.mMax[0], bounds.mMax[1], bounds.mMax[2] );
+  }
+
+  bool leaf = count == 1 || max_depth == 0 || bounds.mNull || mAABB.volume() < minimum_volume;
+
+  // bin the bounding boxes' corners along the three axes
+  real lo[3], ext[3], scale[3];
+  for( int a = 0; a < 3; ++a )
+  {
+    lo[a]    = bounds.mMin[a];
+    ext[a]   = bounds.mMax[a] - bounds.mMin[a];
+    scale[a] = ext[a] > 0 ? SAHBinCount / ext[a] : 0;
+  }
+
+  const auto bin = [&](size_t b, size_t e, SAHBins& cb) {
+    for( size_t i = b; i < e; ++i )
+    {
+      for( int a = 0; a < 3; ++a )
+      {
+        int kmin = (int)( ( items[i].mMin[a] - lo[a] ) * scale[a] );
+        int kmax = (int)( ( items[i].mMax[a] - lo[a] ) * scale[a] );
+        cb.mStart[a][ kmin < 0 ? 0 : ( kmin >= SAHBinCount ? SAHBinCount-1 : kmin ) ]++;
+        cb.mEnd  [a][ kmax < 0 ? 0 : ( kmax >= SAHBinCount ? SAHBinCount-1 : kmax ) ]++;
+      }
+    }
+  };
+
+  SAHBins bins;
+  if ( leaf ) {
+    // nothing to bin
+  }
+  else
+  if ( chunks == 1 ) {
+    bin( begin, end, bins );
+  }
+  else
+  {
+    std::vector<SAHBins> chunk_bins( chunks );
+    ThreadPool::parallelFor( thread_pool, (int)count, chunks, [&](int chunk, int b, int e) {
+      bin( begin + b, begin + e, chunk_bins[chunk] );
+    } );
+    for( int i = 0; i < chunks; ++i ) {
+      bins += chunk_bins[i];
+    }
+  }
+
+  // evaluate the planes at the bin boundaries: cost = traversal + straddling + area weighted children
+  // the straddling Actors stay in this node and are culled every time the node is visited
+  int best_axis = -1;
+  real best_pos  = 0;
+  real best_cost = (real)count;
+  const real node_area = halfArea( ext[0], ext[1], ext[2] );
+  for( int a = 0; ! leaf && a < 3; ++a )
+  {
+    if ( ext[a] <= 0 ) {
+      continue;
+    }
+
+    const int b1 = ( a + 1 ) % 3;
+    const int b2 = ( a + 2 ) % 3;
+    int count_n = 0;
+    int count_p = (int)count;
+    for( int k = 1; k < SAHBinCount; ++k )
+    {
+      count_n += bins.mEnd[a][k-1];
+      count_p -= bins.mStart[a][k-1];
+      if ( count_n + count_p == 0 ) {
+        continue;
+      }
+
+      const real len_n = ext[a] * k / SAHBinCount;
+      const real len_p = ext[a] - len_n;
+      real weight_n, weight_p;
+      if ( node_area > 0 )
+      {
+        weight_n = halfArea( len_n, ext[b1], ext[b2] ) / node_area;
+        weight_p = halfArea( len_p, ext[b1], ext[b2] ) / node_area;
+      }
+      else
+      {
+        // degenerate box: use the lengths
+        weight_n = len_n / ext[a];
+        weight_p = len_p / ext[a];
+      }
+
+      const int count_s = (int)count - count_n - count_p;
+      const real cost = SAHTraversalCost + count_s + weight_n * count_n + weight_p * count_p;
+      if ( cost < best_cost )
+      {
+        best_cost = cost;
+        best_axis = a;
+        best_pos  = lo[a] + len_n;
+      }
+    }
+  }
+
+  if ( best_axis == -1 ) {
+    leaf = true;
+  }
+
+  if ( leaf )
+  {
+    for( size_t i = begin; i < end; ++i ) {
+      actors()->push_back( items[i].mActor );
+    }
+    return;
+  }
+
+  vec3 normal(0,0,0);
+  normal[best_axis] = 1;
+  mPlane = Plane( best_pos, normal );
+
+  // classify with the same test used by insertActor() and partition as [straddling|negative|positive]
+  // the Actors lying clearly on one side are classified using the cached bounds
+  const real margin = ext[best_axis] * real(1.0e-4) + real(1.0e-4);
+  ThreadPool::parallelFor( thread_pool, (int)count, chunks, [&](int, int b, int e) {
+    for( size_t i = begin + b; i < begin + e; ++i )
+    {
+      if ( ! items[i].mNull && items[i].mMax[best_axis] < best_pos - margin ) {
+        items[i].mSide = -1;
+      }
+      else
+      if ( ! items[i].mNull && items[i].mMin[best_axis] > best_pos + margin ) {
+        items[i].mSide = +1;
+      }
+      else {
+        items[i].mSide = mPlane.classify( items[i].mActor->boundingBox() );
+      }
+    }
+  } );
+
+  typedef std::vector<SAHItem>::iterator iterator;
+  iterator it_n = std::partition( items.begin() + begin, items.begin() + end, [](const SAHItem& item) { return item.mSide == 0; } );
+  iterator it_p = std::partition( it_n, items.begin() + end, [](const SAHItem& item) { return item.mSide < 0; } );
+  const size_t mid_n = it_n - items.begin();
+  const size_t mid_p = it_p - items.begin();
+
+  for( size_t i = begin; i < mid_n; ++i ) {
+    actors()->push_back( items[i].mActor );
+  }
+
+  if ( mid_p > mid_n )
+  {
+    setChildN( new ActorKdTree );
+    childN()->setBuildMode( buildMode() );
+    childN()->compileTreeSAH_internal( items, mid_n, mid_p, max_depth-1, minimum_volume, thread_pool, parallel_depth-1, tasks );
+  }
+
+  if ( end > mid_p )
+  {
+    setChildP( new ActorKdTree );
+    childP()->setBuildMode( buildMode() );
+    childP()->compileTreeSAH_internal( items, mid_p, end, max_depth-1, minimum_volume, thread_pool, parallel_depth-1, tasks );
+  }
+}
+//-----------------------------------------------------------------------------
 int ActorKdTree::scorePlane(const Plane& plane, const ActorCollection& acts)
 {
   int cN=0, cC=0, cP=0;
@@ -269,20 +677,238 @@ bool ActorKdTree::findBestPlane(Plane& plane, int& counter, ActorCollection& act
 ActorKdTree* ActorKdTree::insertActor(Actor* actor)
 {
   VL_CHECK(actor->lod(0))
+
+  ActorKdTree* node = insertActor_internal(actor);
+
+  // keep the refit index of the root up to date
+  bool indexed = ! parent() && mRefitState && mRefitState->mIndexed && mRefitState->mIndexTick == updateTick();
+  node->incrementUpdateTick();
+  if ( indexed )
+  {
+    RefitState::ActorEntry entry;
+    entry.mActor = actor;
+    entry.mNode = node;
+    // the node bounds do not include the new Actor yet, let the next refit update them
+    entry.mBoundsVersion = 0;
+    mRefitState->mActorEntry[actor] = mRefitState->mEntries.size();
+    mRefitState->mEntries.push_back( entry );
+    mRefitState->mIndexTick = updateTick();
+  }
+
+  return node;
+}
+//-----------------------------------------------------------------------------
+ActorKdTree* ActorKdTree::insertActor_internal(Actor* actor)
+{
   if (childN() == 0 && childP() == 0)
     actors()->push_back(actor);
   else
   {
     switch( mPlane.classify(actor->boundingBox()) )
     {
-      case -1: if (!childN()) setChildN(new ActorKdTree); return childN()->insertActor(actor);
+      case -1: if (!childN()) setChildN(new ActorKdTree); return childN()->insertActor_internal(actor);
       case 0:  actors()->push_back(actor); break;
-      case +1: if (!childP()) setChildP(new ActorKdTree); return childP()->insertActor(actor);
+      case +1: if (!childP()) setChildP(new ActorKdTree); return childP()->insertActor_internal(actor);
     }
   }
   return this;
 }
 //-----------------------------------------------------------------------------
+ActorKdTree::RefitState* ActorKdTree::refitState()
+{
+  VL_CHECK( ! parent() )
+  if ( ! mRefitState ) {
+    mRefitState = new RefitState;
+  }
+  return mRefitState;
+}
+//-----------------------------------------------------------------------------
+void ActorKdTree::indexActors(RefitState* state, bool keep_versions)
+{
+  // the Actors already indexed keep the bounds version seen by the last refit, the new ones are refit
+  std::unordered_map<const Actor*, unsigned long long> versions;
+  if ( keep_versions )
+  {
+    for( size_t i = 0; i < state->mEntries.size(); ++i ) {
+      versions[ state->mEntries[i].mActor.get() ] = state->mEntries[i].mBoundsVersion;
+    }
+  }
+
+  state->mEntries.clear();
+  state->mActorEntry.clear();
+
+  std::vector<ActorKdTree*> stack;
+  stack.push_back( this );
+  while( ! stack.empty() )
+  {
+    ActorKdTree* node = stack.back();
+    stack.pop_back();
+    for( size_t i = 0; i < node->actors()->size(); ++i )
+    {
+      RefitState::ActorEntry entry;
+      entry.mActor = node->actors()->at(i);
+      entry.mNode = node;
+      if ( keep_versions )
+      {
+        std::unordered_map<const Actor*, unsigned long long>::const_iterator it = versions.find( entry.mActor.get() );
+        entry.mBoundsVersion = it != versions.end() ? it->second : 0;
+      }
+      else {
+        entry.mBoundsVersion = entry.mActor->boundsVersion();
+      }
+      state->mActorEntry[ entry.mActor.get() ] = state->mEntries.size();
+      state->mEntries.push_back( entry );
+    }
+    if ( node->childN() ) stack.push_back( node->childN() );
+    if ( node->childP() ) stack.push_back( node->childP() );
+  }
+
+  state->mIndexed = true;
+  state->mIndexTick = updateTick();
+}
+//-----------------------------------------------------------------------------
+ActorKdTree::RefitState* ActorKdTree::refitIndex()
+{
+  RefitState* state = refitState();
+  if ( ! state->mIndexed || state->mIndexTick != updateTick() ) {
+    indexActors( state, true );
+  }
+  return state;
+}
+//-----------------------------------------------------------------------------
+int ActorKdTree::refit()
+{
+  RefitState* state = refitIndex();
+
+  int count = 0;
+  for( size_t i = 0; i < state->mEntries.size(); ++i ) {
+    count += refitActor( state, i ) ? 1 : 0;
+  }
+
+  refitNodes( state );
+  return count;
+}
+//-----------------------------------------------------------------------------
+int ActorKdTree::refit(ActorCollection& acts)
+{
+  RefitState* state = refitIndex();
+
+  int count = 0;
+  for( size_t i = 0; i < acts.size(); ++i )
+  {
+    std::unordered_map<const Actor*, size_t>::const_iterator it = state->mActorEntry.find( acts.at(i) );
+    if ( it != state->mActorEntry.end() ) {
+      count += refitActor( state, it->second ) ? 1 : 0;
+    }
+  }
+
+  refitNodes( state );
+  return count;
+}
+//-----------------------------------------------------------------------------
+bool ActorKdTree::refitActor(RefitState* state, size_t entry_index)
+{
+  RefitState::ActorEntry& entry = state->mEntries[ entry_index ];
+  Actor* actor = entry.mActor.get();
+  if ( ! actor->lod(0) ) {
+    return false;
+  }
+
+  // boundsDirty() is not enough: the culling might have recomputed the bounds since the last refit
+  actor->computeBounds();
+  if ( actor->boundsVersion() == entry.mBoundsVersion ) {
+    return false;
+  }
+  entry.mBoundsVersion = actor->boundsVersion();
+
+  ActorKdTree* node = entry.mNode;
+  size_t pos = node->actors()->find( actor );
+  if ( pos == Collection<void>::not_found )
+  {
+    // actors() has been edited without incrementUpdateTick(), re-index at the next refit
+    state->mIndexed = false;
+    return false;
+  }
+
+  const AABB& aabb = actor->boundingBox();
+
+  // find the topmost node whose side of its parent's splitting plane the Actor left
+  ActorKdTree* target = node;
+  for( ActorKdTree* n = node; n->parent(); n = static_cast<ActorKdTree*>( n->parent() ) )
+  {
+    const ActorKdTree* p = static_cast<const ActorKdTree*>( n->parent() );
+    int side = n == p->childN() ? -1 : +1;
+    if ( p->plane().classify( aabb ) != side ) {
+      target = static_cast<ActorKdTree*>( n->parent() );
+    }
+  }
+
+  state->markNode( node );
+
+  // move it up lazily, the next rebuild will push it down again
+  if ( target != node )
+  {
+    target->actors()->push_back( actor );
+    node->actors()->eraseAt( pos );
+    entry.mNode = target;
+    ++state->mLiftedCount;
+    state->markNode( target );
+    bool indexed = state->mIndexTick == updateTick();
+    target->incrementUpdateTick();
+    if ( indexed ) {
+      state->mIndexTick = updateTick();
+    }
+  }
+
+  return true;
+}
+//-----------------------------------------------------------------------------
+void ActorKdTree::refitNodes(RefitState* state)
+{
+  // deepest nodes first so that each node is recomputed once after its children
+  for( size_t depth = state->mDirtyNodes.size(); depth--; )
+  {
+    std::vector<ActorKdTree*>& nodes = state->mDirtyNodes[depth];
+    for( size_t i = 0; i < nodes.size(); ++i ) {
+      if ( nodes[i]->computeNodeAABB() && nodes[i]->parent() ) {
+        state->markNode( static_cast<ActorKdTree*>( nodes[i]->parent() ) );
+      }
+    }
+    nodes.clear();
+  }
+  state->mDirtyNodeSet.clear();
+
+  if ( mRebuildThreshold >= 0 && refitDegradation() > mRebuildThreshold ) {
+    rebuildKdTree( state->mMaxDepth, state->mMinimumVolume );
+  }
+}
+//-----------------------------------------------------------------------------
+bool ActorKdTree::computeNodeAABB()
+{
+  AABB aabb;
+  for( size_t i = 0; i < actors()->size(); ++i ) {
+    aabb += actors()->at(i)->boundingBox();
+  }
+  if ( childN() ) {
+    aabb += childN()->aabb();
+  }
+  if ( childP() ) {
+    aabb += childP()->aabb();
+  }
+
+  bool changed = aabb.isNull() != mAABB.isNull() || aabb.minCorner() != mAABB.minCorner() || aabb.maxCorner() != mAABB.maxCorner();
+  mAABB = aabb;
+  return changed;
+}
+//-----------------------------------------------------------------------------
+float ActorKdTree::refitDegradation() const
+{
+  if ( ! mRefitState || mRefitState->mEntries.empty() ) {
+    return 0;
+  }
+  return (float)mRefitState->mLiftedCount / mRefitState->mEntries.size();
+}
+//-----------------------------------------------------------------------------
 int ActorKdTree::childrenCount() const
 {
   if (mChildN && mChildP)
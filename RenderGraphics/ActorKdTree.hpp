@@ -38,10 +38,18 @@
 //#include <vlCore/Plane.hpp>
 //#include <vlCore/Collection.hpp>
 //#include <vlGraphics/ActorTreeAbstract.hpp>
+#include <vlGraphics/ThreadPool.hpp>
  
 
 namespace vl
 {
+  //! Strategy used by ActorKdTree::buildKdTree() to choose the splitting planes.
+  typedef enum
+  {
+    KDB_Median, //!< Splits at the median of the Actors' bounding boxes alternating the x, y and z axes.
+    KDB_SAH     //!< Splits using a binned surface area heuristic in O(n log n), the top levels can be built in parallel.
+  } EKdTreeBuildMode;
+
   /**
    * ActorKdTree class extends the ActorTreeAbstract class implementing a space partitioning scheme based on a Kd-Tree.
    *
@@ -60,10 +68,13 @@ namespace vl
     VL_INSTRUMENT_CLASS(vl::ActorKdTree, ActorTreeAbstract)
 
   public:
-    ActorKdTree()
+    ActorKdTree(): mRefitState(NULL), mBuildMode(KDB_Median), mParallelBuildDepth(4), mRebuildThreshold(0.25f)
     {
       VL_DEBUG_SET_OBJECT_NAME()
     }
+
+    ~ActorKdTree();
+
     virtual int childrenCount() const;
     virtual ActorTreeAbstract* child(int i);
     virtual const ActorTreeAbstract* child(int i) const;
@@ -81,6 +92,21 @@ namespace vl
   //! \note This method calls prepareActors() before computing the KdTree.
   void rebuildKdTree(int max_depth=100, float minimum_volume=0);
 
+  //! The strategy used by buildKdTree() and rebuildKdTree(), KDB_Median by default.
+  void setBuildMode(EKdTreeBuildMode mode) { mBuildMode = mode; }
+  //! The strategy used by buildKdTree() and rebuildKdTree(), KDB_Median by default.
+  EKdTreeBuildMode buildMode() const { return mBuildMode; }
+
+  //! If not NULL the KDB_SAH build mode uses it to bin the top levels and to build the subtrees below parallelBuildDepth() in parallel.
+  void setBuildThreadPool(ThreadPool* thread_pool) { mBuildThreadPool = thread_pool; }
+  //! If not NULL the KDB_SAH build mode uses it to bin the top levels and to build the subtrees below parallelBuildDepth() in parallel.
+  ThreadPool* buildThreadPool() const { return mBuildThreadPool.get(); }
+
+  //! The depth at which the KDB_SAH build mode hands the subtrees to buildThreadPool(), 4 by default.
+  void setParallelBuildDepth(int depth) { mParallelBuildDepth = depth; }
+  //! The depth at which the KDB_SAH build mode hands the subtrees to buildThreadPool(), 4 by default.
+  int parallelBuildDepth() const { return mParallelBuildDepth; }
+
   //! Returns the splitting plane used to divide its two child nodes
   const Plane& plane() const { return mPlane; }
 
@@ -109,6 +135,37 @@ namespace vl
    */
   ActorKdTree* insertActor(Actor* actor);
 
+  /**
+   * Updates the tree after some of its Actors changed their bounds. An Actor is considered changed when its
+   * Actor::boundsVersion() differs from the one seen by the last refit or build, so Actors whose bounds have already been
+   * recomputed by the culling are detected as well. Only the node bounding boxes affected by the changed Actors are recomputed, bottom-up. An Actor that does not
+   * lie anymore on its side of the splitting planes above its node is moved up to the closest node that can contain it,
+   * to be pushed down again by the next rebuild. When the fraction of such moved Actors exceeds rebuildThreshold()
+   * the tree is rebuilt using the parameters of the last buildKdTree().
+   * This version checks the bounds version of every Actor of the tree, which is cheap compared to a rebuild but still
+   * linear in the number of Actors, use refit(ActorCollection&) when the moved Actors are known.
+   * The Actor index used by refit is kept up to date by insertActor(), the actors moved by refit and the builds; it is
+   * rebuilt only when the tree is edited otherwise, which is detected by updateTick(), so nodes whose actors() are edited
+   * directly must call incrementUpdateTick().
+   * \return The number of Actors whose bounds have been updated.
+   * \note Must be called on the root of the tree.
+   */
+  int refit();
+
+  /**
+   * Same as refit() but only considers the given Actors so that the cost is proportional to their number.
+   * Actors not contained in the tree are ignored.
+   */
+  int refit(ActorCollection& actors);
+
+  //! The fraction of Actors moved up by refit() after which the tree is rebuilt, 0.25 by default, a negative value disables the rebuilds.
+  void setRebuildThreshold(float threshold) { mRebuildThreshold = threshold; }
+  //! The fraction of Actors moved up by refit() after which the tree is rebuilt, 0.25 by default, a negative value disables the rebuilds.
+  float rebuildThreshold() const { return mRebuildThreshold; }
+
+  //! The fraction of Actors moved up by refit() since the last build, used as the quality metric of the tree.
+  float refitDegradation() const;
+
   /**
    * Removes the Actors in the internal nodes of the ActorKdTree and uses them to create a new ActorKdTree.
    */
@@ -146,10 +203,36 @@ namespace vl
     //!
     void computeLocalAABB(const ActorCollection& actors);
 
+    struct SAHItem;
+    struct SAHTask;
+    struct RefitState;
+    //! Returns the refit bookkeeping of the root, creating it if needed.
+    RefitState* refitState();
+    //! Indexes all the Actors of the tree by node, keeping the bounds versions of the Actors already indexed if requested.
+    void indexActors(RefitState* state, bool keep_versions);
+    //! Returns the refit bookkeeping re-indexing the tree if it has been edited since the last indexing.
+    RefitState* refitIndex();
+    //! Updates the indexed Actor if its bounds changed since the last refit and moves it up if needed. Returns true if updated.
+    bool refitActor(RefitState* state, size_t entry_index);
+    //! Recomputes the bounding boxes of the nodes touched by refitActor().
+    void refitNodes(RefitState* state);
+    //! Recomputes the bounding box of this node only, from its Actors and child nodes. Returns true if it changed.
+    bool computeNodeAABB();
+    ActorKdTree* insertActor_internal(Actor* actor);
+    //! Builds the tree from the given Actors using the surface area heuristic.
+    void compileTreeSAH(ActorCollection& acts, int max_depth, float minimum_volume);
+    //! Builds the subtree of the given range of items using the surface area heuristic.
+    void compileTreeSAH_internal(std::vector<SAHItem>& items, size_t begin, size_t end, int max_depth, float minimum_volume, ThreadPool* thread_pool, int parallel_depth, std::vector<SAHTask>* tasks);
+
   protected:
     Plane mPlane;
     ref<ActorKdTree> mChildN;
     ref<ActorKdTree> mChildP;
+    ref<ThreadPool> mBuildThreadPool;
+    RefitState* mRefitState;
+    EKdTreeBuildMode mBuildMode;
+    int mParallelBuildDepth;
+    float mRebuildThreshold;
   };
 
 }
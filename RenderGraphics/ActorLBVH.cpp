@@ -0,0 +1,577 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include <vlGraphics/ActorLBVH.hpp>
+#include <vlGraphics/ActorTreeAbstract.hpp>
+#include <vlGraphics/Camera.hpp>
+#include <algorithm>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+namespace
+{
+  // The minimum number of Actors build() hands to a thread pool task.
+  const int MinParallelRange = 8192;
+
+  // Spreads the lower 10 bits of v so that there are two zero bits between each of them.
+  unsigned int expandBits(unsigned int v)
+  {
+    v = ( v * 0x00010001u ) & 0xFF0000FFu;
+    v = ( v * 0x00000101u ) & 0x0F00F00Fu;
+    v = ( v * 0x00000011u ) & 0xC30C30C3u;
+    v = ( v * 0x00000005u ) & 0x49249249u;
+    return v;
+  }
+
+  // 30 bits Morton code of a point whose coordinates are in [0,1].
+  unsigned int mortonCode(float x, float y, float z)
+  {
+    x = std::min( std::max( x * 1024.0f, 0.0f ), 1023.0f );
+    y = std::min( std::max( y * 1024.0f, 0.0f ), 1023.0f );
+    z = std::min( std::max( z * 1024.0f, 0.0f ), 1023.0f );
+    return ( expandBits( (unsigned int)x ) << 2 ) | ( expandBits( (unsigned int)y ) << 1 ) | expandBits( (unsigned int)z );
+  }
+
+  // Index of the highest set bit of v, which must not be 0.
+  int highestBit(unsigned int v)
+  {
+    int bit = 0;
+    if ( v & 0xFFFF0000u ) { v >>= 16; bit += 16; }
+    if ( v & 0x0000FF00u ) { v >>= 8;  bit += 8;  }
+    if ( v & 0x000000F0u ) { v >>= 4;  bit += 4;  }
+    if ( v & 0x0000000Cu ) { v >>= 2;  bit += 2;  }
+    if ( v & 0x00000002u ) { bit += 1; }
+    return bit;
+  }
+
+  // Stable LSD radix sort of the keys by their upper 32 bits, 8 bits per pass.
+  void radixSort(std::vector<unsigned long long>& keys, ThreadPool* thread_pool)
+  {
+    const int count = (int)keys.size();
+    const int chunks = ThreadPool::rangeCount( thread_pool, count, MinParallelRange );
+    std::vector<unsigned long long> temp( keys.size() );
+    std::vector<int> offsets( chunks * 256 );
+
+    unsigned long long* src = &keys[0];
+    unsigned long long* dst = &temp[0];
+    for( int shift = 32; shift < 64; shift += 8 )
+    {
+      // per chunk histograms
+      std::fill( offsets.begin(), offsets.end(), 0 );
+      ThreadPool::parallelFor( thread_pool, count, chunks, [src, shift, &offsets](int chunk, int begin, int end) {
+        int* histogram = &offsets[chunk * 256];
+        for( int i = begin; i < end; ++i ) {
+          ++histogram[ ( src[i] >> shift ) & 0xFF ];
+        }
+      } );
+
+      // a pass where all the keys share the same digit would not move anything
+      bool skip = false;
+      for( int digit = 0; digit < 256 && ! skip; ++digit )
+      {
+        int total = 0;
+        for( int chunk = 0; chunk < chunks; ++chunk ) {
+          total += offsets[chunk * 256 + digit];
+        }
+        skip = total == count;
+      }
+      if ( skip ) {
+        continue;
+      }
+
+      // digit major, chunk minor prefix sum keeps the sort stable
+      int sum = 0;
+      for( int digit = 0; digit < 256; ++digit )
+      {
+        for( int chunk = 0; chunk < chunks; ++chunk )
+        {
+          int& offset = offsets[chunk * 256 + digit];
+          int chunk_count = offset;
+          offset = sum;
+          sum += chunk_count;
+        }
+      }
+
+      ThreadPool::parallelFor( thread_pool, count, chunks, [src, dst, shift, &offsets](int chunk, int begin, int end) {
+        int* offset = &offsets[chunk * 256];
+        for( int i = begin; i < end; ++i ) {
+          dst[ offset[ ( src[i] >> shift ) & 0xFF ]++ ] = src[i];
+        }
+      } );
+
+      std::swap( src, dst );
+    }
+
+    if ( src != &keys[0] ) {
+      keys.swap( temp );
+    }
+  }
+
+  // Returns the index splitting the sorted codes in [begin,end) where their highest differing bit changes.
+  int findSplit(const std::vector<unsigned int>& codes, int begin, int end)
+  {
+    const unsigned int first = codes[begin];
+    const unsigned int last = codes[end - 1];
+
+    // identical codes are split in the middle
+    if ( first == last ) {
+      return ( begin + end ) / 2;
+    }
+
+    // the last index whose code shares more than the common prefix with the first code
+    const int prefix_bit = highestBit( first ^ last );
+    int split = begin;
+    int step = end - 1 - begin;
+    do
+    {
+      step = ( step + 1 ) >> 1;
+      int new_split = split + step;
+      if ( new_split < end - 1 && ( ( first ^ codes[new_split] ) >> prefix_bit ) == 0 ) {
+        split = new_split;
+      }
+    } while( step > 1 );
+
+    return split + 1;
+  }
+
+  // Appends to nodes the subtree of the Actors in [begin,end), node indices are relative to nodes.
+  // The Actors' bounding boxes are read from bounds, in Morton order, instead of chasing the Actors in memory.
+  void buildSubtree(std::vector<ActorLBVH::Node>& nodes, const std::vector<unsigned int>& codes, const std::vector<AABB>& bounds, int begin, int end, int leaf_size)
+  {
+    const int index = (int)nodes.size();
+    nodes.push_back( ActorLBVH::Node() );
+
+    if ( end - begin <= leaf_size )
+    {
+      ActorLBVH::Node& leaf = nodes[index];
+      leaf.mFirst = begin;
+      leaf.mCount = end - begin;
+      leaf.mSkip = index + 1;
+      for( int i = begin; i < end; ++i ) {
+        leaf.mAABB += bounds[i];
+      }
+      return;
+    }
+
+    const int split = findSplit( codes, begin, end );
+    buildSubtree( nodes, codes, bounds, begin, split, leaf_size );
+    buildSubtree( nodes, codes, bounds, split, end, leaf_size );
+
+    ActorLBVH::Node& node = nodes[index];
+    node.mSkip = (int)nodes.size();
+    node.mAABB = nodes[index + 1].mAABB;
+    node.mAABB += nodes[ nodes[index + 1].mSkip ].mAABB;
+  }
+
+  // A range of Actors whose subtree is built by a task.
+  struct Subtree
+  {
+    Subtree(int begin, int end): mBegin(begin), mEnd(end) {}
+
+    int mBegin;
+    int mEnd;
+    std::vector<ActorLBVH::Node> mNodes;
+  };
+
+  // Splits the top levels of the hierarchy down to depth into the ranges of the subtrees to be built in parallel.
+  void planSubtrees(std::vector<Subtree>& subtrees, const std::vector<unsigned int>& codes, int begin, int end, int depth, int leaf_size)
+  {
+    if ( depth == 0 || end - begin <= leaf_size )
+    {
+      subtrees.push_back( Subtree( begin, end ) );
+      return;
+    }
+
+    const int split = findSplit( codes, begin, end );
+    planSubtrees( subtrees, codes, begin, split, depth - 1, leaf_size );
+    planSubtrees( subtrees, codes, split, end, depth - 1, leaf_size );
+  }
+
+  // Emits the top levels planned by planSubtrees() and splices in the subtrees built by the tasks.
+  void assembleSubtrees(std::vector<ActorLBVH::Node>& nodes, std::vector<Subtree>& subtrees, size_t& next, const std::vector<unsigned int>& codes, int begin, int end, int depth, int leaf_size)
+  {
+    if ( depth == 0 || end - begin <= leaf_size )
+    {
+      const std::vector<ActorLBVH::Node>& subtree = subtrees[next++].mNodes;
+      const int offset = (int)nodes.size();
+      nodes.insert( nodes.end(), subtree.begin(), subtree.end() );
+      for( size_t i = offset; i < nodes.size(); ++i ) {
+        nodes[i].mSkip += offset;
+      }
+      return;
+    }
+
+    const int index = (int)nodes.size();
+    nodes.push_back( ActorLBVH::Node() );
+
+    const int split = findSplit( codes, begin, end );
+    assembleSubtrees( nodes, subtrees, next, codes, begin, split, depth - 1, leaf_size );
+    assembleSubtrees( nodes, subtrees, next, codes, split, end, depth - 1, leaf_size );
+
+    ActorLBVH::Node& node = nodes[index];
+    node.mSkip = (int)nodes.size();
+    node.mAABB = nodes[index + 1].mAABB;
+    node.mAABB += nodes[ nodes[index + 1].mSkip ].mAABB;
+  }
+
+  // Culls the nodes in [begin,end), which must be a sequence of whole subtrees.
+  // The leaves refer to ranges of \p order, which holds indices into \p actors.
+  // The Actors are culled in batches using the store, whose slots follow \p order, against the \p planes of the camera.
+  // If deferred is not NULL the Actors whose Renderable bounds are dirty are appended without being updated and culled and their positions are recorded.
+  void extractVisibleNodes(const std::vector<ActorLBVH::Node>& nodes, ActorCollection& actors, const std::vector<int>& order, ActorBoundsStore& store, const ActorBoundsStore::Planes& planes,
+                           int begin, int end, ActorCollection& list, const Camera* camera, unsigned enable_mask, std::vector<size_t>* deferred)
+  {
+    for( int i = begin; i < end; )
+    {
+      const ActorLBVH::Node& node = nodes[i];
+      if ( camera && camera->frustum().cull( node.mAABB ) )
+      {
+        i = node.mSkip;
+        continue;
+      }
+
+      const int leaf_end = node.mFirst + node.mCount;
+      for( int first = node.mFirst; first < leaf_end; first += 32 )
+      {
+        const int last = std::min( first + 32, leaf_end );
+
+        // update the bounds and mirror them to the store
+        for( int j = first; j < last; ++j )
+        {
+          Actor* actor = actors.at( order[j] );
+          if ( ! actor->isEnabled() || ! ( enable_mask & actor->enableMask() ) ) {
+            continue;
+          }
+          if ( deferred && actor->lod(0) && actor->lod(0)->boundsDirty() ) {
+            continue;
+          }
+          actor->computeBounds();
+          if ( camera ) {
+            store.sync( j, actor );
+          }
+        }
+
+        // cull up to 32 bounding spheres and boxes at once
+        unsigned int visible = ~0u;
+        if ( camera ) {
+          store.cull( planes, first, last - first, &visible );
+        }
+
+        for( int j = first; j < last; ++j )
+        {
+          Actor* actor = actors.at( order[j] );
+          if ( ! actor->isEnabled() || ! ( enable_mask & actor->enableMask() ) ) {
+            continue;
+          }
+          if ( deferred && actor->lod(0) && actor->lod(0)->boundsDirty() )
+          {
+            deferred->push_back( list.size() );
+            list.push_back( actor );
+          }
+          else
+          if ( ( visible >> ( j - first ) ) & 1 ) {
+            list.push_back( actor );
+          }
+        }
+      }
+
+      ++i;
+    }
+  }
+
+  // The Actors extracted from a portion of the hierarchy by extractVisibleActorsParallel().
+  struct CullSegment
+  {
+    CullSegment(int begin, int end): mBegin(begin), mEnd(end) {}
+
+    int mBegin; // nodes to be culled by a task, empty if already culled
+    int mEnd;
+    ActorCollection mActors;
+    std::vector<size_t> mDeferred; // Actors in mActors whose Renderable bounds are dirty
+  };
+
+  // Traverses the top levels of the hierarchy on the calling thread and collects the subtrees to be culled in parallel.
+  void splitCullSegments(const std::vector<ActorLBVH::Node>& nodes, ActorCollection& actors, const std::vector<int>& order, ActorBoundsStore& store, const ActorBoundsStore::Planes& planes,
+                         int index, std::vector<CullSegment>& segments, const Camera* camera, unsigned enable_mask, int depth)
+  {
+    const ActorLBVH::Node& node = nodes[index];
+    if ( depth == 0 )
+    {
+      segments.push_back( CullSegment( index, node.mSkip ) );
+      return;
+    }
+
+    if ( node.isLeaf() )
+    {
+      segments.push_back( CullSegment( 0, 0 ) );
+      extractVisibleNodes( nodes, actors, order, store, planes, index, node.mSkip, segments.back().mActors, camera, enable_mask, NULL );
+      return;
+    }
+
+    if ( camera && camera->frustum().cull( node.mAABB ) ) {
+      return;
+    }
+
+    splitCullSegments( nodes, actors, order, store, planes, index + 1, segments, camera, enable_mask, depth - 1 );
+    splitCullSegments( nodes, actors, order, store, planes, nodes[index + 1].mSkip, segments, camera, enable_mask, depth - 1 );
+  }
+}
+//-----------------------------------------------------------------------------
+// ActorLBVH
+//-----------------------------------------------------------------------------
+ActorLBVH::ActorLBVH()
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+  mActors.setAutomaticDelete(false);
+  mUpdateTick = 0;
+  mActorsEdited = false;
+  mLeafSize = 4;
+}
+//-----------------------------------------------------------------------------
+void ActorLBVH::build(ActorCollection& actors)
+{
+  mActors.clear();
+  mActors.reserve( actors.size() );
+  for( size_t i = 0; i < actors.size(); ++i ) {
+    mActors.push_back( actors.at(i) );
+  }
+  build();
+}
+//-----------------------------------------------------------------------------
+void ActorLBVH::build()
+{
+  ++mUpdateTick;
+  mNodes.clear();
+  mOrderedIndices.clear();
+  mActorsEdited = false;
+  mBoundsStore.resize( 0 );
+
+  const int count = (int)mActors.size();
+  if ( count == 0 ) {
+    return;
+  }
+
+  ActorTreeAbstract::prepareActors( mActors );
+
+  ThreadPool* thread_pool = buildThreadPool();
+  const int chunks = ThreadPool::rangeCount( thread_pool, count, MinParallelRange );
+
+  // copy the Actors' bounds and compute the bounds of their centers
+  std::vector<AABB> actor_bounds( count );
+  std::vector<AABB> chunk_bounds( chunks );
+  ThreadPool::parallelFor( thread_pool, count, chunks, [this, &actor_bounds, &chunk_bounds](int chunk, int begin, int end) {
+    AABB& bounds = chunk_bounds[chunk];
+    for( int i = begin; i < end; ++i )
+    {
+      const AABB& aabb = actor_bounds[i] = mActors.at(i)->boundingBox();
+      if ( ! aabb.isNull() ) {
+        bounds.addPoint( aabb.center() );
+      }
+    }
+  } );
+  AABB center_bounds;
+  for( int i = 0; i < chunks; ++i ) {
+    center_bounds += chunk_bounds[i];
+  }
+
+  // Morton codes in the upper 32 bits, Actor index in the lower ones
+  std::vector<unsigned long long> keys( count );
+  const vec3 origin = center_bounds.isNull() ? vec3(0, 0, 0) : center_bounds.minCorner();
+  const vec3 extent = center_bounds.isNull() ? vec3(0, 0, 0) : center_bounds.maxCorner() - center_bounds.minCorner();
+  const float scale_x = extent.x() > 0 ? 1.0f / (float)extent.x() : 0.0f;
+  const float scale_y = extent.y() > 0 ? 1.0f / (float)extent.y() : 0.0f;
+  const float scale_z = extent.z() > 0 ? 1.0f / (float)extent.z() : 0.0f;
+  ThreadPool::parallelFor( thread_pool, count, chunks, [&](int, int begin, int end) {
+    for( int i = begin; i < end; ++i )
+    {
+      const AABB& aabb = actor_bounds[i];
+      unsigned int code = 0;
+      if ( ! aabb.isNull() )
+      {
+        vec3 center = aabb.center() - origin;
+        code = mortonCode( (float)center.x() * scale_x, (float)center.y() * scale_y, (float)center.z() * scale_z );
+      }
+      keys[i] = ( (unsigned long long)code << 32 ) | (unsigned int)i;
+    }
+  } );
+
+  radixSort( keys, thread_pool );
+
+  std::vector<unsigned int> codes( count );
+  std::vector<AABB> sorted_bounds( count );
+  mOrderedIndices.resize( count );
+  mBoundsStore.resize( count );
+  ThreadPool::parallelFor( thread_pool, count, chunks, [&](int, int begin, int end) {
+    for( int i = begin; i < end; ++i )
+    {
+      const int index = (int)( keys[i] & 0xFFFFFFFF );
+      codes[i] = (unsigned int)( keys[i] >> 32 );
+      sorted_bounds[i] = actor_bounds[index];
+      mOrderedIndices[i] = index;
+    }
+  } );
+
+  // split the top levels in about one subtree per range, that is a few per thread
+  int task_depth = 0;
+  if ( chunks > 1 )
+  {
+    while( ( 1 << task_depth ) < chunks ) {
+      ++task_depth;
+    }
+  }
+
+  std::vector<Subtree> subtrees;
+  planSubtrees( subtrees, codes, 0, count, task_depth, mLeafSize );
+
+  if ( subtrees.size() == 1 )
+  {
+    mNodes.reserve( 2 * count / mLeafSize + 1 );
+    buildSubtree( mNodes, codes, sorted_bounds, 0, count, mLeafSize );
+    return;
+  }
+
+  const int leaf_size = mLeafSize;
+  thread_pool->parallelFor( (int)subtrees.size(), [&subtrees, &codes, &sorted_bounds, leaf_size](int i) {
+    Subtree& subtree = subtrees[i];
+    subtree.mNodes.reserve( 2 * ( subtree.mEnd - subtree.mBegin ) / leaf_size + 1 );
+    buildSubtree( subtree.mNodes, codes, sorted_bounds, subtree.mBegin, subtree.mEnd, leaf_size );
+  } );
+
+  mNodes.reserve( 2 * count / mLeafSize + subtrees.size() * 2 );
+  size_t next = 0;
+  assembleSubtrees( mNodes, subtrees, next, codes, 0, count, task_depth, mLeafSize );
+  VL_CHECK( next == subtrees.size() )
+}
+//-----------------------------------------------------------------------------
+bool ActorLBVH::validate()
+{
+  if ( mActorsEdited || mOrderedIndices.size() != mActors.size() )
+  {
+    build();
+    return false;
+  }
+  return true;
+}
+//-----------------------------------------------------------------------------
+void ActorLBVH::refit()
+{
+  if ( ! validate() ) {
+    return;
+  }
+
+  // children always follow their parent
+  for( int i = (int)mNodes.size() - 1; i >= 0; --i )
+  {
+    Node& node = mNodes[i];
+    node.mAABB.setNull();
+    if ( node.isLeaf() )
+    {
+      for( int j = node.mFirst; j < node.mFirst + node.mCount; ++j )
+      {
+        Actor* actor = mActors.at( mOrderedIndices[j] );
+        actor->computeBounds();
+        node.mAABB += actor->boundingBox();
+      }
+    }
+    else
+    {
+      node.mAABB += mNodes[i + 1].mAABB;
+      node.mAABB += mNodes[ mNodes[i + 1].mSkip ].mAABB;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void ActorLBVH::extractActors(ActorCollection& list)
+{
+  for( size_t i = 0; i < mActors.size(); ++i ) {
+    list.push_back( mActors.at(i) );
+  }
+}
+//-----------------------------------------------------------------------------
+void ActorLBVH::extractVisibleActors(ActorCollection& list, const Camera* camera, unsigned enable_mask)
+{
+  validate();
+  const ActorBoundsStore::Planes planes( camera ? camera->frustum() : Frustum() );
+  extractVisibleNodes( mNodes, mActors, mOrderedIndices, mBoundsStore, planes, 0, (int)mNodes.size(), list, camera, enable_mask, NULL );
+}
+//-----------------------------------------------------------------------------
+void ActorLBVH::extractVisibleActorsParallel(ActorCollection& list, const Camera* camera, unsigned enable_mask, int split_depth, ThreadPool* thread_pool)
+{
+  validate();
+
+  if ( mNodes.empty() ) {
+    return;
+  }
+
+  if ( ! thread_pool ) {
+    thread_pool = ThreadPool::defaultThreadPool();
+  }
+
+  const ActorBoundsStore::Planes planes( camera ? camera->frustum() : Frustum() );
+  std::vector<CullSegment> segments;
+  splitCullSegments( mNodes, mActors, mOrderedIndices, mBoundsStore, planes, 0, segments, camera, enable_mask, split_depth > 0 ? split_depth : 1 );
+
+  // collect the subtrees to be culled by the workers
+  std::vector<CullSegment*> tasks;
+  for( size_t i = 0; i < segments.size(); ++i ) {
+    if ( segments[i].mBegin != segments[i].mEnd ) {
+      tasks.push_back( &segments[i] );
+    }
+  }
+
+  thread_pool->parallelFor( (int)tasks.size(), [this, &tasks, &planes, camera, enable_mask](int i) {
+    CullSegment& segment = *tasks[i];
+    extractVisibleNodes( mNodes, mActors, mOrderedIndices, mBoundsStore, planes, segment.mBegin, segment.mEnd, segment.mActors, camera, enable_mask, &segment.mDeferred );
+  } );
+
+  // merge in tree order, finishing up the postponed Actors with the same test used by extractVisibleNodes()
+  for( size_t i = 0; i < segments.size(); ++i )
+  {
+    CullSegment& segment = segments[i];
+    size_t next_deferred = 0;
+    for( size_t j = 0; j < segment.mActors.size(); ++j )
+    {
+      Actor* actor = segment.mActors.at(j);
+      if ( next_deferred < segment.mDeferred.size() && segment.mDeferred[next_deferred] == j )
+      {
+        ++next_deferred;
+        actor->computeBounds();
+        if ( camera && ActorBoundsStore::cull( planes, actor->boundingBox(), actor->boundingSphere() ) ) {
+          continue;
+        }
+      }
+      list.push_back( actor );
+    }
+  }
+}
+//-----------------------------------------------------------------------------
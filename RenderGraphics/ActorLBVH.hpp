@@ -0,0 +1,161 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef ActorLBVH_INCLUDE_ONCE
+#define ActorLBVH_INCLUDE_ONCE
+
+#include <vlGraphics/Actor.hpp>
+#include <vlGraphics/ActorBoundsStore.hpp>
+#include <vlGraphics/ThreadPool.hpp>
+#include <vlCore/AABB.hpp>
+#include <vector>
+
+namespace vl
+{
+  class Camera;
+
+  /**
+   * The ActorLBVH class implements a linear bounding volume hierarchy of Actors.
+   *
+   * The hierarchy is built by sorting the Actors along a Morton curve of their centers and by recursively splitting
+   * the sorted list where the Morton codes differ in their highest bit, so that building even millions of Actors takes
+   * a handful of linear passes. The nodes are stored in a single array in depth-first order, each node storing the index
+   * of the node following its subtree, so that culling is a linear scan of the array that jumps over the culled subtrees.
+   *
+   * Unlike ActorKdTree and ActorTree the nodes are not ActorTreeAbstract objects: the Actors are kept in a single
+   * collection, see actors(), and the hierarchy must be refitted with refit() after the Actors' bounds change.
+   * The leaves refer to the Actors by index: accessing the collection through the non-const actors() marks the hierarchy
+   * as edited and the next refit() or traversal rebuilds it, so the hierarchy never refers to Actors that have been removed.
+   *
+   * \sa
+   * - ActorKdTree
+   * - ActorTree
+   * - SceneManagerActorLBVH
+   */
+  class VLGRAPHICS_EXPORT ActorLBVH: public Object
+  {
+    VL_INSTRUMENT_CLASS(vl::ActorLBVH, Object)
+
+  public:
+    //! A node of the hierarchy.
+    struct Node
+    {
+      Node(): mSkip(0), mFirst(0), mCount(0) {}
+
+      //! Returns \p true if the node contains Actors instead of child nodes.
+      bool isLeaf() const { return mCount > 0; }
+
+      AABB mAABB;
+      //! Index of the first node after this node's subtree.
+      int mSkip;
+      //! First Actor of the leaf in orderedIndices().
+      int mFirst;
+      //! Number of Actors of the leaf, 0 for internal nodes whose children are the next node and the node at its mSkip.
+      int mCount;
+    };
+
+  public:
+    ActorLBVH();
+
+    //! The Actors contained in the hierarchy. The collection is assumed to be modified: updateTick() is incremented and the
+    //! hierarchy is rebuilt by the next refit() or traversal, unless build() is called first.
+    ActorCollection* actors() { ++mUpdateTick; mActorsEdited = true; return &mActors; }
+    //! The Actors contained in the hierarchy.
+    const ActorCollection* actors() const { return &mActors; }
+
+    //! Rebuilds the hierarchy from actors().
+    //! \note This method calls ActorTreeAbstract::prepareActors() before building the hierarchy.
+    void build();
+
+    //! Replaces actors() with the given Actors and rebuilds the hierarchy.
+    void build(ActorCollection& actors);
+
+    //! Recomputes the bounding boxes of all the nodes from the current bounds of the Actors without changing the hierarchy, in linear time.
+    //! Rebuilds the hierarchy instead if actors() has been edited since the last build().
+    void refit();
+
+    //! The maximum number of Actors per leaf, 4 by default.
+    void setLeafSize(int size) { mLeafSize = size < 1 ? 1 : size; }
+    //! The maximum number of Actors per leaf, 4 by default.
+    int leafSize() const { return mLeafSize; }
+
+    //! If not NULL build() uses it to compute the Morton codes, sort them and build the subtrees in parallel.
+    void setBuildThreadPool(ThreadPool* thread_pool) { mBuildThreadPool = thread_pool; }
+    //! If not NULL build() uses it to compute the Morton codes, sort them and build the subtrees in parallel.
+    ThreadPool* buildThreadPool() const { return mBuildThreadPool.get(); }
+
+    //! The nodes in depth-first order, the first one being the root.
+    const std::vector<Node>& nodes() const { return mNodes; }
+
+    //! The indices into actors() of the Actors sorted along the Morton curve, the leaves refer to ranges of this array.
+    const std::vector<int>& orderedIndices() const { return mOrderedIndices; }
+
+    //! Incremented by build() and by the non-const actors(), used by SceneManagerActorLBVH to signal that the Actors of the hierarchy changed.
+    long long updateTick() const { return mUpdateTick; }
+
+    //! The bounding box of the whole hierarchy.
+    const AABB& aabb() const { return mNodes.empty() ? mNullAABB : mNodes[0].mAABB; }
+
+    //! Appends all the Actors to the given ActorCollection.
+    void extractActors(ActorCollection& list);
+
+    /**
+     * Appends to \p list the enabled Actors whose enableMask() matches \p enable_mask and that are not culled by \p camera, if not NULL.
+     * The nodes are culled using their bounding boxes while the Actors of each leaf are culled in batches, using their bounding spheres
+     * and boxes mirrored in an ActorBoundsStore.
+     */
+    void extractVisibleActors(ActorCollection& list, const Camera* camera, unsigned enable_mask=0xFFFFFFFF);
+
+    /**
+     * Same as extractVisibleActors() but the subtrees found at \p split_depth are culled in parallel by \p thread_pool,
+     * or ThreadPool::defaultThreadPool() if NULL. Produces the same list in the same order.
+     */
+    void extractVisibleActorsParallel(ActorCollection& list, const Camera* camera, unsigned enable_mask=0xFFFFFFFF, int split_depth=4, ThreadPool* thread_pool=NULL);
+
+  protected:
+    // rebuilds the hierarchy if actors() has been edited since the last build(), returns false if it did
+    bool validate();
+
+  protected:
+    ActorCollection mActors;
+    std::vector<int> mOrderedIndices;
+    std::vector<Node> mNodes;
+    ActorBoundsStore mBoundsStore;
+    ref<ThreadPool> mBuildThreadPool;
+    AABB mNullAABB;
+    long long mUpdateTick;
+    int mLeafSize;
+    bool mActorsEdited;
+  };
+}
+
+#endif
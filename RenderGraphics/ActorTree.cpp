@@ -41,6 +41,7 @@ void ActorTree::eraseAllChildren()
     mChildren[i]->setParent( NULL );
   }
   mChildren.clear();
+  incrementUpdateTick();
 }
 //-----------------------------------------------------------------------------
 void ActorTree::addChild(ActorTreeAbstract* node)
@@ -51,6 +52,7 @@ void ActorTree::addChild(ActorTreeAbstract* node)
   }
   node->setParent( this );
   mChildren.push_back( node );
+  incrementUpdateTick();
 }
 //-----------------------------------------------------------------------------
 void ActorTree::addChildOnce(ActorTreeAbstract* node)
@@ -90,6 +92,7 @@ void ActorTree::setChild(int i, ActorTreeAbstract* node)
   mChildren[i]->setParent( NULL );
   mChildren[i] = node;
   node->setParent( this );
+  incrementUpdateTick();
 }
 //-----------------------------------------------------------------------------
 void ActorTree::eraseChild(int i, int count)
@@ -98,5 +101,6 @@ void ActorTree::eraseChild(int i, int count)
     mChildren[j]->setParent( NULL );
   }
   mChildren.erase( mChildren.begin() + i, mChildren.begin() + i + count );
+  incrementUpdateTick();
 }
 //-----------------------------------------------------------------------------
@@ -31,6 +31,7 @@
 
 #include <vlGraphics/ActorTreeAbstract.hpp>
 #include <vlGraphics/Camera.hpp>
+#include <vlGraphics/ThreadPool.hpp>
 
 using namespace vl;
 
@@ -40,6 +41,7 @@ ActorTreeAbstract::ActorTreeAbstract()
   VL_DEBUG_SET_OBJECT_NAME()
   mActors.setAutomaticDelete(false);
   mParent = NULL;
+  mUpdateTick = 0;
   mEnabled = true;
 }
 //-----------------------------------------------------------------------------
@@ -83,23 +85,161 @@ void ActorTreeAbstract::extractVisibleActors(ActorCollection& list, const Camera
   }
 
   // Cull / extract this node's Actors
-  for( size_t i = 0; i < actors()->size(); ++i )
+  extractVisibleNodeActors( list, camera, enable_mask );
+
+  // Descend to child nodes
+  for( int i = 0; i < childrenCount(); ++i ) {
+    if ( child(i) ) {
+      child(i)->extractVisibleActors( list, camera );
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void ActorTreeAbstract::extractVisibleNodeActors(ActorCollection& list, const Camera* camera, unsigned enable_mask, std::vector<size_t>* deferred)
+{
+  const int count = (int)actors()->size();
+
+  if ( camera && mBoundsStore.size() != count ) {
+    mBoundsStore.resize( count );
+  }
+
+  // Update the bounds and mirror them to the store
+  for( int i = 0; i < count; ++i )
   {
-    if ( actors()->at(i)->isEnabled() && ( enable_mask & actors()->at(i)->enableMask() ) )
+    Actor* actor = actors()->at(i);
+    if ( actor->isEnabled() && ( enable_mask & actor->enableMask() ) )
     {
-      actors()->at(i)->computeBounds();
-      if ( camera && camera->frustum().cull( actors()->at(i)->boundingSphere() ) ) {
+      if ( deferred && actor->lod(0) && actor->lod(0)->boundsDirty() ) {
         continue;
-      } else {
-        list.push_back(actors()->at(i));
+      }
+      actor->computeBounds();
+      if ( camera ) {
+        mBoundsStore.sync( i, actor );
       }
     }
   }
 
-  // Descend to child nodes
-  for( int i = 0; i < childrenCount(); ++i ) {
-    if ( child(i) ) {
-      child(i)->extractVisibleActors( list, camera );
+  // Cull all the bounding spheres and boxes at once
+  if ( camera ) {
+    mBoundsStore.cull( camera->frustum(), mVisibleMask );
+  }
+
+  for( int i = 0; i < count; ++i )
+  {
+    Actor* actor = actors()->at(i);
+    if ( actor->isEnabled() && ( enable_mask & actor->enableMask() ) )
+    {
+      if ( deferred && actor->lod(0) && actor->lod(0)->boundsDirty() )
+      {
+        deferred->push_back( list.size() );
+        list.push_back( actor );
+      }
+      else
+      if ( ! camera || ActorBoundsStore::isVisible( mVisibleMask, i ) ) {
+        list.push_back( actor );
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+namespace
+{
+  // The Actors extracted from a portion of the tree by extractVisibleActorsParallel().
+  struct CullSegment
+  {
+    CullSegment(): mNode(NULL) {}
+
+    ActorTreeAbstract* mNode; // subtree to be culled by a task or NULL if already culled
+    ActorCollection mActors;
+    std::vector<size_t> mDeferred; // Actors in mActors whose Renderable bounds are dirty
+  };
+
+  // Same as ActorTreeAbstract::extractVisibleActors() but safe to be run concurrently on disjoint subtrees.
+  void extractVisibleActorsTask(ActorTreeAbstract* node, CullSegment& segment, const Camera* camera, unsigned enable_mask)
+  {
+    if ( ! node->isEnabled() || ( camera && camera->frustum().cull( node->aabb() ) ) ) {
+      return;
+    }
+
+    // updating a possibly shared Renderable is left to the calling thread
+    node->extractVisibleNodeActors( segment.mActors, camera, enable_mask, &segment.mDeferred );
+
+    for( int i = 0; i < node->childrenCount(); ++i ) {
+      if ( node->child(i) ) {
+        extractVisibleActorsTask( node->child(i), segment, camera, 0xFFFFFFFF );
+      }
+    }
+  }
+
+  // Traverses the top levels of the tree on the calling thread and collects the subtrees to be culled in parallel.
+  void splitCullSegments(ActorTreeAbstract* node, std::vector<CullSegment>& segments, const Camera* camera, unsigned enable_mask, int depth)
+  {
+    if ( depth == 0 )
+    {
+      segments.push_back( CullSegment() );
+      segments.back().mNode = node;
+      return;
+    }
+
+    if ( ! node->isEnabled() || ( camera && camera->frustum().cull( node->aabb() ) ) ) {
+      return;
+    }
+
+    // this node's own Actors, without descending to the children
+    if ( ! node->actors()->empty() )
+    {
+      segments.push_back( CullSegment() );
+      node->extractVisibleNodeActors( segments.back().mActors, camera, enable_mask );
+    }
+
+    for( int i = 0; i < node->childrenCount(); ++i ) {
+      if ( node->child(i) ) {
+        splitCullSegments( node->child(i), segments, camera, 0xFFFFFFFF, depth - 1 );
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void ActorTreeAbstract::extractVisibleActorsParallel(ActorCollection& list, const Camera* camera, unsigned enable_mask, int split_depth, ThreadPool* thread_pool)
+{
+  if ( ! thread_pool ) {
+    thread_pool = ThreadPool::defaultThreadPool();
+  }
+
+  std::vector<CullSegment> segments;
+  splitCullSegments( this, segments, camera, enable_mask, split_depth > 0 ? split_depth : 1 );
+
+  // collect the subtrees to be culled by the workers
+  std::vector<CullSegment*> tasks;
+  for( size_t i = 0; i < segments.size(); ++i ) {
+    if ( segments[i].mNode ) {
+      tasks.push_back( &segments[i] );
+    }
+  }
+
+  // the root is the only node culled with the user's enable mask, see extractVisibleActors()
+  thread_pool->parallelFor( (int)tasks.size(), [&tasks, camera](int i) {
+    extractVisibleActorsTask( tasks[i]->mNode, *tasks[i], camera, 0xFFFFFFFF );
+  } );
+
+  // merge in tree order, finishing up the postponed Actors with the same test used by extractVisibleNodeActors()
+  const ActorBoundsStore::Planes planes( camera ? camera->frustum() : Frustum() );
+  for( size_t i = 0; i < segments.size(); ++i )
+  {
+    CullSegment& segment = segments[i];
+    size_t next_deferred = 0;
+    for( size_t j = 0; j < segment.mActors.size(); ++j )
+    {
+      Actor* actor = segment.mActors.at(j);
+      if ( next_deferred < segment.mDeferred.size() && segment.mDeferred[next_deferred] == j )
+      {
+        ++next_deferred;
+        actor->computeBounds();
+        if ( camera && ActorBoundsStore::cull( planes, actor->boundingBox(), actor->boundingSphere() ) ) {
+          continue;
+        }
+      }
+      list.push_back( actor );
     }
   }
 }
@@ -110,6 +250,7 @@ ActorTreeAbstract* ActorTreeAbstract::eraseActor(Actor* actor)
   if (pos != Collection<void>::not_found)
   {
     actors()->eraseAt(pos);
+    incrementUpdateTick();
     return this;
   }
   else
@@ -126,15 +267,24 @@ Actor* ActorTreeAbstract::addActor(Renderable* renderable, Effect* eff, Transfor
 {
   ref<Actor> act = new Actor(renderable,eff,tr);
   actors()->push_back( act.get() );
+  incrementUpdateTick();
   return act.get();
 }
 //-----------------------------------------------------------------------------
 Actor* ActorTreeAbstract::addActor(Actor* actor)
 {
   actors()->push_back(actor);
+  incrementUpdateTick();
   return actor;
 }
 //-----------------------------------------------------------------------------
+void ActorTreeAbstract::incrementUpdateTick()
+{
+  for( ActorTreeAbstract* node = this; node; node = node->parent() ) {
+    ++node->mUpdateTick;
+  }
+}
+//-----------------------------------------------------------------------------
 void ActorTreeAbstract::prepareActors(ActorCollection& actors)
 {
   // finds the root transforms
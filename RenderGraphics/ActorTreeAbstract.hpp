@@ -33,11 +33,14 @@
 #define ActorTree_INCLUDE_ONCE
 
 #include <vlGraphics/Actor.hpp>
+#include <vlGraphics/ActorBoundsStore.hpp>
 #include <vlCore/AABB.hpp>
 #include <set>
 
 namespace vl
 {
+  class ThreadPool;
+
   /** The ActorTreeAbstract class implements the interface of a generic tree containing Actors in its nodes.
    *
    * The interface of ActorTreeAbstract allows you to:
@@ -98,6 +101,15 @@ namespace vl
      */
     void extractVisibleActors(ActorCollection& list, const Camera* camera, unsigned enable_mask=0xFFFFFFFF);
 
+    /**
+     * Parallel version of extractVisibleActors() producing exactly the same list of Actors in the same order.
+     * The nodes up to \p split_depth are traversed by the calling thread while each subtree rooted at \p split_depth
+     * is culled as a separate task of \p thread_pool. The results of the tasks are then appended to \p list in tree order.
+     * Actors whose Renderable has dirty bounds are postponed and processed by the calling thread since their Renderable might be shared.
+     * If \p thread_pool is NULL ThreadPool::defaultThreadPool() is used.
+     */
+    void extractVisibleActorsParallel(ActorCollection& list, const Camera* camera, unsigned enable_mask=0xFFFFFFFF, int split_depth=4, ThreadPool* thread_pool=NULL);
+
     /**
      * Removes the given Actor from the ActorTreeAbstract.
      */
@@ -106,9 +118,19 @@ namespace vl
     //! Utility function that adds an Actor and binds it to the given Renderable, Effect and Transform.
     Actor* addActor(Renderable* renderable, Effect* eff, Transform* tr=NULL);
 
-    //! Utility function equivalent to 'actors()->push_back(actor)'.
+    //! Utility function equivalent to 'actors()->push_back(actor)' followed by incrementUpdateTick().
     Actor* addActor(Actor* actor);
 
+    /**
+     * Incremented on a node and on all its ancestors every time Actors or child nodes are added to or removed from the node
+     * by addActor(), eraseActor(), setEnabled(), ActorTree::addChild(), ActorKdTree::buildKdTree() etc. so that the root's updateTick()
+     * changes whenever the content of the tree changes. Call incrementUpdateTick() after editing actors() directly.
+     */
+    long long updateTick() const { return mUpdateTick; }
+
+    //! Increments the updateTick() of this node and of all its ancestors.
+    void incrementUpdateTick();
+
     /**
      * Updates the Transform and the bounds of the given Actors.
      * Before you create a bounding box tree or a kd-tree of Actors you have to
@@ -120,9 +142,20 @@ namespace vl
     //! For internal use only.
     void setParent(ActorTreeAbstract* p) { mParent = p; }
 
+    /**
+     * For internal use only.
+     * Appends to \p list the enabled Actors of this node only which are not culled by \p camera, the bounding spheres and boxes
+     * are culled in batches using boundsStore(). If \p deferred is not NULL the Actors whose Renderable has dirty bounds are appended without
+     * updating their bounds nor culling them and their position in \p list is recorded in \p deferred.
+     */
+    void extractVisibleNodeActors(ActorCollection& list, const Camera* camera, unsigned enable_mask, std::vector<size_t>* deferred=NULL);
+
+    //! The SoA copy of the bounds of this node's Actors used for culling, synchronized by extractVisibleActors().
+    const ActorBoundsStore* boundsStore() const { return &mBoundsStore; }
+
     //! If `false` then extractVisibleActors() will ignore this node and all its children.
     //! \see Actor::enableMask(), Actor::isEnabled(), ActorTreeAbstract::isEnabled(), SceneManager::enableMask(), Rendering::enableMask(), Rendering::effectOverrideMask(), Renderer::enableMask(), Renderer::shaderOverrideMask().
-    void setEnabled( bool enabled ) { mEnabled = enabled; }
+    void setEnabled( bool enabled ) { if ( mEnabled != enabled ) { mEnabled = enabled; incrementUpdateTick(); } }
 
     //! If `false` then extractVisibleActors() will ignore this node and all its children.
     //! \see Actor::enableMask(), Actor::isEnabled(), ActorTreeAbstract::isEnabled(), SceneManager::enableMask(), Rendering::enableMask(), Rendering::effectOverrideMask(), Renderer::enableMask(), Renderer::shaderOverrideMask().
@@ -132,6 +165,9 @@ namespace vl
     ActorTreeAbstract* mParent;
     ActorCollection mActors;
     AABB mAABB;
+    ActorBoundsStore mBoundsStore;
+    std::vector<unsigned int> mVisibleMask;
+    long long mUpdateTick;
     bool mEnabled;
   };
 }
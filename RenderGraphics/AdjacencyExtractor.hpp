@@ -261,17 +261,13 @@ namespace vl
           return NULL;
         }
 
-        for( TriangleIterator trit = dc->triangleIterator(); trit.hasNext(); trit.next() )
-        {
-          u32 a = trit.a();
-          u32 b = trit.b();
-          u32 c = trit.c();
+        dc->forEachTriangle( [&](u32 a, u32 b, u32 c) {
           STriangle triangle( a, b, c );
           edge_map.put( triangle.edge[0].id(), triangle.edge[0] );
           edge_map.put( triangle.edge[1].id(), triangle.edge[1] );
           edge_map.put( triangle.edge[2].id(), triangle.edge[2] );
           ++triangle_count;
-        }
+        } );
         total_triangles += triangle_count;
 
         ref< DrawElementsUInt > dc_adj = new DrawElementsUInt( PT_TRIANGLES_ADJACENCY );
@@ -279,12 +275,7 @@ namespace vl
         dc_adj->indexBuffer()->resize( triangle_count * 6 );
         GLuint* P = dc_adj->indexBuffer()->begin();
 
-        for( TriangleIterator trit = dc->triangleIterator(); trit.hasNext(); trit.next(), P += 6 )
-        {
-          u32 a = trit.a();
-          u32 b = trit.b();
-          u32 c = trit.c();
-
+        dc->forEachTriangle( [&](u32 a, u32 b, u32 c) {
           // NOTE: degenerate edges are important for border detection.
 
           P[0] = a;
@@ -308,7 +299,8 @@ namespace vl
             VL_CHECK( ! edge.isNull() );
             P[5] = edge.O;
           }
-        }
+          P += 6;
+        } );
 
         #ifndef NDEBUG
           printf("EdgeMap: edge-count: %d, cache-hits: %d (%.1f%%), cache MB: %.1f\n",
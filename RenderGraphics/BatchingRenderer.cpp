@@ -0,0 +1,436 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+#include <vlGraphics/BatchingRenderer.hpp>
+#include <vlGraphics/RenderQueue.hpp>
+#include <vlGraphics/OpenGLContext.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+#include <algorithm>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+BatchingRenderer::BatchingRenderer()
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+
+  mBatchedRenderQueue = new RenderQueue;
+  mBatchCount       = 0;
+  mMinBatchSize     = 2;
+  mTransformBinding = 0;
+  mInputQueue       = NULL;
+  mInputTick        = -1;
+
+  mStatsTotalObjects   = 0;
+  mStatsBatchedObjects = 0;
+  mStatsBatches        = 0;
+}
+//-----------------------------------------------------------------------------
+const RenderQueue* BatchingRenderer::render(const RenderQueue* in_render_queue, Camera* camera, real frame_clock)
+{
+  // skip if renderer is disabled
+  if (enableMask() == 0)
+    return in_render_queue;
+
+  // enter/exit behavior contract
+
+  class InOutContract 
+  {
+    RendererAbstract* mRenderer;
+
+  public:
+    InOutContract(RendererAbstract* renderer): mRenderer(renderer)
+    {
+      // increment the render tick.
+      mRenderer->incrementRenderTick();
+
+      // dispatch the renderer-started event.
+      mRenderer->dispatchOnRendererStarted();
+
+      // check user-generated errors.
+      VL_CHECK_OGL()
+    }
+
+    ~InOutContract()
+    {
+      // dispatch the renderer-finished event
+      mRenderer->dispatchOnRendererFinished();
+
+      // check user-generated errors.
+      VL_CHECK_OGL()
+    }
+  } contract(this);
+
+  // --------------- rendering --------------- 
+
+  if (!mWrappedRenderer)
+  {
+    Log::error("BatchingRenderer::render(): no Renderer is wrapped!\n");
+    VL_TRAP();
+    return in_render_queue;
+  }
+
+  // glMultiDrawElementsIndirect() and shader storage buffers require OpenGL 4.3
+  if (!Has_GL_Version_4_3 || mBatchShaders.empty())
+    return mWrappedRenderer->render( in_render_queue, camera, frame_clock );
+
+  // (1)
+  // merge the compatible tokens, only if the incoming queue changed since the last frame.
+  if ( in_render_queue != mInputQueue || in_render_queue->updateTick() != mInputTick )
+  {
+    buildBatches( in_render_queue );
+    mInputQueue = in_render_queue;
+    mInputTick  = in_render_queue->updateTick();
+  }
+
+  // (2)
+  // upload the model matrices of the batched actors.
+  updateTransforms();
+
+  // (3)
+  // render the batched queue.
+  mWrappedRenderer->render( mBatchedRenderQueue.get(), camera, frame_clock );
+
+  return mBatchedRenderQueue.get();
+}
+//-----------------------------------------------------------------------------
+void BatchingRenderer::setWrappedRenderer(Renderer* renderer) 
+{ 
+  mWrappedRenderer = renderer; 
+  mInputTick = -1;
+}
+//-----------------------------------------------------------------------------
+const FramebufferObject* BatchingRenderer::framebuffer() const
+{
+  if (mWrappedRenderer)
+    return mWrappedRenderer->framebuffer();
+  else
+    return NULL;
+}
+//-----------------------------------------------------------------------------
+FramebufferObject* BatchingRenderer::framebuffer()
+{
+  if (mWrappedRenderer)
+    return mWrappedRenderer->framebuffer();
+  else
+    return NULL;
+}
+//-----------------------------------------------------------------------------
+void BatchingRenderer::setBatchShader(const Shader* shader, Shader* batch_shader)
+{
+  if (batch_shader)
+    mBatchShaders[shader] = batch_shader;
+  else
+    mBatchShaders.erase(shader);
+  mInputTick = -1;
+}
+//-----------------------------------------------------------------------------
+Shader* BatchingRenderer::batchShader(const Shader* shader) const
+{
+  std::map< const Shader*, ref<Shader> >::const_iterator it = mBatchShaders.find(shader);
+  return it != mBatchShaders.end() ? it->second.get() : NULL;
+}
+//-----------------------------------------------------------------------------
+void BatchingRenderer::clearArenas()
+{
+  mArenas.clear();
+  mArenaLayouts.clear();
+  mAllocations.clear();
+  mBatches.clear();
+  mBatchCount = 0;
+  mBatchedRenderQueue->clear();
+  mInputTick = -1;
+}
+//-----------------------------------------------------------------------------
+void BatchingRenderer::invalidateGeometry(const Geometry* geom)
+{
+  // the old copy stays in the arena until clearArenas() is called
+  if ( mAllocations.erase(geom) )
+    mInputTick = -1;
+}
+//-----------------------------------------------------------------------------
+const BatchingRenderer::Allocation* BatchingRenderer::batchable(const RenderToken* tok, const RenderQueue* queue)
+{
+  // multipass effects are rendered token by token
+  if ( queue->nextPass(tok) )
+    return NULL;
+
+  if ( mBatchShaders.find(tok->mShader) == mBatchShaders.end() )
+    return NULL;
+
+  // anything that changes the state between two actors breaks the batch
+  const Actor* actor = tok->mActor;
+  if ( actor->scissor() || !actor->actorEventCallbacks()->empty() || !mWrappedRenderer->isEnabled(actor) )
+    return NULL;
+  if ( actor->getUniformSet() && !actor->getUniformSet()->uniforms().empty() )
+    return NULL;
+
+  const Geometry* geom = cast<const Geometry>(tok->mRenderable);
+  if ( !geom )
+    return NULL;
+
+  return allocate(geom);
+}
+//-----------------------------------------------------------------------------
+const BatchingRenderer::Allocation* BatchingRenderer::allocate(const Geometry* geom)
+{
+  // compute the vertex layout
+  TLayout layout;
+  int vert_count = -1;
+  for(int i=0; i<VA_MaxAttribCount; ++i)
+  {
+    const ArrayAbstract* arr = geom->vertexAttribArray(i);
+    if ( !arr )
+      continue;
+    if ( !arr->ptr() || !arr->size() || (vert_count >= 0 && vert_count != (int)arr->size()) )
+      return NULL;
+    vert_count = (int)arr->size();
+    layout.push_back(i);
+    layout.push_back(arr->glType());
+    layout.push_back((int)arr->glSize());
+    layout.push_back(arr->interpretation()*2 + (arr->normalize() ? 1 : 0));
+  }
+  if ( vert_count <= 0 )
+    return NULL;
+
+  // only plain indexed triangles can be merged
+  int index_count = 0;
+  for(int i=0; i<(int)geom->drawCalls().size(); ++i)
+  {
+    const DrawCall* dc = geom->drawCalls().at(i);
+    if ( !dc->isEnabled() )
+      continue;
+    if ( dc->primitiveType() != PT_TRIANGLES || dc->primitiveRestartEnabled() || dc->instances() != 1 )
+      return NULL;
+    index_count += dc->countIndices();
+  }
+  if ( !index_count )
+    return NULL;
+
+  // already copied
+  std::map< const Geometry*, Allocation >::iterator it = mAllocations.find(geom);
+  if ( it != mAllocations.end() )
+  {
+    if ( it->second.mVertexCount == vert_count && it->second.mIndexCount == index_count )
+      return &it->second;
+    // the old copy stays in the arena until clearArenas() is called
+    mAllocations.erase(it);
+  }
+
+  // find or create the arena of the layout
+  std::map< TLayout, int >::iterator layout_it = mArenaLayouts.find(layout);
+  if ( layout_it == mArenaLayouts.end() )
+  {
+    layout_it = mArenaLayouts.insert( std::make_pair(layout, (int)mArenas.size()) ).first;
+    mArenas.push_back( Arena() );
+    Arena& arena = mArenas.back();
+    for(int i=0; i<VA_MaxAttribCount; ++i)
+    {
+      const ArrayAbstract* arr = geom->vertexAttribArray(i);
+      if ( !arr )
+        continue;
+      arena.mArrays[i] = arr->createArray();
+      arena.mArrays[i]->setNormalize( arr->normalize() );
+      arena.mArrays[i]->setInterpretation( arr->interpretation() );
+    }
+    arena.mIndices = new ArrayUInt1;
+  }
+  Arena& arena = mArenas[layout_it->second];
+
+  // grow the arrays geometrically so that appending many small geometries is linear
+  if ( arena.mVertexCount + vert_count > arena.mVertexCapacity )
+  {
+    arena.mVertexCapacity = std::max( arena.mVertexCapacity * 2, std::max(arena.mVertexCount + vert_count, 1024) );
+    for(int i=0; i<VA_MaxAttribCount; ++i)
+    {
+      if ( arena.mArrays[i] )
+      {
+        const ArrayAbstract* arr = geom->vertexAttribArray(i);
+        arena.mArrays[i]->bufferObject()->resize( arena.mVertexCapacity * (arr->bytesUsed() / arr->size()) );
+      }
+    }
+  }
+  if ( arena.mIndexCount + index_count > (int)arena.mIndices->size() )
+    arena.mIndices->resize( std::max( (int)arena.mIndices->size() * 2, std::max(arena.mIndexCount + index_count, 4096) ) );
+
+  Allocation& alloc = mAllocations[geom];
+  alloc.mGeometry    = const_cast<Geometry*>(geom);
+  alloc.mArena       = layout_it->second;
+  alloc.mBaseVertex  = arena.mVertexCount;
+  alloc.mVertexCount = vert_count;
+  alloc.mFirstIndex  = arena.mIndexCount;
+  alloc.mIndexCount  = index_count;
+
+  // copy the vertices
+  for(int i=0; i<VA_MaxAttribCount; ++i)
+  {
+    if ( arena.mArrays[i] )
+    {
+      const ArrayAbstract* arr = geom->vertexAttribArray(i);
+      const size_t stride = arr->bytesUsed() / arr->size();
+      memcpy( arena.mArrays[i]->ptr() + alloc.mBaseVertex * stride, arr->ptr(), arr->bytesUsed() );
+      arena.mArrays[i]->setBufferObjectDirty(true);
+    }
+  }
+
+  // copy the indices, relative to the first vertex of the geometry
+  GLuint* idx = arena.mIndices->begin() + alloc.mFirstIndex;
+  for(int i=0; i<(int)geom->drawCalls().size(); ++i)
+  {
+    const DrawCall* dc = geom->drawCalls().at(i);
+    if ( !dc->isEnabled() )
+      continue;
+    dc->forEachIndex( [&](int index) { *idx++ = (GLuint)index; } );
+  }
+  VL_CHECK( idx == arena.mIndices->begin() + alloc.mFirstIndex + index_count )
+  arena.mIndices->setBufferObjectDirty(true);
+
+  arena.mVertexCount += vert_count;
+  arena.mIndexCount  += index_count;
+
+  return &alloc;
+}
+//-----------------------------------------------------------------------------
+void BatchingRenderer::buildBatches(const RenderQueue* in_render_queue)
+{
+  mBatchedRenderQueue->clear();
+  mBatchCount = 0;
+
+  mStatsTotalObjects   = in_render_queue->size();
+  mStatsBatchedObjects = 0;
+  mStatsBatches        = 0;
+
+  std::vector<const Allocation*> run;
+  for( int i=0; i<in_render_queue->size(); )
+  {
+    const RenderToken* tok = in_render_queue->at(i);
+    const Allocation* alloc = batchable(tok, in_render_queue);
+    if ( !alloc )
+    {
+      mBatchedRenderQueue->appendToken(in_render_queue, i++);
+      continue;
+    }
+
+    // collect the run of consecutive compatible tokens
+    run.clear();
+    run.push_back(alloc);
+    int end = i + 1;
+    for( ; end<in_render_queue->size(); ++end )
+    {
+      const RenderToken* next = in_render_queue->at(end);
+      if ( next->mShader != tok->mShader || next->mActor->enableMask() != tok->mActor->enableMask() )
+        break;
+      const Allocation* next_alloc = batchable(next, in_render_queue);
+      if ( !next_alloc || next_alloc->mArena != alloc->mArena )
+        break;
+      run.push_back(next_alloc);
+    }
+
+    if ( (int)run.size() < mMinBatchSize )
+    {
+      for( ; i<end; ++i )
+        mBatchedRenderQueue->appendToken(in_render_queue, i);
+      continue;
+    }
+
+    // reuse the batches of the previous frames
+    if ( mBatchCount == (int)mBatches.size() )
+    {
+      mBatches.push_back( Batch() );
+      Batch& batch = mBatches.back();
+      batch.mGeometry   = new Geometry;
+      batch.mDrawCall   = new MultiDrawElementsIndirect;
+      batch.mTransforms = new ArrayFloat4;
+      batch.mTransforms->setUsage(BU_DYNAMIC_DRAW);
+      batch.mDrawCall->setDrawDataBuffer( batch.mTransforms.get() );
+      batch.mGeometry->drawCalls().push_back( batch.mDrawCall.get() );
+      batch.mActor = new Actor( batch.mGeometry.get() );
+    }
+    Batch& batch = mBatches[mBatchCount++];
+
+    const Arena& arena = mArenas[alloc->mArena];
+    for(int j=0; j<VA_MaxAttribCount; ++j)
+      batch.mGeometry->setVertexAttribArray( j, arena.mArrays[j].get() );
+    batch.mDrawCall->setIndexBuffer( arena.mIndices.get() );
+    batch.mDrawCall->setDrawDataBinding( mTransformBinding );
+    batch.mDrawCall->clearDraws();
+    batch.mActors.clear();
+    for(size_t j=0; j<run.size(); ++j)
+    {
+      batch.mDrawCall->addDraw( run[j]->mIndexCount, run[j]->mFirstIndex, run[j]->mBaseVertex );
+      batch.mActors.push_back( in_render_queue->at(i + (int)j)->mActor );
+    }
+    batch.mDrawCall->finalizeSetup();
+    batch.mTransforms->resize( run.size() * 4 );
+    batch.mActor->setEnableMask( tok->mActor->enableMask() );
+    // the arena or the commands might have changed
+    batch.mGeometry->setBufferObjectDirty(true);
+
+    // the batch takes the place of the first token of the run
+    RenderToken* batch_tok = mBatchedRenderQueue->newToken(false);
+    *batch_tok = *tok;
+    batch_tok->mNextPassIndex = -1;
+    batch_tok->mActor      = batch.mActor.get();
+    batch_tok->mRenderable = batch.mGeometry.get();
+    batch_tok->mShader     = mBatchShaders[tok->mShader].get();
+
+    mStatsBatchedObjects += (int)run.size();
+    ++mStatsBatches;
+    i = end;
+  }
+}
+//-----------------------------------------------------------------------------
+void BatchingRenderer::updateTransforms()
+{
+  for(int i=0; i<mBatchCount; ++i)
+  {
+    Batch& batch = mBatches[i];
+    bool changed = false;
+    for(size_t j=0; j<batch.mActors.size(); ++j)
+    {
+      const Transform* tr = batch.mActors[j]->transform();
+      fmat4 matrix = tr ? (fmat4)tr->worldMatrix() : fmat4();
+      fvec4* dst = batch.mTransforms->begin() + j*4;
+      if ( memcmp(dst, matrix.ptr(), sizeof(fvec4)*4) != 0 )
+      {
+        memcpy(dst, matrix.ptr(), sizeof(fvec4)*4);
+        changed = true;
+      }
+    }
+    if (changed)
+    {
+      batch.mTransforms->setBufferObjectDirty(true);
+      batch.mGeometry->setBufferObjectDirty(true);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
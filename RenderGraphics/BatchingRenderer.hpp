@@ -0,0 +1,194 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+#ifndef BatchingRenderer_INCLUDE_ONCE
+#define BatchingRenderer_INCLUDE_ONCE
+
+#include <vlGraphics/Renderer.hpp>
+#include <vlGraphics/Geometry.hpp>
+#include <vlGraphics/MultiDrawElementsIndirect.hpp>
+#include <map>
+
+namespace vl
+{
+  //------------------------------------------------------------------------------
+  // BatchingRenderer
+  //------------------------------------------------------------------------------
+  /** Wraps a Renderer merging runs of compatible render tokens into single glMultiDrawElementsIndirect() draws.
+    *
+    * The batching is done on the sorted render queue: consecutive tokens using the same Shader and the same vertex layout
+    * become a single token rendering a MultiDrawElementsIndirect. Only Shaders registered with setBatchShader() are batched,
+    * the batch Shader is used in place of the original one and must fetch the model matrix of each draw from the shader
+    * storage buffer bound at transformBinding(), indexed by \p gl_BaseInstanceARB or \p gl_DrawIDARB, for example:
+    * \code
+    * layout(std430, binding = 0) buffer vl_BatchTransforms { mat4 vl_BatchModelMatrix[]; };
+    * ...
+    * gl_Position = vl_ProjectionMatrix * vl_ModelViewMatrix * vl_BatchModelMatrix[gl_BaseInstanceARB] * vl_Vertex;
+    * \endcode
+    * The batch is rendered with no Transform, so that \p vl_ModelViewMatrix contains only the view matrix.
+    *
+    * A token is batched if its Actor has no Scissor, UniformSet or ActorEventCallback, if its Effect has a single pass and if its
+    * Renderable is a Geometry with local vertex data and only enabled non instanced PT_TRIANGLES draw calls without primitive restart.
+    * The vertices and indices of the batched Geometry are copied once into shared arrays, one set per vertex layout, from which each
+    * batch draws. The shared arrays only grow: if the vertex data of a batched Geometry changes call invalidateGeometry() or clearArenas().
+    *
+    * The batched render queue is rebuilt only when the incoming render queue changes, otherwise only the transforms are updated.
+    * Requires OpenGL 4.3, with lower versions the incoming render queue is passed through to the wrapped Renderer unchanged.
+    * @sa MultiDrawElementsIndirect, OcclusionCullRenderer */
+  class VLGRAPHICS_EXPORT BatchingRenderer: public Renderer
+  {
+    VL_INSTRUMENT_CLASS(vl::BatchingRenderer, Renderer)
+
+  public:
+    /** Constructor. */
+    BatchingRenderer();
+
+    /** Renders using the wrapped renderer after merging the compatible render tokens. */
+    virtual const RenderQueue* render(const RenderQueue* in_render_queue, Camera* camera, real frame_clock);
+
+    /** The renderer to be wrapped by this batching renderer */
+    void setWrappedRenderer(Renderer* renderer);
+
+    /** The renderer to be wrapped by this batching renderer */
+    const Renderer* wrappedRenderer() const { return mWrappedRenderer.get(); }
+
+    /** The renderer to be wrapped by this batching renderer */
+    Renderer* wrappedRenderer() { return mWrappedRenderer.get(); }
+
+    /** Returns the wrapped Renderer's Framebuffer */
+    const FramebufferObject* framebuffer() const;
+
+    /** Returns the wrapped Renderer's Framebuffer */
+    FramebufferObject* framebuffer();
+
+    /** Enables the batching of the tokens using \p shader, which are rendered with \p batch_shader. Pass NULL to disable it. */
+    void setBatchShader(const Shader* shader, Shader* batch_shader);
+
+    /** The Shader used to render the batches of tokens using \p shader or NULL if they are not batched. */
+    Shader* batchShader(const Shader* shader) const;
+
+    /** The minimum number of consecutive compatible tokens merged into a batch (default = 2). */
+    void setMinBatchSize(int size) { mMinBatchSize = size; mInputTick = -1; }
+
+    /** The minimum number of consecutive compatible tokens merged into a batch (default = 2). */
+    int minBatchSize() const { return mMinBatchSize; }
+
+    /** The shader storage buffer binding point of the per-draw model matrices (default = 0). */
+    void setTransformBinding(int binding) { mTransformBinding = binding; mInputTick = -1; }
+
+    /** The shader storage buffer binding point of the per-draw model matrices (default = 0). */
+    int transformBinding() const { return mTransformBinding; }
+
+    /** Releases the shared vertex and index arrays, which will be rebuilt the next frame. */
+    void clearArenas();
+
+    /** Marks the vertex data of \p geom as changed: it will be copied again in the shared arrays the next time it is batched. */
+    void invalidateGeometry(const Geometry* geom);
+
+    /** Returns the number of tokens of the last rendered queue. */
+    int statsTotalObjects() const { return mStatsTotalObjects; }
+
+    /** Returns the number of tokens of the last rendered queue merged into a batch. */
+    int statsBatchedObjects() const { return mStatsBatchedObjects; }
+
+    /** Returns the number of batches of the last rendered queue. */
+    int statsBatches() const { return mStatsBatches; }
+
+  protected:
+    /** The shared vertex and index arrays of a vertex layout. */
+    struct Arena
+    {
+      Arena(): mVertexCount(0), mVertexCapacity(0), mIndexCount(0) {}
+      ref<ArrayAbstract> mArrays[VA_MaxAttribCount];
+      ref<ArrayUInt1> mIndices;
+      int mVertexCount;
+      int mVertexCapacity;
+      int mIndexCount;
+    };
+
+    /** Where a Geometry has been copied within its Arena. */
+    struct Allocation
+    {
+      Allocation(): mArena(-1), mFirstIndex(0), mIndexCount(0), mBaseVertex(0), mVertexCount(0) {}
+      ref<Geometry> mGeometry; // keeps the key alive
+      int mArena;
+      int mFirstIndex;
+      int mIndexCount;
+      int mBaseVertex;
+      int mVertexCount;
+    };
+
+    /** A merged run of tokens, reused across frames. */
+    struct Batch
+    {
+      ref<Actor> mActor;
+      ref<Geometry> mGeometry;
+      ref<MultiDrawElementsIndirect> mDrawCall;
+      ref<ArrayFloat4> mTransforms;
+      std::vector<const Actor*> mActors;
+    };
+
+    //! Slot, type, size and interpretation of each vertex attribute array.
+    typedef std::vector<int> TLayout;
+
+    /** Returns the allocation of the Geometry rendered by \p tok or NULL if the token can't be batched. */
+    const Allocation* batchable(const RenderToken* tok, const RenderQueue* queue);
+
+    /** Copies \p geom in the Arena of its vertex layout. */
+    const Allocation* allocate(const Geometry* geom);
+
+    /** Rebuilds the batched render queue from \p in_render_queue. */
+    void buildBatches(const RenderQueue* in_render_queue);
+
+    /** Writes the model matrices of the batched actors, marking the batches whose matrices changed. */
+    void updateTransforms();
+
+  protected:
+    vl::ref<Renderer> mWrappedRenderer;
+    ref<RenderQueue> mBatchedRenderQueue;
+    std::map< const Shader*, ref<Shader> > mBatchShaders;
+    std::vector<Arena> mArenas;
+    std::map< TLayout, int > mArenaLayouts;
+    std::map< const Geometry*, Allocation > mAllocations;
+    std::vector<Batch> mBatches;
+    int mBatchCount;
+    int mMinBatchSize;
+    int mTransformBinding;
+    const RenderQueue* mInputQueue;
+    long long mInputTick;
+    int mStatsTotalObjects;
+    int mStatsBatchedObjects;
+    int mStatsBatches;
+  };
+  //------------------------------------------------------------------------------
+}
+
+#endif
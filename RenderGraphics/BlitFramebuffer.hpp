@@ -34,6 +34,7 @@
 
 #include <vlGraphics/RenderEventCallback.hpp>
 #include <vlGraphics/FramebufferObject.hpp>
+#include <vlGraphics/OpenGLContext.hpp>
 
 namespace vl
 {
@@ -89,10 +90,8 @@ namespace vl
         VL_CHECK_OGL()
 
         // restore FBOs
-        glBindFramebuffer( GL_READ_FRAMEBUFFER_EXT, read_fbo );
-        VL_CHECK_OGL()
-        glBindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, draw_fbo );
-        VL_CHECK_OGL()
+        readFramebuffer()->openglContext()->bindFramebuffer( GL_READ_FRAMEBUFFER, read_fbo );
+        drawFramebuffer()->openglContext()->bindFramebuffer( GL_DRAW_FRAMEBUFFER, draw_fbo );
       }
     }
 
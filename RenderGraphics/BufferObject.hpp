@@ -63,6 +63,8 @@ namespace vl
       mHandle = 0;
       mUsage = BU_STATIC_DRAW;
       mByteCountBufferObject = 0;
+      mHandleOffset = 0;
+      mHandleShared = false;
     }
 
     BufferObject(const BufferObject& other): Buffer(other)
@@ -71,6 +73,8 @@ namespace vl
       mHandle = 0;
       mUsage = BU_STATIC_DRAW;
       mByteCountBufferObject = 0;
+      mHandleOffset = 0;
+      mHandleShared = false;
       // copy local data
       *this = other;
     }
@@ -92,14 +96,20 @@ namespace vl
       unsigned int tmp_handle = mHandle;
       EBufferObjectUsage tmp_usage = mUsage;
       GLsizeiptr tmp_bytes = mByteCountBufferObject;
+      GLintptr tmp_offset = mHandleOffset;
+      bool tmp_shared = mHandleShared;
       // this <- other
       mHandle = other.mHandle;
       mUsage = tmp_usage;
       mByteCountBufferObject = other.mByteCountBufferObject;
+      mHandleOffset = other.mHandleOffset;
+      mHandleShared = other.mHandleShared;
       // other <- this
       other.mHandle = tmp_handle;
       other.mUsage = tmp_usage;
       other.mByteCountBufferObject = tmp_bytes;
+      other.mHandleOffset = tmp_offset;
+      other.mHandleShared = tmp_shared;
     }
 
     ~BufferObject()
@@ -113,6 +123,24 @@ namespace vl
 
     GLsizeiptr byteCountBufferObject() const { return mByteCountBufferObject; }
 
+    //! Byte offset of the data inside the buffer object handle(), non zero only when the data lives in a region of a shared buffer.
+    GLintptr handleOffset() const { return mHandleOffset; }
+
+    //! Whether handle() is owned by another BufferObject, see setSharedRegion().
+    bool isHandleShared() const { return mHandleShared; }
+
+    //! Makes this BufferObject refer to \p byte_count bytes at \p offset of the buffer object \p handle, owned by someone else.
+    //! The shared buffer is never deleted by this BufferObject. A following setBufferData() releases the region and creates a
+    //! private buffer object again. Used by StreamingBufferObject to suballocate the per-frame data of dynamic arrays.
+    void setSharedRegion(unsigned int handle, GLintptr offset, GLsizeiptr byte_count)
+    {
+      deleteBufferObject();
+      mHandle = handle;
+      mHandleOffset = offset;
+      mByteCountBufferObject = byte_count;
+      mHandleShared = true;
+    }
+
     void createBufferObject()
     {
       VL_CHECK_OGL();
@@ -131,9 +159,19 @@ namespace vl
       // mic fixme: it would be nice to re-enable these
       // VL_CHECK_OGL();
       VL_CHECK(Has_BufferObject || handle() == 0)
+      if (mHandleShared)
+      {
+        // the region belongs to another buffer object
+        mHandle = 0;
+        mHandleOffset = 0;
+        mByteCountBufferObject = 0;
+        mHandleShared = false;
+      }
+      else
       if (Has_BufferObject && handle() != 0)
       {
         glDeleteBuffers( 1, &mHandle ); // VL_CHECK_OGL();
+        forgetBufferBindings( mHandle );
         mHandle = 0;
         mByteCountBufferObject = 0;
       }
@@ -171,11 +209,14 @@ namespace vl
       VL_CHECK(Has_BufferObject)
       if ( Has_BufferObject )
       {
+        if (mHandleShared)
+          deleteBufferObject();
         createBufferObject();
         // we use the GL_ARRAY_BUFFER slot to send the data for no special reason
         glBindBuffer( GL_ARRAY_BUFFER, handle() ); VL_CHECK_OGL();
         glBufferData( GL_ARRAY_BUFFER, byte_count, data, usage ); VL_CHECK_OGL();
         glBindBuffer( GL_ARRAY_BUFFER, 0 ); VL_CHECK_OGL();
+        forgetBufferTarget( GL_ARRAY_BUFFER );
         mByteCountBufferObject = byte_count;
         mUsage = usage;
       }
@@ -205,8 +246,9 @@ namespace vl
       {
         // we use the GL_ARRAY_BUFFER slot to send the data for no special reason
         glBindBuffer( GL_ARRAY_BUFFER, handle() ); VL_CHECK_OGL();
-        glBufferSubData( GL_ARRAY_BUFFER, offset, byte_count, data ); VL_CHECK_OGL();
+        glBufferSubData( GL_ARRAY_BUFFER, handleOffset() + offset, byte_count, data ); VL_CHECK_OGL();
         glBindBuffer( GL_ARRAY_BUFFER, 0 ); VL_CHECK_OGL();
+        forgetBufferTarget( GL_ARRAY_BUFFER );
       }
     }
 
@@ -216,12 +258,14 @@ namespace vl
     {
       VL_CHECK_OGL();
       VL_CHECK(Has_BufferObject)
+      VL_CHECK(!isHandleShared())
       if ( Has_BufferObject )
       {
         createBufferObject();
         glBindBuffer( GL_ARRAY_BUFFER, handle() ); VL_CHECK_OGL();
         void* ptr = glMapBuffer( GL_ARRAY_BUFFER, access ); VL_CHECK_OGL();
         glBindBuffer( GL_ARRAY_BUFFER, 0 ); VL_CHECK_OGL();
+        forgetBufferTarget( GL_ARRAY_BUFFER );
         return ptr;
       }
       else
@@ -248,6 +292,7 @@ namespace vl
         glBindBuffer( GL_ARRAY_BUFFER, handle() ); VL_CHECK_OGL();
         bool ok = glUnmapBuffer( GL_ARRAY_BUFFER ) == GL_TRUE; VL_CHECK_OGL();
         glBindBuffer( GL_ARRAY_BUFFER, 0 ); VL_CHECK_OGL();
+        forgetBufferTarget( GL_ARRAY_BUFFER );
         VL_CHECK_OGL();
         return ok;
       }
@@ -261,7 +306,9 @@ namespace vl
   protected:
     unsigned int mHandle;
     GLsizeiptr mByteCountBufferObject;
+    GLintptr mHandleOffset;
     EBufferObjectUsage mUsage;
+    bool mHandleShared;
   };
 }
 
@@ -31,6 +31,7 @@
 
 #include <vlGraphics/Clear.hpp>
 #include <vlGraphics/Camera.hpp>
+#include <vlGraphics/OpenGLContext.hpp>
 #include <vlCore/Vector4.hpp>
 #include <vlCore/Log.hpp>
 
@@ -48,7 +49,7 @@ Clear::Clear(): mClearColorMode(CCM_Float), mClearDepthValue(1.0f), mClearStenci
   mScissorBox[3] = -1;
 }
 //-----------------------------------------------------------------------------
-void Clear::render_Implementation(const Actor*, const Shader*, const Camera* camera, OpenGLContext*) const
+void Clear::render_Implementation(const Actor*, const Shader*, const Camera* camera, OpenGLContext* gl_context) const
 {
   // build buffer bit mask
   GLbitfield mask = 0;
@@ -65,12 +66,14 @@ void Clear::render_Implementation(const Actor*, const Shader*, const Camera* cam
 
   if (mask)
   {
+    const OpenGLFunctions& gl = gl_context ? gl_context->mGL : GL_Functions;
+
     int viewport[] = { camera->viewport()->x(), camera->viewport()->y(), camera->viewport()->width(), camera->viewport()->height() };
 
     // save scissor settings
-    GLboolean scissor_on = glIsEnabled(GL_SCISSOR_TEST);
+    GLboolean scissor_on = gl._glIsEnabled(GL_SCISSOR_TEST);
     int scissor_box_save[4] = {0,0,-1,-1};
-    glGetIntegerv(GL_SCISSOR_BOX, scissor_box_save);
+    gl._glGetIntegerv(GL_SCISSOR_BOX, scissor_box_save);
 
     int scissor_box[4] = {0,0,-1,-1};
 
@@ -112,31 +115,31 @@ void Clear::render_Implementation(const Actor*, const Shader*, const Camera* cam
     scissor_box[3] = scissor_box[3] -scissor_box[1] +1;
 
     // enable scissor test
-    glEnable(GL_SCISSOR_TEST);
-    glScissor(scissor_box[0], scissor_box[1], scissor_box[2], scissor_box[3]); VL_CHECK_OGL()
+    gl._glEnable(GL_SCISSOR_TEST);
+    gl._glScissor(scissor_box[0], scissor_box[1], scissor_box[2], scissor_box[3]); VL_CHECK_OGL()
 
     // defines the clear values
     if (mClearColorBuffer)
     {
       switch(clearColorMode())
       {
-        case CCM_Float: glClearColor(      mClearColorValue.r(),     mClearColorValue.g(),     mClearColorValue.b(),     mClearColorValue.a());     break;
-        case CCM_Int:   glClearColorIiEXT( mClearColorValueInt.r(),  mClearColorValueInt.g(),  mClearColorValueInt.b(),  mClearColorValueInt.a());  break;
-        case CCM_UInt:  glClearColorIuiEXT(mClearColorValueUInt.r(), mClearColorValueUInt.g(), mClearColorValueUInt.b(), mClearColorValueUInt.a()); break;
+        case CCM_Float: gl._glClearColor(      mClearColorValue.r(),     mClearColorValue.g(),     mClearColorValue.b(),     mClearColorValue.a());     break;
+        case CCM_Int:   gl._glClearColorIiEXT( mClearColorValueInt.r(),  mClearColorValueInt.g(),  mClearColorValueInt.b(),  mClearColorValueInt.a());  break;
+        case CCM_UInt:  gl._glClearColorIuiEXT(mClearColorValueUInt.r(), mClearColorValueUInt.g(), mClearColorValueUInt.b(), mClearColorValueUInt.a()); break;
       }
     }
     if (mClearDepthBuffer)
-      glClearDepth(mClearDepthValue);
+      gl._glClearDepth(mClearDepthValue);
     if (mClearStencilBuffer)
-      glClearStencil(mClearStencilValue);
+      gl._glClearStencil(mClearStencilValue);
 
     // clear!
-    glClear(mask);
+    gl._glClear(mask);
 
     // restore scissor settings
     if (!scissor_on)
-      glDisable(GL_SCISSOR_TEST);
-    glScissor(scissor_box_save[0], scissor_box_save[1], scissor_box_save[2], scissor_box_save[3]); VL_CHECK_OGL()
+      gl._glDisable(GL_SCISSOR_TEST);
+    gl._glScissor(scissor_box_save[0], scissor_box_save[1], scissor_box_save[2], scissor_box_save[3]); VL_CHECK_OGL()
   }
 }
 //-----------------------------------------------------------------------------
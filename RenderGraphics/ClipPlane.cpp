@@ -50,7 +50,7 @@ ClipPlane::ClipPlane(const vec3& o, const vec3& n)
   mEnabled = true;
 }
 //-----------------------------------------------------------------------------
-void ClipPlane::apply(int index, const Camera* camera, OpenGLContext*) const
+void ClipPlane::apply(int index, const Camera* camera, OpenGLContext* ctx) const
 {
   VL_CHECK(index>=0 && index<6);
 
@@ -58,12 +58,12 @@ void ClipPlane::apply(int index, const Camera* camera, OpenGLContext*) const
 
   if (enabled())
   {
-    glEnable(GL_CLIP_PLANE0 + index);
+    ctx->mGL._glEnable(GL_CLIP_PLANE0 + index);
 
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
+    ctx->mGL._glMatrixMode(GL_MODELVIEW);
+    ctx->mGL._glPushMatrix();
 
-    glLoadIdentity();
+    ctx->mGL._glLoadIdentity();
 
     mat4 mat;
     if ( boundTransform() )
@@ -79,13 +79,13 @@ void ClipPlane::apply(int index, const Camera* camera, OpenGLContext*) const
     real orig = dot(n, pt1);
 
     double equation[] = { n.x(), n.y(), n.z(), -orig };
-    glClipPlane(GL_CLIP_PLANE0 + index, equation);
+    ctx->mGL._glClipPlane(GL_CLIP_PLANE0 + index, equation);
 
-    glPopMatrix();
+    ctx->mGL._glPopMatrix();
   }
   else
   {
-    glDisable(GL_CLIP_PLANE0 + index);
+    ctx->mGL._glDisable(GL_CLIP_PLANE0 + index);
   }
 }
 //-----------------------------------------------------------------------------
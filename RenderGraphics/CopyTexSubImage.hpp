@@ -156,6 +156,7 @@ namespace vl
 #endif
 
       glBindTexture(TD_TEXTURE_1D, texture()->handle() ); VL_CHECK_OGL()
+      forgetActiveTextureUnit();
       glCopyTexSubImage1D(TD_TEXTURE_1D, level(), xoffset(), x(), y(), width()); VL_CHECK_OGL()
       glBindTexture(TD_TEXTURE_1D, 0 ); VL_CHECK_OGL()
 
@@ -256,6 +257,7 @@ namespace vl
       };
 
       glBindTexture( bind_target, texture()->handle() ); VL_CHECK_OGL()
+      forgetActiveTextureUnit();
       glCopyTexSubImage2D( target(), level(), xoffset(), yoffset(), x(), y(), width(), height() ); VL_CHECK_OGL()
       glBindTexture( bind_target, 0 ); VL_CHECK_OGL()
 
@@ -349,6 +351,7 @@ namespace vl
 #endif
 
         glBindTexture(texture()->dimension(), texture()->handle() ); VL_CHECK_OGL()
+        forgetActiveTextureUnit();
         glCopyTexSubImage3D(texture()->dimension(), level(), xoffset(), yoffset(), zoffset(), x(), y(), width(), height()); VL_CHECK_OGL()
         glBindTexture(texture()->dimension(), 0 );
 
@@ -70,6 +70,13 @@ void CoreText::render_Implementation(const Actor* actor, const Shader*, const Ca
   if ( text().empty() )
     return;
 
+  // creates the missing glyphs binding their textures through the OpenGLContext
+  for( int i=0; i<text().length(); ++i )
+  {
+    if ( text()[i] != '\n' )
+      font()->glyph( text()[i], gl_context );
+  }
+
   // Lighting can be enabled or disabled.
   // glDisable(GL_LIGHTING);
 
@@ -107,17 +114,17 @@ void CoreText::render_Implementation(const Actor* actor, const Shader*, const Ca
 
   // shadow render
   if (shadowEnabled())
-    renderText( actor, camera, shadowColor(), shadowVector() );
+    renderText( actor, camera, shadowColor(), shadowVector(), gl_context );
   // outline render
   if (outlineEnabled())
   {
-    renderText( actor, camera, outlineColor(), fvec2(-1,0) );
-    renderText( actor, camera, outlineColor(), fvec2(+1,0) );
-    renderText( actor, camera, outlineColor(), fvec2(0,-1) );
-    renderText( actor, camera, outlineColor(), fvec2(0,+1) );
+    renderText( actor, camera, outlineColor(), fvec2(-1,0), gl_context );
+    renderText( actor, camera, outlineColor(), fvec2(+1,0), gl_context );
+    renderText( actor, camera, outlineColor(), fvec2(0,-1), gl_context );
+    renderText( actor, camera, outlineColor(), fvec2(0,+1), gl_context );
   }
   // text render
-  renderText( actor, camera, color(), fvec2(0,0) );
+  renderText( actor, camera, color(), fvec2(0,0), gl_context );
 
   // Pass #2
   // fills the z-buffer (not the stencil buffer): approximated to the text bbox
@@ -156,7 +163,7 @@ void CoreText::render_Implementation(const Actor* actor, const Shader*, const Ca
   }
 }
 //-----------------------------------------------------------------------------
-void CoreText::renderText(const Actor*, const Camera*, const fvec4& color, const fvec2& offset) const
+void CoreText::renderText(const Actor*, const Camera*, const fvec4& color, const fvec2& offset, OpenGLContext* gl_context) const
 {
   if(!mFont)
   {
@@ -187,7 +194,7 @@ void CoreText::renderText(const Actor*, const Camera*, const fvec4& color, const
   // mic fixme: detect GLSLProgram and use VertexAttribPointer if present.
 
   float texc[] = { 0,0,0,0,0,0,0,0 };
-  glActiveTexture( GL_TEXTURE0 );
+  gl_context->activeTexture( 0 );
   glClientActiveTexture( GL_TEXTURE0 );
   glEnable(GL_TEXTURE_2D);
   glEnableClientState( GL_TEXTURE_COORD_ARRAY );
@@ -315,7 +322,7 @@ void CoreText::renderText(const Actor*, const Camera*, const fvec4& color, const
 
       if (glyph->textureHandle())
       {
-        glBindTexture( GL_TEXTURE_2D, glyph->textureHandle() );
+        gl_context->bindTexture( TD_TEXTURE_2D, glyph->textureHandle() );
 
         texc[0] = glyph->s0();
         texc[1] = glyph->t1();
@@ -460,7 +467,7 @@ void CoreText::renderText(const Actor*, const Camera*, const fvec4& color, const
   VL_CHECK_OGL();
 
   glDisable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, 0);
+  gl_context->bindTexture( TD_TEXTURE_2D, 0 );
 }
 //-----------------------------------------------------------------------------
 // returns the raw bounding box of the string, i.e. without alignment, margin and matrix transform.
@@ -159,7 +159,7 @@ namespace vl
     virtual void render_Implementation(const Actor* actor, const Shader* shader, const Camera* camera, OpenGLContext* gl_context) const;
     void computeBounds_Implementation() { setBoundingBox(AABB()); setBoundingSphere(Sphere()); }
 
-    void renderText(const Actor*, const Camera* camera, const fvec4& color, const fvec2& offset) const;
+    void renderText(const Actor*, const Camera* camera, const fvec4& color, const fvec2& offset, OpenGLContext* gl_context) const;
     void renderBackground(const Actor* actor, const Camera* camera) const;
     void renderBorder(const Actor* actor, const Camera* camera) const;
     AABB rawboundingRect(const String& text) const;
@@ -31,11 +31,109 @@
 
 #include <vlGraphics/DoubleVertexRemover.hpp>
 #include <vlCore/Time.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 using namespace vl;
 
 namespace
 {
+  inline u64 mix64(u64 h)
+  {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  inline u64 hashBytes(const void* data, size_t byte_count, u64 h)
+  {
+    const unsigned char* p = (const unsigned char*)data;
+    size_t i = 0;
+    for( ; i + 8 <= byte_count; i += 8 )
+    {
+      u64 w;
+      memcpy( &w, p + i, 8 );
+      h = mix64( h ^ w );
+    }
+    if ( i < byte_count )
+    {
+      u64 w = 0;
+      memcpy( &w, p + i, byte_count - i );
+      h = mix64( h ^ w ^ ( (u64)( byte_count - i ) << 56 ) );
+    }
+    return h;
+  }
+
+  // The attributes of the vertices of a Geometry seen as packed bytes, with the position optionally quantized.
+  class VertexKeys
+  {
+  public:
+    VertexKeys(const Geometry* geom, float tolerance): mPosition(NULL), mTolerance(tolerance)
+    {
+      for(int i=0; i<VA_MaxAttribCount; ++i)
+      {
+        const ArrayAbstract* arr = geom->vertexAttribArray(i);
+        if ( !arr || !arr->size() )
+          continue;
+        if ( i == VA_Position && tolerance > 0 )
+          mPosition = arr;
+        else
+        {
+          mData.push_back( arr->ptr() );
+          mStride.push_back( arr->bytesUsed() / arr->size() );
+        }
+      }
+    }
+
+    void cell(u32 i, long long c[4]) const
+    {
+      vec4 v = mPosition->getAsVec4(i);
+      for(int k=0; k<4; ++k)
+        c[k] = (long long)::floor( v[k] / mTolerance );
+    }
+
+    u64 hash(u32 i) const
+    {
+      u64 h = 0x9e3779b97f4a7c15ULL;
+      if ( mPosition )
+      {
+        long long c[4];
+        cell( i, c );
+        h = hashBytes( c, sizeof(c), h );
+      }
+      for(size_t a=0; a<mData.size(); ++a)
+        h = hashBytes( mData[a] + i * mStride[a], mStride[a], h );
+      return h;
+    }
+
+    bool equals(u32 a, u32 b) const
+    {
+      for(size_t k=0; k<mData.size(); ++k)
+      {
+        if ( memcmp( mData[k] + a * mStride[k], mData[k] + b * mStride[k], mStride[k] ) != 0 )
+          return false;
+      }
+      if ( mPosition )
+      {
+        long long ca[4], cb[4];
+        cell( a, ca );
+        cell( b, cb );
+        return memcmp( ca, cb, sizeof(ca) ) == 0;
+      }
+      return true;
+    }
+
+  protected:
+    std::vector<const unsigned char*> mData;
+    std::vector<size_t> mStride;
+    const ArrayAbstract* mPosition;
+    float mTolerance;
+  };
+
   class LessCompare
   {
   public:
@@ -221,6 +319,37 @@ void DoubleVertexRemover::removeDoubles(Geometry* geom)
   if (!vert_count)
     return;
 
+  if (method() == DVR_Sort)
+    computeMapSort(geom, vert_count);
+  else
+    computeMapHash(geom, vert_count);
+
+  // regenerate vertices
+
+  geom->regenerateVertices(mMapNewToOld);
+
+  // regenerate DrawCall
+
+  std::vector< ref<DrawCall> > draw_cmd;
+  for(size_t idraw=0; idraw<geom->drawCalls().size(); ++idraw)
+    draw_cmd.push_back( geom->drawCalls().at(idraw) );
+  geom->drawCalls().clear();
+
+  for(u32 idraw=0; idraw<draw_cmd.size(); ++idraw)
+  {
+    ref<DrawElementsUInt> de = new DrawElementsUInt( draw_cmd[idraw]->primitiveType() );
+    geom->drawCalls().push_back(de.get());
+    const u32 idx_count = draw_cmd[idraw]->countIndices();
+    de->indexBuffer()->resize(idx_count);
+    GLuint* idx = de->indexBuffer()->begin();
+    draw_cmd[idraw]->forEachIndex( [&](int index) { *idx++ = mMapOldToNew[index]; } );
+  }
+
+  Log::debug( Say("DoubleVertexRemover : method=%s, time=%.2ns, verts=%n/%n, saved=%n, ratio=%.2n\n") << (method() == DVR_Sort ? "sort" : "hash") << timer.elapsed() << mMapNewToOld.size() << vert_count << vert_count - mMapNewToOld.size() << (float)mMapNewToOld.size()/vert_count );
+}
+//-----------------------------------------------------------------------------
+void DoubleVertexRemover::computeMapSort(const Geometry* geom, u32 vert_count)
+{
   std::vector<u32> verti;
   verti.resize(vert_count);
   mMapOldToNew.resize(vert_count);
@@ -246,33 +375,96 @@ void DoubleVertexRemover::removeDoubles(Geometry* geom)
     }
   }
   for(unsigned j=unique_vert_idx; j<verti.size(); ++j)
-  {
     mMapOldToNew[verti[j]] = (u32)mMapNewToOld.size();
-    mMapNewToOld.push_back(verti[unique_vert_idx]);
-  }
+  mMapNewToOld.push_back(verti[unique_vert_idx]);
+}
+//-----------------------------------------------------------------------------
+void DoubleVertexRemover::computeMapHash(const Geometry* geom, u32 vert_count)
+{
+  const VertexKeys keys(geom, mWeldTolerance);
+  const u32 none = 0xFFFFFFFF;
 
-  // regenerate vertices
+  // hash the vertices
 
-  geom->regenerateVertices(mMapNewToOld);
+  std::vector<u64> hashes;
+  hashes.resize(vert_count);
+  ThreadPool::parallelFor( threadPool(), (int)vert_count, ThreadPool::rangeCount( threadPool(), (int)vert_count, 64 * 1024 ), [&](int, int begin, int end) {
+    for(int i=begin; i<end; ++i)
+      hashes[i] = keys.hash(i);
+  } );
 
-  // regenerate DrawCall
+  // distribute the vertices to the shards using the high bits of the hash, keeping them in index order
 
-  std::vector< ref<DrawCall> > draw_cmd;
-  for(size_t idraw=0; idraw<geom->drawCalls().size(); ++idraw)
-    draw_cmd.push_back( geom->drawCalls().at(idraw) );
-  geom->drawCalls().clear();
+  const int shard_bits = 6;
+  const int shard_count = 1 << shard_bits;
+  std::vector<u32> shard_begin(shard_count + 1, 0);
+  for(u32 i=0; i<vert_count; ++i)
+    ++shard_begin[ ( hashes[i] >> ( 64 - shard_bits ) ) + 1 ];
+  for(int s=0; s<shard_count; ++s)
+    shard_begin[s + 1] += shard_begin[s];
 
-  for(u32 idraw=0; idraw<draw_cmd.size(); ++idraw)
+  std::vector<u32> shard_verts;
+  shard_verts.resize(vert_count);
   {
-    ref<DrawElementsUInt> de = new DrawElementsUInt( draw_cmd[idraw]->primitiveType() );
-    geom->drawCalls().push_back(de.get());
-    const u32 idx_count = draw_cmd[idraw]->countIndices();
-    de->indexBuffer()->resize(idx_count);
-    u32 i=0;
-    for(IndexIterator it = draw_cmd[idraw]->indexIterator(); it.hasNext(); it.next(), ++i)
-      de->indexBuffer()->at(i) = mMapOldToNew[it.index()];
+    std::vector<u32> cursor( shard_begin.begin(), shard_begin.end() - 1 );
+    for(u32 i=0; i<vert_count; ++i)
+      shard_verts[ cursor[ hashes[i] >> ( 64 - shard_bits ) ]++ ] = i;
   }
 
-  Log::debug( Say("DoubleVertexRemover : time=%.2ns, verts=%n/%n, saved=%n, ratio=%.2n\n") << timer.elapsed() << mMapNewToOld.size() << verti.size() << verti.size() - mMapNewToOld.size() << (float)mMapNewToOld.size()/verti.size() );
+  // weld every shard with an open addressing table, the first occurrence of a vertex becomes its representative
+
+  std::vector<u32> representative;
+  representative.resize(vert_count);
+  auto weld_shard = [&](int ishard)
+  {
+    const u32 begin = shard_begin[ishard];
+    const u32 end   = shard_begin[ishard + 1];
+    if ( begin == end )
+      return;
+    size_t capacity = 16;
+    while( capacity < ( end - begin ) * 2 )
+      capacity <<= 1;
+    std::vector<u32> table(capacity, none);
+    for(u32 k=begin; k<end; ++k)
+    {
+      const u32 v = shard_verts[k];
+      for( size_t slot = (size_t)hashes[v] & ( capacity - 1 ); ; slot = ( slot + 1 ) & ( capacity - 1 ) )
+      {
+        const u32 t = table[slot];
+        if ( t == none )
+        {
+          table[slot] = v;
+          representative[v] = v;
+          break;
+        }
+        if ( hashes[t] == hashes[v] && keys.equals(t, v) )
+        {
+          representative[v] = t;
+          break;
+        }
+      }
+    }
+  };
+  if ( threadPool() )
+    threadPool()->parallelFor( shard_count, weld_shard );
+  else
+    for(int s=0; s<shard_count; ++s)
+      weld_shard(s);
+
+  // number the unique vertices in order of first occurrence
+
+  mMapOldToNew.resize(vert_count);
+  mMapNewToOld.reserve(vert_count);
+  for(u32 i=0; i<vert_count; ++i)
+  {
+    const u32 r = representative[i];
+    if ( r == i )
+    {
+      mMapOldToNew[i] = (u32)mMapNewToOld.size();
+      mMapNewToOld.push_back(i);
+    }
+    else
+      mMapOldToNew[i] = mMapOldToNew[r];
+  }
 }
 //-----------------------------------------------------------------------------
@@ -33,6 +33,7 @@
 #define DoubleVertexRemover_INCLUDE_ONCE
 
 #include <vlGraphics/Geometry.hpp>
+#include <vlGraphics/ThreadPool.hpp>
 #include <vector>
 
 namespace vl
@@ -58,6 +59,19 @@ namespace vl
   //-----------------------------------------------------------------------------
   // DoubleVertexRemover
   //-----------------------------------------------------------------------------
+  //! The algorithm used by DoubleVertexRemover::removeDoubles().
+  typedef enum
+  {
+    //! Hashes the packed attribute bytes of every vertex and welds the vertices in a sharded hash table, in parallel if a ThreadPool is set.
+    //! Merges bit-identical vertices, or the vertices whose position falls in the same cell of size weldTolerance().
+    //! The new vertices keep the order of their first occurrence. Since the bytes are compared, +0 and -0 are different values
+    //! while NaNs with the same bits are merged, unlike DVR_Sort.
+    DVR_Hash,
+    //! Sorts the vertices comparing their attributes with ArrayAbstract::compare(). Merges only identical vertices, the new vertices are sorted by value.
+    //! The default method.
+    DVR_Sort
+  } EDoubleVertexRemoverMethod;
+
   //! Removes from a Geometry the vertices with the same attributes.
   //! As a result also all the DrawArrays prensent in the Geometry are substituted with DrawElements.
   class VLGRAPHICS_EXPORT DoubleVertexRemover: public VertexMapper
@@ -65,14 +79,40 @@ namespace vl
     VL_INSTRUMENT_CLASS(vl::DoubleVertexRemover, VertexMapper)
 
   public:
-    DoubleVertexRemover() {}
+    DoubleVertexRemover(): mMethod(DVR_Sort), mWeldTolerance(0) {}
     void removeDoubles(Geometry* geom);
     const std::vector<u32>& mapNewToOld() const { return mMapNewToOld; }
     const std::vector<u32>& mapOldToNew() const { return mMapOldToNew; }
 
+    //! The algorithm used by removeDoubles(), DVR_Sort by default.
+    void setMethod(EDoubleVertexRemoverMethod method) { mMethod = method; }
+
+    //! The algorithm used by removeDoubles(), DVR_Sort by default.
+    EDoubleVertexRemoverMethod method() const { return mMethod; }
+
+    //! If > 0 the positions are quantized to a grid of this size before being compared, welding the vertices falling in the same cell.
+    //! Vertices closer than the tolerance but lying across a cell boundary are not welded. Used only by DVR_Hash, 0 by default.
+    void setWeldTolerance(float tolerance) { mWeldTolerance = tolerance; }
+
+    //! If > 0 the positions are quantized to a grid of this size before being compared, see setWeldTolerance().
+    float weldTolerance() const { return mWeldTolerance; }
+
+    //! The ThreadPool used by DVR_Hash to hash and weld the vertices in parallel. NULL by default.
+    void setThreadPool(ThreadPool* thread_pool) { mThreadPool = thread_pool; }
+
+    //! The ThreadPool used by DVR_Hash to hash and weld the vertices in parallel. NULL by default.
+    ThreadPool* threadPool() const { return mThreadPool.get(); }
+
+  protected:
+    void computeMapSort(const Geometry* geom, u32 vert_count);
+    void computeMapHash(const Geometry* geom, u32 vert_count);
+
   protected:
     std::vector<u32> mMapNewToOld;
     std::vector<u32> mMapOldToNew;
+    ref<ThreadPool> mThreadPool;
+    EDoubleVertexRemoverMethod mMethod;
+    float mWeldTolerance;
   };
 }
 
@@ -91,20 +91,22 @@ namespace vl
     virtual void deleteBufferObject() {}
     virtual void updateDirtyBufferObject(EBufferObjectUpdateMode) {}
 
-    virtual void render(bool) const
+    virtual void render(bool, OpenGLContext* gl_context) const
     {
       VL_CHECK_OGL()
 
+      const OpenGLFunctions& gl = glFunctions(gl_context);
+
       // apply patch parameters if any and if using PT_PATCHES
       applyPatchParameters();
 
       if ( instances() > 1 && (Has_GL_ARB_draw_instanced||Has_GL_EXT_draw_instanced) )
-        glDrawArraysInstanced( primitiveType(), (int)start(), (int)count(), (int)instances() );
+        gl._glDrawArraysInstanced( primitiveType(), (int)start(), (int)count(), (int)instances() );
       else
-        glDrawArrays( primitiveType(), (int)start(), (int)count() );
+        gl._glDrawArrays( primitiveType(), (int)start(), (int)count() );
 
       #ifndef NDEBUG
-        unsigned int glerr = glGetError();
+        unsigned int glerr = gl._glGetError();
         if (glerr != GL_NO_ERROR)
         {
           String msg( getGLErrorString(glerr) );
@@ -141,6 +143,15 @@ namespace vl
       return TriangleIterator(tid.get());
     }
 
+    bool indexSpans(IndexSpans& spans) const
+    {
+      spans.mPrimType  = primitiveType();
+      spans.mIndexType = 0;
+      spans.mFirst     = mStart;
+      spans.mCount     = mCount;
+      return true;
+    }
+
     IndexIterator indexIterator() const
     {
       ref<IndexIteratorDrawArrays> iida = new IndexIteratorDrawArrays;
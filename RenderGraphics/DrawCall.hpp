@@ -35,7 +35,9 @@
 #include <vlGraphics/Array.hpp>
 #include <vlGraphics/TriangleIterator.hpp>
 #include <vlGraphics/IndexIterator.hpp>
+#include <vlGraphics/IndexSpans.hpp>
 #include <vlGraphics/PatchParameter.hpp>
+#include <vlGraphics/OpenGLContext.hpp>
 
 namespace vl 
 {
@@ -109,8 +111,9 @@ namespace vl
     /** Returns the draw call's primitive type. */
     EPrimitiveType primitiveType() const { return mType; }
 
-    /** Executes the draw call. */
-    virtual void render(bool use_bo = true) const = 0;
+    /** Executes the draw call.
+      * If \p gl_context is not NULL the index buffer is bound through its state shadow, see OpenGLContext::bindBuffer(). */
+    virtual void render(bool use_bo = true, OpenGLContext* gl_context = NULL) const = 0;
 
     /** Returns a clone of the draw call. */
     virtual ref<DrawCall> clone() const = 0;
@@ -130,7 +133,8 @@ namespace vl
     /** 
      * Returns a TriangleIterator used to iterate through the triangles of a DrawCall.
      * Basically the iterator tesselates in triangles any DrawCall of type: PT_TRIANGLES, PT_TRIANGLE_STRIP
-     * PT_TRIANGLE_FAN, PT_POLYGON, PT_QUADS, PT_QUAD_STRIP. */
+     * PT_TRIANGLE_FAN, PT_POLYGON, PT_QUADS, PT_QUAD_STRIP and PT_TRIANGLES_ADJACENCY, whose adjacency vertices are skipped.
+     * The runs of a multi draw call that are too short to make a triangle are skipped, as well as incomplete trailing primitives. */
     virtual TriangleIterator triangleIterator() const = 0;
 
     /** 
@@ -138,12 +142,52 @@ namespace vl
      * This \note The returned indices already take into account primitive restart and base vertex. */
     virtual IndexIterator indexIterator() const = 0;
 
+    /** 
+     * Fills \p spans with the raw description of the indices of the DrawCall used by forEachTriangle() and forEachIndex().
+     * Returns false if the DrawCall does not support it, in which case forEachTriangle() and forEachIndex() 
+     * fall back to triangleIterator() and indexIterator(). */
+    virtual bool indexSpans(IndexSpans&) const { return false; }
+
+    /** 
+     * Calls \p func(int a, int b, int c) for each triangle of the DrawCall, yielding the same triangles in the same order as triangleIterator().
+     * The DrawCall type, index type and primitive type are dispatched only once, after which the triangles are extracted 
+     * by an inlined loop over the raw indices. Returns the functor like std::for_each(). */
+    template<class F>
+    F forEachTriangle(F func) const
+    {
+      IndexSpans spans;
+      if ( indexSpans(spans) )
+        forEachTriangleInSpans( spans, func );
+      else
+      {
+        for( TriangleIterator it = triangleIterator(); it.hasNext(); it.next() )
+          func( it.a(), it.b(), it.c() );
+      }
+      return func;
+    }
+
+    /** 
+     * Calls \p func(int index) for each virtual index of the DrawCall, see indexIterator().
+     * The indices already take into account primitive restart and base vertex. Returns the functor like std::for_each(). */
+    template<class F>
+    F forEachIndex(F func) const
+    {
+      IndexSpans spans;
+      if ( indexSpans(spans) )
+        forEachIndexInSpans( spans, func );
+      else
+      {
+        for( IndexIterator it = indexIterator(); it.hasNext(); it.next() )
+          func( it.index() );
+      }
+      return func;
+    }
+
     /** Counts the number of virtual indices of a DrawCall., i.e. the number of indices you would retrieve by iterating over the iterator returned by indexIterator(). */
     u32 countIndices() const
     {
       u32 count = 0;
-      for( IndexIterator it = indexIterator(); it.hasNext(); it.next() )
-        ++count;
+      forEachIndex( [&](int) { ++count; } );
       return count;
     }
 
@@ -151,8 +195,7 @@ namespace vl
     u32 countTriangles() const
     {
       u32 count = 0;
-      for( TriangleIterator it = triangleIterator(); it.hasNext(); it.next() )
-        ++count;
+      forEachTriangle( [&](int, int, int) { ++count; } );
       return count;
     }
 
@@ -175,6 +218,26 @@ namespace vl
     const PatchParameter* patchParameter() const { return mPatchParameter.get(); }
 
   protected:
+    //! Binds the index buffer through the OpenGLContext state shadow or directly if \p gl_context is NULL.
+    static void bindIndexBuffer(OpenGLContext* gl_context, GLuint buffer)
+    {
+      if (gl_context)
+      {
+        gl_context->bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+      }
+      else
+      {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer); VL_CHECK_OGL()
+        forgetBufferTarget(GL_ELEMENT_ARRAY_BUFFER);
+      }
+    }
+
+    //! The function table of \p gl_context or vl::GL_Functions if \p gl_context is NULL.
+    static const OpenGLFunctions& glFunctions(OpenGLContext* gl_context)
+    {
+      return gl_context ? gl_context->mGL : GL_Functions;
+    }
+
     void applyPatchParameters() const
     {
       if (mType == PT_PATCHES && mPatchParameter)
@@ -217,9 +217,11 @@ namespace vl
       indexBuffer()->bufferObject()->deleteBufferObject();
     }
 
-    virtual void render(bool use_bo) const
+    virtual void render(bool use_bo, OpenGLContext* gl_context) const
     {
       VL_CHECK_OGL()
+
+      const OpenGLFunctions& gl = glFunctions(gl_context);
       VL_CHECK(!use_bo || (use_bo && Has_BufferObject))
 
       use_bo &= Has_BufferObject; // && indexBuffer()->bufferObject()->handle() && indexBuffer()->sizeBufferObject();
@@ -233,8 +235,8 @@ namespace vl
       if(primitiveRestartEnabled())
       {
         VL_CHECK(Has_Primitive_Restart);
-        glEnable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL();
-        glPrimitiveRestartIndex(primitive_restart_index); VL_CHECK_OGL();
+        gl._glEnable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL();
+        gl._glPrimitiveRestartIndex(primitive_restart_index); VL_CHECK_OGL();
       }
 
       // compute base pointer
@@ -242,12 +244,12 @@ namespace vl
       const GLvoid* ptr = indexBuffer()->bufferObject()->ptr();
       if (use_bo && indexBuffer()->bufferObject()->handle())
       {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer()->bufferObject()->handle()); VL_CHECK_OGL()
+        bindIndexBuffer(gl_context, indexBuffer()->bufferObject()->handle());
         ptr = 0;
       }
       else
       {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); VL_CHECK_OGL()
+        bindIndexBuffer(gl_context, 0);
       }
 
       // compute final pointer and count
@@ -277,12 +279,12 @@ namespace vl
       {
         if ( instances() == 1 )
         {
-          glDrawElements( primitiveType(), count, arr_type::gl_type, ptr ); VL_CHECK_OGL()
+          gl._glDrawElements( primitiveType(), count, arr_type::gl_type, ptr ); VL_CHECK_OGL()
         }
         else
         {
           VL_CHECK(Has_Primitive_Instancing)
-          glDrawElementsInstanced( primitiveType(), count, arr_type::gl_type, ptr, instances() ); VL_CHECK_OGL()
+          gl._glDrawElementsInstanced( primitiveType(), count, arr_type::gl_type, ptr, instances() ); VL_CHECK_OGL()
         }
       }
       else
@@ -290,12 +292,12 @@ namespace vl
         VL_CHECK(Has_Base_Vertex)
         if ( instances() == 1 )
         {
-          glDrawElementsBaseVertex( primitiveType(), count, arr_type::gl_type, ptr, mBaseVertex ); VL_CHECK_OGL()
+          gl._glDrawElementsBaseVertex( primitiveType(), count, arr_type::gl_type, ptr, mBaseVertex ); VL_CHECK_OGL()
         }
         else
         {
           VL_CHECK(Has_Primitive_Instancing)
-          glDrawElementsInstancedBaseVertex( primitiveType(), count, arr_type::gl_type, ptr, instances(), mBaseVertex ); VL_CHECK_OGL()
+          gl._glDrawElementsInstancedBaseVertex( primitiveType(), count, arr_type::gl_type, ptr, instances(), mBaseVertex ); VL_CHECK_OGL()
         }
       }
 
@@ -303,11 +305,11 @@ namespace vl
 
       if(primitiveRestartEnabled())
       {
-        glDisable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL()
+        gl._glDisable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL()
       }
 
       #ifndef NDEBUG
-        unsigned int glerr = glGetError();
+        unsigned int glerr = gl._glGetError();
         if (glerr != GL_NO_ERROR)
         {
           String msg( getGLErrorString(glerr) );
@@ -328,6 +330,22 @@ namespace vl
       return TriangleIterator(it.get());
     }
 
+    bool indexSpans(IndexSpans& spans) const
+    {
+      spans.mPrimType         = primitiveType();
+      // nothing to traverse if the local index buffer is not available
+      if ( !mIndexBuffer || !mIndexBuffer->ptr() )
+        return true;
+      spans.mIndexType        = arr_type::gl_type;
+      spans.mIndices          = mIndexBuffer->ptr();
+      spans.mFirst            = 0;
+      spans.mCount            = (int)mIndexBuffer->size();
+      spans.mBaseVertex       = baseVertex();
+      spans.mPrimRestartOn    = primitiveRestartEnabled();
+      spans.mPrimRestartIndex = primitive_restart_index;
+      return true;
+    }
+
     IndexIterator indexIterator() const
     {
       ref< IndexIteratorElements<arr_type> > iie = new IndexIteratorElements<arr_type>;
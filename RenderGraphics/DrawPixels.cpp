@@ -33,6 +33,7 @@
 #include <vlGraphics/Actor.hpp>
 #include <vlGraphics/Camera.hpp>
 #include <vlGraphics/BufferObject.hpp>
+#include <vlGraphics/OpenGLContext.hpp>
 #include <vlCore/Log.hpp>
 #include <map>
 
@@ -115,7 +116,7 @@ DrawPixels::DrawPixels()
   mDraws.setAutomaticDelete(false);
 }
 //-----------------------------------------------------------------------------
-void DrawPixels::render_Implementation(const Actor* actor, const Shader*, const Camera* camera, OpenGLContext*) const
+void DrawPixels::render_Implementation(const Actor* actor, const Shader*, const Camera* camera, OpenGLContext* gl_context) const
 {
   VL_CHECK_OGL()
 
@@ -226,13 +227,13 @@ void DrawPixels::render_Implementation(const Actor* actor, const Shader*, const
 
     if ( glbuf->handle() )
     {
-      glBindBuffer( GL_PIXEL_UNPACK_BUFFER, glbuf->handle() ); VL_CHECK_OGL()
+      gl_context->bindBuffer( GL_PIXEL_UNPACK_BUFFER, glbuf->handle() ); VL_CHECK_OGL()
       glDrawPixels( cmd->mSize.x() -clip_left -clip_right, cmd->mSize.y() -clip_bottom -clip_top, cmd->image()->format(), cmd->image()->type(), 0 );
       VL_CHECK_OGL();
     }
     else
     {
-      glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+      gl_context->bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
       glDrawPixels( cmd->mSize.x() -clip_left -clip_right, cmd->mSize.y() -clip_bottom -clip_top, cmd->image()->format(), cmd->image()->type(), cmd->image()->pixels() );
       VL_CHECK_OGL();
     }
@@ -240,7 +241,7 @@ void DrawPixels::render_Implementation(const Actor* actor, const Shader*, const
 
   VL_CHECK_OGL();
 
-  glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+  gl_context->bindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
 
   VL_CHECK_OGL()
 
@@ -218,9 +218,11 @@ namespace vl
       indexBuffer()->bufferObject()->deleteBufferObject();
     }
 
-    virtual void render(bool use_bo) const
+    virtual void render(bool use_bo, OpenGLContext* gl_context) const
     {
       VL_CHECK_OGL()
+
+      const OpenGLFunctions& gl = glFunctions(gl_context);
       VL_CHECK(!use_bo || (use_bo && Has_BufferObject))
       use_bo &= Has_BufferObject; // && indexBuffer()->bufferObject()->handle() && indexBuffer()->sizeBufferObject();
       if ( !use_bo && !indexBuffer()->size() )
@@ -233,8 +235,8 @@ namespace vl
       if(primitiveRestartEnabled())
       {
         VL_CHECK(Has_Primitive_Restart);
-        glEnable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL();
-        glPrimitiveRestartIndex(primitive_restart_index); VL_CHECK_OGL();
+        gl._glEnable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL();
+        gl._glPrimitiveRestartIndex(primitive_restart_index); VL_CHECK_OGL();
       }
 
       // compute base pointer
@@ -242,12 +244,12 @@ namespace vl
       const GLvoid* ptr = indexBuffer()->bufferObject()->ptr();
       if (use_bo && indexBuffer()->bufferObject()->handle())
       {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer()->bufferObject()->handle()); VL_CHECK_OGL()
+        bindIndexBuffer(gl_context, indexBuffer()->bufferObject()->handle());
         ptr = 0;
       }
       else
       {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); VL_CHECK_OGL()
+        bindIndexBuffer(gl_context, 0);
       }
 
       // compute final pointer and count
@@ -275,19 +277,19 @@ namespace vl
 
       if (mBaseVertex == 0)
       {
-        glDrawRangeElements( primitiveType(), mRangeStart, mRangeEnd, count, arr_type::gl_type, ptr ); VL_CHECK_OGL()
+        gl._glDrawRangeElements( primitiveType(), mRangeStart, mRangeEnd, count, arr_type::gl_type, ptr ); VL_CHECK_OGL()
       }
       else
       {
         VL_CHECK(Has_Base_Vertex)
-        glDrawRangeElementsBaseVertex( primitiveType(), mRangeStart, mRangeEnd, count, arr_type::gl_type, ptr, mBaseVertex ); VL_CHECK_OGL()
+        gl._glDrawRangeElementsBaseVertex( primitiveType(), mRangeStart, mRangeEnd, count, arr_type::gl_type, ptr, mBaseVertex ); VL_CHECK_OGL()
       }
 
       // primitive restart disable
 
       if(primitiveRestartEnabled())
       {
-        glDisable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL()
+        gl._glDisable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL()
       }
     }
 
@@ -300,6 +302,22 @@ namespace vl
       return TriangleIterator(it.get());
     }
 
+    bool indexSpans(IndexSpans& spans) const
+    {
+      spans.mPrimType         = primitiveType();
+      // nothing to traverse if the local index buffer is not available
+      if ( !mIndexBuffer || !mIndexBuffer->ptr() )
+        return true;
+      spans.mIndexType        = arr_type::gl_type;
+      spans.mIndices          = mIndexBuffer->ptr();
+      spans.mFirst            = 0;
+      spans.mCount            = (int)mIndexBuffer->size();
+      spans.mBaseVertex       = baseVertex();
+      spans.mPrimRestartOn    = primitiveRestartEnabled();
+      spans.mPrimRestartIndex = primitive_restart_index;
+      return true;
+    }
+
     IndexIterator indexIterator() const
     {
       ref< IndexIteratorElements<arr_type> > iie = new IndexIteratorElements<arr_type>;
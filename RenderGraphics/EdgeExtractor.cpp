@@ -86,24 +86,20 @@ void EdgeExtractor::extractEdges(Geometry* geom)
   {
     DrawCall* prim = geom->drawCalls().at(iprim);
     // iterate triangles (if present)
-    for(TriangleIterator trit = prim->triangleIterator(); trit.hasNext(); trit.next())
-    {
-      size_t a = trit.a();
-      size_t b = trit.b();
-      size_t c = trit.c();
+    prim->forEachTriangle( [&](size_t a, size_t b, size_t c) {
       if (a == b || b == c || c == a)
-        continue;
+        return;
       // compute normal
       fvec3 v0 = (fvec3)verts->getAsVec3(a);
       fvec3 v1 = (fvec3)verts->getAsVec3(b) - v0;
       fvec3 v2 = (fvec3)verts->getAsVec3(c) - v0;
       fvec3 n = cross(v1,v2).normalize();
       if (n.isNull())
-        continue;
+        return;
       addEdge(edges, Edge( (fvec3)verts->getAsVec3(a), (fvec3)verts->getAsVec3(b) ), n );
       addEdge(edges, Edge( (fvec3)verts->getAsVec3(b), (fvec3)verts->getAsVec3(c) ), n );
       addEdge(edges, Edge( (fvec3)verts->getAsVec3(c), (fvec3)verts->getAsVec3(a) ), n );
-    }
+    } );
   }
 
   for(std::set<Edge>::iterator it = edges.begin(); it != edges.end(); ++it)
@@ -104,6 +104,7 @@ namespace vl
       mEnableMask = 0xFFFFFFFF;
       mRenderRank = 0;
       mActiveLod  = 0;
+      mUpdateTick = 0;
       mLODShaders[0] = new ShaderPasses(new Shader);
     }
 
@@ -132,6 +133,7 @@ namespace vl
       mActiveLod = other.mActiveLod;
       mRenderRank = other.mRenderRank;
       mEnableMask = other.mEnableMask;
+      ++mUpdateTick;
 
       return *this;
     }
@@ -161,7 +163,7 @@ namespace vl
       * To know more about rendering order please see \ref pagGuideRenderOrder "Rendering Order".
       *
       * \sa Actor::setRenderRank(), Actor::setRenderBlock() */
-    void setRenderRank(int rank) { mRenderRank = rank; }
+    void setRenderRank(int rank) { mRenderRank = rank; ++mUpdateTick; }
 
     /** Returns the rendering rank of an Effect. */
     int renderRank() const { return mRenderRank; }
@@ -185,10 +187,11 @@ namespace vl
     {
       VL_CHECK(lodi<VL_MAX_EFFECT_LOD)
       lod(lodi) = new ShaderPasses(shader1,shader2,shader3,shader4);
+      ++mUpdateTick;
     }
 
     /** Installs the LODEvaluator used to compute the current LOD at rendering time. */
-    void setLODEvaluator(LODEvaluator* lod_evaluator) { mLODEvaluator = lod_evaluator; }
+    void setLODEvaluator(LODEvaluator* lod_evaluator) { mLODEvaluator = lod_evaluator; ++mUpdateTick; }
 
     /** Returns the installed LODEvaluator (if any) or NULL. */
     LODEvaluator* lodEvaluator() { return mLODEvaluator.get(); }
@@ -197,7 +200,7 @@ namespace vl
     const LODEvaluator* lodEvaluator() const { return mLODEvaluator.get(); }
 
     /** The enable mask of an Actor's Effect defines whether the actor should be rendered or not depending on the Rendering::enableMask(). */
-    void setEnableMask(unsigned int mask) { mEnableMask = mask; }
+    void setEnableMask(unsigned int mask) { mEnableMask = mask; ++mUpdateTick; }
 
     /** The enable mask of an Actor's Effect defines whether the actor should be rendered or not depending on the Rendering::enableMask(). */
     unsigned int enableMask() const { return mEnableMask; }
@@ -211,17 +214,26 @@ namespace vl
       VL_CHECK( lod < VL_MAX_EFFECT_LOD )
       VL_CHECK( lod >= 0 )
       mActiveLod = lod;
+      ++mUpdateTick;
     }
 
     /** Returns the lod to be used for rendering. */
     int activeLod() const { return mActiveLod; }
 
+    /** Incremented every time the render rank, the enable mask, the LODs or the LODEvaluator are modified through the Effect's methods, used by Rendering to validate its render queue cache.
+      * Call incrementUpdateTick() after modifying the ShaderPasses returned by lod() directly. */
+    long long updateTick() const { return mUpdateTick; }
+
+    /** Flags the Effect as modified, see updateTick(). */
+    void incrementUpdateTick() { ++mUpdateTick; }
+
   protected:
     ref<ShaderPasses> mLODShaders[VL_MAX_EFFECT_LOD];
     ref<LODEvaluator> mLODEvaluator;
     int mActiveLod;
     int mRenderRank;
     unsigned int mEnableMask;
+    long long mUpdateTick;
   };
   //------------------------------------------------------------------------------
 }
@@ -31,6 +31,7 @@
 
 #include <vlGraphics/Font.hpp>
 #include <vlGraphics/OpenGL.hpp>
+#include <vlGraphics/OpenGLContext.hpp>
 #include <vlGraphics/FontManager.hpp>
 #include <vlCore/Log.hpp>
 #include <vlCore/Say.hpp>
@@ -74,6 +75,7 @@ Glyph::~Glyph()
   if (mTextureHandle)
   {
     glDeleteTextures(1, &mTextureHandle);
+    forgetTextureBindings(mTextureHandle);
     mTextureHandle = 0;
   }
 }
@@ -180,7 +182,7 @@ void Font::loadFont(const String& path)
   }
 }
 //-----------------------------------------------------------------------------
-Glyph* Font::glyph(int character)
+Glyph* Font::glyph(int character, OpenGLContext* gl_context)
 {
   ref<Glyph>& glyph = mGlyphMap[character];
 
@@ -334,8 +336,17 @@ Glyph* Font::glyph(int character)
       unsigned int texhdl;
       glGenTextures( 1, &texhdl );
       glyph->setTextureHandle(texhdl);
-      glActiveTexture(GL_TEXTURE0);
-      glBindTexture( GL_TEXTURE_2D, glyph->textureHandle() );
+      if ( gl_context )
+      {
+        gl_context->activeTexture( 0 );
+        gl_context->bindTexture( TD_TEXTURE_2D, glyph->textureHandle() );
+      }
+      else
+      {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture( GL_TEXTURE_2D, glyph->textureHandle() );
+        forgetActiveTextureUnit( true );
+      }
 
       int texsize[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 0 };
       int max_tex_size = 0;
@@ -440,7 +451,10 @@ Glyph* Font::glyph(int character)
       }
 
       VL_CHECK_OGL();
-      glBindTexture( GL_TEXTURE_2D, 0 );
+      if ( gl_context )
+        gl_context->bindTexture( TD_TEXTURE_2D, 0 );
+      else
+        glBindTexture( GL_TEXTURE_2D, 0 );
     }
 
     glyph->setAdvance( fvec2( (float)mFT_Face->glyph->advance.x / 64.0f, (float)mFT_Face->glyph->advance.y / 64.0f ) );
@@ -476,5 +490,6 @@ void Font::setSmooth(bool smooth)
     }
   }
   glBindTexture( GL_TEXTURE_2D, 0 );
+  forgetActiveTextureUnit();
 }
 //-----------------------------------------------------------------------------
@@ -46,6 +46,7 @@ namespace vl
 {
   class Font;
   class FontManager;
+  class OpenGLContext;
   //-----------------------------------------------------------------------------
   // Glyph
   //-----------------------------------------------------------------------------
@@ -170,7 +171,8 @@ namespace vl
     void setSize(int size);
 
     //! Returns (and eventually creates) the Glyph* associated to the given character.
-    Glyph* glyph(int character);
+    //! If \p gl_context is not NULL the texture of a new glyph is bound through its state shadow, see OpenGLContext::bindTexture().
+    Glyph* glyph(int character, OpenGLContext* gl_context=NULL);
 
     //! Whether the font rendering should use linear filtering or not.
     void setSmooth(bool smooth);
@@ -41,9 +41,10 @@ namespace
 {
   class ScopedFBOBinding
   {
+    OpenGLContext* mOpenGLContext;
     GLint mPrevFBO;
   public:
-    ScopedFBOBinding( FramebufferObject* fbo )
+    ScopedFBOBinding( FramebufferObject* fbo ): mOpenGLContext( fbo->openglContext() )
     {
       VL_CHECK( fbo );
       VL_CHECK( fbo->handle() );
@@ -55,13 +56,13 @@ namespace
       glGetIntegerv( GL_FRAMEBUFFER_BINDING, &mPrevFBO ); VL_CHECK_OGL()
 
       // binds this FBO
-      glBindFramebuffer( GL_FRAMEBUFFER, fbo->handle() ); VL_CHECK_OGL()
+      mOpenGLContext->bindFramebuffer( GL_FRAMEBUFFER, fbo->handle() );
     }
 
     ~ScopedFBOBinding()
     {
       // restore the FBO
-      glBindFramebuffer( GL_FRAMEBUFFER, mPrevFBO ); VL_CHECK_OGL()
+      mOpenGLContext->bindFramebuffer( GL_FRAMEBUFFER, mPrevFBO );
     }
   };
 }
@@ -214,7 +215,7 @@ void FramebufferObject::deleteFBO()
   removeAllAttachments();
   if ( handle() )
   {
-    glBindFramebuffer( GL_FRAMEBUFFER, 0 ); VL_CHECK_OGL();
+    openglContext()->bindFramebuffer( GL_FRAMEBUFFER, 0 );
     glDeleteFramebuffers( 1, &mHandle ); VL_CHECK_OGL();
     mHandle = 0;
   }
@@ -259,7 +260,7 @@ void FramebufferObject::bindFramebuffer( EFramebufferBind target )
   }
   */
 
-   glBindFramebuffer( target, handle() ); VL_CHECK_OGL()
+  openglContext()->bindFramebuffer( target, handle() );
 
 #if defined(VL_OPENGL)
   // bind draw buffers
@@ -282,7 +283,7 @@ void FramebufferObject::bindFramebuffer( EFramebufferBind target )
     if ( status != GL_FRAMEBUFFER_COMPLETE )
     {
       printFramebufferError( status );
-      glBindFramebuffer( GL_FRAMEBUFFER, 0 ); VL_CHECK_OGL()
+      openglContext()->bindFramebuffer( GL_FRAMEBUFFER, 0 );
     }
   }
   #endif
@@ -462,11 +463,11 @@ void FramebufferObject::removeAttachment( EAttachmentPoint attach_point )
     int fbo = -1;
     glGetIntegerv( GL_FRAMEBUFFER_BINDING, &fbo ); VL_CHECK_OGL()
     // bind this fbo
-    glBindFramebuffer( GL_FRAMEBUFFER, handle() ); VL_CHECK_OGL()
+    openglContext()->bindFramebuffer( GL_FRAMEBUFFER, handle() );
     // detach should work for any kind of buffer and texture
     glFramebufferRenderbuffer( GL_FRAMEBUFFER, attach_point, GL_RENDERBUFFER, 0 ); VL_CHECK_OGL()
     // restore fbo
-    glBindFramebuffer( GL_FRAMEBUFFER, fbo ); VL_CHECK_OGL()
+    openglContext()->bindFramebuffer( GL_FRAMEBUFFER, fbo );
   }
   // remove FramebufferObject from FBOAbstractAttachment
   FBOAbstractAttachment* fbo_attachment = /* mFBOAttachments.find( attachment ) != mFBOAttachments.end() ? */ mFBOAttachments[attach_point].get() /* : NULL */;
@@ -509,6 +510,7 @@ void FBOTexture1DAttachment::bindAttachment( FramebufferObject* fbo, EAttachment
 
   // needed to make non-mipmapped textures work with FBO, see framebuffer_object.txt line 442
   glBindTexture( texture()->dimension(), texture()->handle() ); VL_CHECK_OGL()
+  forgetActiveTextureUnit();
   glTexParameteri( texture()->dimension(), GL_TEXTURE_MIN_FILTER, GL_LINEAR ); VL_CHECK_OGL()
   glBindTexture( texture()->dimension(), 0 ); VL_CHECK_OGL()
 }
@@ -542,6 +544,7 @@ void FBOTexture2DAttachment::bindAttachment( FramebufferObject* fbo, EAttachment
   if ( texture()->dimension() != TD_TEXTURE_2D_MULTISAMPLE )
   {
     glBindTexture( texture()->dimension(), texture()->handle() ); VL_CHECK_OGL()
+    forgetActiveTextureUnit();
     glTexParameteri( texture()->dimension(), GL_TEXTURE_MIN_FILTER, GL_LINEAR ); VL_CHECK_OGL()
     glBindTexture( texture()->dimension(), 0 ); VL_CHECK_OGL()
   }
@@ -563,6 +566,7 @@ void FBOTextureAttachment::bindAttachment( FramebufferObject* fbo, EAttachmentPo
   if ( texture()->dimension() != TD_TEXTURE_2D_MULTISAMPLE )
   {
     glBindTexture( texture()->dimension(), texture()->handle() ); VL_CHECK_OGL()
+    forgetActiveTextureUnit();
     glTexParameteri( texture()->dimension(), GL_TEXTURE_MIN_FILTER, GL_LINEAR ); VL_CHECK_OGL()
     glBindTexture( texture()->dimension(), 0 ); VL_CHECK_OGL()
   }
@@ -590,6 +594,7 @@ void FBOTexture3DAttachment::bindAttachment( FramebufferObject* fbo, EAttachment
   if ( texture()->dimension() != TD_TEXTURE_2D_MULTISAMPLE_ARRAY )
   {
     glBindTexture( texture()->dimension(), texture()->handle() ); VL_CHECK_OGL()
+    forgetActiveTextureUnit();
     glTexParameteri( texture()->dimension(), GL_TEXTURE_MIN_FILTER, GL_LINEAR ); VL_CHECK_OGL()
     glBindTexture( texture()->dimension(), 0 ); VL_CHECK_OGL()
   }
@@ -620,6 +625,7 @@ void FBOTextureLayerAttachment::bindAttachment( FramebufferObject* fbo, EAttachm
   if ( texture()->dimension() != TD_TEXTURE_2D_MULTISAMPLE_ARRAY )
   {
     glBindTexture( texture()->dimension(), texture()->handle() ); VL_CHECK_OGL()
+    forgetActiveTextureUnit();
     glTexParameteri( texture()->dimension(), GL_TEXTURE_MIN_FILTER, GL_LINEAR ); VL_CHECK_OGL()
     glBindTexture( texture()->dimension(), 0 ); VL_CHECK_OGL()
   }
@@ -0,0 +1,224 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include <vlGraphics/GLCallCounter.hpp>
+
+#if defined(VL_OPENGL)
+
+using namespace vl;
+
+unsigned long long GLCallCounter::mCallCount[GLF_FunctionCount] = { 0 };
+std::vector<unsigned long long>* GLCallCounter::mCommandStream = NULL;
+bool GLCallCounter::mInstalled = false;
+
+namespace
+{
+  const char* GLFunctionNames[] =
+  {
+    #define VL_GL_FUNCTION(NAME) #NAME,
+    #include <vlGraphics/GL/GLFunctionList_1_1.hpp>
+    #undef VL_GL_FUNCTION
+    #define VL_GL_FUNCTION(TYPE, NAME) #NAME,
+    #include <vlGraphics/GL/GLFunctionList.hpp>
+    #undef VL_GL_FUNCTION
+    ""
+  };
+
+  bool startsWith(const char* name, const char* prefix)
+  {
+    return strncmp(name, prefix, strlen(prefix)) == 0;
+  }
+
+  bool startsWithAny(const char* name, const char* const* prefixes)
+  {
+    for( ; *prefixes; ++prefixes ) {
+      if ( startsWith(name, *prefixes) ) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  EGLCallCategory categorize(const char* name)
+  {
+    static const char* const data_upload[] = {
+      "glBufferData", "glBufferSubData", "glBufferStorage", "glNamedBufferData", "glNamedBufferSubData", "glNamedBufferStorage",
+      "glCopyBufferSubData", "glCopyNamedBufferSubData", "glMapBuffer", "glMapNamedBuffer", "glUnmapBuffer", "glUnmapNamedBuffer",
+      "glFlushMappedBufferRange", "glFlushMappedNamedBufferRange", "glTexImage", "glTexSubImage", "glTexStorage",
+      "glTextureSubImage", "glTextureStorage", "glCompressedTex", "glCopyTex", "glCopyTexture", "glGenerateMipmap",
+      "glGenerateTextureMipmap", NULL
+    };
+    static const char* const state_change[] = { "glUniformBlockBinding", "glClearColor", "glClearDepth", "glClearStencil", NULL };
+    static const char* const draw_call[] = { "glDraw", "glMultiDraw", "glClear", "glDispatchCompute", NULL };
+    static const char* const uniform_upload[] = { "glUniform", "glProgramUniform", NULL };
+    static const char* const object_lifetime[] = { "glGen", "glCreate", "glDelete", NULL };
+    static const char* const query[] = { "glGet", "glIs", "glCheck", "glClientWaitSync", "glReadPixels", NULL };
+
+    if ( startsWithAny(name, data_upload) ) {
+      return GLC_DataUpload;
+    } else if ( startsWithAny(name, state_change) ) {
+      return GLC_StateChange;
+    } else if ( startsWithAny(name, uniform_upload) ) {
+      return GLC_UniformUpload;
+    } else if ( startsWithAny(name, draw_call) ) {
+      return GLC_DrawCall;
+    } else if ( startsWithAny(name, object_lifetime) ) {
+      return GLC_ObjectLifetime;
+    } else if ( startsWithAny(name, query) ) {
+      return GLC_Query;
+    } else {
+      return GLC_StateChange;
+    }
+  }
+
+  std::vector<EGLCallCategory> categorizeFunctions()
+  {
+    std::vector<EGLCallCategory> categories( GLF_FunctionCount );
+    for( int i = 0; i < GLF_FunctionCount; ++i ) {
+      categories[i] = categorize( GLFunctionNames[i] );
+    }
+    return categories;
+  }
+}
+//-----------------------------------------------------------------------------
+void GLCallCounter::install()
+{
+  // initializeOpenGL() might have reset only part of the table
+  #define VL_GL_FUNCTION(TYPE, NAME) \
+    if ( NAME != &GLCallThunk<GLF_##NAME, TYPE>::call ) { \
+      GLCallThunk<GLF_##NAME, TYPE>::mFunction = NAME; \
+      NAME = &GLCallThunk<GLF_##NAME, TYPE>::call; \
+    }
+  #include <vlGraphics/GL/GLFunctionList.hpp>
+  #undef VL_GL_FUNCTION
+
+  install(GL_Functions);
+
+  mInstalled = true;
+}
+//-----------------------------------------------------------------------------
+void GLCallCounter::uninstall()
+{
+  if ( ! mInstalled ) {
+    return;
+  }
+
+  #define VL_GL_FUNCTION(TYPE, NAME) \
+    if ( NAME == &GLCallThunk<GLF_##NAME, TYPE>::call ) { \
+      NAME = GLCallThunk<GLF_##NAME, TYPE>::mFunction; \
+    }
+  #include <vlGraphics/GL/GLFunctionList.hpp>
+  #undef VL_GL_FUNCTION
+
+  uninstall(GL_Functions);
+
+  mInstalled = false;
+}
+//-----------------------------------------------------------------------------
+void GLCallCounter::install(OpenGLFunctions& gl)
+{
+  #define VL_GL_FUNCTION(NAME) \
+    if ( gl._##NAME != &GLCallThunk<GLF_##NAME, decltype(NAME)*>::call ) { \
+      GLCallThunk<GLF_##NAME, decltype(NAME)*>::mFunction = gl._##NAME; \
+      gl._##NAME = &GLCallThunk<GLF_##NAME, decltype(NAME)*>::call; \
+    }
+  #include <vlGraphics/GL/GLFunctionList_1_1.hpp>
+  #undef VL_GL_FUNCTION
+
+  #define VL_GL_FUNCTION(TYPE, NAME) \
+    if ( gl._##NAME != &GLCallThunk<GLF_##NAME, TYPE>::call ) { \
+      GLCallThunk<GLF_##NAME, TYPE>::mFunction = gl._##NAME; \
+      gl._##NAME = &GLCallThunk<GLF_##NAME, TYPE>::call; \
+    }
+  #include <vlGraphics/GL/GLFunctionList.hpp>
+  #undef VL_GL_FUNCTION
+}
+//-----------------------------------------------------------------------------
+void GLCallCounter::uninstall(OpenGLFunctions& gl)
+{
+  #define VL_GL_FUNCTION(NAME) \
+    if ( gl._##NAME == &GLCallThunk<GLF_##NAME, decltype(NAME)*>::call ) { \
+      gl._##NAME = GLCallThunk<GLF_##NAME, decltype(NAME)*>::mFunction; \
+    }
+  #include <vlGraphics/GL/GLFunctionList_1_1.hpp>
+  #undef VL_GL_FUNCTION
+
+  #define VL_GL_FUNCTION(TYPE, NAME) \
+    if ( gl._##NAME == &GLCallThunk<GLF_##NAME, TYPE>::call ) { \
+      gl._##NAME = GLCallThunk<GLF_##NAME, TYPE>::mFunction; \
+    }
+  #include <vlGraphics/GL/GLFunctionList.hpp>
+  #undef VL_GL_FUNCTION
+}
+//-----------------------------------------------------------------------------
+unsigned long long GLCallCounter::callCount(EGLCallCategory category)
+{
+  unsigned long long total = 0;
+  for( int i = 0; i < GLF_FunctionCount; ++i ) {
+    if ( functionCategory( (EGLFunction)i ) == category ) {
+      total += mCallCount[i];
+    }
+  }
+  return total;
+}
+//-----------------------------------------------------------------------------
+unsigned long long GLCallCounter::totalCallCount()
+{
+  unsigned long long total = 0;
+  for( int i = 0; i < GLF_FunctionCount; ++i ) {
+    total += mCallCount[i];
+  }
+  return total;
+}
+//-----------------------------------------------------------------------------
+void GLCallCounter::resetCounts()
+{
+  for( int i = 0; i < GLF_FunctionCount; ++i ) {
+    mCallCount[i] = 0;
+  }
+}
+//-----------------------------------------------------------------------------
+const char* GLCallCounter::functionName(EGLFunction fn)
+{
+  VL_CHECK( fn >= 0 && fn < GLF_FunctionCount )
+  return GLFunctionNames[fn];
+}
+//-----------------------------------------------------------------------------
+EGLCallCategory GLCallCounter::functionCategory(EGLFunction fn)
+{
+  VL_CHECK( fn >= 0 && fn < GLF_FunctionCount )
+  static const std::vector<EGLCallCategory> categories = categorizeFunctions();
+  return categories[fn];
+}
+//-----------------------------------------------------------------------------
+
+#endif
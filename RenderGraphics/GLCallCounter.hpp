@@ -0,0 +1,191 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef GLCallCounter_INCLUDE_ONCE
+#define GLCallCounter_INCLUDE_ONCE
+
+#include <vlGraphics/OpenGL.hpp>
+#include <vector>
+#include <cstring>
+
+#if defined(VL_OPENGL)
+
+namespace vl
+{
+  //-----------------------------------------------------------------------------
+  // EGLFunction
+  //-----------------------------------------------------------------------------
+  //! Identifies an entry of an OpenGL function table: the OpenGL 1.1 functions (see GLFunctionList_1_1.hpp) followed by the OpenGL 1.2 - 4.6 ones (see GLFunctionList.hpp).
+  enum EGLFunction
+  {
+    #define VL_GL_FUNCTION(NAME) GLF_##NAME,
+    #include <vlGraphics/GL/GLFunctionList_1_1.hpp>
+    #undef VL_GL_FUNCTION
+    #define VL_GL_FUNCTION(TYPE, NAME) GLF_##NAME,
+    #include <vlGraphics/GL/GLFunctionList.hpp>
+    #undef VL_GL_FUNCTION
+    GLF_FunctionCount
+  };
+
+  //! Coarse classification of the counted OpenGL calls, see GLCallCounter::functionCategory().
+  typedef enum
+  {
+    GLC_StateChange,    //!< Render states, enables, bindings and everything not falling in the other categories.
+    GLC_DrawCall,       //!< glDraw*(), glMultiDraw*(), glClear() etc.
+    GLC_UniformUpload,  //!< glUniform*() and glProgramUniform*().
+    GLC_DataUpload,     //!< Buffer and texture data transfers.
+    GLC_ObjectLifetime, //!< glGen*(), glCreate*() and glDelete*().
+    GLC_Query,          //!< glGet*(), glIs*() and glCheck*().
+    GLC_CategoryCount
+  } EGLCallCategory;
+
+  //-----------------------------------------------------------------------------
+  // GLCallCounter
+  //-----------------------------------------------------------------------------
+  /**
+   * Counting stand-in for the OpenGL function tables.
+   *
+   * install() replaces every entry of a function table with a thunk that counts the call and then forwards it to the original
+   * function. If the original function is NULL, as it happens when no OpenGL context is available, the call is not forwarded and a
+   * zero-initialized value is returned: this allows headless benchmarks to measure how many OpenGL calls a frame issues.
+   *
+   * The thunks can also append every call, with its arguments, to a command stream, see setCommandStream(). The stream is a sequence
+   * of 64 bits words: for each call a header word `(function << 8) | argument_count` is followed by one word per argument. Integers
+   * and enums are stored sign-extended, floats and doubles bit-wise and pointers by address: the data pointed to is not copied.
+   *
+   * GLCallCounter is installed by RecordingOpenGLContext on its own table, the RenderGraphicsBench benchmarks read the counts through it.
+   *
+   * \note
+   * - initializeOpenGL() resets the global function table, call install() again after it.
+   * - The calls issued through an OpenGLContext's own table, like the draw calls, are counted once install() is called on
+   *   OpenGLContext::mGL. RecordingOpenGLContext does so on its own.
+   * - OpenGL 1.1 functions called directly instead of through a function table, like the texture and framebuffer setup, are not counted.
+   * - There is one thunk per OpenGL function: installing on two tables pointing to different implementations forwards the calls of
+   *   both to the implementation installed last.
+   * - The counters are not thread safe, like any OpenGL call they are meant to be used from the rendering thread.
+   */
+  class VLGRAPHICS_EXPORT GLCallCounter
+  {
+  public:
+    //! Installs the counting thunks in the global OpenGL 1.2 - 4.6 function pointers and in vl::GL_Functions. The entries already redirected are left untouched.
+    static void install();
+
+    //! Restores the original global OpenGL 1.2 - 4.6 function pointers and vl::GL_Functions.
+    static void uninstall();
+
+    //! Installs the counting thunks in the given function table, for example OpenGLContext::mGL. The entries already redirected are left untouched.
+    static void install(OpenGLFunctions& gl);
+
+    //! Restores the original entries of the given function table.
+    static void uninstall(OpenGLFunctions& gl);
+
+    //! Returns true if the counting thunks are installed in the global function pointers.
+    static bool installed() { return mInstalled; }
+
+    //! Number of times the given function has been called since the last resetCounts().
+    static unsigned long long callCount(EGLFunction fn) { return mCallCount[fn]; }
+
+    //! Number of calls of the given category issued since the last resetCounts().
+    static unsigned long long callCount(EGLCallCategory category);
+
+    //! Total number of calls issued since the last resetCounts().
+    static unsigned long long totalCallCount();
+
+    //! Resets all the call counters to zero, usually called at the beginning of each frame.
+    static void resetCounts();
+
+    //! Returns the name of the given OpenGL function.
+    static const char* functionName(EGLFunction fn);
+
+    //! Returns the category the given OpenGL function is counted in.
+    static EGLCallCategory functionCategory(EGLFunction fn);
+
+    //! The stream the calls are appended to, or NULL to only count them. Default is NULL.
+    static void setCommandStream(std::vector<unsigned long long>* stream) { mCommandStream = stream; }
+
+    //! The stream the calls are appended to, or NULL to only count them. Default is NULL.
+    static std::vector<unsigned long long>* commandStream() { return mCommandStream; }
+
+    //! For internal use only.
+    template<typename... Args>
+    static void record(int fn, Args... args)
+    {
+      const unsigned long long words[] = { ((unsigned long long)fn << 8) | sizeof...(Args), encodeArg(args)... };
+      mCommandStream->insert( mCommandStream->end(), words, words + 1 + sizeof...(Args) );
+    }
+
+    //! For internal use only.
+    static unsigned long long mCallCount[GLF_FunctionCount];
+
+    //! For internal use only.
+    static std::vector<unsigned long long>* mCommandStream;
+
+  private:
+    template<typename T> static unsigned long long encodeArg(T* ptr) { return (unsigned long long)(size_t)ptr; }
+    template<typename T> static unsigned long long encodeArg(T val) { return (unsigned long long)val; }
+    static unsigned long long encodeArg(float val) { unsigned int bits; memcpy(&bits, &val, sizeof(bits)); return bits; }
+    static unsigned long long encodeArg(double val) { unsigned long long bits; memcpy(&bits, &val, sizeof(bits)); return bits; }
+
+  private:
+    static bool mInstalled;
+  };
+
+  //-----------------------------------------------------------------------------
+  //! For internal use only.
+  template<int FN, typename T> class GLCallThunk;
+
+  template<int FN, typename R, typename... Args>
+  class GLCallThunk<FN, R (APIENTRY*)(Args...)>
+  {
+  public:
+    static R APIENTRY call(Args... args)
+    {
+      ++GLCallCounter::mCallCount[FN];
+      if ( GLCallCounter::mCommandStream ) {
+        GLCallCounter::record(FN, args...);
+      }
+      if ( ! mFunction ) {
+        return R();
+      }
+      return mFunction(args...);
+    }
+
+    static R (APIENTRY* mFunction)(Args...);
+  };
+
+  template<int FN, typename R, typename... Args>
+  R (APIENTRY* GLCallThunk<FN, R (APIENTRY*)(Args...)>::mFunction)(Args...) = NULL;
+}
+
+#endif
+
+#endif
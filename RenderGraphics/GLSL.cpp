@@ -284,6 +284,8 @@ GLSLProgram::GLSLProgram()
   mHandle = 0;
   mProgramBinaryRetrievableHint = false;
   mProgramSeparable = false;
+  mUniformUploadCount = 0;
+  mUniformSkipCount = 0;
 
   resetBindingLocations();
 }
@@ -302,6 +304,10 @@ void GLSLProgram::resetBindingLocations()
   m_vl_ModelViewProjectionMatrix = -1;
   m_vl_NormalMatrix = -1;
 
+  // user uniform binding, linking also resets the uniform values
+  mUniformLocations.clear();
+  mUniformVersions.clear();
+
   // vertex attrib binding
   m_vl_VertexPosition = -1;
   m_vl_VertexNormal = -1;
@@ -553,6 +559,43 @@ void GLSLProgram::postLink()
   m_vl_ModelViewProjectionMatrix = glGetUniformLocation(handle(), "vl_ModelViewProjectionMatrix");
   m_vl_NormalMatrix              = glGetUniformLocation(handle(), "vl_NormalMatrix");
 
+  // resolve the locations of all the active uniforms once
+
+  mUniformLocations.clear();
+  int uniform_count = 0;
+  int max_name_length = 0;
+  glGetProgramiv(handle(), GL_ACTIVE_UNIFORMS, &uniform_count); VL_CHECK_OGL();
+  glGetProgramiv(handle(), GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length); VL_CHECK_OGL();
+  if ( uniform_count && max_name_length )
+  {
+    std::vector<char> name_buffer( max_name_length + 1 );
+    for( int i = 0; i < uniform_count; ++i )
+    {
+      GLsizei length = 0;
+      GLint size = 0;
+      GLenum type = 0;
+      glGetActiveUniform( handle(), i, max_name_length + 1, &length, &size, &type, &name_buffer[0] ); VL_CHECK_OGL();
+      std::string name( &name_buffer[0], length );
+      // uniform block members have no location
+      int location = glGetUniformLocation( handle(), name.c_str() );
+      if ( location == -1 ) {
+        continue;
+      }
+      setUniformLocation( uniformNameID( name.c_str() ), location );
+      // arrays are reported as "name[0]" but can be addressed also as "name"
+      if ( name.size() > 3 && name.compare( name.size() - 3, 3, "[0]" ) == 0 ) {
+        setUniformLocation( uniformNameID( name.substr( 0, name.size() - 3 ).c_str() ), location );
+      }
+    }
+  }
+
+  // map the uniform blocks to their binding points
+
+  mAppliedUniformBlockBinding.clear();
+  for( std::map<std::string, int>::const_iterator it = mUniformBlockBinding.begin(); it != mUniformBlockBinding.end(); ++it ) {
+    applyUniformBlockBinding( it->first, it->second );
+  }
+
   // track vertex attribute bindings
 
   m_vl_VertexPosition       = glGetAttribLocation( handle(), "vl_VertexPosition" );
@@ -649,7 +692,34 @@ void GLSLProgram::apply(int /*index*/, const Camera*, OpenGLContext* ctx) const
   }
 }
 //-----------------------------------------------------------------------------
-bool GLSLProgram::applyUniformSet(const UniformSet* uniforms) const
+void GLSLProgram::setUniformLocation(int name_id, int location) const
+{
+  if ( name_id >= (int)mUniformLocations.size() ) {
+    mUniformLocations.resize( name_id + 1, UniformLocationUnresolved );
+  }
+  mUniformLocations[name_id] = location;
+}
+//-----------------------------------------------------------------------------
+int GLSLProgram::resolveUniformLocation(const Uniform* uniform) const
+{
+  VL_CHECK( linked() )
+  int location = glGetUniformLocation( handle(), uniform->name().c_str() ); VL_CHECK_OGL();
+  setUniformLocation( uniform->nameID(), location );
+  return location;
+}
+//-----------------------------------------------------------------------------
+void GLSLProgram::applyUniformBlockBinding(const std::string& block_name, int binding) const
+{
+  mAppliedUniformBlockBinding[block_name] = binding;
+  if ( !Has_GL_Version_3_1 && !Has_GL_Version_4_0 )
+    return;
+  GLuint index = glGetUniformBlockIndex( handle(), block_name.c_str() ); VL_CHECK_OGL();
+  if ( index != GL_INVALID_INDEX ) {
+    glUniformBlockBinding( handle(), index, binding ); VL_CHECK_OGL();
+  }
+}
+//-----------------------------------------------------------------------------
+bool GLSLProgram::applyUniformSet(const UniformSet* uniforms, OpenGLContext* gl_context) const
 {
   uniforms = uniforms ? uniforms : getUniformSet();
 
@@ -673,6 +743,20 @@ bool GLSLProgram::applyUniformSet(const UniformSet* uniforms) const
   VL_CHECK(current_glsl_program == (int)handle())
 #endif
 
+  // uniform block: the whole set is sent as a single buffer range
+  if ( uniforms->storage() == USS_UniformBlock )
+  {
+    if ( !uniforms->blockName().empty() )
+    {
+      std::map<std::string, int>::const_iterator it = mAppliedUniformBlockBinding.find( uniforms->blockName() );
+      if ( it == mAppliedUniformBlockBinding.end() || it->second != uniforms->blockBinding() ) {
+        applyUniformBlockBinding( uniforms->blockName(), uniforms->blockBinding() );
+      }
+    }
+    uniforms->bindBlock( gl_context );
+    return true;
+  }
+
   for(size_t i=0, count=uniforms->uniforms().size(); i<count; ++i)
   {
     const Uniform* uniform = uniforms->uniforms()[i].get();
@@ -701,14 +785,41 @@ bool GLSLProgram::applyUniformSet(const UniformSet* uniforms) const
       }
       #endif
     #else
-      int location = glGetUniformLocation(handle(), uniform->name().c_str());
+      int location = uniformLocation(uniform);
       if (location == -1) {
         continue;
       }
     #endif
 
+    // delta binding: skip the uniform if the program already holds this very value.
+    // Arrays are always sent and invalidate the whole range of locations they overwrite.
+
+    const int count = uniform->count();
+    if ( count == 1 )
+    {
+      if ( location < (int)mUniformVersions.size() && mUniformVersions[location] == uniform->version() )
+      {
+        ++mUniformSkipCount;
+        continue;
+      }
+      if ( location < MaxTrackedUniformLocation )
+      {
+        if ( location >= (int)mUniformVersions.size() ) {
+          mUniformVersions.resize( location + 1, 0 );
+        }
+        mUniformVersions[location] = uniform->version();
+      }
+    }
+    else
+    {
+      for( int i = location, end = std::min( location + count, (int)mUniformVersions.size() ); i < end; ++i ) {
+        mUniformVersions[i] = 0;
+      }
+    }
+
+    ++mUniformUploadCount;
+
     // finally transmits the uniform
-    // note: we don't perform delta binding per-uniform variable at the moment!
 
     VL_CHECK_OGL();
     switch(uniform->mType)
@@ -793,6 +904,27 @@ int GLSLProgram::fragDataLocation(const char* name) const
     return -1;
 }
 //-----------------------------------------------------------------------------
+void GLSLProgram::bindUniformBlock(const char* block_name, int binding)
+{
+  mUniformBlockBinding[block_name] = binding;
+  if ( linked() )
+    applyUniformBlockBinding( block_name, binding );
+}
+//-----------------------------------------------------------------------------
+void GLSLProgram::unbindUniformBlock(const char* block_name)
+{
+  mUniformBlockBinding.erase(block_name);
+}
+//-----------------------------------------------------------------------------
+int GLSLProgram::uniformBlockBinding(const char* block_name) const
+{
+  std::map<std::string, int>::const_iterator it = mUniformBlockBinding.find(block_name);
+  if (it != mUniformBlockBinding.end())
+    return it->second;
+  else
+    return -1;
+}
+//-----------------------------------------------------------------------------
 bool GLSLProgram::getProgramBinary(GLenum& binary_format, std::vector<unsigned char>& binary) const
 {
   VL_CHECK_OGL();
@@ -370,6 +370,20 @@ namespace vl
 
     const std::map<std::string, int>& fragDataLocations() const { return mFragDataLocation; }
 
+    // --------------- uniform blocks ---------------
+
+    //! Maps the uniform block \p block_name to the uniform buffer binding point \p binding. The mapping is applied at link time
+    //! and immediately if the program is already linked. See also UniformSet::setUniformBlock().
+    void bindUniformBlock(const char* block_name, int binding);
+
+    //! Removes the mapping of \p block_name set with bindUniformBlock(), effective from the next link.
+    void unbindUniformBlock(const char* block_name);
+
+    //! Returns the binding point of \p block_name set with bindUniformBlock() or -1.
+    int uniformBlockBinding(const char* block_name) const;
+
+    const std::map<std::string, int>& uniformBlockBindings() const { return mUniformBlockBinding; }
+
     // --------------- geometry shader ---------------
 
     // --------------- GLSL 4.x ---------------
@@ -413,9 +427,25 @@ namespace vl
      * Applies a set of uniforms to the currently bound GLSL program.
      * This function expects the GLSLProgram to be already bound, see OpenGLContext::useGLSLProgram().
      *
+     * Non-array uniforms are sent only if the program does not already hold the same Uniform::version() at the same location.
+     * For this reason a uniform managed through a UniformSet must not be also written directly using glUniform*().
+     *
+     * UniformSet using the USS_UniformBlock storage are uploaded and bound as a whole with UniformSet::bindBlock(), if the
+     * set specifies a block name the block is mapped to the set's binding point the first time it is seen after linking.
+     *
      * @param uniforms If NULL uses GLSLProgram::getUniformSet()
+     * @param gl_context The OpenGLContext used to bind the uniform buffers, if NULL the buffers are bound directly.
     */
-    bool applyUniformSet(const UniformSet* uniforms = NULL) const;
+    bool applyUniformSet(const UniformSet* uniforms = NULL, OpenGLContext* gl_context = NULL) const;
+
+    //! Number of uniforms sent to OpenGL by applyUniformSet() since the last resetUniformCounters().
+    unsigned long long uniformUploadCount() const { return mUniformUploadCount; }
+
+    //! Number of uniforms skipped by applyUniformSet() because their value was already up to date since the last resetUniformCounters().
+    unsigned long long uniformSkipCount() const { return mUniformSkipCount; }
+
+    //! Resets uniformUploadCount() and uniformSkipCount().
+    void resetUniformCounters() { mUniformUploadCount = 0; mUniformSkipCount = 0; }
 
     /**
     * Returns the binding index of the given uniform.
@@ -433,6 +463,20 @@ namespace vl
       return location;
     }
 
+    /**
+    * Returns the binding location of the given Uniform or -1 if the uniform is not used by the GLSLProgram.
+    * The locations of the active uniforms are resolved once in linkProgram() and looked up using Uniform::nameID(),
+    * names not reported as active (for example single array elements like "lights[3]") are resolved on first use and cached until the next relink.
+    */
+    int uniformLocation(const Uniform* uniform) const
+    {
+      int id = uniform->nameID();
+      if ( id < (int)mUniformLocations.size() && mUniformLocations[id] != UniformLocationUnresolved ) {
+        return mUniformLocations[id];
+      }
+      return resolveUniformLocation(uniform);
+    }
+
     // --------------- uniform variables: getters ---------------
 
     // general uniform getters: use these to access to all the types supported by your GLSL implementation,
@@ -548,10 +592,22 @@ namespace vl
     void postLink();
     void operator=(const GLSLProgram&) { }
     void resetBindingLocations();
+    int resolveUniformLocation(const Uniform* uniform) const;
+    void setUniformLocation(int name_id, int location) const;
+    void applyUniformBlockBinding(const std::string& block_name, int binding) const;
+
+    //! Marks the entries of mUniformLocations not yet queried
+    enum { UniformLocationUnresolved = -2 };
+
+    //! Uniforms with a location beyond this value are always sent, see applyUniformSet()
+    enum { MaxTrackedUniformLocation = 64 * 1024 };
 
   protected:
     std::vector< ref<GLSLShader> > mShaders;
     std::map<std::string, int> mFragDataLocation;
+    std::map<std::string, int> mUniformBlockBinding;
+    // uniform block bindings applied since the last link, including those requested by UniformSet::blockName()
+    mutable std::map<std::string, int> mAppliedUniformBlockBinding;
     ref<UniformSet> mUniformSet;
     unsigned int mHandle;
     bool mScheduleLink;
@@ -568,6 +624,14 @@ namespace vl
     int m_vl_ModelViewProjectionMatrix;
     int m_vl_NormalMatrix;
 
+    // uniform locations indexed by Uniform::nameID()
+    mutable std::vector<int> mUniformLocations;
+
+    // Uniform::version() last sent to each uniform location, 0 if unknown
+    mutable std::vector<unsigned long long> mUniformVersions;
+    mutable unsigned long long mUniformUploadCount;
+    mutable unsigned long long mUniformSkipCount;
+
     // VL standard vertex attributes
 
     int m_vl_VertexPosition;
@@ -34,11 +34,204 @@
 #include <vlGraphics/DoubleVertexRemover.hpp>
 #include <vlGraphics/MultiDrawElements.hpp>
 #include <vlGraphics/DrawRangeElements.hpp>
+#include <vlGraphics/ThreadPool.hpp>
 #include <cmath>
 #include <algorithm>
 
+#if defined(__AVX__)
+  #define VL_GEOMETRY_AVX
+  #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define VL_GEOMETRY_SSE
+  #include <emmintrin.h>
+#endif
+
 using namespace vl;
 
+namespace
+{
+  // the minimum number of triangles or vertices computeNormals() and computeTangentSpace() hand to a ThreadPool task
+  const int MinParallelRange = 4096;
+
+  // appends the indices of the triangles of dc to tris
+  void collectTriangles(const DrawCall* dc, size_t vert_count, std::vector<u32>& tris)
+  {
+    dc->forEachTriangle( [&](int a, int b, int c) {
+      VL_CHECK( a >= 0 && a < (int)vert_count )
+      VL_CHECK( b >= 0 && b < (int)vert_count )
+      VL_CHECK( c >= 0 && c < (int)vert_count )
+      tris.push_back( a );
+      tris.push_back( b );
+      tris.push_back( c );
+    } );
+  }
+
+  // builds the vertex -> triangle adjacency of tris in compressed sparse row form: the triangles using vertex v are
+  // vert_tris[offsets[v]] ... vert_tris[offsets[v+1]-1] in the same order in which they appear in tris.
+  void computeVertexTriangles(const std::vector<u32>& tris, size_t vert_count, std::vector<u32>& offsets, std::vector<u32>& vert_tris)
+  {
+    offsets.assign( vert_count + 1, 0 );
+    for( size_t i = 0; i < tris.size(); ++i )
+      ++offsets[ tris[i] + 1 ];
+    for( size_t v = 0; v < vert_count; ++v )
+      offsets[v + 1] += offsets[v];
+    std::vector<u32> cursor( offsets.begin(), offsets.end() - 1 );
+    vert_tris.resize( tris.size() );
+    for( size_t i = 0; i < tris.size(); ++i )
+      vert_tris[ cursor[ tris[i] ]++ ] = (u32)( i / 3 );
+  }
+
+#if defined(VL_GEOMETRY_AVX)
+  typedef __m256 simd_float;
+  const size_t SimdWidth = 8;
+  inline simd_float simd_set1(float a) { return _mm256_set1_ps( a ); }
+  inline simd_float simd_load(const float* p) { return _mm256_loadu_ps( p ); }
+  inline void simd_store(float* p, simd_float a) { _mm256_storeu_ps( p, a ); }
+  inline simd_float simd_add(simd_float a, simd_float b) { return _mm256_add_ps( a, b ); }
+  inline simd_float simd_sub(simd_float a, simd_float b) { return _mm256_sub_ps( a, b ); }
+  inline simd_float simd_mul(simd_float a, simd_float b) { return _mm256_mul_ps( a, b ); }
+  inline simd_float simd_div(simd_float a, simd_float b) { return _mm256_div_ps( a, b ); }
+  inline simd_float simd_sqrt(simd_float a) { return _mm256_sqrt_ps( a ); }
+  // 1/a where a > 0, 0 elsewhere
+  inline simd_float simd_safe_rcp(simd_float a) { return _mm256_and_ps( _mm256_cmp_ps( a, _mm256_setzero_ps(), _CMP_GT_OQ ), _mm256_div_ps( simd_set1( 1.0f ), a ) ); }
+#elif defined(VL_GEOMETRY_SSE)
+  typedef __m128 simd_float;
+  const size_t SimdWidth = 4;
+  inline simd_float simd_set1(float a) { return _mm_set1_ps( a ); }
+  inline simd_float simd_load(const float* p) { return _mm_loadu_ps( p ); }
+  inline void simd_store(float* p, simd_float a) { _mm_storeu_ps( p, a ); }
+  inline simd_float simd_add(simd_float a, simd_float b) { return _mm_add_ps( a, b ); }
+  inline simd_float simd_sub(simd_float a, simd_float b) { return _mm_sub_ps( a, b ); }
+  inline simd_float simd_mul(simd_float a, simd_float b) { return _mm_mul_ps( a, b ); }
+  inline simd_float simd_div(simd_float a, simd_float b) { return _mm_div_ps( a, b ); }
+  inline simd_float simd_sqrt(simd_float a) { return _mm_sqrt_ps( a ); }
+  // 1/a where a > 0, 0 elsewhere
+  inline simd_float simd_safe_rcp(simd_float a) { return _mm_and_ps( _mm_cmpgt_ps( a, _mm_setzero_ps() ), _mm_div_ps( simd_set1( 1.0f ), a ) ); }
+#endif
+
+  // computes the normalized face normals of the triangles [begin, end), degenerate triangles get a null normal
+  void faceNormalKernel(const fvec3* pos, const u32* tris, fvec3* normals, size_t begin, size_t end)
+  {
+    size_t i = begin;
+  #if defined(VL_GEOMETRY_AVX) || defined(VL_GEOMETRY_SSE)
+    // the corners are gathered in SoA form, 3 vertices x 3 components
+    float in[9][SimdWidth];
+    float out[3][SimdWidth];
+    for( ; i + SimdWidth <= end; i += SimdWidth )
+    {
+      for( size_t k = 0; k < SimdWidth; ++k )
+      {
+        const u32* tri = tris + ( i + k ) * 3;
+        for( int corner = 0; corner < 3; ++corner )
+        {
+          const fvec3& p = pos[ tri[corner] ];
+          in[corner*3 + 0][k] = p.x();
+          in[corner*3 + 1][k] = p.y();
+          in[corner*3 + 2][k] = p.z();
+        }
+      }
+      simd_float x0 = simd_load( in[0] ), y0 = simd_load( in[1] ), z0 = simd_load( in[2] );
+      simd_float x1 = simd_sub( simd_load( in[3] ), x0 ), y1 = simd_sub( simd_load( in[4] ), y0 ), z1 = simd_sub( simd_load( in[5] ), z0 );
+      simd_float x2 = simd_sub( simd_load( in[6] ), x0 ), y2 = simd_sub( simd_load( in[7] ), y0 ), z2 = simd_sub( simd_load( in[8] ), z0 );
+      // cross(v1, v2)
+      simd_float nx = simd_sub( simd_mul( y1, z2 ), simd_mul( z1, y2 ) );
+      simd_float ny = simd_sub( simd_mul( z1, x2 ), simd_mul( x1, z2 ) );
+      simd_float nz = simd_sub( simd_mul( x1, y2 ), simd_mul( y1, x2 ) );
+      simd_float len = simd_sqrt( simd_add( simd_add( simd_mul( nx, nx ), simd_mul( ny, ny ) ), simd_mul( nz, nz ) ) );
+      simd_float inv_len = simd_safe_rcp( len );
+      simd_store( out[0], simd_mul( nx, inv_len ) );
+      simd_store( out[1], simd_mul( ny, inv_len ) );
+      simd_store( out[2], simd_mul( nz, inv_len ) );
+      for( size_t k = 0; k < SimdWidth; ++k )
+        normals[i + k] = fvec3( out[0][k], out[1][k], out[2][k] );
+    }
+  #endif
+    for( ; i < end; ++i )
+    {
+      const u32* tri = tris + i * 3;
+      const fvec3& v0 = pos[ tri[0] ];
+      normals[i] = cross( pos[ tri[1] ] - v0, pos[ tri[2] ] - v0 ).normalize();
+    }
+  }
+
+  // computes the per face tangent space directions of the triangles [begin, end), see Geometry::computeTangentSpace()
+  void faceTangentKernel(const fvec3* pos, const fvec2* uv, const u32* tris, fvec3* sdirs, fvec3* tdirs, size_t begin, size_t end)
+  {
+    size_t i = begin;
+  #if defined(VL_GEOMETRY_AVX) || defined(VL_GEOMETRY_SSE)
+    // the corners are gathered in SoA form, 3 vertices x (3 position + 2 texture) components
+    float in[15][SimdWidth];
+    float out[6][SimdWidth];
+    for( ; i + SimdWidth <= end; i += SimdWidth )
+    {
+      for( size_t k = 0; k < SimdWidth; ++k )
+      {
+        const u32* tri = tris + ( i + k ) * 3;
+        for( int corner = 0; corner < 3; ++corner )
+        {
+          const fvec3& p = pos[ tri[corner] ];
+          const fvec2& w = uv[ tri[corner] ];
+          in[corner*5 + 0][k] = p.x();
+          in[corner*5 + 1][k] = p.y();
+          in[corner*5 + 2][k] = p.z();
+          in[corner*5 + 3][k] = w.x();
+          in[corner*5 + 4][k] = w.y();
+        }
+      }
+      simd_float x1 = simd_sub( simd_load( in[5] ),  simd_load( in[0] ) );
+      simd_float x2 = simd_sub( simd_load( in[10] ), simd_load( in[0] ) );
+      simd_float y1 = simd_sub( simd_load( in[6] ),  simd_load( in[1] ) );
+      simd_float y2 = simd_sub( simd_load( in[11] ), simd_load( in[1] ) );
+      simd_float z1 = simd_sub( simd_load( in[7] ),  simd_load( in[2] ) );
+      simd_float z2 = simd_sub( simd_load( in[12] ), simd_load( in[2] ) );
+      simd_float s1 = simd_sub( simd_load( in[8] ),  simd_load( in[3] ) );
+      simd_float s2 = simd_sub( simd_load( in[13] ), simd_load( in[3] ) );
+      simd_float t1 = simd_sub( simd_load( in[9] ),  simd_load( in[4] ) );
+      simd_float t2 = simd_sub( simd_load( in[14] ), simd_load( in[4] ) );
+      // not guarded against degenerate texture coordinates, like the scalar code
+      simd_float r = simd_div( simd_set1( 1.0f ), simd_sub( simd_mul( s1, t2 ), simd_mul( s2, t1 ) ) );
+      simd_store( out[0], simd_mul( simd_sub( simd_mul( t2, x1 ), simd_mul( t1, x2 ) ), r ) );
+      simd_store( out[1], simd_mul( simd_sub( simd_mul( t2, y1 ), simd_mul( t1, y2 ) ), r ) );
+      simd_store( out[2], simd_mul( simd_sub( simd_mul( t2, z1 ), simd_mul( t1, z2 ) ), r ) );
+      simd_store( out[3], simd_mul( simd_sub( simd_mul( s1, x2 ), simd_mul( s2, x1 ) ), r ) );
+      simd_store( out[4], simd_mul( simd_sub( simd_mul( s1, y2 ), simd_mul( s2, y1 ) ), r ) );
+      simd_store( out[5], simd_mul( simd_sub( simd_mul( s1, z2 ), simd_mul( s2, z1 ) ), r ) );
+      for( size_t k = 0; k < SimdWidth; ++k )
+      {
+        sdirs[i + k] = fvec3( out[0][k], out[1][k], out[2][k] );
+        tdirs[i + k] = fvec3( out[3][k], out[4][k], out[5][k] );
+      }
+    }
+  #endif
+    for( ; i < end; ++i )
+    {
+      const u32* tri = tris + i * 3;
+      const fvec3& v1 = pos[ tri[0] ];
+      const fvec3& v2 = pos[ tri[1] ];
+      const fvec3& v3 = pos[ tri[2] ];
+      const fvec2& w1 = uv[ tri[0] ];
+      const fvec2& w2 = uv[ tri[1] ];
+      const fvec2& w3 = uv[ tri[2] ];
+
+      float x1 = v2.x() - v1.x();
+      float x2 = v3.x() - v1.x();
+      float y1 = v2.y() - v1.y();
+      float y2 = v3.y() - v1.y();
+      float z1 = v2.z() - v1.z();
+      float z2 = v3.z() - v1.z();
+
+      float s1 = w2.x() - w1.x();
+      float s2 = w3.x() - w1.x();
+      float t1 = w2.y() - w1.y();
+      float t2 = w3.y() - w1.y();
+
+      float r = 1.0F / (s1 * t2 - s2 * t1);
+      sdirs[i] = fvec3((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r);
+      tdirs[i] = fvec3((s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r);
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 // Geometry
 //-----------------------------------------------------------------------------
@@ -71,22 +264,20 @@ void Geometry::computeBounds_Implementation()
   AABB aabb;
   for(size_t i=0; i<drawCalls().size(); ++i)
   {
-    for(IndexIterator iit = drawCalls().at(i)->indexIterator(); iit.hasNext(); iit.next())
-    {
-      aabb += coords->getAsVec3( iit.index() );
-    }
+    drawCalls().at(i)->forEachIndex( [&](int index) {
+      aabb += coords->getAsVec3( index );
+    } );
   }
 
-  real radius = 0, r = 0;
+  real radius = 0;
   vec3 center = aabb.center();
   for(size_t i=0; i<drawCalls().size(); ++i)
   {
-    for(IndexIterator iit = drawCalls().at(i)->indexIterator(); iit.hasNext(); iit.next())
-    {
-      r = (coords->getAsVec3(iit.index()) - center).lengthSquared();
+    drawCalls().at(i)->forEachIndex( [&](int index) {
+      real r = (coords->getAsVec3(index) - center).lengthSquared();
       if (r > radius)
         radius = r;
-    }
+    } );
   }
 
   setBoundingBox( aabb );
@@ -266,7 +457,7 @@ bool Geometry::flipNormals()
   return false;
 }
 //-----------------------------------------------------------------------------
-void Geometry::computeNormals(bool verbose)
+void Geometry::computeNormals(bool verbose, ThreadPool* thread_pool)
 {
   // Retrieve vertex position array
   ArrayAbstract* posarr = vertexArray();
@@ -282,6 +473,37 @@ void Geometry::computeNormals(bool verbose)
   // Install the normal array
   setNormalArray( norm3f.get() );
 
+  // fast path: SIMD face normals gathered per vertex through the vertex -> triangle adjacency, so that
+  // the vertices can be processed in parallel without write contention.
+  ArrayFloat3* pos3f = posarr->as<ArrayFloat3>();
+  if ( pos3f && !verbose )
+  {
+    std::vector<u32> tris;
+    for(int prim=0; prim<(int)drawCalls().size(); prim++)
+      collectTriangles( mDrawCalls[prim], pos3f->size(), tris );
+
+    const size_t tri_count = tris.size() / 3;
+    std::vector<fvec3> face_normals( tri_count );
+    ThreadPool::parallelFor( thread_pool, (int)tri_count, ThreadPool::rangeCount( thread_pool, (int)tri_count, MinParallelRange ), [&](int, int begin, int end) {
+      faceNormalKernel( pos3f->begin(), tris.data(), face_normals.data(), begin, end );
+    } );
+
+    std::vector<u32> offsets, vert_tris;
+    computeVertexTriangles( tris, norm3f->size(), offsets, vert_tris );
+    fvec3* normals = norm3f->begin();
+    const int vert_count = (int)norm3f->size();
+    ThreadPool::parallelFor( thread_pool, vert_count, ThreadPool::rangeCount( thread_pool, vert_count, MinParallelRange ), [&](int, int begin, int end) {
+      for( int v = begin; v < end; ++v )
+      {
+        fvec3 n;
+        for( u32 k = offsets[v]; k < offsets[v + 1]; ++k )
+          n += face_normals[ vert_tris[k] ];
+        normals[v] = n.normalize();
+      }
+    } );
+    return;
+  }
+
   // zero the normals
   for(u32 i=0; i<norm3f->size(); ++i)
     (*norm3f)[i] = 0;
@@ -290,17 +512,12 @@ void Geometry::computeNormals(bool verbose)
   for(int prim=0; prim<(int)drawCalls().size(); prim++)
   {
     // iterate all triangles, if present
-    for(TriangleIterator trit = mDrawCalls[prim]->triangleIterator(); trit.hasNext(); trit.next())
-    {
-      u32 a = trit.a();
-      u32 b = trit.b();
-      u32 c = trit.c();
-
+    mDrawCalls[prim]->forEachTriangle( [&](u32 a, u32 b, u32 c) {
       if (verbose)
       if (a == b || b == c || c == a)
       {
         Log::warning( Say("Geometry::computeNormals(): skipping degenerate triangle %n %n %n\n") << a << b << c );
-        continue;
+        return;
       }
 
       VL_CHECK( a < posarr->size() )
@@ -317,7 +534,7 @@ void Geometry::computeNormals(bool verbose)
       if (v0 == v1 || v1 == v2 || v2 == v0)
       {
         Log::warning("Geometry::computeNormals(): skipping degenerate triangle (same vertex coodinate).\n");
-        continue;
+        return;
       }
 
       v1 -= v0;
@@ -329,13 +546,13 @@ void Geometry::computeNormals(bool verbose)
       if ( fabs(1.0f - n.length()) > 0.1f )
       {
         Log::warning("Geometry::computeNormals(): skipping degenerate triangle (normalization failed).\n");
-        continue;
+        return;
       }
 
       (*norm3f)[a] += (fvec3)n;
       (*norm3f)[b] += (fvec3)n;
       (*norm3f)[c] += (fvec3)n;
-    }
+    } );
   }
 
   // normalize the normals
@@ -377,6 +594,11 @@ void Geometry::updateDirtyBufferObject(EBufferObjectUpdateMode mode)
 }
 //-----------------------------------------------------------------------------
 void Geometry::render_Implementation(const Actor*, const Shader*, const Camera*, OpenGLContext* gl_ctx) const
+{
+  renderGeometry( gl_ctx );
+}
+//-----------------------------------------------------------------------------
+void Geometry::renderGeometry(OpenGLContext* gl_ctx) const
 {
   VL_CHECK_OGL()
 
@@ -389,7 +611,7 @@ void Geometry::render_Implementation(const Actor*, const Shader*, const Camera*,
 
   for( int i = 0; i < (int)drawCalls().size(); i++ ) {
     if ( drawCalls().at(i)->isEnabled() ) {
-      drawCalls().at(i)->render( vbo_on );
+      drawCalls().at(i)->render( vbo_on, gl_ctx );
     }
   }
 
@@ -456,8 +678,7 @@ DrawCall* Geometry::mergeTriangleStrips()
   for(u32 i=0; i<de_vector.size(); ++i)
   {
     u32 index_count = 0;
-    for(IndexIterator it=de_vector[i]->indexIterator(); it.hasNext(); it.next(), ++index_count)
-      indices.push_back(it.index());
+    de_vector[i]->forEachIndex( [&](int index) { indices.push_back(index); ++index_count; } );
 
     if (index_count == 0)
       continue;
@@ -532,11 +753,10 @@ void Geometry::mergeDrawCallsWithPrimitiveRestart(EPrimitiveType primitive_type)
   // merge draw calls using primitive restart!
   for( u32 i=0; i<mergendo_calls.size(); ++i )
   {
-    for( IndexIterator it = mergendo_calls[i]->indexIterator(); it.hasNext(); it.next(), ++index )
-    {
-      *index = it.index();
-      // VL_CHECK(*index < posarr->size());
-    }
+    mergendo_calls[i]->forEachIndex( [&](int idx) {
+      *index++ = idx;
+      // VL_CHECK(idx < posarr->size());
+    } );
     if ( i != mergendo_calls.size() -1 )
     {
       *index = DrawElementsUInt::primitive_restart_index;
@@ -588,11 +808,10 @@ void Geometry::mergeDrawCallsWithMultiDrawElements(EPrimitiveType primitive_type
   // merge draw calls using primitive restart!
   for( u32 i=0; i<mergendo_calls.size(); ++i )
   {
-    for( IndexIterator it = mergendo_calls[i]->indexIterator(); it.hasNext(); it.next(), ++index )
-    {
-      *index = it.index();
-      // VL_CHECK(*index < posarr->size());
-    }
+    mergendo_calls[i]->forEachIndex( [&](int idx) {
+      *index++ = idx;
+      // VL_CHECK(idx < posarr->size());
+    } );
   }
   VL_CHECK( index == de_multi->indexBuffer()->end() )
 
@@ -655,18 +874,18 @@ void Geometry::mergeDrawCallsWithTriangles(EPrimitiveType primitive_type)
   u32 idx = 0;
   for(u32 i=0; i<mergendo_calls.size(); ++i)
   {
-    for(TriangleIterator it = mergendo_calls[i]->triangleIterator(); it.hasNext(); it.next(), idx+=3)
-    {
+    mergendo_calls[i]->forEachTriangle( [&](int a, int b, int c) {
       VL_CHECK( idx+2 < index_buffer.size() );
 
-      index_buffer[idx+0] = it.a();
-      index_buffer[idx+1] = it.b();
-      index_buffer[idx+2] = it.c();
+      index_buffer[idx+0] = a;
+      index_buffer[idx+1] = b;
+      index_buffer[idx+2] = c;
+      idx += 3;
 
       // some sanity checks since we are here...
-      // VL_CHECK( it.a() < (int)posarr->size() && it.b() < (int)posarr->size() && it.c() < (int)posarr->size() );
-      VL_CHECK( it.a() >= 0 && it.b() >= 0 && it.c() >= 0 );
-    }
+      // VL_CHECK( a < (int)posarr->size() && b < (int)posarr->size() && c < (int)posarr->size() );
+      VL_CHECK( a >= 0 && b >= 0 && c >= 0 );
+    } );
   }
   VL_CHECK( idx == index_buffer.size() );
   drawCalls().push_back(de.get());
@@ -716,39 +935,39 @@ void Geometry::fixTriangleWinding()
   u32 idx = 0;
   for(u32 i=0; i<mergendo_calls.size(); ++i)
   {
-    for(TriangleIterator it = mergendo_calls[i]->triangleIterator(); it.hasNext(); it.next(), idx+=3)
-    {
+    mergendo_calls[i]->forEachTriangle( [&](int a, int b, int c) {
       VL_CHECK( idx+2 < index_buffer.size() );
 
-      vec3 p0 = posarr->getAsVec3(it.a());
-      vec3 p1 = posarr->getAsVec3(it.b());
-      vec3 p2 = posarr->getAsVec3(it.c());
+      vec3 p0 = posarr->getAsVec3(a);
+      vec3 p1 = posarr->getAsVec3(b);
+      vec3 p2 = posarr->getAsVec3(c);
       p1 = (p1 - p0).normalize();
       p2 = (p2 - p0).normalize();
       vec3 n1 = vl::cross(p1, p2);
 
-      vec3 v0 = normarr->getAsVec3(it.a());
-      vec3 v1 = normarr->getAsVec3(it.b());
-      vec3 v2 = normarr->getAsVec3(it.c());
+      vec3 v0 = normarr->getAsVec3(a);
+      vec3 v1 = normarr->getAsVec3(b);
+      vec3 v2 = normarr->getAsVec3(c);
       vec3 n2 = (v0+v1+v2).normalize();
 
       if (dot(n1, n2) > 0)
       {
-        index_buffer[idx+0] = it.a();
-        index_buffer[idx+1] = it.b();
-        index_buffer[idx+2] = it.c();
+        index_buffer[idx+0] = a;
+        index_buffer[idx+1] = b;
+        index_buffer[idx+2] = c;
       }
       else
       {
-        index_buffer[idx+0] = it.a();
-        index_buffer[idx+1] = it.c();
-        index_buffer[idx+2] = it.b();
+        index_buffer[idx+0] = a;
+        index_buffer[idx+1] = c;
+        index_buffer[idx+2] = b;
       }
 
       // some sanity checks since we are here...
-      VL_CHECK( it.a() < (int)posarr->size() && it.b() < (int)posarr->size() && it.c() < (int)posarr->size() );
-      VL_CHECK( it.a() >= 0 && it.b() >= 0 && it.c() >= 0 );
-    }
+      VL_CHECK( a < (int)posarr->size() && b < (int)posarr->size() && c < (int)posarr->size() );
+      VL_CHECK( a >= 0 && b >= 0 && c >= 0 );
+      idx += 3;
+    } );
   }
   VL_CHECK( idx == index_buffer.size() );
   drawCalls().push_back(de.get());
@@ -774,8 +993,7 @@ void Geometry::convertDrawCallToDrawArrays()
   for(int i=drawCalls().size(); i--; )
   {
     int start = (int)map_new_to_old.size();
-    for(IndexIterator it=drawCalls().at(i)->indexIterator(); it.hasNext(); it.next())
-      map_new_to_old.push_back(it.index());
+    drawCalls().at(i)->forEachIndex( [&](int index) { map_new_to_old.push_back(index); } );
     int count = (int)map_new_to_old.size() - start;
 
     // substitute with DrawArrays
@@ -808,12 +1026,12 @@ void Geometry::triangulateDrawCalls()
     ref<DrawElementsUInt> triangles = new DrawElementsUInt(PT_TRIANGLES, dc->instances());
     triangles->indexBuffer()->resize( tri_count*3 );
     unsigned int* ptr = triangles->indexBuffer()->begin();
-    for( TriangleIterator it = dc->triangleIterator(); it.hasNext(); ++it, ptr+=3 )
-    {
-      ptr[0] = it.a();
-      ptr[1] = it.b();
-      ptr[2] = it.c();
-    }
+    dc->forEachTriangle( [&](int a, int b, int c) {
+      ptr[0] = a;
+      ptr[1] = b;
+      ptr[2] = c;
+      ptr += 3;
+    } );
     VL_CHECK( ptr == triangles->indexBuffer()->end() )
     // substitute the draw call
     drawCalls()[idraw] = triangles;
@@ -1185,8 +1403,7 @@ void Geometry::colorizePrimitives()
     c.b() = rand()%100 / 99.0f;
     c.a() = 1.0f;
 
-    for(IndexIterator it=drawCalls().at(i)->indexIterator(); it.hasNext(); it.next())
-      col->at( it.index() ) = c;
+    drawCalls().at(i)->forEachIndex( [&](int index) { col->at( index ) = c; } );
   }
 }
 //-----------------------------------------------------------------------------
@@ -1197,68 +1414,45 @@ void Geometry::computeTangentSpace(
   const fvec2 *texcoord,
   const DrawCall* prim,
   fvec3 *tangent,
-  fvec3 *bitangent )
+  fvec3 *bitangent,
+  ThreadPool* thread_pool )
 {
-  std::vector<fvec3> tan1;
-  std::vector<fvec3> tan2;
-  tan1.resize(vert_count);
-  tan2.resize(vert_count);
-
-  for ( TriangleIterator trit = prim->triangleIterator(); trit.hasNext(); trit.next() )
-  {
-    int tri[] = { trit.a(), trit.b(), trit.c() };
-
-    VL_CHECK(tri[0] < (int)vert_count );
-    VL_CHECK(tri[1] < (int)vert_count );
-    VL_CHECK(tri[2] < (int)vert_count );
-
-    const fvec3& v1 = vertex[tri[0]];
-    const fvec3& v2 = vertex[tri[1]];
-    const fvec3& v3 = vertex[tri[2]];
-
-    const fvec2& w1 = texcoord[tri[0]];
-    const fvec2& w2 = texcoord[tri[1]];
-    const fvec2& w3 = texcoord[tri[2]];
-
-    float x1 = v2.x() - v1.x();
-    float x2 = v3.x() - v1.x();
-    float y1 = v2.y() - v1.y();
-    float y2 = v3.y() - v1.y();
-    float z1 = v2.z() - v1.z();
-    float z2 = v3.z() - v1.z();
-
-    float s1 = w2.x() - w1.x();
-    float s2 = w3.x() - w1.x();
-    float t1 = w2.y() - w1.y();
-    float t2 = w3.y() - w1.y();
-
-    float r = 1.0F / (s1 * t2 - s2 * t1);
-    fvec3 sdir((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r);
-    fvec3 tdir((s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r);
-
-    tan1[tri[0]] += sdir;
-    tan1[tri[1]] += sdir;
-    tan1[tri[2]] += sdir;
-
-    tan2[tri[0]] += tdir;
-    tan2[tri[1]] += tdir;
-    tan2[tri[2]] += tdir;
-  }
+  std::vector<u32> tris;
+  collectTriangles( prim, vert_count, tris );
+
+  // per face tangent directions
+  const size_t tri_count = tris.size() / 3;
+  std::vector<fvec3> sdirs( tri_count );
+  std::vector<fvec3> tdirs( tri_count );
+  ThreadPool::parallelFor( thread_pool, (int)tri_count, ThreadPool::rangeCount( thread_pool, (int)tri_count, MinParallelRange ), [&](int, int begin, int end) {
+    faceTangentKernel( vertex, texcoord, tris.data(), sdirs.data(), tdirs.data(), begin, end );
+  } );
+
+  // gathers the directions of the faces sharing each vertex through the vertex -> triangle adjacency
+  std::vector<u32> offsets, vert_tris;
+  computeVertexTriangles( tris, vert_count, offsets, vert_tris );
+  ThreadPool::parallelFor( thread_pool, (int)vert_count, ThreadPool::rangeCount( thread_pool, (int)vert_count, MinParallelRange ), [&](int, int begin, int end) {
+    for( int a = begin; a < end; ++a )
+    {
+      fvec3 t, t2;
+      for( u32 k = offsets[a]; k < offsets[a + 1]; ++k )
+      {
+        t  += sdirs[ vert_tris[k] ];
+        t2 += tdirs[ vert_tris[k] ];
+      }
 
-  for ( u32 a = 0; a < vert_count; a++)
-  {
-    const fvec3& n = normal[a];
-    const fvec3& t = tan1[a];
+      const fvec3& n = normal[a];
 
-    // Gram-Schmidt orthogonalize
-    tangent[a] = (t - n * dot(n, t)).normalize();
+      // Gram-Schmidt orthogonalize
+      tangent[a] = (t - n * dot(n, t)).normalize();
 
-    if ( bitangent )
-    {
-      // Calculate handedness
-      float w = (dot(cross(n, t), tan2[a]) < 0.0F) ? -1.0F : 1.0F;
-      bitangent[a] = cross( n, tangent[a] ) * w;
+      if ( bitangent )
+      {
+        // Calculate handedness
+        float w = (dot(cross(n, t), t2) < 0.0F) ? -1.0F : 1.0F;
+        bitangent[a] = cross( n, tangent[a] ) * w;
+      }
     }
-  }
+  } );
 }
 //-----------------------------------------------------------------------------
@@ -48,6 +48,7 @@
 namespace vl
 {
   class OpenGLContext;
+  class ThreadPool;
 
   //------------------------------------------------------------------------------
   // Geometry
@@ -150,11 +151,15 @@ namespace vl
      * unchanged the normals of line and point primitives when possible, i.e. when
      * they don't share vertices with the polygonal primitives.
      *
+     * If the vertex positions are stored in an ArrayFloat3 and \p verbose is false the face normals are computed 
+     * with SIMD instructions and gathered per vertex through a vertex to triangle adjacency, splitting the work 
+     * across \p thread_pool (if not NULL) for large meshes.
+     *
      * \note
      * This function modifies the local buffers. After calling this you might want
      * to update the buffers allocated on the GPU.
     */
-    void computeNormals(bool verbose=false);
+    void computeNormals(bool verbose=false, ThreadPool* thread_pool=NULL);
 
     /** Inverts the orientation of the normals.
      *  Returns \p true if the normals could be flipped. The function fails if the normals
@@ -227,6 +232,7 @@ namespace vl
     //! @param primitives The triangles, quads etc. defining the geometry of the object.
     //! @param tangent [out] Returns the tangent vector of the vertices. This parameter is mandatory.
     //! @param bitangent [out] Returns the bitangent vector of the vertics. This parameter can be NULL.
+    //! @param thread_pool If not NULL the computation of large meshes is split across its threads.
     // Based on:
     // Lengyel, Eric. “Computing Tangent Space Basis Vectors for an Arbitrary Mesh”. Terathon Software 3D Graphics Library, 2001.
     // http://www.terathon.com/code/tangent.html
@@ -237,7 +243,8 @@ namespace vl
       const vl::fvec2 *texcoord,
       const vl::DrawCall* primitives,
       vl::fvec3 *tangent,
-      vl::fvec3 *bitangent );
+      vl::fvec3 *bitangent,
+      ThreadPool* thread_pool=NULL );
 
     // ------------------------------------------------------------------------
     // IVertexAttribSet Interface Implementation
@@ -285,6 +292,10 @@ namespace vl
 
     ArrayAbstract* vertexAttribArray(int attrib_location);
 
+    //! Binds the vertex arrays and renders the enabled draw calls like render_Implementation() but without virtual dispatch.
+    //! Used by the Renderer command list replay, buffer objects and display lists are not updated, see Renderable::render().
+    void renderGeometry(OpenGLContext* gl_context) const;
+
   protected:
     virtual void computeBounds_Implementation();
 
@@ -134,80 +134,175 @@ namespace vl
       initialize( NULL, NULL, NULL, 0, false, 0 );
     }
 
+    /** If \p p_vert_counts is not NULL the indices are made of runs of the given sizes packed one after the other, each using
+      * its own base vertex from \p p_base_vertices, otherwise of a single run spanning the whole array and using \p base_vert. */
     void initialize( const TArray* idx_array, const std::vector<GLint>* p_base_vertices, const std::vector<GLsizei>* p_vert_counts,
                      int base_vert, bool prim_restart_on, unsigned int prim_restart_idx )
     {
+      VL_CHECK( !p_vert_counts || !p_base_vertices || p_base_vertices->empty() || p_base_vertices->size() == p_vert_counts->size() )
       mArray = idx_array;
       mBaseVert = base_vert;
       mpBaseVertices = p_base_vertices;
       mpVertCounts   = p_vert_counts;
-      mBaseCount     = 0;
-      mBaseIdx       = 0;
-
       mPrimRestartEnabled = prim_restart_on;
       mPrimRestartIdx = prim_restart_idx;
-      mCurPos = 0;
-      if (mArray && mArray->size())
+      mRun       = -1;
+      mRunStart  = 0;
+      mRunBase   = 0;
+      mCurPos    = 0;
+      mEnd       = 0;
+      mIndex     = -1;
+      if (mArray)
+        startNextRun();
+    }
+
+    virtual bool hasNext() const
+    {
+      return mCurPos != mEnd;
+    }
+
+    virtual bool next()
+    {
+      if ( mCurPos == mEnd )
+        return false;
+      ++mCurPos;
+      skipPrimRestart();
+      if ( mCurPos == mEnd )
+        startNextRun();
+      return mCurPos != mEnd;
+    }
+
+  protected:
+    //! Moves to the first index of the next run that is not a primitive restart index, leaves mCurPos == mEnd if there are none.
+    void startNextRun()
+    {
+      const int run_count = mpVertCounts ? (int)mpVertCounts->size() : 1;
+      for( ++mRun; mRun < run_count; ++mRun )
       {
-        mIndex = mArray->at(0) + mBaseVert;
+        if (mpVertCounts)
+        {
+          mCurPos   = mRunStart;
+          mEnd      = mRunStart + (*mpVertCounts)[mRun];
+          mRunStart = mEnd;
+          mRunBase  = mpBaseVertices && !mpBaseVertices->empty() ? (*mpBaseVertices)[mRun] : 0;
+        }
+        else
+        {
+          mCurPos  = 0;
+          mEnd     = (int)mArray->size();
+          mRunBase = mBaseVert;
+        }
+        skipPrimRestart();
+        if ( mCurPos != mEnd )
+          return;
       }
+      mCurPos = mEnd;
+      mIndex  = -1;
+    }
 
-      if (p_vert_counts)
-      {
-        VL_CHECK(p_base_vertices)
-        VL_CHECK( p_base_vertices->size() == p_vert_counts->size() )
+    //! Skips the primitive restart indices and updates mIndex.
+    void skipPrimRestart()
+    {
+      while( mCurPos != mEnd && mPrimRestartEnabled && mArray->at(mCurPos) == mPrimRestartIdx )
+        ++mCurPos;
+      mIndex = mCurPos != mEnd ? (int)mArray->at(mCurPos) + mRunBase : -1;
+    }
+
+  protected:
+    const TArray* mArray;
+    int mBaseVert;
+    int mCurPos;
+    int mEnd;
+    bool mPrimRestartEnabled;
+    unsigned int mPrimRestartIdx;
+    const std::vector<GLint>* mpBaseVertices;
+    const std::vector<GLsizei>* mpVertCounts;
+    int mRun;
+    int mRunStart;
+    int mRunBase;
+  };
+//-----------------------------------------------------------------------------
+// IndexIteratorIndirect
+//-----------------------------------------------------------------------------
+  /** Index iterator operating over MultiDrawElementsIndirect, where every draw reads \p count indices starting at its own first index. */
+  template<class TArray>
+  class IndexIteratorIndirect: public IndexIteratorAbstract
+  {
+    VL_INSTRUMENT_CLASS(vl::IndexIteratorIndirect<TArray>, IndexIteratorAbstract)
 
-        mBaseCount = (*p_vert_counts)[mBaseIdx];
+  public:
+    IndexIteratorIndirect()
+    {
+      VL_DEBUG_SET_OBJECT_NAME()
+      initialize( NULL, NULL, NULL, NULL );
+    }
 
-        mIndex = (*mpBaseVertices)[mBaseIdx];
+    void initialize( const TArray* idx_array, const std::vector<GLint>* p_first_indices, const std::vector<GLsizei>* p_counts, const std::vector<GLint>* p_base_vertices )
+    {
+      mArray = idx_array;
+      mpFirstIndices = p_first_indices;
+      mpCounts       = p_counts;
+      mpBaseVertices = p_base_vertices;
+      mDraw   = 0;
+      mCurPos = 0;
+      mEnd    = 0;
+      mIndex  = -1;
+      if (mArray && mpCounts)
+      {
+        VL_CHECK( mpFirstIndices && mpFirstIndices->size() == mpCounts->size() )
+        VL_CHECK( mpBaseVertices && mpBaseVertices->size() == mpCounts->size() )
+        mDraw = -1;
+        startNextDraw();
       }
     }
 
     virtual bool hasNext() const
     {
-      return mCurPos != (int)mArray->size();
+      return mCurPos != mEnd;
     }
 
     virtual bool next()
     {
       ++mCurPos;
-      while( mCurPos < (int)mArray->size() && mArray->at(mCurPos) == mPrimRestartIdx && mPrimRestartEnabled  )
-        ++mCurPos;
-      if ( mCurPos < (int)mArray->size() )
+      if ( mCurPos == mEnd )
+        startNextDraw();
+      if ( mCurPos != mEnd )
       {
-        mIndex = mArray->at(mCurPos) + mBaseVert;
-        if (mpVertCounts)
-        {
-          VL_CHECK(mpBaseVertices)
-          mBaseCount--;
-          if (!mBaseCount)
-          {
-            mBaseIdx++;
-            mBaseCount = (*mpVertCounts)[mBaseIdx];
-          }
-          mIndex += (*mpBaseVertices)[mBaseIdx];
-        }
-
+        mIndex = mArray->at(mCurPos) + (*mpBaseVertices)[mDraw];
         return true;
       }
       else
       {
         mIndex = -1;
-        mCurPos = (int)mArray->size();
         return false;
       }
     }
 
+  protected:
+    //! Moves to the first index of the next non empty draw, leaves mCurPos == mEnd if there are none.
+    void startNextDraw()
+    {
+      for( ++mDraw; mDraw < (int)mpCounts->size(); ++mDraw )
+      {
+        if ( (*mpCounts)[mDraw] )
+        {
+          mCurPos = (*mpFirstIndices)[mDraw];
+          mEnd    = mCurPos + (*mpCounts)[mDraw];
+          mIndex  = mArray->at(mCurPos) + (*mpBaseVertices)[mDraw];
+          return;
+        }
+      }
+      mCurPos = mEnd;
+    }
+
   protected:
     const TArray* mArray;
-    int mBaseVert;
-    int mCurPos;
-    bool mPrimRestartEnabled;
-    unsigned int mPrimRestartIdx;
+    const std::vector<GLint>* mpFirstIndices;
+    const std::vector<GLsizei>* mpCounts;
     const std::vector<GLint>* mpBaseVertices;
-    const std::vector<GLsizei>* mpVertCounts;
-    int mBaseCount;
-    int mBaseIdx;
+    int mDraw;
+    int mCurPos;
+    int mEnd;
   };
 //-----------------------------------------------------------------------------
 }
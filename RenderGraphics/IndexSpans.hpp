@@ -0,0 +1,324 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef IndexSpans_INCLUDE_ONCE
+#define IndexSpans_INCLUDE_ONCE
+
+#include <vlCore/vlnamespace.hpp>
+#include <vlGraphics/OpenGL.hpp>
+#include <vector>
+
+namespace vl
+{
+//-----------------------------------------------------------------------------
+// IndexSpans
+//-----------------------------------------------------------------------------
+  /** Raw description of the indices of a DrawCall used by DrawCall::forEachTriangle() and DrawCall::forEachIndex().
+   * A DrawCall fills it once in DrawCall::indexSpans() so that the traversal can run a tight, inlined loop
+   * over the raw index memory instead of going through a virtual TriangleIterator or IndexIterator per element.
+   * For internal use only. */
+  struct IndexSpans
+  {
+    IndexSpans()
+    {
+      mPrimType         = PT_UNKNOWN;
+      mIndexType        = 0;
+      mIndices          = NULL;
+      mFirst            = 0;
+      mCount            = 0;
+      mBaseVertex       = 0;
+      mpCounts          = NULL;
+      mpFirstIndices    = NULL;
+      mpBaseVertices    = NULL;
+      mPrimRestartIndex = 0;
+      mPrimRestartOn    = false;
+    }
+
+    //! The primitive type of the draw call.
+    EPrimitiveType mPrimType;
+    //! GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_UNSIGNED_INT or 0 if the vertices are not indexed (DrawArrays).
+    GLenum mIndexType;
+    //! The local index buffer, ignored if mIndexType is 0.
+    const void* mIndices;
+    //! First index/vertex of the single run, used only when mpCounts is NULL.
+    int mFirst;
+    //! Number of indices/vertices of the single run, used only when mpCounts is NULL.
+    int mCount;
+    //! Base vertex of the single run, used only when mpCounts is NULL.
+    int mBaseVertex;
+    //! Index count of each run. If not NULL the draw call is made of multiple runs.
+    const std::vector<GLsizei>* mpCounts;
+    //! First index of each run, if NULL or empty the runs are packed one after the other.
+    const std::vector<GLint>* mpFirstIndices;
+    //! Base vertex of each run, if NULL or empty the base vertex is 0.
+    const std::vector<GLint>* mpBaseVertices;
+    //! The primitive restart index, see mPrimRestartOn.
+    unsigned int mPrimRestartIndex;
+    //! Whether primitive restart is enabled, never true for non indexed draw calls.
+    bool mPrimRestartOn;
+  };
+//-----------------------------------------------------------------------------
+// Index readers
+//-----------------------------------------------------------------------------
+  /** Reads the indices of an IndexSpans from a raw GLubyte, GLushort or GLuint array. For internal use only. */
+  template<class TIndex>
+  class IndexSpanReader
+  {
+  public:
+    IndexSpanReader(const void* indices): mIndices((const TIndex*)indices) {}
+
+    unsigned int at(int i) const { return mIndices[i]; }
+
+  private:
+    const TIndex* mIndices;
+  };
+
+  /** Returns the position itself as index, used for non indexed draw calls. For internal use only. */
+  class IndexSpanDirectReader
+  {
+  public:
+    unsigned int at(int i) const { return (unsigned int)i; }
+  };
+//-----------------------------------------------------------------------------
+// Kernels
+//-----------------------------------------------------------------------------
+  /** Tessellates the run [start, end) in triangles with the same rules as TriangleIteratorIndexed and TriangleIteratorDirect
+   * calling \p func(a, b, c) for each of them. The indices of a triangle are never read past \p end. For internal use only. */
+  template<class TReader, class F>
+  void forEachTriangleInRun(const TReader& idx, EPrimitiveType prim_type, int start, int end, int base_vert, bool prim_restart_on, unsigned int prim_restart_idx, F& func)
+  {
+    auto vert       = [&](int i) { return (int)idx.at(i) + base_vert; };
+    auto is_restart = [&](int i) { return prim_restart_on && idx.at(i) == prim_restart_idx; };
+
+    if (end - start < 3)
+      return;
+
+    switch(prim_type)
+    {
+
+    case PT_TRIANGLES:
+    case PT_TRIANGLES_ADJACENCY:
+    {
+      // the adjacency vertices are skipped
+      const int vstep = prim_type == PT_TRIANGLES ? 1 : 2;
+      const int step  = vstep * 3;
+      for(int i = start; i + 2*vstep < end; i += step)
+      {
+        if ( i != start && is_restart(i) )
+        {
+          i += 1;
+          if ( i + 2*vstep >= end )
+            break;
+        }
+        func( vert(i), vert(i + vstep), vert(i + 2*vstep) );
+      }
+      break;
+    }
+
+    case PT_QUAD_STRIP:
+    case PT_TRIANGLE_STRIP:
+    {
+      func( vert(start), vert(start+1), vert(start+2) );
+      bool even = true;
+      for(int i = start + 1; i + 2 < end; ++i)
+      {
+        if ( is_restart(i + 2) )
+        {
+          i += 3;
+          if ( i + 2 >= end )
+            break;
+          even = true;
+          func( vert(i), vert(i+1), vert(i+2) );
+        }
+        else
+        {
+          even = !even;
+          if (even)
+            func( vert(i), vert(i+1), vert(i+2) );
+          else
+            func( vert(i), vert(i+2), vert(i+1) );
+        }
+      }
+      break;
+    }
+
+    case PT_TRIANGLE_FAN:
+    case PT_POLYGON:
+    {
+      int a = vert(start);
+      func( a, vert(start+1), vert(start+2) );
+      for(int i = start + 2; i + 1 < end; ++i)
+      {
+        if ( is_restart(i + 1) )
+        {
+          int index0 = i + 2;
+          i = index0 + 1;
+          if ( i + 1 >= end )
+            break;
+          a = vert(index0);
+        }
+        func( a, vert(i), vert(i+1) );
+      }
+      break;
+    }
+
+    case PT_QUADS:
+    {
+      func( vert(start), vert(start+1), vert(start+2) );
+      bool even = true;
+      for(int i = start + 2; i < end; i += 2)
+      {
+        if ( is_restart(i) )
+        {
+          i += 1;
+          even = true;
+        }
+        else
+          even = !even;
+
+        if (even)
+        {
+          if ( i + 2 >= end )
+            break;
+          func( vert(i), vert(i+1), vert(i+2) );
+        }
+        else
+        {
+          if ( i + 1 >= end )
+            break;
+          func( vert(i), vert(i+1), vert(i-2) );
+        }
+      }
+      break;
+    }
+
+    default:
+      break;
+    }
+  }
+
+  /** Calls \p func(index) for every index of the run [start, end) skipping the primitive restart indices. For internal use only. */
+  template<class TReader, class F>
+  void forEachIndexInRun(const TReader& idx, int start, int end, int base_vert, bool prim_restart_on, unsigned int prim_restart_idx, F& func)
+  {
+    if (prim_restart_on)
+    {
+      for(int i = start; i < end; ++i)
+      {
+        unsigned int index = idx.at(i);
+        if (index != prim_restart_idx)
+          func( (int)index + base_vert );
+      }
+    }
+    else
+    {
+      for(int i = start; i < end; ++i)
+        func( (int)idx.at(i) + base_vert );
+    }
+  }
+//-----------------------------------------------------------------------------
+// Run iteration
+//-----------------------------------------------------------------------------
+  /** Calls \p run(start, end, base_vertex) for the single run or for each of the multiple runs of \p spans. For internal use only. */
+  template<class F>
+  void forEachRunInSpans(const IndexSpans& spans, F& run)
+  {
+    if (!spans.mpCounts)
+    {
+      run( spans.mFirst, spans.mFirst + spans.mCount, spans.mBaseVertex );
+      return;
+    }
+
+    const std::vector<GLsizei>& counts = *spans.mpCounts;
+    const bool first_indices = spans.mpFirstIndices && !spans.mpFirstIndices->empty();
+    const bool base_vertices = spans.mpBaseVertices && !spans.mpBaseVertices->empty();
+    VL_CHECK( !first_indices || spans.mpFirstIndices->size() == counts.size() )
+    VL_CHECK( !base_vertices || spans.mpBaseVertices->size() == counts.size() )
+    int start = 0;
+    for(size_t i=0; i<counts.size(); ++i)
+    {
+      if (first_indices)
+        start = (*spans.mpFirstIndices)[i];
+      run( start, start + counts[i], base_vertices ? (*spans.mpBaseVertices)[i] : 0 );
+      start += counts[i];
+    }
+  }
+
+  /** Calls \p func(a, b, c) for each triangle of \p spans reading the indices through \p idx. For internal use only. */
+  template<class TReader, class F>
+  void forEachTriangleInSpans(const TReader& idx, const IndexSpans& spans, F& func)
+  {
+    auto run = [&](int start, int end, int base_vert) {
+      forEachTriangleInRun( idx, spans.mPrimType, start, end, base_vert, spans.mPrimRestartOn, spans.mPrimRestartIndex, func );
+    };
+    forEachRunInSpans( spans, run );
+  }
+
+  /** Calls \p func(index) for each index of \p spans reading the indices through \p idx. For internal use only. */
+  template<class TReader, class F>
+  void forEachIndexInSpans(const TReader& idx, const IndexSpans& spans, F& func)
+  {
+    auto run = [&](int start, int end, int base_vert) {
+      forEachIndexInRun( idx, start, end, base_vert, spans.mPrimRestartOn, spans.mPrimRestartIndex, func );
+    };
+    forEachRunInSpans( spans, run );
+  }
+
+  /** Dispatches once on the index type of \p spans and calls \p func(a, b, c) for each triangle. For internal use only. */
+  template<class F>
+  void forEachTriangleInSpans(const IndexSpans& spans, F& func)
+  {
+    switch(spans.mIndexType)
+    {
+    case GL_UNSIGNED_BYTE:  forEachTriangleInSpans( IndexSpanReader<GLubyte>(spans.mIndices),  spans, func ); break;
+    case GL_UNSIGNED_SHORT: forEachTriangleInSpans( IndexSpanReader<GLushort>(spans.mIndices), spans, func ); break;
+    case GL_UNSIGNED_INT:   forEachTriangleInSpans( IndexSpanReader<GLuint>(spans.mIndices),   spans, func ); break;
+    default:                forEachTriangleInSpans( IndexSpanDirectReader(),                   spans, func ); break;
+    }
+  }
+
+  /** Dispatches once on the index type of \p spans and calls \p func(index) for each index. For internal use only. */
+  template<class F>
+  void forEachIndexInSpans(const IndexSpans& spans, F& func)
+  {
+    switch(spans.mIndexType)
+    {
+    case GL_UNSIGNED_BYTE:  forEachIndexInSpans( IndexSpanReader<GLubyte>(spans.mIndices),  spans, func ); break;
+    case GL_UNSIGNED_SHORT: forEachIndexInSpans( IndexSpanReader<GLushort>(spans.mIndices), spans, func ); break;
+    case GL_UNSIGNED_INT:   forEachIndexInSpans( IndexSpanReader<GLuint>(spans.mIndices),   spans, func ); break;
+    default:                forEachIndexInSpans( IndexSpanDirectReader(),                   spans, func ); break;
+    }
+  }
+//-----------------------------------------------------------------------------
+}
+
+#endif
@@ -58,16 +58,16 @@ Light::Light()
   mEnabled = true;
 }
 //------------------------------------------------------------------------------
-void Light::apply(int index, const Camera* camera, OpenGLContext*) const
+void Light::apply(int index, const Camera* camera, OpenGLContext* ctx) const
 {
   VL_CHECK_OGL()
 
   if (enabled())
   {
-    glEnable (GL_LIGHT0 + index); VL_CHECK_OGL()
+    ctx->mGL._glEnable(GL_LIGHT0 + index); VL_CHECK_OGL()
 
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
+    ctx->mGL._glMatrixMode(GL_MODELVIEW);
+    ctx->mGL._glPushMatrix();
 
     // follows the given node
     if ( boundTransform() )
@@ -75,40 +75,40 @@ void Light::apply(int index, const Camera* camera, OpenGLContext*) const
     else
     {
       // follows the camera
-      /*glMatrixMode(GL_MODELVIEW);*/
-      glLoadIdentity();
+      /*ctx->mGL._glMatrixMode(GL_MODELVIEW);*/
+      ctx->mGL._glLoadIdentity();
     }
 
-    glLightfv(GL_LIGHT0+index, GL_AMBIENT,  mAmbient.ptr());
-    glLightfv(GL_LIGHT0+index, GL_DIFFUSE,  mDiffuse.ptr());
-    glLightfv(GL_LIGHT0+index, GL_SPECULAR, mSpecular.ptr());
-    glLightfv(GL_LIGHT0+index, GL_POSITION, mPosition.ptr());
+    ctx->mGL._glLightfv(GL_LIGHT0+index, GL_AMBIENT,  mAmbient.ptr());
+    ctx->mGL._glLightfv(GL_LIGHT0+index, GL_DIFFUSE,  mDiffuse.ptr());
+    ctx->mGL._glLightfv(GL_LIGHT0+index, GL_SPECULAR, mSpecular.ptr());
+    ctx->mGL._glLightfv(GL_LIGHT0+index, GL_POSITION, mPosition.ptr());
 
-    glLightf(GL_LIGHT0+index, GL_SPOT_CUTOFF, mSpotCutoff);
+    ctx->mGL._glLightf(GL_LIGHT0+index, GL_SPOT_CUTOFF, mSpotCutoff);
 
     // if its a spot light
     if (mSpotCutoff != 180.0f)
     {
       VL_CHECK(mSpotCutoff>=0.0f && mSpotCutoff<=90.0f);
-      glLightfv(GL_LIGHT0+index, GL_SPOT_DIRECTION, mSpotDirection.ptr());
-      glLightf(GL_LIGHT0+index, GL_SPOT_EXPONENT, mSpotExponent);
+      ctx->mGL._glLightfv(GL_LIGHT0+index, GL_SPOT_DIRECTION, mSpotDirection.ptr());
+      ctx->mGL._glLightf(GL_LIGHT0+index, GL_SPOT_EXPONENT, mSpotExponent);
     }
 
     // if positional or spot light compute the attenuation factors, that is
     // attenuation is useless of directional lights.
     if (mSpotCutoff != 180.0f || mPosition.w() != 0)
     {
-      glLightf(GL_LIGHT0+index, GL_CONSTANT_ATTENUATION, mConstantAttenuation);
-      glLightf(GL_LIGHT0+index, GL_LINEAR_ATTENUATION, mLinearAttenuation);
-      glLightf(GL_LIGHT0+index, GL_QUADRATIC_ATTENUATION, mQuadraticAttenuation);
+      ctx->mGL._glLightf(GL_LIGHT0+index, GL_CONSTANT_ATTENUATION, mConstantAttenuation);
+      ctx->mGL._glLightf(GL_LIGHT0+index, GL_LINEAR_ATTENUATION, mLinearAttenuation);
+      ctx->mGL._glLightf(GL_LIGHT0+index, GL_QUADRATIC_ATTENUATION, mQuadraticAttenuation);
     }
 
-    /*glMatrixMode(GL_MODELVIEW);*/
-    glPopMatrix();
+    /*ctx->mGL._glMatrixMode(GL_MODELVIEW);*/
+    ctx->mGL._glPopMatrix();
   }
   else
   {
-    glDisable(GL_LIGHT0 + index);
+    ctx->mGL._glDisable(GL_LIGHT0 + index);
   }
 }
 //------------------------------------------------------------------------------
@@ -32,9 +32,178 @@
 #include <vlGraphics/MorphingCallback.hpp>
 #include <vlCore/ResourceDatabase.hpp>
 #include <vlGraphics/GLSL.hpp>
+#include <vlGraphics/DrawElements.hpp>
+#include <vlGraphics/DrawRangeElements.hpp>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX__)
+  #define VL_MORPH_AVX
+  #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define VL_MORPH_SSE
+  #include <emmintrin.h>
+#endif
 
 using namespace vl;
 
+namespace
+{
+  // out[i] = a[i]*ha + b[i]*hb for i in [0, count)
+  void blendKernel(float* out, const float* a, const float* b, float ha, float hb, size_t count)
+  {
+    size_t i = 0;
+  #if defined(VL_MORPH_AVX)
+    const __m256 wa = _mm256_set1_ps( ha );
+    const __m256 wb = _mm256_set1_ps( hb );
+    for( ; i + 8 <= count; i += 8 )
+    {
+    #if defined(__FMA__)
+      __m256 r = _mm256_fmadd_ps( _mm256_loadu_ps( b + i ), wb, _mm256_mul_ps( _mm256_loadu_ps( a + i ), wa ) );
+    #else
+      __m256 r = _mm256_add_ps( _mm256_mul_ps( _mm256_loadu_ps( a + i ), wa ), _mm256_mul_ps( _mm256_loadu_ps( b + i ), wb ) );
+    #endif
+      _mm256_storeu_ps( out + i, r );
+    }
+  #elif defined(VL_MORPH_SSE)
+    const __m128 wa = _mm_set1_ps( ha );
+    const __m128 wb = _mm_set1_ps( hb );
+    for( ; i + 4 <= count; i += 4 )
+    {
+      __m128 r = _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( a + i ), wa ), _mm_mul_ps( _mm_loadu_ps( b + i ), wb ) );
+      _mm_storeu_ps( out + i, r );
+    }
+  #endif
+    for( ; i < count; ++i )
+      out[i] = a[i]*ha + b[i]*hb;
+  }
+
+  // blends the [begin, end) range of the scalars of an ArrayFloat3
+  void blendRange(ArrayFloat3* out, const ArrayFloat3* a, const ArrayFloat3* b, float ha, float hb, size_t begin, size_t end)
+  {
+    end = std::min( end, out->size() * 3 );
+    if ( begin >= end )
+      return;
+    blendKernel( (float*)out->ptr() + begin, (const float*)a->ptr() + begin, (const float*)b->ptr() + begin, ha, hb, end - begin );
+  }
+}
+
+//-----------------------------------------------------------------------------
+// MorphingAtlas
+//-----------------------------------------------------------------------------
+MorphingAtlas::MorphingAtlas()
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+  mVertexAtlas = new ArrayFloat3;
+  mNormalAtlas = new ArrayFloat3;
+  mFrameCount = 0;
+  mFrameVertexCount = 0;
+}
+//-----------------------------------------------------------------------------
+bool MorphingAtlas::build(const std::vector< ref<ArrayFloat3> >& vertex_frames, const std::vector< ref<ArrayFloat3> >& normal_frames)
+{
+  mVertexViews.clear();
+  mNormalViews.clear();
+  mFrameCount = 0;
+  mFrameVertexCount = 0;
+
+  if ( vertex_frames.empty() || vertex_frames.size() != normal_frames.size() )
+    return false;
+
+  const size_t vert_count = vertex_frames[0]->size();
+  for( size_t i = 0; i < vertex_frames.size(); ++i )
+  {
+    if ( vertex_frames[i]->size() != vert_count || normal_frames[i]->size() != vert_count )
+      return false;
+  }
+
+  mVertexAtlas->resize( vert_count * vertex_frames.size() );
+  mNormalAtlas->resize( vert_count * normal_frames.size() );
+  const size_t frame_bytes = vert_count * sizeof(fvec3);
+  for( size_t i = 0; i < vertex_frames.size(); ++i )
+  {
+    memcpy( mVertexAtlas->ptr() + i * frame_bytes, vertex_frames[i]->ptr(), frame_bytes );
+    memcpy( mNormalAtlas->ptr() + i * frame_bytes, normal_frames[i]->ptr(), frame_bytes );
+  }
+  mVertexAtlas->setBufferObjectDirty( true );
+  mNormalAtlas->setBufferObjectDirty( true );
+
+  mFrameCount = (int)vertex_frames.size();
+  mFrameVertexCount = (int)vert_count;
+  mVertexViews.resize( mFrameCount );
+  mNormalViews.resize( mFrameCount );
+  return true;
+}
+//-----------------------------------------------------------------------------
+ArrayFloat3* MorphingAtlas::view(ArrayFloat3* atlas, std::vector< ref<ArrayFloat3> >& views, int frame_offset)
+{
+  VL_CHECK( frame_offset >= 0 && frame_offset < mFrameCount )
+
+  // the frames are kept by the MorphingCallback, no need to keep a second local copy
+  if ( !atlas->bufferObject()->handle() || atlas->isBufferObjectDirty() )
+    atlas->updateBufferObject( BUM_DiscardRamBuffer );
+
+  ref<ArrayFloat3>& view = views[frame_offset];
+  if ( !view )
+    view = new ArrayFloat3;
+
+  const BufferObject* atlas_bo = atlas->bufferObject();
+  const GLintptr offset = (GLintptr)frame_offset * mFrameVertexCount * sizeof(fvec3);
+  if ( view->bufferObject()->handle() != atlas_bo->handle() || view->bufferObject()->handleOffset() != offset )
+  {
+    view->bufferObject()->setSharedRegion( atlas_bo->handle(), offset, atlas_bo->byteCountBufferObject() - offset );
+    view->setBufferObjectDirty( false );
+  }
+  return view.get();
+}
+//-----------------------------------------------------------------------------
+// MorphingBlendCache
+//-----------------------------------------------------------------------------
+MorphingBlendCache::MorphingBlendCache(int max_entries, int interpolation_steps)
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+  mMaxEntries = max_entries;
+  mInterpolationSteps = interpolation_steps < 1 ? 1 : interpolation_steps;
+  mHitCount = 0;
+  mMissCount = 0;
+}
+//-----------------------------------------------------------------------------
+MorphingBlendResult* MorphingBlendCache::acquire(const void* frame_set, int frame1, int frame2, float t, real frame_clock, bool& created)
+{
+  Key key;
+  key.mFrameSet = frame_set;
+  key.mFrame1 = frame1;
+  key.mFrame2 = frame2;
+  key.mStep = step( t );
+
+  std::map< Key, ref<MorphingBlendResult> >::iterator it = mEntries.find( key );
+  if ( it != mEntries.end() )
+  {
+    ++mHitCount;
+    created = false;
+    it->second->mLastUse = frame_clock;
+    return it->second.get();
+  }
+
+  // drop the results not used by the current frame, the ones still referenced by a MorphingCallback stay alive
+  if ( (int)mEntries.size() >= mMaxEntries )
+  {
+    for( it = mEntries.begin(); it != mEntries.end(); )
+    {
+      if ( it->second->mLastUse != frame_clock )
+        mEntries.erase( it++ );
+      else
+        ++it;
+    }
+  }
+
+  ++mMissCount;
+  created = true;
+  ref<MorphingBlendResult> result = new MorphingBlendResult;
+  result->mLastUse = frame_clock;
+  mEntries[key] = result;
+  return result.get();
+}
 //-----------------------------------------------------------------------------
 // MorphingCallback
 //-----------------------------------------------------------------------------
@@ -43,6 +212,9 @@ MorphingCallback::MorphingCallback()
   VL_DEBUG_SET_OBJECT_NAME()
 
   mGeometry = new Geometry;
+  mBlend = new MorphingBlendResult;
+  mParallelBlendThreshold = 16384;
+  mAtlasEnabled = false;
   setAnimation(0,0,0);
   resetGLSLBindings();
   setGLSLVertexBlendEnabled(false);
@@ -100,30 +272,47 @@ void MorphingCallback::onActorRenderStarted(Actor*, real frame_clock, const Came
     // Since every character is in a different stage of the animation they all have different vertex/normal/etc. arrays pointers,
     // thus the lazy-vertex-array setup is forced to call glVertexAttribPointer/glVertexPointer/glBindBuffer continuously.
     // We may be able to partially solve this by putting all the animations in a single ArrayFloat3 and let the draw_calls
-    // switch the frame by using the base-vertex functionality.
+    // switch the frame by using the base-vertex functionality -> this is what the atlas mode does, see initAtlas().
     // I modified the App_MorphAnimation test so that all the characters share the same animation (thus the same vertex arrays) and don't have
     // transforms attached to eliminate the cost of glLoadMatrix/glMatrixMode. The resulting frame to frame time resulted only 1.2% reduced.
 
-    // vertex/normals frame 1
-    mGeometry->setVertexArray( mVertexFrames[mFrame1].get() );
-    mGeometry->setNormalArray( mNormalFrames[mFrame1].get() );
+    ArrayFloat3* vert_frame2 = mVertexFrames[mFrame2].get();
+    ArrayFloat3* norm_frame2 = mNormalFrames[mFrame2].get();
 
-    if (!mVertexFrames[mFrame1]->bufferObject()->handle() || mVertexFrames[mFrame1]->isBufferObjectDirty())
-      mVertexFrames[mFrame1]->updateBufferObject(BUM_KeepRamBuffer);
+    if ( atlasEnabled() )
+    {
+      // the draw calls select the lowest frame with the base vertex and the frame arrays are views of the atlas starting
+      // from there: the views are the same for all the characters, only the base vertex changes from one to another.
+      const int base_frame = std::min( mFrame1, mFrame2 );
+      mGeometry->setVertexArray( mAtlas->vertexView( mFrame1 - base_frame ) );
+      mGeometry->setNormalArray( mAtlas->normalView( mFrame1 - base_frame ) );
+      vert_frame2 = mAtlas->vertexView( mFrame2 - base_frame );
+      norm_frame2 = mAtlas->normalView( mFrame2 - base_frame );
+      setBaseVertex( base_frame * mAtlas->frameVertexCount() );
+    }
+    else
+    {
+      // vertex/normals frame 1
+      mGeometry->setVertexArray( mVertexFrames[mFrame1].get() );
+      mGeometry->setNormalArray( mNormalFrames[mFrame1].get() );
 
-    if (!mVertexFrames[mFrame2]->bufferObject()->handle() || mVertexFrames[mFrame2]->isBufferObjectDirty())
-      mVertexFrames[mFrame2]->updateBufferObject(BUM_KeepRamBuffer);
+      if (!mVertexFrames[mFrame1]->bufferObject()->handle() || mVertexFrames[mFrame1]->isBufferObjectDirty())
+        mVertexFrames[mFrame1]->updateBufferObject(BUM_KeepRamBuffer);
 
-    if (!mNormalFrames[mFrame1]->bufferObject()->handle() || mNormalFrames[mFrame1]->isBufferObjectDirty())
-      mNormalFrames[mFrame1]->updateBufferObject(BUM_KeepRamBuffer);
+      if (!mVertexFrames[mFrame2]->bufferObject()->handle() || mVertexFrames[mFrame2]->isBufferObjectDirty())
+        mVertexFrames[mFrame2]->updateBufferObject(BUM_KeepRamBuffer);
 
-    if (!mNormalFrames[mFrame2]->bufferObject()->handle() || mNormalFrames[mFrame2]->isBufferObjectDirty())
-      mNormalFrames[mFrame2]->updateBufferObject(BUM_KeepRamBuffer);
+      if (!mNormalFrames[mFrame1]->bufferObject()->handle() || mNormalFrames[mFrame1]->isBufferObjectDirty())
+        mNormalFrames[mFrame1]->updateBufferObject(BUM_KeepRamBuffer);
 
-    VL_CHECK( mVertexFrames[mFrame1]->bufferObject()->handle() )
-    VL_CHECK( mVertexFrames[mFrame2]->bufferObject()->handle() )
-    VL_CHECK( mNormalFrames[mFrame1]->bufferObject()->handle() )
-    VL_CHECK( mNormalFrames[mFrame2]->bufferObject()->handle() )
+      if (!mNormalFrames[mFrame2]->bufferObject()->handle() || mNormalFrames[mFrame2]->isBufferObjectDirty())
+        mNormalFrames[mFrame2]->updateBufferObject(BUM_KeepRamBuffer);
+
+      VL_CHECK( mVertexFrames[mFrame1]->bufferObject()->handle() )
+      VL_CHECK( mVertexFrames[mFrame2]->bufferObject()->handle() )
+      VL_CHECK( mNormalFrames[mFrame1]->bufferObject()->handle() )
+      VL_CHECK( mNormalFrames[mFrame2]->bufferObject()->handle() )
+    }
 
     #if 1 // faster method:
 
@@ -138,8 +327,8 @@ void MorphingCallback::onActorRenderStarted(Actor*, real frame_clock, const Came
         mAnim_t_Binding = glslprogram->getUniformLocation("anim_t");
 
       // vertex/normals frame 2
-      mGeometry->setVertexAttribArray( mVertex2_Binding, mVertexFrames[mFrame2].get() );
-      mGeometry->setVertexAttribArray( mNormal2_Binding, mNormalFrames[mFrame2].get() );
+      mGeometry->setVertexAttribArray( mVertex2_Binding, vert_frame2 );
+      mGeometry->setVertexAttribArray( mNormal2_Binding, norm_frame2 );
       // frame interpolation ratio
       glUniform1fv(mAnim_t_Binding, 1, &mAnim_t);
 
@@ -153,15 +342,34 @@ void MorphingCallback::onActorRenderStarted(Actor*, real frame_clock, const Came
     #endif
   }
   else
-  if ( do_update )
   {
-    if (mGeometry->vertexArray() == NULL)
-      mGeometry->setVertexArray(mVertices.get());
+    // the CPU blended arrays are not part of the atlas
+    if ( atlasEnabled() )
+      setBaseVertex( 0 );
 
-    if (mGeometry->normalArray() == NULL)
-      mGeometry->setNormalArray(mNormals.get());
+    if ( do_update )
+    {
+      // characters at the same stage of the animation share the same blending
+      bool blend_needed = true;
+      float t = mAnim_t;
+      if ( mBlendCache )
+      {
+        t = mBlendCache->quantize( mAnim_t );
+        mBlend = mBlendCache->acquire( mVertexFrames[0].get(), mFrame1, mFrame2, t, frame_clock, blend_needed );
+      }
+
+      if ( blend_needed )
+        blendFrames(mFrame1, mFrame2, t);
+
+      if (mGeometry->vertexArray() != mBlend->mVertices.get())
+        mGeometry->setVertexArray(mBlend->mVertices.get());
+
+      if (mGeometry->normalArray() != mBlend->mNormals.get())
+        mGeometry->setNormalArray(mBlend->mNormals.get());
+    }
 
-    blendFrames(mFrame1, mFrame2, mAnim_t);
+    // uploads shared results only once and streams them again when their ring region is recycled
+    updateBufferObjects();
   }
 }
 //-----------------------------------------------------------------------------
@@ -178,8 +386,7 @@ void MorphingCallback::init(ResourceDatabase* res_db)
 
   Geometry* geometry = res_db->get<Geometry>(0);
   mGeometry->shallowCopyFrom( *geometry );
-  mVertices = new ArrayFloat3;
-  mNormals  = new ArrayFloat3;
+  mBlend = new MorphingBlendResult;
 
   // setup Geometry vertex attributes
 
@@ -227,14 +434,82 @@ void MorphingCallback::init(ResourceDatabase* res_db)
   mGeometry->setNormalArray(NULL);
 }
 //-----------------------------------------------------------------------------
+bool MorphingCallback::initAtlas()
+{
+  mAtlas = NULL;
+  mAtlasEnabled = false;
+
+  if ( !Has_BufferObject || !mGeometry->isBufferObjectEnabled() || !Has_Base_Vertex )
+  {
+    Log::error("MorphingCallback::initAtlas(): the atlas mode requires buffer objects and base vertex support.\n");
+    return false;
+  }
+
+  for( int i = 0; i < (int)mGeometry->drawCalls().size(); ++i )
+  {
+    const DrawCall* dc = mGeometry->drawCalls().at(i);
+    if ( !cast<const DrawElementsBase>( dc ) && !cast<const DrawRangeElementsBase>( dc ) )
+    {
+      Log::error("MorphingCallback::initAtlas(): the atlas mode requires DrawElements or DrawRangeElements draw calls.\n");
+      return false;
+    }
+  }
+
+  ref<MorphingAtlas> atlas = new MorphingAtlas;
+  if ( !atlas->build( mVertexFrames, mNormalFrames ) )
+  {
+    Log::error("MorphingCallback::initAtlas(): the vertex and normal frames must all have the same size.\n");
+    return false;
+  }
+
+  mAtlas = atlas;
+  mAtlasEnabled = true;
+  return true;
+}
+//-----------------------------------------------------------------------------
+void MorphingCallback::setAtlasEnabled(bool enable)
+{
+  if ( atlasEnabled() && !enable )
+    setBaseVertex( 0 );
+  mAtlasEnabled = enable;
+}
+//-----------------------------------------------------------------------------
+void MorphingCallback::setBaseVertex(int base_vertex)
+{
+  // the draw calls are shared among the characters: the base vertex is set right before every draw
+  for( int i = 0; i < (int)mGeometry->drawCalls().size(); ++i )
+  {
+    DrawCall* dc = mGeometry->drawCalls().at(i);
+    if ( DrawElementsBase* de = cast<DrawElementsBase>( dc ) )
+      de->setBaseVertex( base_vertex );
+    else
+    if ( DrawRangeElementsBase* dre = cast<DrawRangeElementsBase>( dc ) )
+      dre->setBaseVertex( base_vertex );
+  }
+}
+//-----------------------------------------------------------------------------
+const char* MorphingCallback::blendSimdPath()
+{
+#if defined(VL_MORPH_AVX)
+  return "AVX";
+#elif defined(VL_MORPH_SSE)
+  return "SSE";
+#else
+  return "scalar";
+#endif
+}
+//-----------------------------------------------------------------------------
 void MorphingCallback::blendFrames(int a, int b, float t)
 {
+  ArrayFloat3* vertices = mBlend->mVertices.get();
+  ArrayFloat3* normals  = mBlend->mNormals.get();
+
   // allocate interpolation buffers
-  if (mVertices->size() != mVertexFrames[0]->size() ||
-      mNormals->size()  != mNormalFrames[0]->size() )
+  if (vertices->size() != mVertexFrames[0]->size() ||
+      normals->size()  != mNormalFrames[0]->size() )
   {
-    mVertices->resize( mVertexFrames[0]->size() );
-    mNormals->resize(  mNormalFrames[0]->size() );
+    vertices->resize( mVertexFrames[0]->size() );
+    normals->resize(  mNormalFrames[0]->size() );
   }
 
   #if 1
@@ -245,17 +520,52 @@ void MorphingCallback::blendFrames(int a, int b, float t)
     float Hb = -2*t*t*t + 3*t*t;
   #endif
 
-  for(size_t i=0; i<mVertices->size(); ++i)
-  {
-    mVertices->at(i) = mVertexFrames[ a ]->at(i)*Ha + mVertexFrames[ b ]->at(i)*Hb;
-    mNormals->at(i)  = mNormalFrames[ a ]->at(i)*Ha + mNormalFrames[ b ]->at(i)*Hb;
-  }
+  // the arrays are blended as flat float arrays
+  const ArrayFloat3* vert_a = mVertexFrames[ a ].get();
+  const ArrayFloat3* vert_b = mVertexFrames[ b ].get();
+  const ArrayFloat3* norm_a = mNormalFrames[ a ].get();
+  const ArrayFloat3* norm_b = mNormalFrames[ b ].get();
+  const size_t scalar_count = std::max( vertices->size(), normals->size() ) * 3;
+
+  // ranges of whole blocks of 8 floats so that only the last one has a scalar tail
+  const int block_count = (int)( ( scalar_count + 7 ) / 8 );
+  const int range_count = (int)vertices->size() >= parallelBlendThreshold() ? ThreadPool::rangeCount( threadPool(), block_count, 1 ) : 1;
+  ThreadPool::parallelFor( threadPool(), block_count, range_count, [=](int, int begin, int end) {
+    blendRange( vertices, vert_a, vert_b, Ha, Hb, begin * (size_t)8, end * (size_t)8 );
+    blendRange( normals,  norm_a, norm_b, Ha, Hb, begin * (size_t)8, end * (size_t)8 );
+  } );
+
+  mBlend->mFrame1 = a;
+  mBlend->mFrame2 = b;
+  mBlend->mT = t;
+  mBlend->mUploaded = false;
+
+  updateBufferObjects();
+}
+//-----------------------------------------------------------------------------
+void MorphingCallback::updateBufferObjects()
+{
+  if (!mGeometry->isBufferObjectEnabled() || !Has_BufferObject)
+    return;
 
-  if (mGeometry->isBufferObjectEnabled() && Has_BufferObject)
-  {
-    mVertices->bufferObject()->setBufferData(BU_DYNAMIC_DRAW, false);
-    mNormals ->bufferObject()->setBufferData(BU_DYNAMIC_DRAW, false);
-  }
+  MorphingBlendResult* blend = mBlend.get();
+  if (blend->mVertices->size() == 0)
+    return;
+
+  // the streamed regions are recycled after a few frames: stream them again even if the blending did not change
+  bool restream = mStreamingBuffer && blend->mStreamedFrame != -1 && blend->mStreamedFrame != mStreamingBuffer->frameCount();
+  if (blend->mUploaded && !restream)
+    return;
+
+  // stream to the shared ring if possible, fall back to reallocating the buffer objects
+  bool vert_streamed = mStreamingBuffer && mStreamingBuffer->stream(blend->mVertices.get());
+  if (!vert_streamed)
+    blend->mVertices->bufferObject()->setBufferData(BU_DYNAMIC_DRAW, false);
+  bool norm_streamed = mStreamingBuffer && mStreamingBuffer->stream(blend->mNormals.get());
+  if (!norm_streamed)
+    blend->mNormals ->bufferObject()->setBufferData(BU_DYNAMIC_DRAW, false);
+  blend->mStreamedFrame = vert_streamed || norm_streamed ? mStreamingBuffer->frameCount() : -1;
+  blend->mUploaded = true;
 }
 //-----------------------------------------------------------------------------
 void MorphingCallback::setAnimation(int start, int end, float period)
@@ -288,13 +598,18 @@ void MorphingCallback::stopAnimation()
 //-----------------------------------------------------------------------------
 void MorphingCallback::initFrom(MorphingCallback* morph_cb)
 {
-  mVertices = new ArrayFloat3;
-  mNormals  = new ArrayFloat3;
+  mBlend = new MorphingBlendResult;
 
   // copy vertex frames
 
   mVertexFrames = morph_cb->mVertexFrames;
   mNormalFrames = morph_cb->mNormalFrames;
+  mStreamingBuffer = morph_cb->mStreamingBuffer;
+  mBlendCache = morph_cb->mBlendCache;
+  mThreadPool = morph_cb->mThreadPool;
+  mParallelBlendThreshold = morph_cb->mParallelBlendThreshold;
+  mAtlas = morph_cb->mAtlas;
+  mAtlasEnabled = morph_cb->mAtlasEnabled;
 
   #if 0
     // Geometry sharing method: works only wiht GLSL
@@ -34,11 +34,161 @@
 
 #include <vlGraphics/Actor.hpp>
 #include <vlGraphics/Geometry.hpp>
+#include <vlGraphics/StreamingBufferObject.hpp>
+#include <vlGraphics/ThreadPool.hpp>
+#include <map>
 
 namespace vl
 {
   class ResourceDatabase;
 
+  //-----------------------------------------------------------------------------
+  // MorphingBlendResult
+  //-----------------------------------------------------------------------------
+  /** The vertex and normal arrays blended on the CPU by a MorphingCallback for a given pair of frames.
+      A MorphingBlendResult can be shared by several MorphingCallback through a MorphingBlendCache. */
+  class MorphingBlendResult: public Object
+  {
+    VL_INSTRUMENT_CLASS(vl::MorphingBlendResult, Object)
+
+  public:
+    MorphingBlendResult(): mFrame1(-1), mFrame2(-1), mT(0), mLastUse(-1), mStreamedFrame(-1), mUploaded(false)
+    {
+      VL_DEBUG_SET_OBJECT_NAME()
+      mVertices = new ArrayFloat3;
+      mNormals  = new ArrayFloat3;
+    }
+
+    ref<ArrayFloat3> mVertices;
+    ref<ArrayFloat3> mNormals;
+    int mFrame1;
+    int mFrame2;
+    float mT;
+    //! Frame clock of the last MorphingBlendCache::acquire() returning this result.
+    real mLastUse;
+    //! StreamingBufferObject::frameCount() of the last streaming, -1 if the arrays are not streamed.
+    long long mStreamedFrame;
+    //! Whether the arrays have been uploaded since the last blending.
+    bool mUploaded;
+  };
+
+  //-----------------------------------------------------------------------------
+  // MorphingAtlas
+  //-----------------------------------------------------------------------------
+  /** Packs all the vertex and normal frames of a morphing animation in a single vertex array and a single normal array.
+      A frame is selected by the base vertex of the draw calls, the next frame by a view of the atlas starting a few frames later
+      (see vertexView()), so that all the characters animated from the same atlas share the same vertex array bindings.
+      The local copy of the atlas is released once uploaded on the GPU.
+      \sa MorphingCallback::initAtlas() */
+  class VLGRAPHICS_EXPORT MorphingAtlas: public Object
+  {
+    VL_INSTRUMENT_CLASS(vl::MorphingAtlas, Object)
+
+  public:
+    MorphingAtlas();
+
+    //! Packs the given frames. All the frames must have the same number of vertices.
+    //! \return false if the frames are empty, or of different sizes or count.
+    bool build(const std::vector< ref<ArrayFloat3> >& vertex_frames, const std::vector< ref<ArrayFloat3> >& normal_frames);
+
+    //! Number of frames in the atlas.
+    int frameCount() const { return mFrameCount; }
+
+    //! Number of vertices of a frame, i.e. the base vertex step between two frames.
+    int frameVertexCount() const { return mFrameVertexCount; }
+
+    //! An array referring to the GPU copy of the vertex atlas starting at frame \p frame_offset. Uploads the atlas if needed.
+    ArrayFloat3* vertexView(int frame_offset) { return view( mVertexAtlas.get(), mVertexViews, frame_offset ); }
+
+    //! An array referring to the GPU copy of the normal atlas starting at frame \p frame_offset. Uploads the atlas if needed.
+    ArrayFloat3* normalView(int frame_offset) { return view( mNormalAtlas.get(), mNormalViews, frame_offset ); }
+
+  protected:
+    ArrayFloat3* view(ArrayFloat3* atlas, std::vector< ref<ArrayFloat3> >& views, int frame_offset);
+
+  protected:
+    ref<ArrayFloat3> mVertexAtlas;
+    ref<ArrayFloat3> mNormalAtlas;
+    std::vector< ref<ArrayFloat3> > mVertexViews;
+    std::vector< ref<ArrayFloat3> > mNormalViews;
+    int mFrameCount;
+    int mFrameVertexCount;
+  };
+
+  //-----------------------------------------------------------------------------
+  // MorphingBlendCache
+  //-----------------------------------------------------------------------------
+  /** Shares the frames blended on the CPU among the MorphingCallback[s] animating the same vertex frames, so that the
+      characters sitting at the same frame pair and interpolation step are blended and uploaded only once.
+      Results are keyed by the first vertex frame, thus they are shared among the MorphingCallback[s] created with
+      initFrom() from the same MorphingCallback. The interpolation factor is quantized to interpolationSteps() steps
+      per frame pair, see quantize().
+      \sa MorphingCallback::setBlendCache() */
+  class VLGRAPHICS_EXPORT MorphingBlendCache: public Object
+  {
+    VL_INSTRUMENT_CLASS(vl::MorphingBlendCache, Object)
+
+  public:
+    MorphingBlendCache(int max_entries = 256, int interpolation_steps = 32);
+
+    /** Returns the result for the given frame set, frame pair and interpolation factor, which should be quantized with quantize().
+      * \p created is set to true if the result has just been created and must be blended by the caller.
+      * When the cache is full the results not used during \p frame_clock are dropped. */
+    MorphingBlendResult* acquire(const void* frame_set, int frame1, int frame2, float t, real frame_clock, bool& created);
+
+    //! Rounds \p t to the closest of the interpolationSteps() steps, the MorphingCallback[s] blend the frames using the rounded value.
+    float quantize(float t) const { return (float)step( t ) / mInterpolationSteps; }
+
+    //! Number of interpolation steps between two frames, 32 by default. Fewer steps let more characters share the same results.
+    void setInterpolationSteps(int steps) { mInterpolationSteps = steps < 1 ? 1 : steps; clear(); }
+
+    //! Number of interpolation steps between two frames, 32 by default.
+    int interpolationSteps() const { return mInterpolationSteps; }
+
+    //! Removes all the cached results.
+    void clear() { mEntries.clear(); }
+
+    //! Number of cached results.
+    int size() const { return (int)mEntries.size(); }
+
+    //! Maximum number of cached results, see acquire().
+    void setMaxEntries(int max_entries) { mMaxEntries = max_entries; }
+
+    //! Maximum number of cached results, see acquire().
+    int maxEntries() const { return mMaxEntries; }
+
+    //! Number of acquire() calls that returned an already blended result.
+    long long hitCount() const { return mHitCount; }
+
+    //! Number of acquire() calls that created a new result.
+    long long missCount() const { return mMissCount; }
+
+  protected:
+    int step(float t) const { return (int)( t * mInterpolationSteps + 0.5f ); }
+
+    struct Key
+    {
+      const void* mFrameSet;
+      int mFrame1;
+      int mFrame2;
+      int mStep;
+
+      bool operator<(const Key& other) const
+      {
+        if ( mFrameSet != other.mFrameSet ) return mFrameSet < other.mFrameSet;
+        if ( mFrame1 != other.mFrame1 ) return mFrame1 < other.mFrame1;
+        if ( mFrame2 != other.mFrame2 ) return mFrame2 < other.mFrame2;
+        return mStep < other.mStep;
+      }
+    };
+
+    std::map< Key, ref<MorphingBlendResult> > mEntries;
+    int mMaxEntries;
+    int mInterpolationSteps;
+    long long mHitCount;
+    long long mMissCount;
+  };
+
   /** The MorphingCallback class implements a simple morphing animation mechanism using the
       GPU acceleration where available. */
   class VLGRAPHICS_EXPORT MorphingCallback: public ActorEventCallback
@@ -70,6 +220,9 @@ namespace vl
 
     void blendFrames(int a, int b, float t);
 
+    //! Uploads the arrays computed by the last blendFrames() to the GPU, if not already uploaded.
+    void updateBufferObjects();
+
     void setAnimation(int start, int end, float period);
 
     void startAnimation(real time = -1);
@@ -88,10 +241,72 @@ namespace vl
 
     bool animationStarted() const { return mAnimationStarted; }
 
+    /** When set and buffer objects are enabled, blendFrames() streams the blended vertices and normals to a region of
+      * \p buffer instead of reallocating their BufferObject with setBufferData(). The same StreamingBufferObject can be
+      * shared by many MorphingCallback and is inherited by initFrom(). Default is NULL.
+      * \sa StreamingBufferFrameCallback */
+    void setStreamingBuffer(StreamingBufferObject* buffer) { mStreamingBuffer = buffer; }
+
+    /** The StreamingBufferObject used by blendFrames(), see setStreamingBuffer(). */
+    StreamingBufferObject* streamingBuffer() { return mStreamingBuffer.get(); }
+
+    /** The StreamingBufferObject used by blendFrames(), see setStreamingBuffer(). */
+    const StreamingBufferObject* streamingBuffer() const { return mStreamingBuffer.get(); }
+
+    /** When set, the CPU blending is shared with the other MorphingCallback[s] using the same cache, see MorphingBlendCache.
+      * The interpolation factor is then rounded with MorphingBlendCache::quantize(). The cache is inherited by initFrom(). Default is NULL. */
+    void setBlendCache(MorphingBlendCache* cache) { mBlendCache = cache; mBlend = new MorphingBlendResult; }
+
+    /** The MorphingBlendCache used by the CPU blending, see setBlendCache(). */
+    MorphingBlendCache* blendCache() { return mBlendCache.get(); }
+
+    /** The MorphingBlendCache used by the CPU blending, see setBlendCache(). */
+    const MorphingBlendCache* blendCache() const { return mBlendCache.get(); }
+
+    /** When set, blendFrames() splits the meshes with at least parallelBlendThreshold() vertices across the threads of \p thread_pool.
+      * The thread pool is inherited by initFrom(). Default is NULL. */
+    void setThreadPool(ThreadPool* thread_pool) { mThreadPool = thread_pool; }
+
+    /** The ThreadPool used by blendFrames(), see setThreadPool(). */
+    ThreadPool* threadPool() { return mThreadPool.get(); }
+
+    /** The minimum number of vertices for which blendFrames() uses the threadPool(). Default is 16384. */
+    void setParallelBlendThreshold(int vertex_count) { mParallelBlendThreshold = vertex_count; }
+
+    /** The minimum number of vertices for which blendFrames() uses the threadPool(). Default is 16384. */
+    int parallelBlendThreshold() const { return mParallelBlendThreshold; }
+
+    /** The SIMD instruction set used by the CPU blending: "AVX", "SSE" or "scalar". */
+    static const char* blendSimdPath();
+
+    /** Packs the vertex and normal frames in a MorphingAtlas and enables the atlas mode, used by the GLSL vertex blending.
+      * In atlas mode the frame is selected setting the base vertex of the draw calls, which must be DrawElements or DrawRangeElements,
+      * and all the characters share the same vertex array bindings. Requires buffer objects and base vertex support, see Has_Base_Vertex.
+      * The atlas is shared with the MorphingCallback[s] created with initFrom().
+      * \return false if the atlas mode is not supported, in which case the frames are bound separately as usual. */
+    bool initAtlas();
+
+    /** Enables/disables the atlas mode set up by initAtlas(). */
+    void setAtlasEnabled(bool enable);
+
+    /** Whether the atlas mode is active, see initAtlas(). */
+    bool atlasEnabled() const { return mAtlasEnabled && mAtlas; }
+
+    /** The MorphingAtlas used in atlas mode, see initAtlas(). */
+    const MorphingAtlas* atlas() const { return mAtlas.get(); }
+
+  protected:
+    void setBaseVertex(int base_vertex);
+
   protected:
     ref<Geometry> mGeometry;
-    ref<ArrayFloat3> mVertices;
-    ref<ArrayFloat3> mNormals;
+    ref<StreamingBufferObject> mStreamingBuffer;
+    ref<MorphingBlendCache> mBlendCache;
+    ref<MorphingBlendResult> mBlend;
+    ref<ThreadPool> mThreadPool;
+    int mParallelBlendThreshold;
+    ref<MorphingAtlas> mAtlas;
+    bool mAtlasEnabled;
     std::vector< ref<ArrayFloat3> > mVertexFrames;
     std::vector< ref<ArrayFloat3> > mNormalFrames;
 
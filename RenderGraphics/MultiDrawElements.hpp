@@ -200,9 +200,11 @@ namespace vl
       indexBuffer()->bufferObject()->deleteBufferObject();
     }
 
-    virtual void render(bool use_bo) const
+    virtual void render(bool use_bo, OpenGLContext* gl_context) const
     {
       VL_CHECK_OGL()
+
+      const OpenGLFunctions& gl = glFunctions(gl_context);
       VL_CHECK(Has_GL_EXT_multi_draw_arrays||Has_GL_Version_1_4||Has_GL_Version_3_0||Has_GL_Version_4_0);
       VL_CHECK(!use_bo || (use_bo && Has_BufferObject))
       use_bo &= Has_BufferObject; // && indexBuffer()->bufferObject()->handle() && indexBuffer()->sizeBufferObject();
@@ -216,20 +218,20 @@ namespace vl
       if(primitiveRestartEnabled())
       {
         VL_CHECK(Has_Primitive_Restart);
-        glEnable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL();
-        glPrimitiveRestartIndex(primitive_restart_index); VL_CHECK_OGL();
+        gl._glEnable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL();
+        gl._glPrimitiveRestartIndex(primitive_restart_index); VL_CHECK_OGL();
       }
 
       const GLvoid **indices_ptr = NULL;
       if (use_bo && indexBuffer()->bufferObject()->handle())
       {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer()->bufferObject()->handle()); VL_CHECK_OGL()
+        bindIndexBuffer(gl_context, indexBuffer()->bufferObject()->handle());
         VL_CHECK(!mBufferObjectPointerVector.empty())
         indices_ptr = (const GLvoid**)&mBufferObjectPointerVector[0];
       }
       else
       {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        bindIndexBuffer(gl_context, 0);
         VL_CHECK(!mPointerVector.empty())
         indices_ptr = (const GLvoid**)&mPointerVector[0];
       }
@@ -240,7 +242,7 @@ namespace vl
         VL_CHECK( baseVertices().size() == countVector().size() )
         if (Has_GL_ARB_draw_elements_base_vertex||Has_GL_Version_3_1||Has_GL_Version_4_0)
         {
-          glMultiDrawElementsBaseVertex( primitiveType(), (GLsizei*)&mCountVector[0], indexBuffer()->glType(), indices_ptr, (GLsizei)mCountVector.size(), (GLint*)&mBaseVertices[0] ); VL_CHECK_OGL()
+          gl._glMultiDrawElementsBaseVertex( primitiveType(), (GLsizei*)&mCountVector[0], indexBuffer()->glType(), indices_ptr, (GLsizei)mCountVector.size(), (GLint*)&mBaseVertices[0] ); VL_CHECK_OGL()
         }
         else
         {
@@ -251,18 +253,33 @@ namespace vl
       }
       else
       {
-        glMultiDrawElements( primitiveType(), (GLsizei*)&mCountVector[0], indexBuffer()->glType(), (const GLvoid**)indices_ptr, (GLsizei)mCountVector.size() ); VL_CHECK_OGL()
+        gl._glMultiDrawElements( primitiveType(), (GLsizei*)&mCountVector[0], indexBuffer()->glType(), (const GLvoid**)indices_ptr, (GLsizei)mCountVector.size() ); VL_CHECK_OGL()
       }
 
       // primitive restart disable
       if(primitiveRestartEnabled())
       {
-        glDisable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL()
+        gl._glDisable(GL_PRIMITIVE_RESTART); VL_CHECK_OGL()
       }
     }
 
     TriangleIterator triangleIterator() const;
 
+    bool indexSpans(IndexSpans& spans) const
+    {
+      spans.mPrimType         = primitiveType();
+      // nothing to traverse if the local index buffer is not available
+      if ( !mIndexBuffer || !mIndexBuffer->ptr() )
+        return true;
+      spans.mIndexType        = arr_type::gl_type;
+      spans.mIndices          = mIndexBuffer->ptr();
+      spans.mpCounts          = &mCountVector;
+      spans.mpBaseVertices    = &mBaseVertices;
+      spans.mPrimRestartOn    = primitiveRestartEnabled();
+      spans.mPrimRestartIndex = primitive_restart_index;
+      return true;
+    }
+
     IndexIterator indexIterator() const
     {
       ref< IndexIteratorElements<arr_type> > iie = new IndexIteratorElements<arr_type>;
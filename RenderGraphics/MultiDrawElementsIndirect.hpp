@@ -0,0 +1,278 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+#ifndef MultiDrawElementsIndirect_INCLUDE_ONCE
+#define MultiDrawElementsIndirect_INCLUDE_ONCE
+
+#include <vlGraphics/DrawCall.hpp>
+#include <vlGraphics/Array.hpp>
+#include <vlGraphics/TriangleIterator.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+
+namespace vl
+{
+  //------------------------------------------------------------------------------
+  // MultiDrawElementsIndirect
+  //------------------------------------------------------------------------------
+  /**
+   * Wrapper for the OpenGL function glMultiDrawElementsIndirect(). See vl::DrawCall for an overview of the different draw call methods.
+   *
+   * This class wraps the following OpenGL functions:
+   * - glMultiDrawElementsIndirect (http://www.opengl.org/sdk/docs/man4/xhtml/glMultiDrawElementsIndirect.xml)
+   *
+   * Supports:
+   * - <b>Multi instancing</b>: NO
+   * - <b>Base vertex</b>: YES
+   * - <b>Primitive restart</b>: NO
+   *
+   * Every draw reads \p count indices of type \p GLuint starting at its own first index of the shared indexBuffer() and adds its own base vertex to them.
+   * The draws are stored in the commandBuffer() as DrawElementsIndirectCommand structures, the base instance of each draw is set to its
+   * position in the command list so that a GLSL program can fetch per-draw data, for example the model matrix, from the drawDataBuffer()
+   * which is bound as a shader storage buffer to the binding point drawDataBinding() using either \p gl_BaseInstanceARB or \p gl_DrawIDARB
+   * (GL_ARB_shader_draw_parameters).
+   *
+   * Call addDraw() for each draw and then finalizeSetup() to update the command buffer. Requires OpenGL 4.3 and BufferObjects.
+   * This draw call is used by BatchingRenderer to merge many compatible Geometry draws into a single OpenGL call.
+   * @sa Geometry::drawCalls(), DrawCall, MultiDrawElements, BatchingRenderer */
+  class MultiDrawElementsIndirect: public DrawCall
+  {
+    VL_INSTRUMENT_CLASS(vl::MultiDrawElementsIndirect, DrawCall)
+
+  public:
+    MultiDrawElementsIndirect(EPrimitiveType primitive = PT_TRIANGLES)
+    {
+      VL_DEBUG_SET_OBJECT_NAME()
+      mType            = primitive;
+      mIndexBuffer     = new ArrayUInt1;
+      mCommandBuffer   = new ArrayUInt1;
+      mDrawDataBinding = 0;
+    }
+
+    MultiDrawElementsIndirect& operator=(const MultiDrawElementsIndirect& other)
+    {
+      super::operator=(other);
+      *indexBuffer() = *other.indexBuffer();
+      mFirstIndices    = other.mFirstIndices;
+      mCountVector     = other.mCountVector;
+      mBaseVertices    = other.mBaseVertices;
+      mDrawData        = other.mDrawData;
+      mDrawDataBinding = other.mDrawDataBinding;
+      finalizeSetup();
+      return *this;
+    }
+
+    virtual ref<DrawCall> clone() const
+    {
+      ref<MultiDrawElementsIndirect> de = new MultiDrawElementsIndirect;
+      *de = *this;
+      return de;
+    }
+
+    void setIndexBuffer(ArrayUInt1* index_buffer) { mIndexBuffer = index_buffer; }
+
+    ArrayUInt1* indexBuffer() { return mIndexBuffer.get(); }
+
+    const ArrayUInt1* indexBuffer() const { return mIndexBuffer.get(); }
+
+    /** The buffer containing the DrawElementsIndirectCommand structures, 5 GLuint per draw, computed by finalizeSetup(). */
+    ArrayUInt1* commandBuffer() { return mCommandBuffer.get(); }
+
+    /** The buffer containing the DrawElementsIndirectCommand structures, 5 GLuint per draw, computed by finalizeSetup(). */
+    const ArrayUInt1* commandBuffer() const { return mCommandBuffer.get(); }
+
+    /** The per-draw data bound as a shader storage buffer while rendering, can be NULL. */
+    void setDrawDataBuffer(ArrayAbstract* draw_data) { mDrawData = draw_data; }
+
+    /** The per-draw data bound as a shader storage buffer while rendering, can be NULL. */
+    ArrayAbstract* drawDataBuffer() { return mDrawData.get(); }
+
+    /** The per-draw data bound as a shader storage buffer while rendering, can be NULL. */
+    const ArrayAbstract* drawDataBuffer() const { return mDrawData.get(); }
+
+    /** The shader storage buffer binding point of the drawDataBuffer() (default = 0). */
+    void setDrawDataBinding(int binding) { mDrawDataBinding = binding; }
+
+    /** The shader storage buffer binding point of the drawDataBuffer() (default = 0). */
+    int drawDataBinding() const { return mDrawDataBinding; }
+
+    /** Removes all the draws. Call finalizeSetup() once the new draws have been added. */
+    void clearDraws()
+    {
+      mFirstIndices.clear();
+      mCountVector.clear();
+      mBaseVertices.clear();
+    }
+
+    /** Adds a draw reading \p count indices starting at \p first_index and returns its position, which is also its base instance. */
+    int addDraw(GLsizei count, GLint first_index, GLint base_vertex)
+    {
+      mFirstIndices.push_back(first_index);
+      mCountVector.push_back(count);
+      mBaseVertices.push_back(base_vertex);
+      return (int)mCountVector.size() - 1;
+    }
+
+    /** The number of draws issued by a single render() call. */
+    int drawCount() const { return (int)mCountVector.size(); }
+
+    /** The first index of each draw. */
+    const std::vector<GLint>& firstIndices() const { return mFirstIndices; }
+
+    /** The number of indices of each draw. */
+    const std::vector<GLsizei>& countVector() const { return mCountVector; }
+
+    /** The base vertex of each draw. */
+    const std::vector<GLint>& baseVertices() const { return mBaseVertices; }
+
+    /** Writes the draws into the commandBuffer(), which is marked dirty only if its content changed.
+      * @note Must be called after the draws have been added. */
+    void finalizeSetup()
+    {
+      const size_t words = mCountVector.size() * 5;
+      bool changed = commandBuffer()->size() != words;
+      if (changed)
+        commandBuffer()->resize(words);
+      for(size_t i=0; i<mCountVector.size(); ++i)
+      {
+        const GLuint cmd[] = { (GLuint)mCountVector[i], 1, (GLuint)mFirstIndices[i], (GLuint)mBaseVertices[i], (GLuint)i };
+        GLuint* dst = commandBuffer()->begin() + i*5;
+        if ( changed || memcmp(dst, cmd, sizeof(cmd)) != 0 )
+        {
+          memcpy(dst, cmd, sizeof(cmd));
+          changed = true;
+        }
+      }
+      if (changed)
+        commandBuffer()->setBufferObjectDirty(true);
+    }
+
+    virtual void updateDirtyBufferObject(EBufferObjectUpdateMode mode)
+    {
+      if (indexBuffer()->isBufferObjectDirty() || (mode & BUF_ForceUpdate))
+        indexBuffer()->updateBufferObject(mode);
+      // the command buffer is always used from the GPU
+      if (commandBuffer()->isBufferObjectDirty() || (mode & BUF_ForceUpdate))
+        commandBuffer()->updateBufferObject(BUM_KeepRamBuffer);
+      if (drawDataBuffer() && (drawDataBuffer()->isBufferObjectDirty() || (mode & BUF_ForceUpdate)))
+        drawDataBuffer()->updateBufferObject(BUM_KeepRamBuffer);
+    }
+
+    virtual void deleteBufferObject()
+    {
+      indexBuffer()->bufferObject()->deleteBufferObject();
+      commandBuffer()->bufferObject()->deleteBufferObject();
+      if (drawDataBuffer())
+        drawDataBuffer()->bufferObject()->deleteBufferObject();
+    }
+
+    virtual void render(bool use_bo, OpenGLContext* gl_context) const
+    {
+      VL_CHECK_OGL()
+      VL_CHECK(Has_GL_Version_4_3)
+      if ( mCountVector.empty() )
+        return;
+
+      if ( !use_bo || !Has_BufferObject || !indexBuffer()->bufferObject()->handle() || !commandBuffer()->bufferObject()->handle() )
+      {
+        vl::Log::error("MultiDrawElementsIndirect::render(): the index and command BufferObjects are required!\n");
+        return;
+      }
+
+      const OpenGLFunctions& gl = glFunctions(gl_context);
+
+      // apply patch parameters if any and if using PT_PATCHES
+      applyPatchParameters();
+
+      bindIndexBuffer(gl_context, indexBuffer()->bufferObject()->handle());
+
+      if (gl_context)
+      {
+        gl_context->bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer()->bufferObject()->handle());
+      }
+      else
+      {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer()->bufferObject()->handle()); VL_CHECK_OGL()
+        forgetBufferTarget(GL_DRAW_INDIRECT_BUFFER);
+      }
+
+      if (drawDataBuffer() && drawDataBuffer()->bufferObject()->handle())
+      {
+        gl._glBindBufferBase(GL_SHADER_STORAGE_BUFFER, drawDataBinding(), drawDataBuffer()->bufferObject()->handle()); VL_CHECK_OGL()
+      }
+
+      gl._glMultiDrawElementsIndirect( primitiveType(), GL_UNSIGNED_INT, 0, (GLsizei)mCountVector.size(), 0 ); VL_CHECK_OGL()
+    }
+
+    TriangleIterator triangleIterator() const
+    {
+      ref< TriangleIteratorMulti<ArrayUInt1> > it =
+        new TriangleIteratorMulti<ArrayUInt1>( &mBaseVertices, &mCountVector, mIndexBuffer.get(), primitiveType(), false, 0, &mFirstIndices );
+      it->initialize();
+      return TriangleIterator(it.get());
+    }
+
+    bool indexSpans(IndexSpans& spans) const
+    {
+      spans.mPrimType       = primitiveType();
+      // nothing to traverse if the local index buffer is not available
+      if ( !mIndexBuffer || !mIndexBuffer->ptr() )
+        return true;
+      spans.mIndexType      = GL_UNSIGNED_INT;
+      spans.mIndices        = mIndexBuffer->ptr();
+      spans.mpCounts        = &mCountVector;
+      spans.mpFirstIndices  = &mFirstIndices;
+      spans.mpBaseVertices  = &mBaseVertices;
+      return true;
+    }
+
+    IndexIterator indexIterator() const
+    {
+      ref< IndexIteratorIndirect<ArrayUInt1> > iii = new IndexIteratorIndirect<ArrayUInt1>;
+      iii->initialize( mIndexBuffer.get(), &mFirstIndices, &mCountVector, &mBaseVertices );
+      IndexIterator iit;
+      iit.initialize( iii.get() );
+      return iit;
+    }
+
+  protected:
+    ref<ArrayUInt1> mIndexBuffer;
+    ref<ArrayUInt1> mCommandBuffer;
+    ref<ArrayAbstract> mDrawData;
+    std::vector<GLint>   mFirstIndices;
+    std::vector<GLsizei> mCountVector;
+    std::vector<GLint>   mBaseVertices;
+    int mDrawDataBinding;
+  };
+  //------------------------------------------------------------------------------
+}
+
+#endif
@@ -185,9 +185,8 @@ void OcclusionCullRenderer::render_pass1(const RenderQueue* in_render_queue )
 
     if (occluded == false)
     {
-      // pass over the incoming render token to the list of visible objects
-      RenderToken* tok = mCulledRenderQueue->newToken(false);
-      *tok = *in_render_queue->at(i);
+      // pass over the incoming render token and its passes to the list of visible objects
+      mCulledRenderQueue->appendToken(in_render_queue, i);
     }
     else
       mStatsOccludedObjects++;
@@ -107,6 +107,8 @@ namespace vl
     #define VL_GL_FUNCTION(TYPE, NAME) TYPE NAME = NULL;
     #include <vlGraphics/GL/GLFunctionList.hpp>
     #undef VL_GL_FUNCTION
+
+    OpenGLFunctions GL_Functions;
   #endif
 
   const GLenum Translate_Enable[] =
@@ -312,7 +314,7 @@ bool vl::initializeOpenGL(const OpenGLFunctions* gl)
   gl->_glGetError();
 
   // check OpenGL context is present
-  if (glGetError() != GL_NO_ERROR)
+  if (gl->_glGetError() != GL_NO_ERROR)
     return false;
 
   // - - - OpenGL function pointers - - -
@@ -320,16 +322,20 @@ bool vl::initializeOpenGL(const OpenGLFunctions* gl)
   // MIC FIXME: remove this and use OpenGLFunctions -> OpenGLContext::mGL instead
   
   // Globally accessible OpenGL functions - INITIALIZE
+  // They mirror the context's function table so that OpenGLContext subclasses providing their own table (see RecordingOpenGLContext) are honored.
   #if defined(VL_OPENGL)
-    #define VL_GL_FUNCTION(TYPE, NAME) NAME = (TYPE)getGLProcAddress(#NAME);
+    #define VL_GL_FUNCTION(TYPE, NAME) NAME = gl->_##NAME;
     #include <vlGraphics/GL/GLFunctionList.hpp>
+    #undef VL_GL_FUNCTION
+
+    GL_Functions = *gl;
   #endif
 
   // - - - OpenGL versions - - -
 
   // GL versions
   // OpenGL ES returns "OpenGL ES-XX N.M"
-  const char* version_string = (const char*)glGetString(GL_VERSION);
+  const char* version_string = (const char*)gl->_glGetString(GL_VERSION);
 
   const int vmaj = version_string[0] - '0';
   const int vmin = version_string[2] - '0';
@@ -339,7 +345,7 @@ bool vl::initializeOpenGL(const OpenGLFunctions* gl)
   if( vmaj >= 3 )
   {
     int forward_compatible = 0;
-    glGetIntegerv( GL_CONTEXT_FLAGS, &forward_compatible ); VL_CHECK_OGL();
+    gl->_glGetIntegerv( GL_CONTEXT_FLAGS, &forward_compatible ); VL_CHECK_OGL();
     Is_OpenGL_Forward_Compatible = (forward_compatible & GL_CONTEXT_FLAG_FORWARD_COMPATIBLE_BIT) != 0;
   }
 
@@ -357,7 +363,7 @@ bool vl::initializeOpenGL(const OpenGLFunctions* gl)
     // - Creating a context in the old way returns the highest compatible OpenGL version available thus the presence 
     //   of CONTEXT_COMPATIBILITY_PROFILE_BIT is not enough, we need to check the absence of CONTEXT_CORE_PROFILE_BIT
     int context_flags = 0;
-    glGetIntegerv( CONTEXT_PROFILE_MASK, &context_flags ); VL_CHECK_OGL();
+    gl->_glGetIntegerv( CONTEXT_PROFILE_MASK, &context_flags ); VL_CHECK_OGL();
     Is_OpenGL_Core_Profile = (context_flags & CONTEXT_CORE_PROFILE_BIT) != 0;
   }
 
@@ -476,7 +482,7 @@ bool vl::initializeOpenGL(const OpenGLFunctions* gl)
   
   // Clipping planes
   int max_clip_planes = 0;
-  glGetIntegerv(GL_MAX_CLIP_DISTANCES, &max_clip_planes); // GL_MAX_CLIP_DISTANCES == GL_MAX_CLIP_PLANES
+  gl->_glGetIntegerv(GL_MAX_CLIP_DISTANCES, &max_clip_planes); // GL_MAX_CLIP_DISTANCES == GL_MAX_CLIP_PLANES
   Is_Enable_Supported[EN_CLIP_DISTANCE0] = max_clip_planes >= 1;
   Is_Enable_Supported[EN_CLIP_DISTANCE1] = max_clip_planes >= 2;
   Is_Enable_Supported[EN_CLIP_DISTANCE2] = max_clip_planes >= 3;
@@ -504,8 +510,8 @@ bool vl::initializeOpenGL(const OpenGLFunctions* gl)
   bool got_error = false;
   for(int i=0; i<EN_EnableCount; ++i)
   {
-    glDisable(Translate_Enable[i]); // glIsEnabled() for some reason is not reliable!
-    bool supported = glGetError() == GL_NO_ERROR;
+    gl->_glDisable(Translate_Enable[i]); // glIsEnabled() for some reason is not reliable!
+    bool supported = gl->_glGetError() == GL_NO_ERROR;
     if (supported != Is_Enable_Supported[i])
     {
       Log::error( Say("%s: capability %s supported! This is a harmless glitch either in your GL driver or in VL.\n") << Translate_Enable_String[i] << (supported? "*IS*" : "*IS NOT*") );
@@ -514,7 +520,7 @@ bool vl::initializeOpenGL(const OpenGLFunctions* gl)
   }
   if(got_error)
   {
-    printf("OpenGL Version = %s\n", glGetString(GL_VERSION));
+    printf("OpenGL Version = %s\n", gl->_glGetString(GL_VERSION));
     #define PRINT_INFO(STRING) printf(#STRING" = %d\n", STRING?1:0)
     PRINT_INFO(Is_OpenGL_Core_Profile);
     PRINT_INFO(Is_OpenGL_Forward_Compatible);
@@ -585,9 +591,12 @@ std::string vl::getOpenGLExtensions(const vl::OpenGLFunctions* gl)
 //------------------------------------------------------------------------------
 int vl::glcheck(const char* file, int line)
 {
-  unsigned int glerr = glGetError();
+  // before the first initializeOpenGL() the function table is still empty
+  decltype(glGetError)* get_error = GL_Functions._glGetError ? GL_Functions._glGetError : &glGetError;
+
+  unsigned int glerr = get_error();
   // if an OpenGL context is available this must be clear!
-  if ( glGetError() )
+  if ( get_error() )
   {
     Log::bug( Say("%s:%n: NO OPENGL CONTEXT ACTIVE!\n") << file << line );
   }
@@ -141,6 +141,11 @@ namespace vl
     #undef VL_GL_FUNCTION
     void initFunctions();
   };
+
+  //! The function table passed to the last vl::initializeOpenGL() call. The OpenGL 1.1 calls issued where no OpenGLContext is at hand,
+  //! like VL_CHECK_OGL() and Viewport::activate(), go through it so that they reach the table of OpenGLContext subclasses providing
+  //! their own (see RecordingOpenGLContext) and are counted by GLCallCounter.
+  VLGRAPHICS_EXPORT extern OpenGLFunctions GL_Functions;
 #endif
 
   //-----------------------------------------------------------------------------
@@ -157,6 +162,24 @@ namespace vl
   VLGRAPHICS_EXPORT const char* getGLErrorString(int err);
 
   VLGRAPHICS_EXPORT std::string getOpenGLExtensions(const OpenGLFunctions* gl);
+
+  //! Forgets \p texture in the binding shadow of every OpenGLContext, to be called when deleting a texture since OpenGL
+  //! reverts its bindings to 0 and may reuse its name. See OpenGLContext::forgetTexture().
+  VLGRAPHICS_EXPORT void forgetTextureBindings(GLuint texture);
+
+  //! Forgets \p buffer in the binding shadow of every OpenGLContext, to be called when deleting a buffer object.
+  //! See OpenGLContext::forgetBuffer().
+  VLGRAPHICS_EXPORT void forgetBufferBindings(GLuint buffer);
+
+  //! Forgets the buffer bound to \p target in the binding shadow of every OpenGLContext, to be called after binding a buffer
+  //! with glBindBuffer() instead of OpenGLContext::bindBuffer(), for example where no OpenGLContext is at hand.
+  //! For GL_UNIFORM_BUFFER the indexed binding points are forgotten too, to be used after glBindBufferRange() as well.
+  VLGRAPHICS_EXPORT void forgetBufferTarget(GLenum target);
+
+  //! Forgets the texture bound to the active texture unit in the binding shadow of every OpenGLContext, to be called after binding
+  //! a texture with glBindTexture() instead of OpenGLContext::bindTexture(). Pass \p unit_changed = true if glActiveTexture() was
+  //! called directly too: the active unit and the textures bound to every unit are then forgotten.
+  VLGRAPHICS_EXPORT void forgetActiveTextureUnit(bool unit_changed=false);
   
   //-----------------------------------------------------------------------------
   // VL_CHECK_OGL
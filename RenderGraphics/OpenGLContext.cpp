@@ -41,10 +41,18 @@
 #include <vlCore/Say.hpp>
 #include <algorithm>
 #include <sstream>
+#include <mutex>
 #include <vlGraphics/NaryQuickMap.hpp>
 
 using namespace vl;
 
+namespace
+{
+  // the live OpenGLContext[s], used to forget the bindings of deleted objects
+  std::mutex gContextsMutex;
+  std::vector<OpenGLContext*> gContexts;
+}
+
 //-----------------------------------------------------------------------------
 // UIEventListener
 //-----------------------------------------------------------------------------
@@ -77,6 +85,9 @@ OpenGLContext::OpenGLContext(int w, int h)
   mCurVAS = NULL;
   mGLSLUpdated = true;
 
+  invalidateStateShadow();
+  resetStateCallCounters();
+
   mNormal = fvec3(0,1,0);
   mColor  = fvec4(1,1,1,1);
   mSecondaryColor = fvec3(1,1,1);
@@ -87,10 +98,18 @@ OpenGLContext::OpenGLContext(int w, int h)
   mContinuousUpdate = true;
   mIgnoreNextMouseMoveEvent = false;
   mFullscreen = false;
+
+  std::lock_guard<std::mutex> lock( gContextsMutex );
+  gContexts.push_back( this );
 }
 //-----------------------------------------------------------------------------
 OpenGLContext::~OpenGLContext()
 {
+  {
+    std::lock_guard<std::mutex> lock( gContextsMutex );
+    gContexts.erase( std::remove( gContexts.begin(), gContexts.end(), this ), gContexts.end() );
+  }
+
   if ( mLeftFramebuffer || mRightFramebuffer || mFramebufferObject.size() || mEventListeners.size() )
   {
     Log::warning("~OpenGLContext() called before dispatchDestroyEvent(), your application will likely crash.\n");
@@ -237,7 +256,7 @@ bool OpenGLContext::initGLContext(bool log)
 
   makeCurrent();
 
-  mGL.initFunctions();
+  initGLFunctions();
 
   // init OpenGL extensions
   if (!initializeOpenGL(&mGL))
@@ -505,6 +524,7 @@ void OpenGLContext::applyEnables( const EnableSet* new_enables )
       mNewEnableSet->append(capability);
       if(!mCurrentEnableSet->hasKey(capability))
       {
+        ++mIssuedStateCalls[SC_Enable];
         mGL._glEnable( Translate_Enable[capability] );
         #ifndef NDEBUG
           if (mGL._glGetError() != GL_NO_ERROR)
@@ -513,6 +533,10 @@ void OpenGLContext::applyEnables( const EnableSet* new_enables )
           }
         #endif
       }
+      else
+      {
+        ++mSuppressedStateCalls[SC_Enable];
+      }
     }
   }
 
@@ -520,6 +544,7 @@ void OpenGLContext::applyEnables( const EnableSet* new_enables )
   {
     if (!mNewEnableSet->hasKey(*capability))
     {
+      ++mIssuedStateCalls[SC_Enable];
       mGL._glDisable( Translate_Enable[*capability] );
       #ifndef NDEBUG
         if (mGL._glGetError() != GL_NO_ERROR)
@@ -549,8 +574,13 @@ void OpenGLContext::applyRenderStates( const RenderStateSet* new_rs, const Camer
       if ( ! mCurrentRenderStateSet->hasKey(rs.type()) || rs.mRS.get() != mCurrentRenderStateSet->valueFromKey( rs.type() ).mRS.get() )
       {
         VL_CHECK(rs.mRS.get());
+        ++mIssuedStateCalls[SC_RenderState];
         rs.apply(camera, this); VL_CHECK_OGL()
       }
+      else
+      {
+        ++mSuppressedStateCalls[SC_RenderState];
+      }
     }
   }
 
@@ -558,6 +588,7 @@ void OpenGLContext::applyRenderStates( const RenderStateSet* new_rs, const Camer
   {
     if ( ! mNewRenderStateSet->hasKey( rs->type() ) )
     {
+      ++mIssuedStateCalls[SC_RenderState];
       mDefaultRenderStates[rs->type()].apply(NULL, this); VL_CHECK_OGL()
     }
   }
@@ -1225,7 +1256,10 @@ void OpenGLContext::resetContextStates(EResetContextStates start_or_finish)
   if (globalSettings()->checkOpenGLStates())
     isCleanState(true);
 
-  glBindFramebuffer( GL_FRAMEBUFFER, 0 ); VL_CHECK_OGL();
+  // the application might have changed any binding since the last rendering
+  invalidateStateShadow();
+
+  bindFramebuffer( GL_FRAMEBUFFER, 0 );
 
   // not existing under OpenGL ES 1 and 2
 #if defined(VL_OPENGL)
@@ -1274,7 +1308,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
       if ( use_bo && vas->vertexArray()->bufferObject()->handle() )
       {
         buf_obj = vas->vertexArray()->bufferObject()->handle();
-        ptr = 0;
+        ptr = (const unsigned char*)(size_t)vas->vertexArray()->bufferObject()->handleOffset();
       }
       else
       {
@@ -1287,11 +1321,8 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
         {
           mGL._glEnableClientState(GL_VERTEX_ARRAY); VL_CHECK_OGL();
         }
-        // mic fixme:
-        // Note: for the moment we threat glBindBuffer and glVertexPointer as an atomic operation.
-        // In the future we'll want to eliminate all direct calls to glBindBuffer and similar an
-        // go through the OpenGLContext that will lazily do everything.
-        glBindBuffer(GL_ARRAY_BUFFER, buf_obj); VL_CHECK_OGL();
+        // Note: the buffer binding is filtered by the state shadow, glVertexPointer is skipped by the lazy array state above.
+        bindBuffer(GL_ARRAY_BUFFER, buf_obj);
         mGL._glVertexPointer((int)vas->vertexArray()->glSize(), vas->vertexArray()->glType(), /*stride*/0, ptr); VL_CHECK_OGL();
         mVertexArray.mPtr = ptr;
         mVertexArray.mBufferObject = buf_obj;
@@ -1316,7 +1347,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
       if ( use_bo && vas->normalArray()->bufferObject()->handle() )
       {
         buf_obj = vas->normalArray()->bufferObject()->handle();
-        ptr = 0;
+        ptr = (const unsigned char*)(size_t)vas->normalArray()->bufferObject()->handleOffset();
       }
       else
       {
@@ -1329,7 +1360,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
         {
           mGL._glEnableClientState(GL_NORMAL_ARRAY); VL_CHECK_OGL();
         }
-        glBindBuffer(GL_ARRAY_BUFFER, buf_obj); VL_CHECK_OGL();
+        bindBuffer(GL_ARRAY_BUFFER, buf_obj);
         mGL._glNormalPointer(vas->normalArray()->glType(), /*stride*/0, ptr); VL_CHECK_OGL();
         mNormalArray.mPtr = ptr;
         mNormalArray.mBufferObject = buf_obj;
@@ -1358,7 +1389,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
       if ( use_bo && vas->colorArray()->bufferObject()->handle() )
       {
         buf_obj = vas->colorArray()->bufferObject()->handle();
-        ptr = 0;
+        ptr = (const unsigned char*)(size_t)vas->colorArray()->bufferObject()->handleOffset();
       }
       else
       {
@@ -1371,7 +1402,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
         {
           mGL._glEnableClientState(GL_COLOR_ARRAY); VL_CHECK_OGL();
         }
-        glBindBuffer(GL_ARRAY_BUFFER, buf_obj); VL_CHECK_OGL();
+        bindBuffer(GL_ARRAY_BUFFER, buf_obj);
         mGL._glColorPointer((int)vas->colorArray()->glSize(), vas->colorArray()->glType(), /*stride*/0, ptr); VL_CHECK_OGL();
         mColorArray.mPtr = ptr;
         mColorArray.mBufferObject = buf_obj;
@@ -1400,7 +1431,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
       if ( use_bo && vas->secondaryColorArray()->bufferObject()->handle() )
       {
         buf_obj = vas->secondaryColorArray()->bufferObject()->handle();
-        ptr = 0;
+        ptr = (const unsigned char*)(size_t)vas->secondaryColorArray()->bufferObject()->handleOffset();
       }
       else
       {
@@ -1413,7 +1444,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
         {
           mGL._glEnableClientState(GL_SECONDARY_COLOR_ARRAY); VL_CHECK_OGL();
         }
-        glBindBuffer(GL_ARRAY_BUFFER, buf_obj); VL_CHECK_OGL();
+        bindBuffer(GL_ARRAY_BUFFER, buf_obj);
         mGL._glSecondaryColorPointer((int)vas->secondaryColorArray()->glSize(), vas->secondaryColorArray()->glType(), /*stride*/0, ptr); VL_CHECK_OGL();
         mSecondaryColorArray.mPtr = ptr;
         mSecondaryColorArray.mBufferObject = buf_obj;
@@ -1442,7 +1473,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
       if ( use_bo && vas->fogCoordArray()->bufferObject()->handle() )
       {
         buf_obj = vas->fogCoordArray()->bufferObject()->handle();
-        ptr = 0;
+        ptr = (const unsigned char*)(size_t)vas->fogCoordArray()->bufferObject()->handleOffset();
       }
       else
       {
@@ -1455,7 +1486,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
         {
           mGL._glEnableClientState(GL_FOG_COORD_ARRAY); VL_CHECK_OGL();
         }
-        glBindBuffer(GL_ARRAY_BUFFER, buf_obj); VL_CHECK_OGL();
+        bindBuffer(GL_ARRAY_BUFFER, buf_obj);
         mGL._glFogCoordPointer(vas->fogCoordArray()->glType(), /*stride*/0, ptr); VL_CHECK_OGL();
         mFogArray.mPtr = ptr;
         mFogArray.mBufferObject = buf_obj;
@@ -1495,7 +1526,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
       if ( use_bo && texarr->bufferObject()->handle() )
       {
         buf_obj = texarr->bufferObject()->handle();
-        ptr = 0;
+        ptr = (const unsigned char*)(size_t)texarr->bufferObject()->handleOffset();
       }
       else
       {
@@ -1507,7 +1538,7 @@ void OpenGLContext::bindVAS_Fixed(const IVertexAttribSet* vas, bool use_bo) {
         mTexCoordArray[tex_coord_i].mPtr = ptr;
         mTexCoordArray[tex_coord_i].mBufferObject = buf_obj;
 
-        glBindBuffer(GL_ARRAY_BUFFER, buf_obj); VL_CHECK_OGL();
+        bindBuffer(GL_ARRAY_BUFFER, buf_obj);
         mGL._glTexCoordPointer((int)texarr->glSize(), texarr->glType(), 0/*texarr->stride()*/, ptr/*+ texarr->offset()*/); VL_CHECK_OGL();
       }
     }
@@ -1557,7 +1588,7 @@ void OpenGLContext::bindVAS_Attribs(const IVertexAttribSet* vas, bool use_bo) {
       if ( use_bo && arr->bufferObject()->handle() )
       {
         buf_obj = arr->bufferObject()->handle();
-        ptr = 0;
+        ptr = (const unsigned char*)(size_t)arr->bufferObject()->handleOffset();
       }
       else
       {
@@ -1568,7 +1599,7 @@ void OpenGLContext::bindVAS_Attribs(const IVertexAttribSet* vas, bool use_bo) {
       {
         mVertexAttrib[idx].mPtr = ptr;
         mVertexAttrib[idx].mBufferObject = buf_obj;
-        glBindBuffer(GL_ARRAY_BUFFER, buf_obj); VL_CHECK_OGL();
+        bindBuffer(GL_ARRAY_BUFFER, buf_obj);
 
         if ( arr->interpretation() == VAI_NORMAL )
         {
@@ -1635,9 +1666,9 @@ void OpenGLContext::bindVAS_Reset()
   // reset all gl states
 
   // note this one
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); VL_CHECK_OGL();
+  bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0); VL_CHECK_OGL();
+  bindBuffer(GL_ARRAY_BUFFER, 0);
 
   if(Has_Fixed_Function_Pipeline)
   {
@@ -1738,19 +1769,139 @@ void OpenGLContext::useGLSLProgram(const GLSLProgram* glsl)
     // bind the GLSL program
     if ( ok )
     {
-      glUseProgram( glsl->handle() ); VL_CHECK_OGL()
+      useProgram( glsl->handle() );
       mGLSLProgram = glsl;
     }
     else
     {
-      glUseProgram( 0 ); VL_CHECK_OGL()
+      useProgram( 0 );
       mGLSLProgram = NULL;
     }
   }
   else
   {
-    glUseProgram( 0 ); VL_CHECK_OGL();
+    useProgram( 0 );
     mGLSLProgram = NULL;
   }
 }
 //-----------------------------------------------------------------------------
+void OpenGLContext::invalidateStateShadow()
+{
+  for( int i=0; i<VL_MAX_TEXTURE_IMAGE_UNITS; ++i )
+  {
+    mTextureShadow[i].mTarget = TD_TEXTURE_UNKNOWN;
+    mTextureShadow[i].mHandle = ShadowUnknown;
+  }
+  for( int i=0; i<BufferShadowCount; ++i )
+    mBufferShadow[i] = ShadowUnknown;
+  for( int i=0; i<UniformBufferShadowCount; ++i )
+  {
+    mUniformBufferShadow[i].mHandle = ShadowUnknown;
+    mUniformBufferShadow[i].mOffset = 0;
+    mUniformBufferShadow[i].mSize   = 0;
+  }
+  mDrawFramebufferShadow = ShadowUnknown;
+  mReadFramebufferShadow = ShadowUnknown;
+  mProgramShadow = ShadowUnknown;
+  mActiveTexture = -1;
+}
+//-----------------------------------------------------------------------------
+void OpenGLContext::forgetTexture(GLuint texture)
+{
+  for( int i=0; i<VL_MAX_TEXTURE_IMAGE_UNITS; ++i )
+  {
+    if ( mTextureShadow[i].mHandle == texture )
+    {
+      mTextureShadow[i].mTarget = TD_TEXTURE_UNKNOWN;
+      mTextureShadow[i].mHandle = ShadowUnknown;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void OpenGLContext::forgetBuffer(GLuint buffer)
+{
+  for( int i=0; i<BufferShadowCount; ++i )
+  {
+    if ( mBufferShadow[i] == buffer )
+      mBufferShadow[i] = ShadowUnknown;
+  }
+  for( int i=0; i<UniformBufferShadowCount; ++i )
+  {
+    if ( mUniformBufferShadow[i].mHandle == buffer )
+    {
+      mUniformBufferShadow[i].mHandle = ShadowUnknown;
+      mUniformBufferShadow[i].mOffset = 0;
+      mUniformBufferShadow[i].mSize   = 0;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void OpenGLContext::forgetBufferTarget(GLenum target)
+{
+  GLuint* shadow = bufferShadow(target);
+  if ( shadow )
+    *shadow = ShadowUnknown;
+  // glBindBufferRange() and glBindBufferBase() bind the generic and the indexed binding points at once
+  if ( target == GL_UNIFORM_BUFFER )
+  {
+    for( int i=0; i<UniformBufferShadowCount; ++i )
+    {
+      mUniformBufferShadow[i].mHandle = ShadowUnknown;
+      mUniformBufferShadow[i].mOffset = 0;
+      mUniformBufferShadow[i].mSize   = 0;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void OpenGLContext::forgetActiveTextureUnit(bool unit_changed)
+{
+  if ( unit_changed )
+    mActiveTexture = -1;
+  // with the active unit unknown any of them might have been bound
+  for( int i=0; i<VL_MAX_TEXTURE_IMAGE_UNITS; ++i )
+  {
+    if ( mActiveTexture < 0 || i == mActiveTexture )
+    {
+      mTextureShadow[i].mTarget = TD_TEXTURE_UNKNOWN;
+      mTextureShadow[i].mHandle = ShadowUnknown;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void vl::forgetTextureBindings(GLuint texture)
+{
+  std::lock_guard<std::mutex> lock( gContextsMutex );
+  for( size_t i=0; i<gContexts.size(); ++i )
+    gContexts[i]->forgetTexture( texture );
+}
+//-----------------------------------------------------------------------------
+void vl::forgetBufferBindings(GLuint buffer)
+{
+  std::lock_guard<std::mutex> lock( gContextsMutex );
+  for( size_t i=0; i<gContexts.size(); ++i )
+    gContexts[i]->forgetBuffer( buffer );
+}
+//-----------------------------------------------------------------------------
+void vl::forgetBufferTarget(GLenum target)
+{
+  std::lock_guard<std::mutex> lock( gContextsMutex );
+  for( size_t i=0; i<gContexts.size(); ++i )
+    gContexts[i]->forgetBufferTarget( target );
+}
+//-----------------------------------------------------------------------------
+void vl::forgetActiveTextureUnit(bool unit_changed)
+{
+  std::lock_guard<std::mutex> lock( gContextsMutex );
+  for( size_t i=0; i<gContexts.size(); ++i )
+    gContexts[i]->forgetActiveTextureUnit( unit_changed );
+}
+//-----------------------------------------------------------------------------
+void OpenGLContext::resetStateCallCounters()
+{
+  for( int i=0; i<SC_StateCallCount; ++i )
+  {
+    mIssuedStateCalls[i] = 0;
+    mSuppressedStateCalls[i] = 0;
+  }
+}
+//-----------------------------------------------------------------------------
@@ -49,6 +49,20 @@ namespace vl
   class IVertexAttribSet;
   class ArrayAbstract;
 
+  //! The state calls filtered by OpenGLContext against its shadow of the OpenGL state, see OpenGLContext::issuedStateCalls().
+  typedef enum
+  {
+    SC_ActiveTexture,   //!< glActiveTexture()
+    SC_BindTexture,     //!< glBindTexture()
+    SC_BindBuffer,      //!< glBindBuffer()
+    SC_BindBufferRange, //!< glBindBufferRange() issued by OpenGLContext::bindUniformBufferRange()
+    SC_BindFramebuffer, //!< glBindFramebuffer()
+    SC_UseProgram,      //!< glUseProgram()
+    SC_Enable,          //!< glEnable() and glDisable() issued by OpenGLContext::applyEnables()
+    SC_RenderState,     //!< RenderState::apply() issued by OpenGLContext::applyRenderStates()
+    SC_StateCallCount
+  } EStateCall;
+
   //-----------------------------------------------------------------------------
   // OpenGLContextFormat
   //-----------------------------------------------------------------------------
@@ -548,6 +562,130 @@ namespace vl
     const GLSLProgram* glslProgram() const { return mGLSLProgram.get(); }
     GLSLProgram* glslProgram() { return mGLSLProgram.get(); }
 
+    // --- OpenGL state shadow ---
+
+    //! Makes \p unit the active texture unit, glActiveTexture() is called only if the active unit changes.
+    void activeTexture(int unit)
+    {
+      VL_CHECK(unit >= 0 && unit < VL_MAX_TEXTURE_IMAGE_UNITS);
+      if ( unit == mActiveTexture ) {
+        ++mSuppressedStateCalls[SC_ActiveTexture];
+        return;
+      }
+      mGL._glActiveTexture( GL_TEXTURE0 + unit ); VL_CHECK_OGL()
+      mActiveTexture = unit;
+      ++mIssuedStateCalls[SC_ActiveTexture];
+    }
+
+    //! Binds \p texture to \p target on the active texture unit, glBindTexture() is called only if the binding changes.
+    //! Only the last target bound on each unit is tracked.
+    void bindTexture(ETextureDimension target, GLuint texture)
+    {
+      if ( mActiveTexture >= 0 && mTextureShadow[mActiveTexture].mTarget == target && mTextureShadow[mActiveTexture].mHandle == texture ) {
+        ++mSuppressedStateCalls[SC_BindTexture];
+        return;
+      }
+      mGL._glBindTexture( target, texture ); VL_CHECK_OGL()
+      if ( mActiveTexture >= 0 ) {
+        mTextureShadow[mActiveTexture].mTarget = target;
+        mTextureShadow[mActiveTexture].mHandle = texture;
+      }
+      ++mIssuedStateCalls[SC_BindTexture];
+    }
+
+    //! Binds \p buffer to \p target, glBindBuffer() is called only if the binding changes.
+    //! The generic binding points are shadowed, other targets are always forwarded.
+    void bindBuffer(GLenum target, GLuint buffer)
+    {
+      GLuint* shadow = bufferShadow(target);
+      if ( shadow && *shadow == buffer ) {
+        ++mSuppressedStateCalls[SC_BindBuffer];
+        return;
+      }
+      mGL._glBindBuffer( target, buffer ); VL_CHECK_OGL()
+      if ( shadow ) {
+        *shadow = buffer;
+      }
+      ++mIssuedStateCalls[SC_BindBuffer];
+    }
+
+    //! Binds \p framebuffer to \p target, glBindFramebuffer() is called only if the binding changes.
+    //! \p target can be GL_FRAMEBUFFER, GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER.
+    void bindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+      bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+      bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+      if ( (!draw || mDrawFramebufferShadow == framebuffer) && (!read || mReadFramebufferShadow == framebuffer) ) {
+        ++mSuppressedStateCalls[SC_BindFramebuffer];
+        return;
+      }
+      mGL._glBindFramebuffer( target, framebuffer ); VL_CHECK_OGL()
+      if ( draw ) {
+        mDrawFramebufferShadow = framebuffer;
+      }
+      if ( read ) {
+        mReadFramebufferShadow = framebuffer;
+      }
+      ++mIssuedStateCalls[SC_BindFramebuffer];
+    }
+
+    //! Installs \p program, glUseProgram() is called only if the program changes. See also useGLSLProgram().
+    void useProgram(GLuint program)
+    {
+      if ( mProgramShadow == program ) {
+        ++mSuppressedStateCalls[SC_UseProgram];
+        return;
+      }
+      mGL._glUseProgram( program ); VL_CHECK_OGL()
+      mProgramShadow = program;
+      ++mIssuedStateCalls[SC_UseProgram];
+    }
+
+    //! Binds the range [\p offset, \p offset + \p size) of \p buffer to the uniform buffer binding point \p index,
+    //! glBindBufferRange() is called only if the binding changes. As in OpenGL this also binds \p buffer to GL_UNIFORM_BUFFER.
+    void bindUniformBufferRange(int index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+      UniformBufferShadow* shadow = index >= 0 && index < UniformBufferShadowCount ? &mUniformBufferShadow[index] : NULL;
+      if ( shadow && shadow->mHandle == buffer && shadow->mOffset == offset && shadow->mSize == size ) {
+        ++mSuppressedStateCalls[SC_BindBufferRange];
+        return;
+      }
+      mGL._glBindBufferRange( GL_UNIFORM_BUFFER, index, buffer, offset, size ); VL_CHECK_OGL()
+      if ( shadow ) {
+        shadow->mHandle = buffer;
+        shadow->mOffset = offset;
+        shadow->mSize   = size;
+      }
+      *bufferShadow(GL_UNIFORM_BUFFER) = buffer;
+      ++mIssuedStateCalls[SC_BindBufferRange];
+    }
+
+    //! Forgets the shadowed bindings so that the next binding calls are issued unconditionally.
+    //! Call it after changing texture, buffer, framebuffer or program bindings without going through the OpenGLContext.
+    //! To forget a single binding see vl::forgetBufferTarget() and vl::forgetActiveTextureUnit().
+    void invalidateStateShadow();
+
+    //! Forgets the shadowed bindings of \p texture, see forgetTextureBindings().
+    void forgetTexture(GLuint texture);
+
+    //! Forgets the shadowed bindings of \p buffer, see forgetBufferBindings().
+    void forgetBuffer(GLuint buffer);
+
+    //! Forgets the buffer bound to \p target, see forgetBufferTarget().
+    void forgetBufferTarget(GLenum target);
+
+    //! Forgets the texture bound to the active texture unit, see forgetActiveTextureUnit().
+    void forgetActiveTextureUnit(bool unit_changed);
+
+    //! Number of state calls of the given type issued to OpenGL since the last resetStateCallCounters().
+    unsigned long long issuedStateCalls(EStateCall call) const { return mIssuedStateCalls[call]; }
+
+    //! Number of state calls of the given type found redundant and not issued since the last resetStateCallCounters().
+    unsigned long long suppressedStateCalls(EStateCall call) const { return mSuppressedStateCalls[call]; }
+
+    //! Resets the issued and suppressed state call counters, usually called at the beginning of each frame.
+    void resetStateCallCounters();
+
 
     //! Returns \p true if the two UniformSet contain at least one Uniform variable with the same name.
     static bool areUniformsColliding(const UniformSet* u1, const UniformSet* u2);
@@ -618,6 +756,49 @@ namespace vl
     ref<GLSLProgram> mGLSLProgram;
     bool mGLSLUpdated;
 
+    // OpenGL state shadow, ShadowUnknown marks a binding that must be issued unconditionally.
+    static const GLuint ShadowUnknown = 0xFFFFFFFF;
+    enum { BufferShadowCount = 10 };
+    enum { UniformBufferShadowCount = 96 };
+    struct TextureShadow
+    {
+      ETextureDimension mTarget;
+      GLuint mHandle;
+    };
+    TextureShadow mTextureShadow[VL_MAX_TEXTURE_IMAGE_UNITS];
+    GLuint mBufferShadow[BufferShadowCount];
+    struct UniformBufferShadow
+    {
+      GLuint mHandle;
+      GLintptr mOffset;
+      GLsizeiptr mSize;
+    };
+    UniformBufferShadow mUniformBufferShadow[UniformBufferShadowCount];
+    GLuint mDrawFramebufferShadow;
+    GLuint mReadFramebufferShadow;
+    GLuint mProgramShadow;
+    int mActiveTexture;
+    unsigned long long mIssuedStateCalls[SC_StateCallCount];
+    unsigned long long mSuppressedStateCalls[SC_StateCallCount];
+
+    GLuint* bufferShadow(GLenum target)
+    {
+      switch( target )
+      {
+      case GL_ARRAY_BUFFER:              return &mBufferShadow[0];
+      case GL_ELEMENT_ARRAY_BUFFER:      return &mBufferShadow[1];
+      case GL_PIXEL_PACK_BUFFER:         return &mBufferShadow[2];
+      case GL_PIXEL_UNPACK_BUFFER:       return &mBufferShadow[3];
+      case GL_UNIFORM_BUFFER:            return &mBufferShadow[4];
+      case GL_TEXTURE_BUFFER:            return &mBufferShadow[5];
+      case GL_COPY_READ_BUFFER:          return &mBufferShadow[6];
+      case GL_COPY_WRITE_BUFFER:         return &mBufferShadow[7];
+      case GL_DRAW_INDIRECT_BUFFER:      return &mBufferShadow[8];
+      case GL_TRANSFORM_FEEDBACK_BUFFER: return &mBufferShadow[9];
+      default:                           return NULL;
+      }
+    }
+
   private:
     struct VertexArrayInfo
     {
@@ -645,6 +826,10 @@ namespace vl
     fvec4 mVertexAttribValue[VA_MaxAttribCount];
     GLuint mDefaultVAO;
 
+  protected:
+    //! Fills mGL, called by initGLContext() once the context is current. Subclasses can reimplement it to provide their own function table.
+    virtual void initGLFunctions() { mGL.initFunctions(); }
+
   private:
     void setupDefaultRenderStates();
   };
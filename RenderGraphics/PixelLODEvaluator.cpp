@@ -40,6 +40,41 @@ int PixelLODEvaluator::evaluate(Actor* actor, Camera* camera)
   if (mPixelRangeSet.empty())
     return 0;
 
+  double pixels = projectedArea(actor, camera);
+
+  // we assume the distances are sorted in increasing order
+  int i=0;
+  for(; i<(int)mPixelRangeSet.size(); ++i)
+  {
+    if (pixels>mPixelRangeSet[mPixelRangeSet.size() - 1 - i])
+      return i;
+  }
+
+  return i; // == mPixelRangeSet.size()
+}
+//-----------------------------------------------------------------------------
+float PixelLODEvaluator::evaluateDetail(Actor* actor, const Camera* camera) const
+{
+  if (mPixelRangeSet.empty())
+    return 1.0f;
+
+  double pixels = projectedArea(actor, camera);
+
+  // we assume the distances are sorted in increasing order
+  if (pixels >= mPixelRangeSet.back())
+    return 1.0f;
+  if (pixels <= mPixelRangeSet.front())
+    return 0.0f;
+
+  int i=1;
+  while( pixels > mPixelRangeSet[i] )
+    ++i;
+  double t = (pixels - mPixelRangeSet[i-1]) / (mPixelRangeSet[i] - mPixelRangeSet[i-1]);
+  return (float)( (i - 1 + t) / (mPixelRangeSet.size() - 1) );
+}
+//-----------------------------------------------------------------------------
+double PixelLODEvaluator::projectedArea(Actor* actor, const Camera* camera) const
+{
   AABB aabb = actor->transform() ? actor->lod(0)->boundingBox().transformed( actor->transform()->worldMatrix() ) : actor->lod(0)->boundingBox();
 
   vec3 corner[] =
@@ -82,16 +117,6 @@ int PixelLODEvaluator::evaluate(Actor* actor, Camera* camera)
     aabb.addPoint(out.xyz());
   }
 
-  double pixels = aabb.width() * aabb.height();
-
-  // we assume the distances are sorted in increasing order
-  int i=0;
-  for(; i<(int)mPixelRangeSet.size(); ++i)
-  {
-    if (pixels>mPixelRangeSet[mPixelRangeSet.size() - 1 - i])
-      return i;
-  }
-
-  return i; // == mPixelRangeSet.size()
+  return aabb.width() * aabb.height();
 }
 //-----------------------------------------------------------------------------
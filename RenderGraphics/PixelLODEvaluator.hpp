@@ -59,6 +59,13 @@ namespace vl
 
     virtual int evaluate(Actor* actor, Camera* camera);
 
+    /** Returns a continuous level of detail in the range [0,1], 1 being the full detail, linearly interpolated between the pixel ranges 
+        covered by the Actor. Used to drive the detail of a ProgressiveMesh (see ProgressiveMeshCallback). Returns 1 if no range is specified. */
+    float evaluateDetail(Actor* actor, const Camera* camera) const;
+
+    //! Returns the approximate area in pixels covered on the screen by the bounding box of the Actor's LOD #0.
+    double projectedArea(Actor* actor, const Camera* camera) const;
+
     const std::vector<float>& pixelRangeSet() const { return mPixelRangeSet; }
 
     std::vector<float>& pixelRangeSet() { return mPixelRangeSet; }
@@ -31,42 +31,233 @@
 
 #include <vlGraphics/PolygonSimplifier.hpp>
 #include <vlGraphics/DoubleVertexRemover.hpp>
+#include <vlGraphics/ProgressiveMesh.hpp>
 #include <vlCore/Time.hpp>
 #include <vlCore/Log.hpp>
 #include <vlCore/Say.hpp>
-#include <set>
+#include <algorithm>
 
 using namespace vl;
 
 //-----------------------------------------------------------------------------
 namespace
 {
-  class VertexPtrWrapper
+  // Indexed binary min-heap of the vertices ordered by collapse cost and then by address.
+  // The heap position of each vertex is stored in a flat array indexed by the vertex offset in the vertex lump, so that
+  // a vertex can be repositioned or removed in O(log n) after its collapse cost changes.
+  class VertexHeap
   {
   public:
-    VertexPtrWrapper(PolygonSimplifier::Vertex* ptr=NULL): mVertex(ptr) {}
+    VertexHeap(const PolygonSimplifier::Vertex* lump, size_t lump_size): mLump(lump), mSlot(lump_size, -1) {}
 
-    bool operator==(const VertexPtrWrapper& other) const
+    int size() const { return (int)mHeap.size(); }
+
+    bool contains(const PolygonSimplifier::Vertex* v) const { return slot(v) != -1; }
+
+    //! Builds the heap from \p verts in O(n).
+    void build(const std::vector<PolygonSimplifier::Vertex*>& verts)
+    {
+      mHeap = verts;
+      for( int i = 0; i < (int)mHeap.size(); ++i )
+        slot(mHeap[i]) = i;
+      for( int i = (int)mHeap.size() / 2; i--; )
+        siftDown(i);
+    }
+
+    PolygonSimplifier::Vertex* pop()
+    {
+      VL_CHECK( !mHeap.empty() )
+      PolygonSimplifier::Vertex* v = mHeap[0];
+      removeAt(0);
+      return v;
+    }
+
+    void remove(const PolygonSimplifier::Vertex* v)
+    {
+      if ( contains(v) )
+        removeAt( slot(v) );
+    }
+
+    //! Repositions \p v after its collapse cost changed, inserting it if not present.
+    void update(PolygonSimplifier::Vertex* v)
+    {
+      if ( !contains(v) )
+      {
+        mHeap.push_back(v);
+        slot(v) = (int)mHeap.size() - 1;
+      }
+      int i = slot(v);
+      if ( i > 0 && less( mHeap[i], mHeap[(i - 1) / 2] ) )
+        siftUp(i);
+      else
+        siftDown(i);
+    }
+
+  private:
+    static bool less(const PolygonSimplifier::Vertex* a, const PolygonSimplifier::Vertex* b)
     {
-      return mVertex == other.mVertex;
+      if ( a->collapseCost() != b->collapseCost() )
+        return a->collapseCost() < b->collapseCost();
+      else
+        return a < b;
     }
 
-    bool operator!=(const VertexPtrWrapper& other) const
+    int& slot(const PolygonSimplifier::Vertex* v) { return mSlot[ v - mLump ]; }
+    int slot(const PolygonSimplifier::Vertex* v) const { return mSlot[ v - mLump ]; }
+
+    void place(int i, PolygonSimplifier::Vertex* v)
     {
-      return mVertex == other.mVertex;
+      mHeap[i] = v;
+      slot(v) = i;
     }
 
-    bool operator<(const VertexPtrWrapper& other) const
+    void removeAt(int i)
     {
-      if ( mVertex->collapseCost() != other.mVertex->collapseCost() )
-        return mVertex->collapseCost() < other.mVertex->collapseCost();
+      slot(mHeap[i]) = -1;
+      PolygonSimplifier::Vertex* last = mHeap.back();
+      mHeap.pop_back();
+      if ( i == (int)mHeap.size() )
+        return;
+      place(i, last);
+      if ( i > 0 && less( mHeap[i], mHeap[(i - 1) / 2] ) )
+        siftUp(i);
       else
-        return mVertex < other.mVertex;
+        siftDown(i);
     }
-    PolygonSimplifier::Vertex* mVertex;
+
+    void siftUp(int i)
+    {
+      PolygonSimplifier::Vertex* v = mHeap[i];
+      while( i > 0 )
+      {
+        int parent = (i - 1) / 2;
+        if ( !less( v, mHeap[parent] ) )
+          break;
+        place( i, mHeap[parent] );
+        i = parent;
+      }
+      place(i, v);
+    }
+
+    void siftDown(int i)
+    {
+      PolygonSimplifier::Vertex* v = mHeap[i];
+      const int count = (int)mHeap.size();
+      for( int child = 2 * i + 1; child < count; child = 2 * i + 1 )
+      {
+        if ( child + 1 < count && less( mHeap[child + 1], mHeap[child] ) )
+          ++child;
+        if ( !less( mHeap[child], v ) )
+          break;
+        place( i, mHeap[child] );
+        i = child;
+      }
+      place(i, v);
+    }
+
+  private:
+    const PolygonSimplifier::Vertex* mLump;
+    std::vector<int> mSlot;
+    std::vector<PolygonSimplifier::Vertex*> mHeap;
   };
+
+  // the minimum number of triangles or vertices the setup hands to a ThreadPool task
+  const int MinParallelRange = 4096;
 }
 //-----------------------------------------------------------------------------
+// PolygonSimplifier::CollapseLog
+//-----------------------------------------------------------------------------
+// Records the edge collapses performed by simplify(), the vertices and triangles they removed and the 
+// triangle corners they moved from the collapsed vertex to the kept one, used to generate a ProgressiveMesh.
+class PolygonSimplifier::CollapseLog
+{
+public:
+  class Collapse
+  {
+  public:
+    Vertex* mVertex;
+    Vertex* mKeptVertex;
+    fvec3 mSplitPosition;
+    fvec3 mCollapsePosition;
+    // end of the records of this collapse in mVertices, mTriangles and mCorners
+    int mVertexEnd;
+    int mTriangleEnd;
+    int mCornerEnd;
+  };
+
+  // a triangle and its vertices before the collapse
+  class TriangleState
+  {
+  public:
+    Triangle* mTriangle;
+    Vertex* mVertices[3];
+  };
+
+  // must be called before collapsing v
+  void beginCollapse(Vertex* v)
+  {
+    Collapse collapse;
+    collapse.mVertex = v;
+    collapse.mKeptVertex = v->collapseVertex();
+    collapse.mSplitPosition = v->collapseVertex()->position();
+    collapse.mCollapsePosition = v->collapsePosition();
+    collapse.mVertexEnd = collapse.mTriangleEnd = collapse.mCornerEnd = 0;
+    mCollapses.push_back( collapse );
+
+    mIncidentTriangles.clear();
+    for(int itri=0; itri<v->incidentTrianglesCount(); ++itri)
+    {
+      TriangleState state;
+      state.mTriangle = v->incidentTriangle(itri);
+      // degenerate triangles are listed once per corner
+      bool listed = false;
+      for(size_t i=0; i<mIncidentTriangles.size() && !listed; ++i)
+        listed = mIncidentTriangles[i].mTriangle == state.mTriangle;
+      if ( listed )
+        continue;
+      for(int i=0; i<3; ++i)
+        state.mVertices[i] = state.mTriangle->vertex(i);
+      mIncidentTriangles.push_back( state );
+    }
+  }
+
+  // must be called after collapsing v, adj_verts are the vertices whose connectivity might have changed
+  void endCollapse(Vertex* v, const std::vector<Vertex*>& adj_verts)
+  {
+    for(size_t itri=0; itri<mIncidentTriangles.size(); ++itri)
+    {
+      const TriangleState& state = mIncidentTriangles[itri];
+      if ( state.mTriangle->removed() )
+        mTriangles.push_back( state );
+      else
+      {
+        for(int i=0; i<3; ++i)
+          if ( state.mVertices[i] == v )
+            mCorners.push_back( std::make_pair( state.mTriangle, i ) );
+      }
+    }
+
+    // v and the vertices left without triangles (adj_verts contains v as well since it is adjacent to the kept vertex)
+    mVertices.push_back( v );
+    for(size_t ivert=0; ivert<adj_verts.size(); ++ivert)
+      if ( adj_verts[ivert] != v && adj_verts[ivert]->removed() )
+        mVertices.push_back( adj_verts[ivert] );
+
+    mCollapses.back().mVertexEnd   = (int)mVertices.size();
+    mCollapses.back().mTriangleEnd = (int)mTriangles.size();
+    mCollapses.back().mCornerEnd   = (int)mCorners.size();
+  }
+
+public:
+  std::vector<Collapse> mCollapses;
+  std::vector<Vertex*> mVertices;
+  std::vector<TriangleState> mTriangles;
+  std::vector< std::pair<Triangle*, int> > mCorners;
+
+private:
+  std::vector<TriangleState> mIncidentTriangles;
+};
+//-----------------------------------------------------------------------------
 void PolygonSimplifier::simplify()
 {
   if (!mInput)
@@ -90,6 +281,7 @@ void PolygonSimplifier::simplify()
   if ( removeDoubles() )
   {
     DoubleVertexRemover remover;
+    remover.setThreadPool( threadPool() );
     remover.removeDoubles( mInput.get() );
   }
 
@@ -102,12 +294,11 @@ void PolygonSimplifier::simplify()
   for( size_t i=0; i<mInput->drawCalls().size(); ++i )
   {
     DrawCall* prim = mInput->drawCalls().at(i);
-    for(TriangleIterator trit = prim->triangleIterator(); trit.hasNext(); trit.next())
-    {
-      indices.push_back( trit.a() );
-      indices.push_back( trit.b() );
-      indices.push_back( trit.c() );
-    }
+    prim->forEachTriangle( [&](int a, int b, int c) {
+      indices.push_back( a );
+      indices.push_back( b );
+      indices.push_back( c );
+    } );
   }
 
   if (indices.empty())
@@ -158,6 +349,7 @@ void PolygonSimplifier::simplify(const std::vector<fvec3>& in_verts, const std::
   mProtectedVerts.clear();
   mTriangleLump.clear();
   mVertexLump.clear(); // mic fixme: this is the one taking time.
+  mProgressiveMesh = NULL;
 
   // preallocate vertices and triangles in one chunk
   mTriangleLump.resize(in_tris.size()/3);
@@ -203,10 +395,6 @@ void PolygonSimplifier::simplify(const std::vector<fvec3>& in_verts, const std::
 
     // unprotect the vertex
     mSimplifiedVertices[ivert]->mProtected = false;
-
-    // reserve the memory for quicker allocation
-    mSimplifiedVertices[ivert]->mIncidentTriangles.reserve(12);
-    mSimplifiedVertices[ivert]->mAdjacentVerts.reserve(12);
   }
 
   // initialize triangles
@@ -218,42 +406,7 @@ void PolygonSimplifier::simplify(const std::vector<fvec3>& in_verts, const std::
     mSimplifiedTriangles[itri]->mVertices[2] = mSimplifiedVertices[ in_tris[idx+2] ];
   }
 
-  // compute vertex/vertex and vertex/triangle connectivity
-  for(int itri=0; itri<(int)mSimplifiedTriangles.size(); ++itri)
-  {
-    // add this triangle to all its vertices
-    mSimplifiedTriangles[itri]->mVertices[0]->mIncidentTriangles.push_back( mSimplifiedTriangles[itri] );
-    mSimplifiedTriangles[itri]->mVertices[1]->mIncidentTriangles.push_back( mSimplifiedTriangles[itri] );
-    mSimplifiedTriangles[itri]->mVertices[2]->mIncidentTriangles.push_back( mSimplifiedTriangles[itri] );
-    // add adjacent vertices
-    mSimplifiedTriangles[itri]->mVertices[0]->addAdjacentVertex( mSimplifiedTriangles[itri]->mVertices[1] ); // vertex 0
-    mSimplifiedTriangles[itri]->mVertices[0]->addAdjacentVertex( mSimplifiedTriangles[itri]->mVertices[2] );
-    mSimplifiedTriangles[itri]->mVertices[1]->addAdjacentVertex( mSimplifiedTriangles[itri]->mVertices[0] ); // vertex 1
-    mSimplifiedTriangles[itri]->mVertices[1]->addAdjacentVertex( mSimplifiedTriangles[itri]->mVertices[2] );
-    mSimplifiedTriangles[itri]->mVertices[2]->addAdjacentVertex( mSimplifiedTriangles[itri]->mVertices[0] ); // vertex 2
-    mSimplifiedTriangles[itri]->mVertices[2]->addAdjacentVertex( mSimplifiedTriangles[itri]->mVertices[1] );
-    // compute normal
-    mSimplifiedTriangles[itri]->computeNormal();
-    // error
-    QErr qerr = mSimplifiedTriangles[itri]->computeQErr();
-    mSimplifiedTriangles[itri]->mVertices[0]->addQErr(qerr);
-    mSimplifiedTriangles[itri]->mVertices[1]->addQErr(qerr);
-    mSimplifiedTriangles[itri]->mVertices[2]->addQErr(qerr);
-  }
-
-  // - remove vertices without triangles
-  // - compute edge penalties
-  // - initialize the collapse info of each vertex
-  for( int ivert=(int)mSimplifiedVertices.size(); ivert--; )
-  {
-    if ( mSimplifiedVertices[ivert]->incidentTrianglesCount() == 0 )
-      mSimplifiedVertices.erase( mSimplifiedVertices.begin() + ivert );
-    else
-    {
-      mSimplifiedVertices[ivert]->computeEdgePenalty();
-      computeCollapseInfo( mSimplifiedVertices[ivert] );
-    }
-  }
+  setupDatabase();
 
   // sets the protected vertices
   for(int i=0; i<(int)mProtectedVerts.size(); ++i)
@@ -265,14 +418,19 @@ void PolygonSimplifier::simplify(const std::vector<fvec3>& in_verts, const std::
   if (verbose())
     Log::print(Say("database setup = %.3n\n") << timer.elapsed() );
 
-  std::set<VertexPtrWrapper> vertex_set;
+  VertexHeap vertex_heap( mVertexLump.empty() ? NULL : &mVertexLump[0], mVertexLump.size() );
+  std::vector<Vertex*> heap_verts;
+  heap_verts.reserve( mSimplifiedVertices.size() );
   for(int ivert=0; ivert<(int)mSimplifiedVertices.size(); ++ivert)
     if ( !mSimplifiedVertices[ivert]->mProtected )
-      vertex_set.insert( mSimplifiedVertices[ivert] );
+      heap_verts.push_back( mSimplifiedVertices[ivert] );
+  vertex_heap.build( heap_verts );
 
   if (verbose())
     Log::print(Say("heap setup = %.3n\n") << timer.elapsed() );
 
+  CollapseLog collapse_log;
+
   // loop through the simplification targets
   for(size_t itarget=0, remove_order=0; itarget<mTargets.size(); ++itarget)
   {
@@ -287,14 +445,12 @@ void PolygonSimplifier::simplify(const std::vector<fvec3>& in_verts, const std::
     timer.start(1);
 
     std::vector< PolygonSimplifier::Vertex* > adj_verts;
-    for( ; (int)vertex_set.size()>target_vertex_count; ++remove_order )
+    for( ; vertex_heap.size()>target_vertex_count; ++remove_order )
     {
-      std::set<VertexPtrWrapper>::iterator it = vertex_set.begin();
-      PolygonSimplifier::Vertex* v = it->mVertex;
+      PolygonSimplifier::Vertex* v = vertex_heap.pop();
       v->mRemoveOrder = (int)remove_order;
-      vertex_set.erase(it);
 
-      // remove the adjacent vertices to v and v->collapseVert()
+      // collect the adjacent vertices to v and v->collapseVert(), their collapse info will change
       adj_verts.clear();
       for(int i=0; i<v->adjacentVerticesCount(); ++i)
       {
@@ -303,31 +459,36 @@ void PolygonSimplifier::simplify(const std::vector<fvec3>& in_verts, const std::
 
         adj_verts.push_back( v->adjacentVertex(i) );
         adj_verts.back()->mAlreadyProcessed = true;
-        vertex_set.erase( v->adjacentVertex(i) );
       }
       for(int i=0; i<v->collapseVertex()->adjacentVerticesCount(); ++i)
       {
         if ( !v->collapseVertex()->adjacentVertex(i)->mAlreadyProcessed )
-        {
           adj_verts.push_back( v->collapseVertex()->adjacentVertex(i) );
-          vertex_set.erase( v->collapseVertex()->adjacentVertex(i) );
-        }
       }
 
       VL_CHECK(!v->removed())
       VL_CHECK(v->collapseVertex())
       VL_CHECK(!v->collapseVertex()->removed())
 
+      if ( progressiveOutput() )
+        collapse_log.beginCollapse( v );
+
       collapse( v );
 
-      // reinsert the adj_verts if not removed
+      if ( progressiveOutput() )
+        collapse_log.endCollapse( v, adj_verts );
+
+      // update the position in the heap of the adj_verts, remove them if they have been removed
       // NOTE: v->collapseVertex() might have been also removed
       for( int i=(int)adj_verts.size(); i--; )
       {
         adj_verts[i]->mAlreadyProcessed = false;
 
         if ( adj_verts[i]->removed() )
+        {
+          vertex_heap.remove( adj_verts[i] );
           continue;
+        }
 
         computeCollapseInfo( adj_verts[i] );
 
@@ -335,16 +496,26 @@ void PolygonSimplifier::simplify(const std::vector<fvec3>& in_verts, const std::
         VL_CHECK( adj_verts[i]->collapseVertex() != v )
         VL_CHECK( !adj_verts[i]->collapseVertex()->removed() )
 
-        vertex_set.insert( adj_verts[i] );
+        vertex_heap.update( adj_verts[i] );
       }
     }
 
     if (verbose())
       Log::print(Say("simplification = %.3ns (%.3ns)\n") << timer.elapsed() << timer.elapsed(1) );
 
-    outputSimplifiedGeometry();
+    if ( !progressiveOutput() )
+      outputSimplifiedGeometry();
   }
 
+  if ( progressiveOutput() )
+  {
+    outputProgressiveMesh( collapse_log );
+
+    if (verbose())
+      Log::print(Say("PROGRESSIVE: %n vertex splits, base mesh %n triangles, %n vertices\n") 
+        << progressiveMesh()->vertexSplitCount() << progressiveMesh()->baseTriangleCount() << progressiveMesh()->baseVertexCount() );
+  }
+  else
   if (verbose() && !output().empty())
   {
     float elapsed = (float)timer.elapsed();
@@ -355,6 +526,89 @@ void PolygonSimplifier::simplify(const std::vector<fvec3>& in_verts, const std::
   }
 }
 //-----------------------------------------------------------------------------
+void PolygonSimplifier::setupDatabase()
+{
+  const int vert_count = (int)mSimplifiedVertices.size();
+  const int tri_count  = (int)mSimplifiedTriangles.size();
+
+  // vertex -> incident triangles in compressed sparse row form, one entry per triangle corner in triangle order
+  std::vector<int> offsets( vert_count + 1, 0 );
+  for(int itri=0; itri<tri_count; ++itri)
+    for(int i=0; i<3; ++i)
+      ++offsets[ mSimplifiedTriangles[itri]->mVertices[i]->mOriginalIndex + 1 ];
+  for(int ivert=0; ivert<vert_count; ++ivert)
+    offsets[ivert + 1] += offsets[ivert];
+  std::vector<Triangle*> incident_tris( offsets[vert_count] );
+  {
+    std::vector<int> cursor( offsets.begin(), offsets.end() - 1 );
+    for(int itri=0; itri<tri_count; ++itri)
+      for(int i=0; i<3; ++i)
+        incident_tris[ cursor[ mSimplifiedTriangles[itri]->mVertices[i]->mOriginalIndex ]++ ] = mSimplifiedTriangles[itri];
+  }
+
+  const int tri_ranges  = ThreadPool::rangeCount( threadPool(), tri_count, MinParallelRange );
+  const int vert_ranges = ThreadPool::rangeCount( threadPool(), vert_count, MinParallelRange );
+
+  // triangle normals and quadrics
+  std::vector<QErr> tri_qerr( tri_count );
+  ThreadPool::parallelFor( threadPool(), tri_count, tri_ranges, [&](int, int begin, int end) {
+    for(int itri=begin; itri<end; ++itri)
+    {
+      mSimplifiedTriangles[itri]->computeNormal();
+      tri_qerr[itri] = mSimplifiedTriangles[itri]->computeQErr();
+    }
+  } );
+
+  // vertex/vertex and vertex/triangle connectivity, vertex quadrics and edge penalties.
+  // The quadrics are accumulated in the same order as the serial per-triangle scatter.
+  std::vector<QErr> penalized_qerr( vert_count );
+  ThreadPool::parallelFor( threadPool(), vert_count, vert_ranges, [&](int, int begin, int end) {
+    for(int ivert=begin; ivert<end; ++ivert)
+    {
+      Vertex* v = mSimplifiedVertices[ivert];
+      v->mIncidentTriangles.assign( incident_tris.begin() + offsets[ivert], incident_tris.begin() + offsets[ivert + 1] );
+      v->mAdjacentVerts.clear();
+      v->mAdjacentVerts.reserve( v->mIncidentTriangles.size() + 2 );
+      QErr qerr;
+      for(int itri=offsets[ivert]; itri<offsets[ivert + 1]; ++itri)
+      {
+        const Triangle* tri = incident_tris[itri];
+        v->addAdjacentVertex( tri->mVertices[0] );
+        v->addAdjacentVertex( tri->mVertices[1] );
+        v->addAdjacentVertex( tri->mVertices[2] );
+        qerr += tri_qerr[ tri - &mTriangleLump[0] ];
+      }
+      v->mQErr = qerr;
+      penalized_qerr[ivert] = qerr;
+      v->computeEdgePenalty( penalized_qerr[ivert] );
+    }
+  } );
+
+  // initialize the collapse info of each vertex.
+  // The serial setup computed the edge penalty and the collapse info of one vertex at a time from the last
+  // to the first one, so that the collapse info of a vertex saw the edge penalties of the vertices following it only.
+  ThreadPool::parallelFor( threadPool(), vert_count, vert_ranges, [&](int, int begin, int end) {
+    for(int ivert=begin; ivert<end; ++ivert)
+    {
+      Vertex* v = mSimplifiedVertices[ivert];
+      if ( v->incidentTrianglesCount() == 0 )
+        continue;
+      computeCollapseInfo( v, [&](const Vertex* u) -> const QErr& {
+        return u->mOriginalIndex >= v->mOriginalIndex ? penalized_qerr[ u->mOriginalIndex ] : u->mQErr;
+      } );
+    }
+  } );
+
+  ThreadPool::parallelFor( threadPool(), vert_count, vert_ranges, [&](int, int begin, int end) {
+    for(int ivert=begin; ivert<end; ++ivert)
+      mSimplifiedVertices[ivert]->mQErr = penalized_qerr[ivert];
+  } );
+
+  // remove vertices without triangles
+  mSimplifiedVertices.erase( std::remove_if( mSimplifiedVertices.begin(), mSimplifiedVertices.end(), 
+    [](const Vertex* v) { return v->incidentTrianglesCount() == 0; } ), mSimplifiedVertices.end() );
+}
+//-----------------------------------------------------------------------------
 void PolygonSimplifier::outputSimplifiedGeometry()
 {
   // count vertices required
@@ -405,6 +659,91 @@ void PolygonSimplifier::outputSimplifiedGeometry()
   mOutput.back()->drawCalls().push_back( de.get() );
 }
 //-----------------------------------------------------------------------------
+void PolygonSimplifier::outputProgressiveMesh(const CollapseLog& log)
+{
+  // vertices: the ones of the base mesh first, then the removed ones from the last to the first removed,
+  // in the position they had when removed, which is the one they have after a vertex split restores them.
+  ref<ArrayFloat3> arr_f3 = new ArrayFloat3;
+  arr_f3->resize( mSimplifiedVertices.size() );
+  int vert_index = 0;
+  for(int i=0; i<(int)mSimplifiedVertices.size(); ++i)
+  {
+    if (!mSimplifiedVertices[i]->mRemoved)
+    {
+      arr_f3->at(vert_index) = mSimplifiedVertices[i]->mPosition;
+      mSimplifiedVertices[i]->mSimplifiedIndex = vert_index++;
+    }
+  }
+  const int base_vertex_count = vert_index;
+  for(int i=(int)log.mVertices.size(); i--; )
+  {
+    arr_f3->at(vert_index) = log.mVertices[i]->mPosition;
+    log.mVertices[i]->mSimplifiedIndex = vert_index++;
+  }
+  VL_CHECK( vert_index == (int)arr_f3->size() )
+
+  // triangles: the ones of the base mesh first, then the removed ones from the last to the first removed,
+  // referring the vertices they had when removed.
+  std::vector<int> tri_slot( mTriangleLump.size(), -1 );
+  ref<DrawElementsUInt> de = new DrawElementsUInt(PT_TRIANGLES);
+  de->indexBuffer()->resize( mSimplifiedTriangles.size() * 3 );
+  DrawElementsUInt::index_type* ptr = de->indexBuffer()->begin();
+  int tri_index = 0;
+  for(size_t i=0; i<mSimplifiedTriangles.size(); ++i)
+  {
+    if(!mSimplifiedTriangles[i]->mRemoved)
+    {
+      tri_slot[ mSimplifiedTriangles[i] - &mTriangleLump[0] ] = tri_index++;
+      ptr[0] = mSimplifiedTriangles[i]->mVertices[0]->mSimplifiedIndex;
+      ptr[1] = mSimplifiedTriangles[i]->mVertices[1]->mSimplifiedIndex;
+      ptr[2] = mSimplifiedTriangles[i]->mVertices[2]->mSimplifiedIndex;
+      ptr+=3;
+    }
+  }
+  const int base_triangle_count = tri_index;
+  for(int i=(int)log.mTriangles.size(); i--; )
+  {
+    tri_slot[ log.mTriangles[i].mTriangle - &mTriangleLump[0] ] = tri_index++;
+    ptr[0] = log.mTriangles[i].mVertices[0]->mSimplifiedIndex;
+    ptr[1] = log.mTriangles[i].mVertices[1]->mSimplifiedIndex;
+    ptr[2] = log.mTriangles[i].mVertices[2]->mSimplifiedIndex;
+    ptr+=3;
+  }
+  VL_CHECK(ptr == de->indexBuffer()->end());
+
+  // vertex splits: the i-th split reverts the i-th last collapse
+  mProgressiveMesh = new ProgressiveMesh;
+  std::vector<ProgressiveMesh::VertexSplit>& splits = mProgressiveMesh->vertexSplits();
+  std::vector<u32>& corners = mProgressiveMesh->splitCorners();
+  splits.resize( log.mCollapses.size() );
+  corners.reserve( log.mCorners.size() );
+  for(int isplit=0; isplit<(int)splits.size(); ++isplit)
+  {
+    const int icollapse = (int)log.mCollapses.size() - 1 - isplit;
+    const CollapseLog::Collapse& collapse = log.mCollapses[icollapse];
+    const int vertex_begin   = icollapse ? log.mCollapses[icollapse-1].mVertexEnd   : 0;
+    const int triangle_begin = icollapse ? log.mCollapses[icollapse-1].mTriangleEnd : 0;
+    const int corner_begin   = icollapse ? log.mCollapses[icollapse-1].mCornerEnd   : 0;
+
+    ProgressiveMesh::VertexSplit& split = splits[isplit];
+    split.mVertex = collapse.mVertex->mSimplifiedIndex;
+    split.mKeptVertex = collapse.mKeptVertex->mSimplifiedIndex;
+    split.mSplitPosition = collapse.mSplitPosition;
+    split.mCollapsePosition = collapse.mCollapsePosition;
+    split.mVertexCount   = base_vertex_count   + (u32)log.mVertices.size()  - vertex_begin;
+    split.mTriangleCount = base_triangle_count + (u32)log.mTriangles.size() - triangle_begin;
+    split.mCornerBegin = (u32)corners.size();
+    for(int i=corner_begin; i<collapse.mCornerEnd; ++i)
+    {
+      VL_CHECK( tri_slot[ log.mCorners[i].first - &mTriangleLump[0] ] != -1 )
+      corners.push_back( tri_slot[ log.mCorners[i].first - &mTriangleLump[0] ] * 3 + log.mCorners[i].second );
+    }
+    split.mCornerEnd = (u32)corners.size();
+  }
+
+  mProgressiveMesh->setBaseMesh( arr_f3.get(), de.get(), base_vertex_count, base_triangle_count );
+}
+//-----------------------------------------------------------------------------
 void PolygonSimplifier::clearTrianglesAndVertices()
 {
   mSimplifiedVertices.clear();
@@ -33,6 +33,7 @@
 #define PolygonSimplifier_INCLUDE_ONCE
 
 #include <vlGraphics/link_config.hpp>
+#include <vlGraphics/ThreadPool.hpp>
 #include <vlCore/Object.hpp>
 #include <vlCore/Vector3.hpp>
 #include <vlCore/glsl_math.hpp>
@@ -42,12 +43,20 @@
 namespace vl
 {
   class Geometry;
+  class ProgressiveMesh;
 //-----------------------------------------------------------------------------
 // PolygonSimplifier
 //-----------------------------------------------------------------------------
   /**
    * The PolygonSimplifier class reduces the amount of polygons present in a Geometry using a quadric error metric.
    * The algorithm simplifies only the position array of the Geometry all the other vertex attributes will be discarded.
+   *
+   * The vertices are kept in an indexed binary min-heap ordered by collapse cost, whose entries are updated in place 
+   * after each collapse. The connectivity, the quadrics and the initial collapse costs are computed in parallel if 
+   * a ThreadPool is set, producing the same output as the serial setup.
+   *
+   * If setProgressiveOutput() is enabled, instead of one Geometry per target a single ProgressiveMesh is generated, 
+   * whose base mesh is the smallest target and whose vertex splits revert the edge collapses down to the full resolution mesh.
   */
   class VLGRAPHICS_EXPORT PolygonSimplifier: public Object
   {
@@ -256,6 +265,7 @@ namespace vl
       inline void removeIncidentTriangle(const Triangle*);
       inline bool checkTriangles() const;
       inline void computeEdgePenalty();
+      inline void computeEdgePenalty(QErr& qerr) const;
 
       //! the position
       const fvec3& position() const { return mPosition; }
@@ -318,7 +328,7 @@ namespace vl
     };
 
   public:
-    PolygonSimplifier(): mRemoveDoubles(false), mVerbose(true), mQuick(true) {}
+    PolygonSimplifier(): mRemoveDoubles(false), mVerbose(true), mQuick(true), mProgressiveOutput(false) {}
 
     void simplify();
     void simplify(const std::vector<fvec3>& in_verts, const std::vector<int>& in_tris);
@@ -333,6 +343,10 @@ namespace vl
     std::vector< ref<Geometry> >& output() { return mOutput; }
     const std::vector< ref<Geometry> >& output() const { return mOutput; }
 
+    //! The ProgressiveMesh generated by the last simplify() if progressiveOutput() is enabled.
+    ProgressiveMesh* progressiveMesh() { return mProgressiveMesh.get(); }
+    const ProgressiveMesh* progressiveMesh() const { return mProgressiveMesh.get(); }
+
     void setProtectedVertices(const std::vector<int>& protected_verts) { mProtectedVerts = protected_verts; }
 
     int simplifiedVerticesCount() const { return (int)mSimplifiedVertices.size(); }
@@ -352,21 +366,44 @@ namespace vl
     bool quick() const { return mQuick; }
     void setQuick(bool quick) { mQuick = quick; }
 
+    //! If enabled simplify() generates a single ProgressiveMesh (see progressiveMesh()) instead of one Geometry per target. Disabled by default.
+    void setProgressiveOutput(bool progressive) { mProgressiveOutput = progressive; }
+
+    //! If enabled simplify() generates a single ProgressiveMesh (see progressiveMesh()) instead of one Geometry per target. Disabled by default.
+    bool progressiveOutput() const { return mProgressiveOutput; }
+
+    //! The ThreadPool used to setup the connectivity, the quadrics and the collapse costs in parallel. NULL by default.
+    void setThreadPool(ThreadPool* thread_pool) { mThreadPool = thread_pool; }
+
+    //! The ThreadPool used to setup the connectivity, the quadrics and the collapse costs in parallel. NULL by default.
+    ThreadPool* threadPool() const { return mThreadPool.get(); }
+
   protected:
+    class CollapseLog;
+
+    //! Computes the connectivity, the quadrics and the initial collapse info of the vertices, in parallel if a ThreadPool is set.
+    void setupDatabase();
     void outputSimplifiedGeometry();
+    void outputProgressiveMesh(const CollapseLog& log);
     inline void collapse(Vertex* v);
     inline void computeCollapseInfo(Vertex* v);
+    //! Computes the collapse info of \p v reading the quadric error of a vertex through \p qerr_of(const Vertex*).
+    template<class TQErrOf>
+    inline void computeCollapseInfo(Vertex* v, const TQErrOf& qerr_of);
 
   protected:
     ref<Geometry> mInput;
     std::vector< ref<Geometry> > mOutput;
+    ref<ProgressiveMesh> mProgressiveMesh;
     std::vector< u32 > mTargets;
     std::vector<Vertex*> mSimplifiedVertices;
     std::vector<Triangle*> mSimplifiedTriangles;
     std::vector<int> mProtectedVerts;
+    ref<ThreadPool> mThreadPool;
     bool mRemoveDoubles;
     bool mVerbose;
     bool mQuick;
+    bool mProgressiveOutput;
 
   private:
     std::vector<Triangle> mTriangleLump;
@@ -420,6 +457,12 @@ namespace vl
   }
   //-----------------------------------------------------------------------------
   inline void PolygonSimplifier::Vertex::computeEdgePenalty()
+  {
+    computeEdgePenalty(mQErr);
+  }
+  //-----------------------------------------------------------------------------
+  //! Adds the edge penalties of the vertex to \p qerr.
+  inline void PolygonSimplifier::Vertex::computeEdgePenalty(QErr& qerr) const
   {
     for(int ivert=0; ivert<adjacentVerticesCount(); ++ivert)
     {
@@ -439,7 +482,7 @@ namespace vl
         dvec3 n = (dvec3)cross(incidentTriangle(border_tri)->normal(), edge );
         n.normalize();
         double d = -dot(n,(dvec3)position());
-        mQErr += QErr( n, d, dot(edge, edge) * 1.0 );
+        qerr += QErr( n, d, dot(edge, edge) * 1.0 );
       }
     }
   }
@@ -694,6 +737,12 @@ namespace vl
   //-----------------------------------------------------------------------------
   // compute collapse cost and vertex
   inline void PolygonSimplifier::computeCollapseInfo(Vertex* v)
+  {
+    computeCollapseInfo( v, [](const Vertex* u) -> const QErr& { return u->qerr(); } );
+  }
+  //-----------------------------------------------------------------------------
+  template<class TQErrOf>
+  inline void PolygonSimplifier::computeCollapseInfo(Vertex* v, const TQErrOf& qerr_of)
   {
     VL_CHECK(!v->mRemoved)
     if(v->mRemoved)
@@ -713,8 +762,8 @@ namespace vl
       dvec3 solution;
       if (quick())
       {
-        QErr qe = v->qerr();
-        qe += v->mAdjacentVerts[ivert]->qerr();
+        QErr qe = qerr_of(v);
+        qe += qerr_of(v->mAdjacentVerts[ivert]);
         // find the best solution
         solution = (dvec3)v->position();
         solution += (dvec3)v->mAdjacentVerts[ivert]->position();
@@ -723,8 +772,8 @@ namespace vl
       }
       else
       {
-        QErr qe = v->qerr();
-        qe += v->mAdjacentVerts[ivert]->qerr();
+        QErr qe = qerr_of(v);
+        qe += qerr_of(v->mAdjacentVerts[ivert]);
         bool analytic_ok = qe.analyticSolution(solution);
         if ( analytic_ok )
         {
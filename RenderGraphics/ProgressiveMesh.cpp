@@ -0,0 +1,173 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include <vlGraphics/ProgressiveMesh.hpp>
+#include <vlCore/Log.hpp>
+#include <algorithm>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+// ProgressiveMesh
+//-----------------------------------------------------------------------------
+ProgressiveMesh::ProgressiveMesh(): mBaseVertexCount(0), mBaseTriangleCount(0), mLevel(0)
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+}
+//-----------------------------------------------------------------------------
+void ProgressiveMesh::setBaseMesh(ArrayFloat3* vertices, DrawElementsUInt* triangles, int base_vertex_count, int base_triangle_count)
+{
+  VL_CHECK( vertices && triangles )
+  VL_CHECK( base_vertex_count  >= 0 && base_vertex_count  <= (int)vertices->size() )
+  VL_CHECK( base_triangle_count >= 0 && base_triangle_count*3 <= (int)triangles->indexBuffer()->size() )
+
+  // replace the previous triangles, if any
+  for(int i=drawCalls().size(); i--; )
+    if ( drawCalls().at(i) == mTriangles.get() )
+      drawCalls().eraseAt(i);
+
+  mVertices  = vertices;
+  mTriangles = triangles;
+  mBaseVertexCount   = base_vertex_count;
+  mBaseTriangleCount = base_triangle_count;
+  mLevel = 0;
+
+  setVertexArray( mVertices.get() );
+  drawCalls().push_back( mTriangles.get() );
+  mTriangles->setCount( mBaseTriangleCount * 3 );
+
+  setBoundsDirty(true);
+  setBufferObjectDirty(true);
+}
+//-----------------------------------------------------------------------------
+void ProgressiveMesh::setLevel(int level)
+{
+  level = clamp( level, 0, vertexSplitCount() );
+  if ( level == mLevel || !mVertices || !mTriangles )
+    return;
+
+  fvec3* verts = mVertices->begin();
+  DrawElementsUInt::index_type* indices = mTriangles->indexBuffer()->begin();
+
+  // refine
+  while( mLevel < level )
+  {
+    const VertexSplit& split = mVertexSplits[mLevel++];
+    verts[split.mKeptVertex] = split.mSplitPosition;
+    for(u32 i=split.mCornerBegin; i<split.mCornerEnd; ++i)
+      indices[ mSplitCorners[i] ] = split.mVertex;
+  }
+
+  // coarsen
+  while( mLevel > level )
+  {
+    const VertexSplit& split = mVertexSplits[--mLevel];
+    verts[split.mKeptVertex] = split.mCollapsePosition;
+    for(u32 i=split.mCornerBegin; i<split.mCornerEnd; ++i)
+      indices[ mSplitCorners[i] ] = split.mKeptVertex;
+  }
+
+  mTriangles->setCount( triangleCount() * 3 );
+
+  mVertices->setBufferObjectDirty(true);
+  mTriangles->indexBuffer()->setBufferObjectDirty(true);
+  setBufferObjectDirty(true);
+  setDisplayListDirty(true);
+}
+//-----------------------------------------------------------------------------
+void ProgressiveMesh::setDetail(float detail)
+{
+  setLevel( (int)( clamp( detail, 0.0f, 1.0f ) * vertexSplitCount() + 0.5f ) );
+}
+//-----------------------------------------------------------------------------
+void ProgressiveMesh::setTriangleBudget(int triangle_count)
+{
+  // the triangle count never decreases with the level
+  int lo = 0, hi = vertexSplitCount();
+  while( lo < hi )
+  {
+    int mid = (lo + hi + 1) / 2;
+    if ( (int)mVertexSplits[mid-1].mTriangleCount <= triangle_count )
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  setLevel( lo );
+}
+//-----------------------------------------------------------------------------
+void ProgressiveMesh::computeBounds_Implementation()
+{
+  if ( !mVertices || mVertices->size() == 0 )
+  {
+    Log::debug("ProgressiveMesh::computeBounds_Implementation() failed! No vertices present!\n");
+    return;
+  }
+
+  // all the vertices in their current state plus the positions the split vertices can take
+  AABB aabb;
+  for(size_t i=0; i<mVertices->size(); ++i)
+    aabb += (vec3)mVertices->at(i);
+  for(size_t i=0; i<mVertexSplits.size(); ++i)
+  {
+    aabb += (vec3)mVertexSplits[i].mSplitPosition;
+    aabb += (vec3)mVertexSplits[i].mCollapsePosition;
+  }
+
+  real radius = 0;
+  vec3 center = aabb.center();
+  for(size_t i=0; i<mVertices->size(); ++i)
+    radius = max( radius, ( (vec3)mVertices->at(i) - center ).lengthSquared() );
+  for(size_t i=0; i<mVertexSplits.size(); ++i)
+  {
+    radius = max( radius, ( (vec3)mVertexSplits[i].mSplitPosition - center ).lengthSquared() );
+    radius = max( radius, ( (vec3)mVertexSplits[i].mCollapsePosition - center ).lengthSquared() );
+  }
+
+  setBoundingBox( aabb );
+  setBoundingSphere( Sphere(center, sqrt(radius)) );
+}
+//-----------------------------------------------------------------------------
+// ProgressiveMeshCallback
+//-----------------------------------------------------------------------------
+void ProgressiveMeshCallback::onActorRenderStarted(Actor* actor, real, const Camera* cam, Renderable* renderable, const Shader*, int pass)
+{
+  // the level must be the same for all the passes
+  if ( !isEnabled() || pass > 0 )
+    return;
+
+  ProgressiveMesh* mesh = cast<ProgressiveMesh>( renderable );
+  if ( !mesh )
+    return;
+
+  mesh->setDetail( mLODEvaluator ? mLODEvaluator->evaluateDetail( actor, cam ) : 1.0f );
+}
+//-----------------------------------------------------------------------------
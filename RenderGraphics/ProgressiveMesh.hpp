@@ -0,0 +1,191 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef ProgressiveMesh_INCLUDE_ONCE
+#define ProgressiveMesh_INCLUDE_ONCE
+
+#include <vlGraphics/Actor.hpp>
+#include <vlGraphics/Geometry.hpp>
+#include <vlGraphics/DrawElements.hpp>
+#include <vlGraphics/PixelLODEvaluator.hpp>
+#include <vector>
+
+namespace vl
+{
+  //-----------------------------------------------------------------------------
+  // ProgressiveMesh
+  //-----------------------------------------------------------------------------
+  /**
+   * A Geometry whose level of detail can be changed continuously and incrementally between a base mesh and the full resolution mesh.
+   *
+   * A ProgressiveMesh is made of a base mesh plus an ordered list of vertex splits: the i-th vertex split restores the vertex 
+   * removed by the i-th last edge collapse performed by the PolygonSimplifier (see PolygonSimplifier::setProgressiveOutput()).
+   * The vertices and the triangles are sorted so that the ones visible at any level form a prefix of the vertex array and 
+   * of the index buffer, so that changing level only rewrites the few indices and the position touched by each vertex split,
+   * while the triangles drawn are selected using DrawElements::setCount().
+   *
+   * Only one copy of the vertices and of the triangles is stored, no matter how many levels of detail are used.
+   * Like the PolygonSimplifier output only the position array is defined. A ProgressiveMesh should not be shared
+   * among Actor[s] rendered at different levels of detail, since the level is stored in the mesh itself.
+   *
+   * \sa
+   * - ProgressiveMeshCallback
+   * - PolygonSimplifier
+  */
+  class VLGRAPHICS_EXPORT ProgressiveMesh: public Geometry
+  {
+    VL_INSTRUMENT_CLASS(vl::ProgressiveMesh, Geometry)
+
+  public:
+    //-----------------------------------------------------------------------------
+    // VertexSplit
+    //-----------------------------------------------------------------------------
+    //! A vertex split record, restores the vertex mVertex collapsed onto mKeptVertex.
+    class VertexSplit
+    {
+    public:
+      VertexSplit(): mVertex(0), mKeptVertex(0), mVertexCount(0), mTriangleCount(0), mCornerBegin(0), mCornerEnd(0) {}
+
+      //! The position of mKeptVertex after the split.
+      fvec3 mSplitPosition;
+      //! The position of mKeptVertex before the split, i.e. after the edge collapse.
+      fvec3 mCollapsePosition;
+      //! The vertex restored by the split.
+      u32 mVertex;
+      //! The vertex on which mVertex collapsed.
+      u32 mKeptVertex;
+      //! Number of vertices visible after the split.
+      u32 mVertexCount;
+      //! Number of triangles visible after the split.
+      u32 mTriangleCount;
+      //! The range in splitCorners() of the index buffer entries switching from mKeptVertex to mVertex.
+      u32 mCornerBegin;
+      u32 mCornerEnd;
+    };
+
+  public:
+    ProgressiveMesh();
+
+    /** Installs the vertices and the triangles of all the levels of detail, in the state they have at the base level.
+        The first \p base_vertex_count vertices and \p base_triangle_count triangles form the base mesh.
+        The vertex splits and the split corners must be filled before or after calling this function, after which the level is reset to 0. */
+    void setBaseMesh(ArrayFloat3* vertices, DrawElementsUInt* triangles, int base_vertex_count, int base_triangle_count);
+
+    //! The vertex split records ordered from the base mesh to the full resolution mesh.
+    std::vector<VertexSplit>& vertexSplits() { return mVertexSplits; }
+
+    //! The vertex split records ordered from the base mesh to the full resolution mesh.
+    const std::vector<VertexSplit>& vertexSplits() const { return mVertexSplits; }
+
+    //! The index buffer entries (3 x triangle + corner) modified by each vertex split, see VertexSplit::mCornerBegin.
+    std::vector<u32>& splitCorners() { return mSplitCorners; }
+
+    //! The index buffer entries (3 x triangle + corner) modified by each vertex split, see VertexSplit::mCornerBegin.
+    const std::vector<u32>& splitCorners() const { return mSplitCorners; }
+
+    //! Number of vertex splits, i.e. the level of the full resolution mesh.
+    int vertexSplitCount() const { return (int)mVertexSplits.size(); }
+
+    //! The number of vertex splits applied to the base mesh.
+    int level() const { return mLevel; }
+
+    /** Applies or reverts the vertex splits needed to go from the current level to \p level, which is clamped to [0, vertexSplitCount()].
+        The cost is proportional to the number of vertex splits between the two levels. */
+    void setLevel(int level);
+
+    //! Sets the level as a fraction of vertexSplitCount(): 0 renders the base mesh, 1 the full resolution mesh.
+    void setDetail(float detail);
+
+    //! Sets the highest level whose triangle count does not exceed \p triangle_count (the base mesh if none).
+    void setTriangleBudget(int triangle_count);
+
+    //! Number of vertices visible at the current level.
+    int vertexCount() const { return mLevel ? (int)mVertexSplits[mLevel-1].mVertexCount : mBaseVertexCount; }
+
+    //! Number of triangles rendered at the current level.
+    int triangleCount() const { return mLevel ? (int)mVertexSplits[mLevel-1].mTriangleCount : mBaseTriangleCount; }
+
+    //! Number of vertices of the base mesh.
+    int baseVertexCount() const { return mBaseVertexCount; }
+
+    //! Number of triangles of the base mesh.
+    int baseTriangleCount() const { return mBaseTriangleCount; }
+
+  protected:
+    //! Computes the bounds of all the positions the vertices can take at any level, so that they do not change with the level.
+    virtual void computeBounds_Implementation();
+
+  protected:
+    ref<ArrayFloat3> mVertices;
+    ref<DrawElementsUInt> mTriangles;
+    std::vector<VertexSplit> mVertexSplits;
+    std::vector<u32> mSplitCorners;
+    int mBaseVertexCount;
+    int mBaseTriangleCount;
+    int mLevel;
+  };
+
+  //-----------------------------------------------------------------------------
+  // ProgressiveMeshCallback
+  //-----------------------------------------------------------------------------
+  /**
+   * Sets the level of detail of the ProgressiveMesh bound to an Actor before it is rendered, according to the continuous 
+   * level of detail computed by a PixelLODEvaluator (see PixelLODEvaluator::evaluateDetail()).
+   * The PixelLODEvaluator must be installed here and not in the Actor, whose LOD #0 must be the ProgressiveMesh.
+   * If no PixelLODEvaluator is installed the ProgressiveMesh is rendered at full resolution.
+  */
+  class VLGRAPHICS_EXPORT ProgressiveMeshCallback: public ActorEventCallback
+  {
+    VL_INSTRUMENT_CLASS(vl::ProgressiveMeshCallback, ActorEventCallback)
+
+  public:
+    ProgressiveMeshCallback(PixelLODEvaluator* lod_evaluator=NULL): mLODEvaluator(lod_evaluator)
+    {
+      VL_DEBUG_SET_OBJECT_NAME()
+    }
+
+    virtual void onActorRenderStarted(Actor* actor, real frame_clock, const Camera* cam, Renderable* renderable, const Shader* shader, int pass);
+
+    virtual void onActorDelete(Actor*) {}
+
+    void setLODEvaluator(PixelLODEvaluator* lod_evaluator) { mLODEvaluator = lod_evaluator; }
+
+    PixelLODEvaluator* lodEvaluator() { return mLODEvaluator.get(); }
+
+    const PixelLODEvaluator* lodEvaluator() const { return mLODEvaluator.get(); }
+
+  protected:
+    ref<PixelLODEvaluator> mLODEvaluator;
+  };
+}
+
+#endif
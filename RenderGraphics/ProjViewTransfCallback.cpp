@@ -61,8 +61,12 @@ void ProjViewTransfCallback::updateMatrices(bool cam_changed, bool transf_change
     if ( Has_Fixed_Function_Pipeline )
     {
       // this updates 
-      glMatrixMode( GL_PROJECTION ); VL_CHECK_OGL();
-      VL_glLoadMatrix( camera->projectionMatrix().ptr() ); VL_CHECK_OGL();
+      GL_Functions._glMatrixMode( GL_PROJECTION ); VL_CHECK_OGL();
+#if VL_PIPELINE_PRECISION == 1
+      GL_Functions._glLoadMatrixf( camera->projectionMatrix().ptr() ); VL_CHECK_OGL();
+#elif VL_PIPELINE_PRECISION == 2
+      GL_Functions._glLoadMatrixd( camera->projectionMatrix().ptr() ); VL_CHECK_OGL();
+#endif
     }
   }
 
@@ -123,8 +127,12 @@ void ProjViewTransfCallback::updateMatrices(bool cam_changed, bool transf_change
 
     if( Has_Fixed_Function_Pipeline )
     {
-      glMatrixMode( GL_MODELVIEW ); VL_CHECK_OGL();
-      VL_glLoadMatrix( modelview.ptr() ); VL_CHECK_OGL();
+      GL_Functions._glMatrixMode( GL_MODELVIEW ); VL_CHECK_OGL();
+#if VL_PIPELINE_PRECISION == 1
+      GL_Functions._glLoadMatrixf( modelview.ptr() ); VL_CHECK_OGL();
+#elif VL_PIPELINE_PRECISION == 2
+      GL_Functions._glLoadMatrixd( modelview.ptr() ); VL_CHECK_OGL();
+#endif
     }
   }
 }
@@ -74,11 +74,7 @@ void RayIntersector::intersectGeometry(Actor* act, Geometry* geom)
     {
       DrawCall* prim = geom->drawCalls().at(i);
       int itri = 0;
-      for(TriangleIterator trit = prim->triangleIterator(); trit.hasNext(); trit.next(), ++itri)
-      {
-        int ia = trit.a();
-        int ib = trit.b();
-        int ic = trit.c();
+      prim->forEachTriangle( [&](int ia, int ib, int ic) {
         vec3 a = posarr->getAsVec3(ia);
         vec3 b = posarr->getAsVec3(ib);
         vec3 c = posarr->getAsVec3(ic);
@@ -88,8 +84,8 @@ void RayIntersector::intersectGeometry(Actor* act, Geometry* geom)
           b = matrix * b;
           c = matrix * c;
         }
-        intersectTriangle(a, b, c, ia, ib, ic, act, geom, prim, itri);
-      }
+        intersectTriangle(a, b, c, ia, ib, ic, act, geom, prim, itri++);
+      } );
     }
   }
 }
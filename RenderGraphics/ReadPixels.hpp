@@ -104,6 +104,7 @@ namespace vl
       glbuf->setBufferData( bytes, NULL, glbuf->usage() );
       // bind the pbo
       glBindBuffer( GL_PIXEL_PACK_BUFFER, glbuf->handle() );
+      forgetBufferTarget( GL_PIXEL_PACK_BUFFER );
       // read pixels into the pbo
       glReadPixels( x, y, w, h, image->format(), image->type(), 0);
       // unbind the pbo
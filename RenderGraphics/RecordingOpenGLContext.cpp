@@ -0,0 +1,271 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include <vlGraphics/RecordingOpenGLContext.hpp>
+
+#if defined(VL_OPENGL)
+
+using namespace vl;
+
+RecordingOpenGLContext* RecordingOpenGLContext::mCurrent = NULL;
+
+namespace
+{
+  //-----------------------------------------------------------------------------
+  // Emulated stand-ins: return plausible values, GLCallCounter counts and records the calls.
+  //-----------------------------------------------------------------------------
+  void APIENTRY genObjects(GLsizei n, GLuint* names)
+  {
+    if ( RecordingOpenGLContext* context = RecordingOpenGLContext::current() ) {
+      for( GLsizei i = 0; i < n; ++i ) {
+        names[i] = context->newHandle();
+      }
+    }
+  }
+
+  void APIENTRY createTargetObjects(GLenum, GLsizei n, GLuint* names)
+  {
+    genObjects(n, names);
+  }
+
+  GLuint APIENTRY genLists(GLsizei range)
+  {
+    RecordingOpenGLContext* context = RecordingOpenGLContext::current();
+    if ( ! context || range <= 0 ) {
+      return 0;
+    }
+    GLuint first = context->newHandle();
+    for( GLsizei i = 1; i < range; ++i ) {
+      context->newHandle();
+    }
+    return first;
+  }
+
+  GLuint APIENTRY createProgram()
+  {
+    RecordingOpenGLContext* context = RecordingOpenGLContext::current();
+    return context ? context->newHandle() : 0;
+  }
+
+  GLuint APIENTRY createShader(GLenum)
+  {
+    return createProgram();
+  }
+
+  void APIENTRY getObjectiv(GLuint, GLenum pname, GLint* params)
+  {
+    // everything compiles, links and validates with an empty info log
+    switch( pname )
+    {
+    case GL_COMPILE_STATUS:
+    case GL_LINK_STATUS:
+    case GL_VALIDATE_STATUS:
+      *params = GL_TRUE;
+      break;
+    default:
+      *params = 0;
+    }
+  }
+
+  void APIENTRY getInfoLog(GLuint, GLsizei buf_size, GLsizei* length, GLchar* info_log)
+  {
+    if ( length ) {
+      *length = 0;
+    }
+    if ( info_log && buf_size > 0 ) {
+      info_log[0] = 0;
+    }
+  }
+
+  GLint APIENTRY getLocation(GLuint program, const GLchar* name)
+  {
+    RecordingOpenGLContext* context = RecordingOpenGLContext::current();
+    return context ? context->location(program, name) : -1;
+  }
+
+  GLuint APIENTRY getUniformBlockIndex(GLuint program, const GLchar* name)
+  {
+    RecordingOpenGLContext* context = RecordingOpenGLContext::current();
+    return context ? (GLuint)context->location(program, name) : GL_INVALID_INDEX;
+  }
+
+  GLenum APIENTRY checkFramebufferStatus(GLenum)
+  {
+    return GL_FRAMEBUFFER_COMPLETE;
+  }
+
+  const GLubyte* APIENTRY getString(GLenum name)
+  {
+    switch( name )
+    {
+    case GL_VENDOR:                   return (const GLubyte*)"Visualization Library";
+    case GL_RENDERER:                 return (const GLubyte*)"RecordingOpenGLContext";
+    case GL_VERSION:                  return (const GLubyte*)"4.5 Recording";
+    case GL_SHADING_LANGUAGE_VERSION: return (const GLubyte*)"4.50 Recording";
+    default:                          return (const GLubyte*)"";
+    }
+  }
+
+  const GLubyte* APIENTRY getStringi(GLenum, GLuint)
+  {
+    return (const GLubyte*)"";
+  }
+
+  void APIENTRY getIntegerv(GLenum pname, GLint* data)
+  {
+    // the limits of a typical OpenGL 4.5 core profile implementation
+    switch( pname )
+    {
+    case 0x9126 /*GL_CONTEXT_PROFILE_MASK*/:     *data = 0x1 /*GL_CONTEXT_CORE_PROFILE_BIT*/; break;
+    case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:    *data = 32; break;
+    case GL_MAX_TEXTURE_IMAGE_UNITS:             *data = 16; break;
+    case GL_MAX_VERTEX_ATTRIBS:                  *data = 16; break;
+    case GL_MAX_CLIP_DISTANCES:                  *data = 8; break;
+    case GL_MAX_TEXTURE_SIZE:                    *data = 16384; break;
+    case GL_MAX_3D_TEXTURE_SIZE:                 *data = 2048; break;
+    case GL_MAX_CUBE_MAP_TEXTURE_SIZE:           *data = 16384; break;
+    case GL_MAX_RENDERBUFFER_SIZE:               *data = 16384; break;
+    case GL_MAX_DRAW_BUFFERS:                    *data = 8; break;
+    case GL_MAX_COLOR_ATTACHMENTS:               *data = 8; break;
+    case GL_MAX_SAMPLES:                         *data = 8; break;
+    case GL_MAX_UNIFORM_BUFFER_BINDINGS:         *data = 84; break;
+    case GL_MAX_UNIFORM_BLOCK_SIZE:              *data = 65536; break;
+    case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:     *data = 256; break;
+    default:                                     *data = 0;
+    }
+  }
+
+  GLsync APIENTRY fenceSync(GLenum, GLbitfield)
+  {
+    RecordingOpenGLContext* context = RecordingOpenGLContext::current();
+    return context ? (GLsync)(size_t)context->newHandle() : NULL;
+  }
+
+  GLenum APIENTRY clientWaitSync(GLsync, GLbitfield, GLuint64)
+  {
+    return GL_ALREADY_SIGNALED;
+  }
+}
+//-----------------------------------------------------------------------------
+// RecordingOpenGLContext
+//-----------------------------------------------------------------------------
+RecordingOpenGLContext::RecordingOpenGLContext(int w, int h):
+  OpenGLContext(w, h),
+  mLastHandle(0),
+  mFrameCount(0),
+  mCommandStreamEnabled(true)
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+}
+//-----------------------------------------------------------------------------
+RecordingOpenGLContext::~RecordingOpenGLContext()
+{
+  if ( mCurrent == this ) {
+    mCurrent = NULL;
+    GLCallCounter::setCommandStream(NULL);
+  }
+}
+//-----------------------------------------------------------------------------
+void RecordingOpenGLContext::makeCurrent()
+{
+  mCurrent = this;
+  GLCallCounter::setCommandStream( mCommandStreamEnabled ? &mCommandStream : NULL );
+}
+//-----------------------------------------------------------------------------
+void RecordingOpenGLContext::setCommandStreamEnabled(bool enabled)
+{
+  mCommandStreamEnabled = enabled;
+  if ( mCurrent == this ) {
+    GLCallCounter::setCommandStream( mCommandStreamEnabled ? &mCommandStream : NULL );
+  }
+}
+//-----------------------------------------------------------------------------
+void RecordingOpenGLContext::initGLFunctions()
+{
+  // every function not emulated below returns zero
+  mGL = OpenGLFunctions();
+
+  // object names
+  mGL._glGenTextures            = &genObjects;
+  mGL._glGenBuffers             = &genObjects;
+  mGL._glGenVertexArrays        = &genObjects;
+  mGL._glGenFramebuffers        = &genObjects;
+  mGL._glGenRenderbuffers       = &genObjects;
+  mGL._glGenQueries             = &genObjects;
+  mGL._glGenSamplers            = &genObjects;
+  mGL._glGenTransformFeedbacks  = &genObjects;
+  mGL._glGenProgramPipelines    = &genObjects;
+  mGL._glCreateBuffers          = &genObjects;
+  mGL._glCreateVertexArrays     = &genObjects;
+  mGL._glCreateFramebuffers     = &genObjects;
+  mGL._glCreateRenderbuffers    = &genObjects;
+  mGL._glCreateTextures         = &createTargetObjects;
+  mGL._glCreateQueries          = &createTargetObjects;
+  mGL._glGenLists               = &genLists;
+  mGL._glCreateProgram          = &createProgram;
+  mGL._glCreateShader           = &createShader;
+
+  // GLSL
+  mGL._glGetProgramiv           = &getObjectiv;
+  mGL._glGetShaderiv            = &getObjectiv;
+  mGL._glGetProgramInfoLog      = &getInfoLog;
+  mGL._glGetShaderInfoLog       = &getInfoLog;
+  mGL._glGetUniformLocation     = &getLocation;
+  mGL._glGetAttribLocation      = &getLocation;
+  mGL._glGetFragDataLocation    = &getLocation;
+  mGL._glGetUniformBlockIndex   = &getUniformBlockIndex;
+
+  // context queries and synchronization
+  mGL._glCheckFramebufferStatus = &checkFramebufferStatus;
+  mGL._glGetString              = &getString;
+  mGL._glGetStringi             = &getStringi;
+  mGL._glGetIntegerv            = &getIntegerv;
+  mGL._glFenceSync              = &fenceSync;
+  mGL._glClientWaitSync         = &clientWaitSync;
+
+  // count and record every call, glGetError() included which returns GL_NO_ERROR
+  GLCallCounter::install(mGL);
+}
+//-----------------------------------------------------------------------------
+GLint RecordingOpenGLContext::location(GLuint program, const char* name)
+{
+  std::map< std::pair<GLuint, std::string>, GLint >::iterator it = mLocations.find( std::make_pair(program, std::string(name)) );
+  if ( it != mLocations.end() ) {
+    return it->second;
+  }
+  GLint loc = mNextLocation[program]++;
+  mLocations[ std::make_pair(program, std::string(name)) ] = loc;
+  return loc;
+}
+//-----------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,139 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef RecordingOpenGLContext_INCLUDE_ONCE
+#define RecordingOpenGLContext_INCLUDE_ONCE
+
+#include <vlGraphics/OpenGLContext.hpp>
+#include <vlGraphics/GLCallCounter.hpp>
+#include <vector>
+#include <map>
+#include <string>
+
+#if defined(VL_OPENGL)
+
+namespace vl
+{
+  //-----------------------------------------------------------------------------
+  // RecordingOpenGLContext
+  //-----------------------------------------------------------------------------
+  /**
+   * Headless OpenGLContext that records the OpenGL calls instead of executing them.
+   *
+   * The context fills its function table (OpenGLContext::mGL, and through initializeOpenGL() the globally accessible OpenGL 1.2 - 4.6
+   * function pointers) with software stand-ins and installs GLCallCounter on it, so that every call is counted and, while the context
+   * is current, appended to its command stream. No GPU or windowing system is needed, which allows measuring the CPU side of
+   * Rendering::render() on headless machines:
+   *
+   * \code
+   * ref<RecordingOpenGLContext> context = new RecordingOpenGLContext(1920, 1080);
+   * context->initGLContext(false);
+   * rendering->renderer()->setFramebuffer( context->framebuffer() );
+   * GLCallCounter::resetCounts();
+   * rendering->render();
+   * GLCallCounter::callCount(GLC_DrawCall);
+   * \endcode
+   *
+   * The stand-ins emulate just enough of an OpenGL 4.5 core profile for VL to work: object names returned by glGen*() and glCreate*()
+   * are unique fake handles, shaders always compile and link, uniform and attribute locations are assigned on first request,
+   * framebuffers are always complete and fences are always signaled. Every other query leaves its output untouched and returns zero.
+   * See GLCallCounter for the layout of the command stream.
+   *
+   * \note
+   * - The draw calls, the RenderState::apply() implementations, OpenGLContext::applyEnables(), Viewport::activate(), Scissor, Clear and
+   *   VL_CHECK_OGL() go through mGL or vl::GL_Functions and are recorded. The OpenGL 1.1 functions still called directly outside of
+   *   the rendering loop, like the texture and framebuffer setup, are linked statically and bypass the recording.
+   * - glMapBuffer() and glMapBufferRange() return NULL.
+   * - Only one RecordingOpenGLContext can be current at a time, the emulated stand-ins answer on behalf of the current one.
+   */
+  class VLGRAPHICS_EXPORT RecordingOpenGLContext: public OpenGLContext
+  {
+    VL_INSTRUMENT_CLASS(vl::RecordingOpenGLContext, OpenGLContext)
+
+  public:
+    //! Constructor.
+    RecordingOpenGLContext(int w=0, int h=0);
+
+    //! Destructor.
+    ~RecordingOpenGLContext();
+
+    //! Counts the presented frames, see frameCount().
+    virtual void swapBuffers() { ++mFrameCount; }
+
+    //! Makes this the context receiving the recorded calls.
+    virtual void makeCurrent();
+
+    //! Dispatches the update event right away since there is no event loop.
+    virtual void update() { dispatchUpdateEvent(); }
+
+    //! The RecordingOpenGLContext currently receiving the recorded calls, if any.
+    static RecordingOpenGLContext* current() { return mCurrent; }
+
+    //! If false the calls are only counted and the command stream is left untouched. Default is true.
+    void setCommandStreamEnabled(bool enabled);
+
+    //! If false the calls are only counted and the command stream is left untouched. Default is true.
+    bool commandStreamEnabled() const { return mCommandStreamEnabled; }
+
+    //! The recorded command stream, see GLCallCounter for its layout.
+    const std::vector<unsigned long long>& commandStream() const { return mCommandStream; }
+
+    //! Empties the command stream keeping its memory allocated.
+    void clearCommandStream() { mCommandStream.clear(); }
+
+    //! Number of swapBuffers() calls since construction.
+    int frameCount() const { return mFrameCount; }
+
+    //! For internal use only.
+    GLuint newHandle() { return ++mLastHandle; }
+
+    //! For internal use only.
+    GLint location(GLuint program, const char* name);
+
+  protected:
+    virtual void initGLFunctions();
+
+  protected:
+    std::vector<unsigned long long> mCommandStream;
+    std::map< std::pair<GLuint, std::string>, GLint > mLocations;
+    std::map< GLuint, GLint > mNextLocation;
+    GLuint mLastHandle;
+    int mFrameCount;
+    bool mCommandStreamEnabled;
+
+    static RecordingOpenGLContext* mCurrent;
+  };
+}
+
+#endif
+
+#endif
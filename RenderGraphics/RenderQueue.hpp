@@ -41,45 +41,123 @@ namespace vl
   //------------------------------------------------------------------------------
   /**
    * The RenderQueue class collects a list of RenderToken objects to be sorted and rendered.
+   *
+   * The tokens are stored by value in two arrays reused across frames, one for the first passes, which are sorted, and one for
+   * the following passes of multipass Effects, which are chained to the first pass by index. Sorting reorders an array of keys
+   * and then moves the tokens in place once, so that filling, sorting and rendering the queue touch a few contiguous arrays
+   * without allocating memory once the arrays have grown to the size of the scene.
   */
   class RenderQueue: public Object
   {
     VL_INSTRUMENT_CLASS(vl::RenderQueue, Object)
 
   public:
-    RenderQueue(): mSize(0), mSizeMP(0)
+    RenderQueue(): mUpdateTick(0), mSize(0), mSizeMP(0), mLastToken(-1), mLastTokenMP(false)
     {
       VL_DEBUG_SET_OBJECT_NAME()
-      mList.reserve(100);
-      mListMP.reserve(100);
+      mTokens.reserve(100);
+      mTokensMP.reserve(100);
     }
 
-    const RenderToken* at(int i) const { return mList[i].get(); }
+    const RenderToken* at(int i) const { return &mTokens[i]; }
 
-    RenderToken* at(int i) { return mList[i].get(); }
+    RenderToken* at(int i) { return &mTokens[i]; }
 
+    //! Returns the pass following \p tok, or NULL if \p tok is the last pass.
+    const RenderToken* nextPass(const RenderToken* tok) const
+    {
+      return tok->mNextPassIndex < 0 ? NULL : &mTokensMP[tok->mNextPassIndex];
+    }
+
+    /**
+     * Returns a new RenderToken. If \p multipass is \p true the token is chained as the next pass of the token returned by the previous call.
+     * The returned pointer is valid until the next call to newToken() or appendToken().
+     */
     RenderToken* newToken(bool multipass)
     {
+      ++mUpdateTick;
       if (multipass)
       {
-        ++mSizeMP;
-        if ( mSizeMP > (int)mListMP.size() )
-          mListMP.push_back( new RenderToken );
-        return mListMP[mSizeMP-1].get();
+        VL_CHECK( mLastToken >= 0 )
+        if ( mSizeMP == (int)mTokensMP.size() )
+          mTokensMP.push_back( RenderToken() );
+        else
+          mTokensMP[mSizeMP] = RenderToken();
+        RenderToken* prev_pass = mLastTokenMP ? &mTokensMP[mLastToken] : &mTokens[mLastToken];
+        prev_pass->mNextPassIndex = mSizeMP;
+        mLastToken = mSizeMP++;
+        mLastTokenMP = true;
+        return &mTokensMP[mLastToken];
       }
       else
       {
-        ++mSize;
-        if ( mSize > (int)mList.size() )
-          mList.push_back( new RenderToken );
-        return mList[mSize-1].get();
+        if ( mSize == (int)mTokens.size() )
+          mTokens.push_back( RenderToken() );
+        else
+          mTokens[mSize] = RenderToken();
+        mLastToken = mSize++;
+        mLastTokenMP = false;
+        return &mTokens[mLastToken];
+      }
+    }
+
+    //! Appends a copy of the token at position \p i of \p queue together with its passes. Returns the new token.
+    RenderToken* appendToken(const RenderQueue* queue, int i)
+    {
+      const RenderToken* src = queue->at(i);
+      RenderToken* tok = newToken(false);
+      *tok = *src;
+      tok->mNextPassIndex = -1;
+      const int index = mLastToken;
+      for( src = queue->nextPass(src); src; src = queue->nextPass(src) )
+      {
+        RenderToken* pass = newToken(true);
+        *pass = *src;
+        pass->mNextPassIndex = -1;
+      }
+      return &mTokens[index];
+    }
+
+    //! Appends all the tokens of \p queue together with their passes, preserving their order.
+    void append(const RenderQueue* queue)
+    {
+      ++mUpdateTick;
+      if ( mTokens.size() < (size_t)(mSize + queue->mSize) )
+        mTokens.resize( mSize + queue->mSize );
+      if ( mTokensMP.size() < (size_t)(mSizeMP + queue->mSizeMP) )
+        mTokensMP.resize( mSizeMP + queue->mSizeMP );
+
+      // the pass chains of the appended tokens point past the passes already present
+      for( int i=0; i<queue->mSize; ++i )
+      {
+        RenderToken& tok = mTokens[mSize + i];
+        tok = queue->mTokens[i];
+        if ( tok.mNextPassIndex >= 0 )
+          tok.mNextPassIndex += mSizeMP;
       }
+      for( int i=0; i<queue->mSizeMP; ++i )
+      {
+        RenderToken& tok = mTokensMP[mSizeMP + i];
+        tok = queue->mTokensMP[i];
+        if ( tok.mNextPassIndex >= 0 )
+          tok.mNextPassIndex += mSizeMP;
+      }
+
+      if ( queue->mLastToken >= 0 )
+      {
+        mLastToken = queue->mLastToken + (queue->mLastTokenMP ? mSizeMP : mSize);
+        mLastTokenMP = queue->mLastTokenMP;
+      }
+      mSize   += queue->mSize;
+      mSizeMP += queue->mSizeMP;
     }
 
     void clear()
     {
+      ++mUpdateTick;
       mSize   = 0;
       mSizeMP = 0;
+      mLastToken = -1;
     }
 
     bool empty()
@@ -92,8 +170,12 @@ namespace vl
       return mSize;
     }
 
+    //! Incremented every time the tokens are added, removed or sorted, used by Renderer to validate its command list.
+    long long updateTick() const { return mUpdateTick; }
+
     void sort(RenderQueueSorter* sorter, Camera* camera)
     {
+      ++mUpdateTick;
       if (sorter->mightNeedZCameraDistance())
       {
         for(int i=0; i<size(); ++i)
@@ -115,34 +197,124 @@ namespace vl
       }
 
       VL_CHECK( sorter )
-      std::sort( mList.begin(), mList.begin() + size(), Sorter( sorter ) );
+      if ( ! sortByKeys( sorter ) )
+      {
+        for( int i = 0; i < size(); ++i ) {
+          mKeys[i].mIndex = i;
+        }
+        std::sort( mKeys.begin(), mKeys.end(), Sorter( sorter, mTokens.empty() ? NULL : &mTokens[0] ) );
+      }
+
+      // move the tokens in the sorted order, the passes refer to mTokensMP and do not move
+      mSortedTokens.resize( mTokens.size() );
+      for( int i = 0; i < size(); ++i ) {
+        mSortedTokens[i] = mTokens[ mKeys[i].mIndex ];
+      }
+      mTokens.swap( mSortedTokens );
+      mLastToken = -1;
     }
 
   private:
+    struct SortKey
+    {
+      bool operator<(const SortKey& other) const
+      {
+        return mKey != other.mKey ? mKey < other.mKey : mIndex < other.mIndex;
+      }
+
+      unsigned long long mKey;
+      int mIndex;
+    };
+
+    // Fills mKeys with the keys encoded by the sorter and sorts them, returns false if the sorter cannot encode them.
+    bool sortByKeys(const RenderQueueSorter* sorter)
+    {
+      mKeyIds.clear();
+      mKeys.resize( size() );
+      for( int i = 0; i < size(); ++i )
+      {
+        if ( ! sorter->encodeKey( at(i), mKeyIds, mKeys[i].mKey ) ) {
+          return false;
+        }
+        mKeys[i].mIndex = i;
+      }
+
+      // the index makes the comparison sort stable like the radix sort
+      if ( size() < 64 ) {
+        std::sort( mKeys.begin(), mKeys.end() );
+      } else {
+        radixSortKeys();
+      }
+
+      return true;
+    }
+
+    // Stable LSD radix sort of mKeys, 8 bits per pass, skipping the bytes equal in all the keys.
+    void radixSortKeys()
+    {
+      const int count = (int)mKeys.size();
+      std::vector<int>& histograms = mRadixHistograms;
+      histograms.assign( 8 * 256, 0 );
+      for( int i = 0; i < count; ++i )
+      {
+        unsigned long long key = mKeys[i].mKey;
+        for( int pass = 0; pass < 8; ++pass, key >>= 8 ) {
+          ++histograms[ pass * 256 + (int)( key & 0xFF ) ];
+        }
+      }
+
+      mKeysTemp.resize( count );
+      for( int pass = 0; pass < 8; ++pass )
+      {
+        int* offsets = &histograms[ pass * 256 ];
+        if ( offsets[ (int)( ( mKeys[0].mKey >> ( pass * 8 ) ) & 0xFF ) ] == count ) {
+          continue;
+        }
+
+        int sum = 0;
+        for( int digit = 0; digit < 256; ++digit )
+        {
+          int digit_count = offsets[digit];
+          offsets[digit] = sum;
+          sum += digit_count;
+        }
+
+        for( int i = 0; i < count; ++i ) {
+          mKeysTemp[ offsets[ (int)( ( mKeys[i].mKey >> ( pass * 8 ) ) & 0xFF ) ]++ ] = mKeys[i];
+        }
+        mKeys.swap( mKeysTemp );
+      }
+    }
+
     class Sorter
     {
     public:
-      Sorter(const RenderQueueSorter* sorter): mRenderQueueSorter(sorter) {}
-      bool operator()(const ref<RenderToken>& a, const ref<RenderToken>& b) const
+      Sorter(const RenderQueueSorter* sorter, const RenderToken* tokens): mRenderQueueSorter(sorter), mTokens(tokens) {}
+      bool operator()(const SortKey& a, const SortKey& b) const
       {
-        VL_CHECK(a && b);
-        return mRenderQueueSorter->operator()(a.get(), b.get());
+        return mRenderQueueSorter->operator()(&mTokens[a.mIndex], &mTokens[b.mIndex]);
       }
     protected:
       const RenderQueueSorter* mRenderQueueSorter;
+      const RenderToken* mTokens;
     };
 
   protected:
-    // mic fixme: would be nice not to allocate these dinamically.
-    // Necessary because:
-    // 1- RenderToken.mNextPass: the pointer should be stable across std::vector reallocations.
-    //    Maybe we can use indices?
-    // 2- The sorting sorts only pointers instead of whole structures.
     // Note: we need two lists because the sorting must still respect the multipassing order.
-    std::vector< ref<RenderToken> > mList;
-    std::vector< ref<RenderToken> > mListMP;
+    std::vector<RenderToken> mTokens;
+    std::vector<RenderToken> mTokensMP;
+    // sort() buffers, reused across frames
+    std::vector<RenderToken> mSortedTokens;
+    std::vector<SortKey> mKeys;
+    std::vector<SortKey> mKeysTemp;
+    std::vector<int> mRadixHistograms;
+    RenderKeyIds mKeyIds;
+    long long mUpdateTick;
     int mSize;
     int mSizeMP;
+    // last token returned by newToken(), the one the next multipass token is chained to
+    int mLastToken;
+    bool mLastTokenMP;
   };
   //------------------------------------------------------------------------------
   typedef std::map< float, ref<RenderQueue> > TRenderQueueMap;
@@ -0,0 +1,281 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include <vlGraphics/RenderQueueCache.hpp>
+#include <vlGraphics/Rendering.hpp>
+#include <vlGraphics/Camera.hpp>
+#include <vlGraphics/SceneManager.hpp>
+#include <set>
+
+using namespace vl;
+
+namespace
+{
+  // the Rendering settings affecting the render queue
+  unsigned int renderingFlags(const Rendering* rendering)
+  {
+    return ( rendering->cullingEnabled() ? 1 : 0 ) |
+           ( rendering->evaluateLOD() ? 2 : 0 ) |
+           ( rendering->nearFarClippingPlanesOptimized() ? 4 : 0 );
+  }
+}
+
+//------------------------------------------------------------------------------
+RenderQueueCache::RenderQueueCache():
+  mEnableMask(0), mFlags(0), mSorter(NULL), mHitCount(0), mCullHitCount(0), mMissCount(0), mCameraDependentLOD(false), mValid(false)
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+  for(int i=0; i<4; ++i)
+    mViewport[i] = 0;
+}
+//------------------------------------------------------------------------------
+void RenderQueueCache::invalidate()
+{
+  mValid = false;
+  // release the referenced objects
+  mSceneManagers.clear();
+  mActors.clear();
+  mTransforms.clear();
+  mEffects.clear();
+  mShaders.clear();
+  mVisibleActors.clear();
+}
+//------------------------------------------------------------------------------
+bool RenderQueueCache::sceneChanged(Rendering* rendering)
+{
+  if ( ! mValid )
+    return true;
+
+  // rendering settings
+
+  if ( rendering->enableMask() != mEnableMask || renderingFlags(rendering) != mFlags || rendering->renderQueueSorter() != mSorter )
+    return true;
+
+  const std::map<unsigned int, ref<Effect> >& overrides = rendering->effectOverrideMask();
+  if ( overrides.size() != mEffectOverrides.size() )
+    return true;
+  size_t iovr = 0;
+  for( std::map<unsigned int, ref<Effect> >::const_iterator it = overrides.begin(); it != overrides.end(); ++it, ++iovr )
+  {
+    if ( it->first != mEffectOverrides[iovr].first || it->second.get() != mEffectOverrides[iovr].second )
+      return true;
+  }
+
+  const Collection<SceneManager>* scene_managers = rendering->sceneManagers();
+  if ( scene_managers->size() != mSceneManagers.size() )
+    return true;
+  for( size_t i=0; i<mSceneManagers.size(); ++i )
+  {
+    if ( scene_managers->at(i) != mSceneManagers[i].first.get() || scene_managers->at(i)->updateTick() != mSceneManagers[i].second )
+      return true;
+  }
+
+  // scene
+
+  for( size_t i=0; i<mActors.size(); ++i )
+  {
+    if ( actorChanged( mActors[i] ) )
+      return true;
+  }
+
+  for( size_t i=0; i<mEffects.size(); ++i )
+  {
+    if ( mEffects[i].first->updateTick() != mEffects[i].second )
+      return true;
+  }
+
+  for( size_t i=0; i<mShaders.size(); ++i )
+  {
+    if ( mShaders[i].first->updateTick() != mShaders[i].second )
+      return true;
+  }
+
+  // the Transform tree is usually recomputed at every frame: compare the world matrices only when the tick changes
+  for( size_t i=0; i<mTransforms.size(); ++i )
+  {
+    TransformState& state = mTransforms[i];
+    if ( state.mTransform->worldMatrixUpdateTick() != state.mUpdateTick )
+    {
+      if ( state.mTransform->worldMatrix() != state.mWorldMatrix )
+        return true;
+      state.mUpdateTick = state.mTransform->worldMatrixUpdateTick();
+    }
+  }
+
+  return false;
+}
+//------------------------------------------------------------------------------
+bool RenderQueueCache::cameraChanged(const Camera* camera) const
+{
+  const Viewport* viewport = camera->viewport();
+  return camera->viewMatrix() != mViewMatrix ||
+         camera->projectionMatrix() != mProjectionMatrix ||
+         viewport->x() != mViewport[0] || viewport->y() != mViewport[1] ||
+         viewport->width() != mViewport[2] || viewport->height() != mViewport[3];
+}
+//------------------------------------------------------------------------------
+bool RenderQueueCache::visibleActorsChanged(const ActorCollection* actor_queue) const
+{
+  if ( ! mValid || actor_queue->size() != mVisibleActors.size() )
+    return true;
+
+  for( size_t i=0; i<mVisibleActors.size(); ++i )
+  {
+    if ( actor_queue->at(i) != mVisibleActors[i] )
+      return true;
+  }
+
+  return false;
+}
+//------------------------------------------------------------------------------
+void RenderQueueCache::storeCamera(const Camera* camera)
+{
+  mViewMatrix       = camera->viewMatrix();
+  mProjectionMatrix = camera->projectionMatrix();
+  mViewport[0] = camera->viewport()->x();
+  mViewport[1] = camera->viewport()->y();
+  mViewport[2] = camera->viewport()->width();
+  mViewport[3] = camera->viewport()->height();
+}
+//------------------------------------------------------------------------------
+void RenderQueueCache::storeScene(Rendering* rendering, const ActorCollection* actor_queue)
+{
+  invalidate();
+
+  // rendering settings
+
+  mEnableMask = rendering->enableMask();
+  mFlags      = renderingFlags(rendering);
+  mSorter     = rendering->renderQueueSorter();
+
+  std::set<Effect*> effects;
+  mCameraDependentLOD = false;
+
+  const std::map<unsigned int, ref<Effect> >& overrides = rendering->effectOverrideMask();
+  for( std::map<unsigned int, ref<Effect> >::const_iterator it = overrides.begin(); it != overrides.end(); ++it )
+  {
+    mEffectOverrides.push_back( std::make_pair( it->first, (const Effect*)it->second.get() ) );
+    effects.insert( it->second.get() );
+  }
+
+  ActorCollection actors;
+  Collection<SceneManager>* scene_managers = rendering->sceneManagers();
+  for( size_t i=0; i<scene_managers->size(); ++i )
+  {
+    mSceneManagers.push_back( std::make_pair( scene_managers->at(i), scene_managers->at(i)->updateTick() ) );
+    scene_managers->at(i)->extractActors( actors );
+  }
+
+  // scene
+
+  std::set<Transform*> transforms;
+  mActors.resize( actors.size() );
+  for( size_t i=0; i<actors.size(); ++i )
+  {
+    Actor* actor = actors.at(i);
+    fillActorState( mActors[i], actor );
+    if ( actor->effect() )
+      effects.insert( actor->effect() );
+    if ( actor->transform() && transforms.insert( actor->transform() ).second )
+    {
+      TransformState state;
+      state.mTransform   = actor->transform();
+      state.mUpdateTick  = actor->transform()->worldMatrixUpdateTick();
+      state.mWorldMatrix = actor->transform()->worldMatrix();
+      mTransforms.push_back( state );
+    }
+  }
+
+  std::set<Shader*> shaders;
+  for( std::set<Effect*>::iterator it = effects.begin(); it != effects.end(); ++it )
+  {
+    Effect* effect = *it;
+    mEffects.push_back( std::make_pair( effect, effect->updateTick() ) );
+    if ( effect->lodEvaluator() )
+      mCameraDependentLOD = true;
+    for( int lod=0; lod<VL_MAX_EFFECT_LOD; ++lod )
+    {
+      for( size_t pass=0; effect->lod(lod) && pass<effect->lod(lod)->size(); ++pass )
+      {
+        Shader* shader = effect->lod(lod)->at(pass);
+        if ( shader && shaders.insert( shader ).second )
+          mShaders.push_back( std::make_pair( shader, shader->updateTick() ) );
+      }
+    }
+  }
+
+  // culled actors
+
+  mVisibleActors.resize( actor_queue->size() );
+  for( size_t i=0; i<actor_queue->size(); ++i )
+  {
+    mVisibleActors[i] = actor_queue->at(i);
+    if ( rendering->evaluateLOD() && actor_queue->at(i)->lodEvaluator() )
+      mCameraDependentLOD = true;
+  }
+
+  mValid = true;
+}
+//------------------------------------------------------------------------------
+void RenderQueueCache::fillActorState(ActorState& state, Actor* actor) const
+{
+  state.mActor        = actor;
+  state.mEffect       = actor->effect();
+  state.mTransform    = actor->transform();
+  for( int i=0; i<VL_MAX_ACTOR_LOD; ++i )
+    state.mLods[i]    = actor->lod(i);
+  state.mBoundsUpdateTick = actor->lod(0) ? actor->lod(0)->boundsUpdateTick() : -1;
+  state.mLODEvaluator = actor->lodEvaluator();
+  state.mEnableMask   = actor->enableMask();
+  state.mRenderRank   = actor->renderRank();
+  state.mRenderBlock  = actor->renderBlock();
+  state.mEnabled      = actor->isEnabled();
+}
+//------------------------------------------------------------------------------
+bool RenderQueueCache::actorChanged(const ActorState& state) const
+{
+  const Actor* actor = state.mActor.get();
+  if ( actor->effect() != state.mEffect || actor->transform() != state.mTransform || actor->lodEvaluator() != state.mLODEvaluator ||
+       actor->enableMask() != state.mEnableMask || actor->isEnabled() != state.mEnabled ||
+       actor->renderRank() != state.mRenderRank || actor->renderBlock() != state.mRenderBlock )
+    return true;
+
+  for( int i=0; i<VL_MAX_ACTOR_LOD; ++i )
+  {
+    if ( actor->lod(i) != state.mLods[i] )
+      return true;
+  }
+
+  // a dirty Renderable is about to change its bounds
+  return actor->lod(0) && ( actor->lod(0)->boundsDirty() || actor->lod(0)->boundsUpdateTick() != state.mBoundsUpdateTick );
+}
+//------------------------------------------------------------------------------
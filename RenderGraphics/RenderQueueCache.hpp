@@ -0,0 +1,183 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef RenderQueueCache_INCLUDE_ONCE
+#define RenderQueueCache_INCLUDE_ONCE
+
+#include <vlGraphics/link_config.hpp>
+#include <vlGraphics/Actor.hpp>
+#include <vlGraphics/Effect.hpp>
+#include <vlGraphics/SceneManager.hpp>
+#include <vlCore/Transform.hpp>
+#include <vlCore/Collection.hpp>
+#include <vector>
+
+namespace vl
+{
+  class Rendering;
+  class Camera;
+  class RenderQueueSorter;
+
+  //------------------------------------------------------------------------------
+  // RenderQueueCache
+  //------------------------------------------------------------------------------
+  /**
+   * The RenderQueueCache class keeps the fingerprint of the inputs used by a Rendering to build its render queue
+   * so that the culled Actor[s] and the sorted RenderQueue can be reused across frames when nothing has changed.
+   *
+   * The fingerprint is made of:
+   * - the Rendering's enable mask, flags, RenderQueueSorter, SceneManager[s] and effect override mask,
+   * - the SceneManager::updateTick() of each SceneManager,
+   * - the Actor[s] contained in the scene: their Effect, Transform, Renderable[s], LODEvaluator, enable state, render rank and block,
+   * - the world matrix of each Transform, compared only when Transform::worldMatrixUpdateTick() changes,
+   * - the Effect::updateTick() and Shader::updateTick() of each Effect and Shader used by the Actor[s],
+   * - the Camera's view and projection matrices and viewport, the projection matrix as modified by the near/far clipping planes
+   *   optimization, see Rendering::setNearFarClippingPlanesOptimized().
+   *
+   * Adding or removing Actor[s] through the ActorTreeAbstract functions or rebuilding the tree of a SceneManagerBVH is detected
+   * automatically, see ActorTreeAbstract::updateTick(). After editing ActorTreeAbstract::actors() directly or changing the
+   * Actor[s] of other scene managers call ActorTreeAbstract::incrementUpdateTick(), SceneManager::incrementUpdateTick()
+   * or invalidate(). Checking the fingerprint is linear in the number of Actor[s] of the scene.
+   *
+   * \sa Rendering::setRenderQueueCacheEnabled()
+   */
+  class VLGRAPHICS_EXPORT RenderQueueCache: public Object
+  {
+    VL_INSTRUMENT_CLASS(vl::RenderQueueCache, Object)
+
+  public:
+    RenderQueueCache();
+
+    //! Forces the next rendering to cull the scene and rebuild the render queue.
+    void invalidate();
+
+    //! Whether the fingerprint has been stored with storeScene() and not invalidated.
+    bool valid() const { return mValid; }
+
+    //! Returns \p true if anything but the camera has changed since the last storeScene().
+    //! The stored transform ticks are refreshed when a Transform has been recomputed without changing its world matrix.
+    bool sceneChanged(Rendering* rendering);
+
+    //! Returns \p true if the camera has changed since the last storeCamera().
+    bool cameraChanged(const Camera* camera) const;
+
+    //! Returns \p true if \p actor_queue differs from the culled Actor[s] stored by the last storeScene().
+    bool visibleActorsChanged(const ActorCollection* actor_queue) const;
+
+    //! Whether the render queue depends on the camera through the LODEvaluator[s] of the Actor[s] or of the Effect[s].
+    bool cameraDependentLOD() const { return mCameraDependentLOD; }
+
+    //! Stores the camera fingerprint, called by Rendering after the near/far clipping planes optimization.
+    void storeCamera(const Camera* camera);
+
+    //! Stores the scene fingerprint together with the culled Actor[s] found in \p actor_queue.
+    void storeScene(Rendering* rendering, const ActorCollection* actor_queue);
+
+    //! Number of renderings that reused the render queue without culling.
+    long long hitCount() const { return mHitCount; }
+
+    //! Number of renderings that culled the scene but reused the render queue as the culled Actor[s] did not change.
+    long long cullHitCount() const { return mCullHitCount; }
+
+    //! Number of renderings that rebuilt the render queue.
+    long long missCount() const { return mMissCount; }
+
+    //! Resets hitCount(), cullHitCount() and missCount().
+    void resetCounters() { mHitCount = mCullHitCount = mMissCount = 0; }
+
+    //! Used internally.
+    void countHit() { ++mHitCount; }
+
+    //! Used internally.
+    void countCullHit() { ++mCullHitCount; }
+
+    //! Used internally.
+    void countMiss() { ++mMissCount; }
+
+  private:
+    RenderQueueCache(const RenderQueueCache&);
+    RenderQueueCache& operator=(const RenderQueueCache&);
+
+  private:
+    struct ActorState
+    {
+      ref<Actor> mActor;
+      const Effect* mEffect;
+      const Transform* mTransform;
+      const Renderable* mLods[VL_MAX_ACTOR_LOD];
+      long long mBoundsUpdateTick;
+      const LODEvaluator* mLODEvaluator;
+      unsigned int mEnableMask;
+      int mRenderRank;
+      int mRenderBlock;
+      bool mEnabled;
+    };
+
+    struct TransformState
+    {
+      ref<Transform> mTransform;
+      long long mUpdateTick;
+      mat4 mWorldMatrix;
+    };
+
+    void fillActorState(ActorState& state, Actor* actor) const;
+    bool actorChanged(const ActorState& state) const;
+
+  private:
+    // rendering settings
+    unsigned int mEnableMask;
+    unsigned int mFlags;
+    const RenderQueueSorter* mSorter;
+    std::vector< std::pair<unsigned int, const Effect*> > mEffectOverrides;
+    std::vector< std::pair< ref<SceneManager>, long long > > mSceneManagers;
+
+    // scene
+    std::vector<ActorState> mActors;
+    std::vector<TransformState> mTransforms;
+    std::vector< std::pair< ref<Effect>, long long > > mEffects;
+    std::vector< std::pair< ref<Shader>, long long > > mShaders;
+    std::vector<const Actor*> mVisibleActors;
+
+    // camera
+    mat4 mViewMatrix;
+    mat4 mProjectionMatrix;
+    int mViewport[4];
+
+    long long mHitCount;
+    long long mCullHitCount;
+    long long mMissCount;
+    bool mCameraDependentLOD;
+    bool mValid;
+  };
+}
+
+#endif
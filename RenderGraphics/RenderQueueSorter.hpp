@@ -33,14 +33,137 @@
 #define RenderQueueSorter_INCLUDE_ONCE
 
 #include <vlGraphics/RenderToken.hpp>
+#include <vector>
 
 namespace vl
 {
+  //------------------------------------------------------------------------------
+  // RenderKeyIdMap
+  //------------------------------------------------------------------------------
+  /**
+   * Assigns consecutive IDs, in order of first appearance, to the objects referenced by the RenderTokens being sorted.
+   * Used by RenderQueueSorter::encodeKey() to pack shader, texture and geometry pointers into a few bits of a sort key.
+  */
+  class RenderKeyIdMap
+  {
+  public:
+    RenderKeyIdMap(): mGeneration(1), mSize(0) {}
+
+    //! Logically removes all the entries without releasing memory.
+    void clear()
+    {
+      mSize = 0;
+      if ( ++mGeneration == 0 )
+      {
+        // very unlikely wrap around: invalidate the slots explicitly
+        for( size_t i = 0; i < mSlots.size(); ++i ) {
+          mSlots[i].mGeneration = 0;
+        }
+        mGeneration = 1;
+      }
+    }
+
+    //! Returns the ID of \p ptr, assigning the next one if not seen since the last clear().
+    //! IDs greater than \p max_id are clamped to it: the objects are then not grouped together anymore but the sorting remains correct.
+    unsigned int id(const void* ptr, unsigned int max_id)
+    {
+      if ( ( mSize + 1 ) * 2 > (int)mSlots.size() ) {
+        grow();
+      }
+
+      const size_t mask = mSlots.size() - 1;
+      for( size_t i = hash( ptr ) & mask; ; i = ( i + 1 ) & mask )
+      {
+        Slot& slot = mSlots[i];
+        if ( slot.mGeneration != mGeneration )
+        {
+          slot.mGeneration = mGeneration;
+          slot.mKey = ptr;
+          slot.mId = mSize++;
+          return slot.mId < max_id ? slot.mId : max_id;
+        }
+        if ( slot.mKey == ptr ) {
+          return slot.mId < max_id ? slot.mId : max_id;
+        }
+      }
+    }
+
+    //! Number of IDs assigned since the last clear().
+    int size() const { return mSize; }
+
+  private:
+    struct Slot
+    {
+      Slot(): mKey(NULL), mGeneration(0), mId(0) {}
+      const void* mKey;
+      unsigned int mGeneration;
+      unsigned int mId;
+    };
+
+    static size_t hash(const void* ptr)
+    {
+      size_t h = (size_t)ptr >> 4;
+      return h ^ ( h >> 9 ) ^ ( h >> 17 );
+    }
+
+    void grow()
+    {
+      std::vector<Slot> old_slots;
+      old_slots.swap( mSlots );
+      mSlots.resize( old_slots.empty() ? 64 : old_slots.size() * 2 );
+      const size_t mask = mSlots.size() - 1;
+      for( size_t j = 0; j < old_slots.size(); ++j )
+      {
+        if ( old_slots[j].mGeneration != mGeneration ) {
+          continue;
+        }
+        size_t i = hash( old_slots[j].mKey ) & mask;
+        while( mSlots[i].mGeneration == mGeneration ) {
+          i = ( i + 1 ) & mask;
+        }
+        mSlots[i] = old_slots[j];
+      }
+    }
+
+  private:
+    std::vector<Slot> mSlots;
+    unsigned int mGeneration;
+    int mSize;
+  };
+  //------------------------------------------------------------------------------
+  //! The RenderKeyIdMap objects used to encode the keys of a RenderQueue, cleared at every sorting.
+  struct RenderKeyIds
+  {
+    void clear()
+    {
+      mPrograms.clear();
+      mTextures.clear();
+      mStateSets.clear();
+      mEnableSets.clear();
+      mShaders.clear();
+      mGeometries.clear();
+    }
+
+    RenderKeyIdMap mPrograms;
+    RenderKeyIdMap mTextures;
+    RenderKeyIdMap mStateSets;
+    RenderKeyIdMap mEnableSets;
+    RenderKeyIdMap mShaders;
+    RenderKeyIdMap mGeometries;
+  };
   //------------------------------------------------------------------------------
   // RenderQueueSorter
   //------------------------------------------------------------------------------
   /**
    * The RenderQueueSorter class is the abstract base class of all the algorithms used to sort a set of RenderToken.
+   *
+   * Sorters can implement encodeKey() to pack their ordering into a 64 bits key computed once per RenderToken, in which case
+   * RenderQueue::sort() orders the tokens with a radix sort of the keys instead of calling operator() O(n log n) times.
+   * The layout used by the built-in sorters is, from the most significant bit:
+   * - 20 bits: Actor render block, Effect render rank and Actor render rank, see encodeRanks()
+   * - 1 bit: blending enabled
+   * - 43 bits: either the camera distance followed by sorter specific IDs, see encodeDepth(), or the IDs of
+   *   GLSL program, texture, Shader and Renderable assigned by the RenderKeyIds.
   */
   class RenderQueueSorter: public Object
   {
@@ -54,6 +177,48 @@ namespace vl
     virtual bool operator()(const RenderToken* a, const RenderToken* b) const = 0;
     virtual bool confirmZCameraDistanceNeed(const RenderToken*) const = 0;
     virtual bool mightNeedZCameraDistance() const = 0;
+
+    /**
+     * Encodes into \p key the position of \p token in the sorted RenderQueue.
+     * The keys follow the render blocks, ranks, blending and camera distance ordering of operator(), the latter at single
+     * precision, but they are not equivalent to it: the ties that operator() breaks comparing state pointers are broken by
+     * the RenderKeyIds, assigned in order of first appearance, and RenderQueueSorterStandard and RenderQueueSorterAggressive
+     * also group the tokens by GLSL program and by texture or render state set, which their operator() does not do.
+     * Called after RenderToken::mCameraDistance has been computed. Returns \p false if the token cannot be encoded,
+     * in which case the whole RenderQueue is sorted using operator(). The default implementation always returns \p false.
+     */
+    virtual bool encodeKey(const RenderToken* /*token*/, RenderKeyIds& /*ids*/, unsigned long long& /*key*/) const { return false; }
+
+  protected:
+    //! Number of bits at the bottom of the key below the ranks and the blending bit.
+    static const int KeyLowBits = 43;
+
+    //! Puts Actor render block, Effect render rank and Actor render rank in the upper 20 bits of \p key.
+    //! Returns \p false if they do not fit in 6, 7 and 7 bits respectively.
+    static bool encodeRanks(const RenderToken* token, unsigned long long& key)
+    {
+      const int block       = token->mActor->renderBlock()  + 32;
+      const int effect_rank = token->mEffectRenderRank      + 64;
+      const int actor_rank  = token->mActor->renderRank()   + 64;
+      if ( block < 0 || block > 63 || effect_rank < 0 || effect_rank > 127 || actor_rank < 0 || actor_rank > 127 ) {
+        return false;
+      }
+      key = ( (unsigned long long)block << 58 ) | ( (unsigned long long)effect_rank << 51 ) | ( (unsigned long long)actor_rank << 44 );
+      return true;
+    }
+
+    //! Returns the bit used to put blended tokens after the opaque ones.
+    static unsigned long long blendingBit() { return 1ULL << KeyLowBits; }
+
+    //! Maps the camera distance to 32 bits preserving its order, reversed if \p far_to_near is \p true.
+    static unsigned int encodeDepth(real distance, bool far_to_near)
+    {
+      union { float f; unsigned int u; } bits;
+      bits.f = (float)distance;
+      // flip negative values entirely and positive values' sign so that the unsigned order matches the float order
+      unsigned int depth = ( bits.u & 0x80000000u ) ? ~bits.u : ( bits.u | 0x80000000u );
+      return far_to_near ? ~depth : depth;
+    }
   };
   //------------------------------------------------------------------------------
   // RenderQueueSorterByShader
@@ -75,6 +240,11 @@ namespace vl
     {
       return a->mShader < b->mShader;
     }
+    virtual bool encodeKey(const RenderToken* a, RenderKeyIds& ids, unsigned long long& key) const
+    {
+      key = ids.mShaders.id( a->mShader, 0xFFFFFFFF );
+      return true;
+    }
   };
   //------------------------------------------------------------------------------
   // RenderQueueSorterByRenderable
@@ -96,6 +266,11 @@ namespace vl
     {
       return a->mRenderable < b->mRenderable;
     }
+    virtual bool encodeKey(const RenderToken* a, RenderKeyIds& ids, unsigned long long& key) const
+    {
+      key = ids.mGeometries.id( a->mRenderable, 0xFFFFFFFF );
+      return true;
+    }
   };
   //------------------------------------------------------------------------------
   // RenderQueueSorterBasic
@@ -133,6 +308,15 @@ namespace vl
       else
         return a->mRenderable < b->mRenderable;
     }
+    virtual bool encodeKey(const RenderToken* a, RenderKeyIds& ids, unsigned long long& key) const
+    {
+      if ( ! encodeRanks( a, key ) ) {
+        return false;
+      }
+      key |= (unsigned long long)ids.mShaders.id( a->mShader, 0x3FFFFF ) << 21;
+      key |= ids.mGeometries.id( a->mRenderable, 0x1FFFFF );
+      return true;
+    }
   };
   //------------------------------------------------------------------------------
   // RenderQueueSorterStandard
@@ -211,6 +395,32 @@ namespace vl
         return a->mRenderable < b->mRenderable;
     }
 
+    virtual bool encodeKey(const RenderToken* a, RenderKeyIds& ids, unsigned long long& key) const
+    {
+      if ( ! encodeRanks( a, key ) ) {
+        return false;
+      }
+
+      if ( mDepthSortMode != AlwaysDepthSort && a->mShader->isBlendingEnabled() ) {
+        key |= blendingBit();
+      }
+
+      if ( confirmZCameraDistanceNeed(a) ) {
+        key |= (unsigned long long)encodeDepth( a->mCameraDistance, true ) << ( KeyLowBits - 32 );
+      }
+      else
+      {
+        // group by GLSL program and first texture, then by Shader and Renderable
+        const GLSLProgram* glsl = a->mShader->glslProgram();
+        const TextureImageUnit* unit = a->mShader->getRenderStateSet() ? a->mShader->getTextureImageUnit(0) : NULL;
+        key |= (unsigned long long)ids.mPrograms.id( glsl, 0xFF ) << 35;
+        key |= (unsigned long long)ids.mTextures.id( unit ? unit->texture() : NULL, 0xFFF ) << 23;
+        key |= (unsigned long long)ids.mShaders.id( a->mShader, 0x7FF ) << 12;
+        key |= ids.mGeometries.id( a->mRenderable, 0xFFF );
+      }
+      return true;
+    }
+
     EDepthSortMode depthSortMode() const { return mDepthSortMode; }
     void setDepthSortMode(EDepthSortMode mode) { mDepthSortMode = mode; }
 
@@ -285,6 +495,24 @@ namespace vl
       else
         return a->mRenderable < b->mRenderable;
     }
+
+    virtual bool encodeKey(const RenderToken* a, RenderKeyIds& ids, unsigned long long& key) const
+    {
+      if ( ! encodeRanks( a, key ) ) {
+        return false;
+      }
+
+      if ( a->mShader->isBlendingEnabled() ) {
+        key |= blendingBit() | ( (unsigned long long)encodeDepth( a->mCameraDistance, true ) << ( KeyLowBits - 32 ) );
+      }
+      else
+      {
+        // front to back, equal distances grouped by Shader
+        key |= (unsigned long long)encodeDepth( a->mCameraDistance, false ) << ( KeyLowBits - 32 );
+        key |= ids.mShaders.id( a->mShader, 0x7FF );
+      }
+      return true;
+    }
   };
   //------------------------------------------------------------------------------
   // RenderQueueSorterAggressive
@@ -365,6 +593,31 @@ namespace vl
         return a->mRenderable < b->mRenderable;
     }
 
+    virtual bool encodeKey(const RenderToken* a, RenderKeyIds& ids, unsigned long long& key) const
+    {
+      if ( ! encodeRanks( a, key ) ) {
+        return false;
+      }
+
+      if ( mDepthSortMode != AlwaysDepthSort && a->mShader->isBlendingEnabled() ) {
+        key |= blendingBit();
+      }
+
+      if ( confirmZCameraDistanceNeed(a) ) {
+        key |= (unsigned long long)encodeDepth( a->mCameraDistance, true ) << ( KeyLowBits - 32 );
+      }
+      else
+      {
+        // GLSL program -> render state set -> enable set -> Shader -> Renderable
+        key |= (unsigned long long)ids.mPrograms.id( a->mShader->glslProgram(), 0xFF ) << 35;
+        key |= (unsigned long long)ids.mStateSets.id( a->mShader->getRenderStateSet(), 0x3FF ) << 25;
+        key |= (unsigned long long)ids.mEnableSets.id( a->mShader->getEnableSet(), 0x3F ) << 19;
+        key |= (unsigned long long)ids.mShaders.id( a->mShader, 0x3FF ) << 9;
+        key |= ids.mGeometries.id( a->mRenderable, 0x1FF );
+      }
+      return true;
+    }
+
     EDepthSortMode depthSortMode() const { return mDepthSortMode; }
     void setDepthSortMode(EDepthSortMode mode) { mDepthSortMode = mode; }
 
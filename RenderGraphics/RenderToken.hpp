@@ -43,17 +43,16 @@ namespace vl
   //------------------------------------------------------------------------------
   // RenderToken
   //------------------------------------------------------------------------------
-  //! Internally used by the rendering engine
-  class RenderToken: public Object
+  //! Internally used by the rendering engine.
+  //! RenderTokens are stored by value in the RenderQueue, the passes of a multipass Effect are chained by index, see RenderQueue::nextPass().
+  class RenderToken
   {
-    VL_INSTRUMENT_CLASS(vl::RenderToken, Object)
-
   public:
-    RenderToken(): mNextPass(NULL), mActor(NULL), mShader(NULL), mEffectRenderRank(0), mCameraDistance(0.0)
+    RenderToken(): mNextPassIndex(-1), mActor(NULL), mRenderable(NULL), mShader(NULL), mEffectRenderRank(0), mCameraDistance(0.0)
     {
-      VL_DEBUG_SET_OBJECT_NAME()
     }
-    const RenderToken* mNextPass;
+    // Index of the next pass in the RenderQueue's multipass tokens, -1 if this is the last pass.
+    int mNextPassIndex;
 
     Actor* mActor; // Actor is non-const as it can be updated by the ActorEventCallback
     Renderable* mRenderable; // Renderable is non-const because Actor is non-const
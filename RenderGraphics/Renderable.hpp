@@ -38,6 +38,7 @@
 #include <vlCore/Sphere.hpp>
 #include <vlCore/Log.hpp>
 #include <vlGraphics/OpenGL.hpp>
+#include <vlGraphics/OpenGLContext.hpp>
 
 namespace vl
 {
@@ -88,19 +89,21 @@ protected:
         {
           if ( !displayList() )
           {
-            setDisplayList( glGenLists(1) ); VL_CHECK_OGL();
+            setDisplayList( gl_context->mGL._glGenLists(1) ); VL_CHECK_OGL();
           }
           VL_CHECK( displayList() );
-          glNewList( displayList(), GL_COMPILE_AND_EXECUTE ); VL_CHECK_OGL();
+          gl_context->mGL._glNewList( displayList(), GL_COMPILE_AND_EXECUTE ); VL_CHECK_OGL();
             render_Implementation( actor, shader, camera, gl_context ); VL_CHECK_OGL();
-          glEndList(); VL_CHECK_OGL();
+          gl_context->mGL._glEndList(); VL_CHECK_OGL();
           setDisplayListDirty( false );
         }
         else
         {
           VL_CHECK( displayList() );
-          glCallList( displayList() );
+          gl_context->mGL._glCallList( displayList() );
         }
+        // display lists replay their bindings directly
+        gl_context->invalidateStateShadow();
       }
       else
       {
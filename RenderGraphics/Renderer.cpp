@@ -35,15 +35,28 @@
 #include <vlGraphics/Renderer.hpp>
 #include <vlGraphics/OpenGLContext.hpp>
 #include <vlGraphics/GLSL.hpp>
+#include <vlGraphics/Geometry.hpp>
 #include <vlGraphics/RenderQueue.hpp>
 #include <vlCore/Log.hpp>
 
 using namespace vl;
 
+//-----------------------------------------------------------------------------
+namespace
+{
+  // a UniformSet is treated as NULL by renderRaw() if it is empty
+  inline const UniformSet* activeUniformSet(const UniformSet* us)
+  {
+    return us && ! us->uniforms().empty() ? us : NULL;
+  }
+}
+
 //------------------------------------------------------------------------------
 // Renderer
 //------------------------------------------------------------------------------
-Renderer::Renderer()
+Renderer::Renderer():
+  mCommandListEnabled(false), mCommandListValid(false), mCommandListQueue(NULL), mCommandListQueueTick(0), mCommandListCamera(NULL),
+  mCommandListEnableMask(0), mCommandListReplayCount(0), mCommandListRecordCount(0)
 {
   VL_DEBUG_SET_OBJECT_NAME()
 
@@ -53,46 +66,35 @@ Renderer::Renderer()
   mDummyStateSet = new RenderStateSet;
 }
 //------------------------------------------------------------------------------
-namespace
-{
-  struct GLSLProgState
-  {
-  public:
-    GLSLProgState(): mCamera(NULL), mTransform(NULL), mGLSLProgUniformSet(NULL), mShaderUniformSet(NULL), mActorUniformSet(NULL) {}
-
-    bool operator<(const GLSLProgState& other) const
-    {
-      if ( mCamera != other.mCamera )
-        return mCamera < other.mCamera;
-      else
-      if ( mTransform != other.mTransform )
-        return mTransform < other.mTransform;
-      else
-      if ( mGLSLProgUniformSet != other.mGLSLProgUniformSet )
-        return mGLSLProgUniformSet < other.mGLSLProgUniformSet;
-      else
-      if ( mShaderUniformSet != other.mShaderUniformSet )
-        return mShaderUniformSet < other.mShaderUniformSet;
-      else
-        return mActorUniformSet < other.mActorUniformSet;
-    }
-
-    const Camera* mCamera;
-    const Transform* mTransform;
-    const UniformSet* mGLSLProgUniformSet;
-    const UniformSet* mShaderUniformSet;
-    const UniformSet* mActorUniformSet;
-  };
-}
-//------------------------------------------------------------------------------
 const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera* camera, real frame_clock) {
 
-  // FIXME: use a small & simple hash-map<int, GLSLProgState> allocated on the stack
-  // mapping the GLSL program ID to the corresponding GLSLProgState.
-  std::map<const GLSLProgram*, GLSLProgState> glslprogram_map;
+  // maps each GLSLProgram to its GLSLProgState, reuses the memory of the previous renderings.
+  mGLSLProgStates.clear();
 
   OpenGLContext* opengl_context = framebuffer()->openglContext();
 
+  // --------------- uniform buffer ring ---------------
+
+  if ( uniformBufferRing() ) {
+    placeUniformBlocks( render_queue, opengl_context );
+  }
+
+  // --------------- command list ---------------
+
+  if ( commandListEnabled() && commandListValid( render_queue, camera ) )
+  {
+    replayCommandList( opengl_context, camera, frame_clock );
+    ++mCommandListReplayCount;
+    resetRenderingStates( opengl_context );
+    return render_queue;
+  }
+
+  // record the state changes and draw invocations performed below
+  const bool record = commandListEnabled();
+  if ( record ) {
+    beginCommandList( render_queue, camera );
+  }
+
   // --------------- default scissor ---------------
 
   // non GLSLProgram state sets
@@ -127,7 +129,8 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
     // indexed scissoring and viewport.
 
     const Scissor* scissor = actor->scissor() ? actor->scissor() : tok->mShader->scissor();
-    if (cur_scissor != scissor)
+    const bool scissor_changed = cur_scissor != scissor;
+    if (scissor_changed)
     {
       cur_scissor = scissor;
       if (cur_scissor)
@@ -138,12 +141,12 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
       {
         // scissor the viewport by default: needed for points and lines with size > 1.0 as they are not clipped against the viewport.
         VL_CHECK(glIsEnabled(GL_SCISSOR_TEST))
-        glScissor(camera->viewport()->x(), camera->viewport()->y(), camera->viewport()->width(), camera->viewport()->height());
+        opengl_context->mGL._glScissor(camera->viewport()->x(), camera->viewport()->y(), camera->viewport()->width(), camera->viewport()->height());
       }
     }
 
     // multipassing
-    for( int ipass=0; tok != NULL; tok = tok->mNextPass, ++ipass )
+    for( int ipass=0; tok != NULL; tok = render_queue->nextPass(tok), ++ipass )
     {
       VL_CHECK_OGL()
 
@@ -164,12 +167,33 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
         }
       }
 
+      RenderCommand* cmd = NULL;
+      if ( record )
+      {
+        mCommandList.push_back( RenderCommand() );
+        cmd = &mCommandList.back();
+        cmd->mActor      = actor;
+        cmd->mRenderable = tok->mRenderable;
+        cmd->mGeometry   = tok->mRenderable->classType() == Geometry::Type() ? static_cast<const Geometry*>( tok->mRenderable ) : NULL;
+        cmd->mShader     = shader;
+        cmd->mScissor    = scissor;
+        cmd->mPass       = ipass;
+        cmd->mFlags      = ipass == 0 && scissor_changed ? RC_Scissor : 0;
+        if ( mCommandListShaders.empty() || mCommandListShaders.back().first != shader ) {
+          mCommandListShaders.push_back( std::make_pair( shader, shader->updateTick() ) );
+        }
+      }
+
       // shader's render states
 
       if ( cur_render_state_set != shader->getRenderStateSet() )
       {
         opengl_context->applyRenderStates( shader->getRenderStateSet(), camera );
         cur_render_state_set = shader->getRenderStateSet();
+        if ( cmd ) {
+          cmd->mRenderStateSet = cur_render_state_set;
+          cmd->mFlags |= RC_RenderStates;
+        }
       }
 
       VL_CHECK_OGL()
@@ -180,10 +204,14 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
       {
         opengl_context->applyEnables( shader->getEnableSet() );
         cur_enable_set = shader->getEnableSet();
+        if ( cmd ) {
+          cmd->mEnableSet = cur_enable_set;
+          cmd->mFlags |= RC_Enables;
+        }
       }
 
       #ifndef NDEBUG
-        if (glGetError() != GL_NO_ERROR)
+        if (opengl_context->mGL._glGetError() != GL_NO_ERROR)
         {
           Log::error("An unsupported OpenGL glEnable/glDisable capability has been enabled!\n");
           VL_TRAP()
@@ -230,19 +258,17 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
       bool update_pu = false; // update glsl-program uniforms
       bool update_su = false; // update shader uniforms
       bool update_au = false; // update actor uniforms
-      GLSLProgState* glsl_state = NULL;
 
       // retrieve the state of this GLSLProgram (including the NULL one)
-      std::map<const GLSLProgram*, GLSLProgState>::iterator glsl_state_it = glslprogram_map.find(cur_glsl_program);
+      bool first_use = false;
+      GLSLProgState* glsl_state = mGLSLProgStates.find(cur_glsl_program, first_use);
 
-      if ( glsl_state_it == glslprogram_map.end() )
+      if ( first_use )
       {
         //
         // this is the first time we see this GLSL program so we update everything we can
         //
 
-        // create a new glsl-state entry
-        glsl_state = &glslprogram_map[cur_glsl_program];
         update_cm = true;
         update_tr = true;
         update_pu = cur_glsl_prog_uniform_set != NULL;
@@ -255,7 +281,6 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
         // we already know this GLSLProgram so we update only what has changed since last time
         //
 
-        glsl_state = &glsl_state_it->second;
         // check for differences
         update_cm = glsl_state->mCamera             != camera;
         update_tr = glsl_state->mTransform          != cur_transform;
@@ -264,6 +289,24 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
         update_au = glsl_state->mActorUniformSet    != cur_actor_uniform_set     && cur_actor_uniform_set     != NULL;
       }
 
+      // uniform buffer binding points are shared by all the GLSL programs: uniform blocks are bound at every use
+      update_pu |= cur_glsl_prog_uniform_set && cur_glsl_prog_uniform_set->storage() == USS_UniformBlock;
+      update_su |= cur_shader_uniform_set    && cur_shader_uniform_set->storage()    == USS_UniformBlock;
+      update_au |= cur_actor_uniform_set     && cur_actor_uniform_set->storage()     == USS_UniformBlock;
+
+      if ( cmd )
+      {
+        cmd->mGLSLProgram    = cur_glsl_program;
+        cmd->mTransform      = cur_transform;
+        cmd->mFlags         |= ( update_cm ? RC_UpdateCamera : 0 ) | ( update_tr ? RC_UpdateTransform : 0 );
+        cmd->mUniformSets[0] = update_pu ? cur_glsl_prog_uniform_set : NULL;
+        cmd->mUniformSets[1] = update_su ? cur_shader_uniform_set : NULL;
+        cmd->mUniformSets[2] = update_au ? cur_actor_uniform_set : NULL;
+        cmd->mActiveUniformSets[0] = cur_glsl_prog_uniform_set;
+        cmd->mActiveUniformSets[1] = cur_shader_uniform_set;
+        cmd->mActiveUniformSets[2] = cur_actor_uniform_set;
+      }
+
       // update glsl-state structure
       glsl_state->mCamera             = camera;
       glsl_state->mTransform          = cur_transform;
@@ -295,7 +338,7 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
       {
         VL_CHECK( cur_glsl_prog_uniform_set && cur_glsl_prog_uniform_set->uniforms().size() );
         VL_CHECK( shader->getRenderStateSet()->glslProgram() && shader->getRenderStateSet()->glslProgram()->handle() )
-        cur_glsl_program->applyUniformSet( cur_glsl_prog_uniform_set );
+        cur_glsl_program->applyUniformSet( cur_glsl_prog_uniform_set, opengl_context );
       }
 
       VL_CHECK_OGL()
@@ -305,7 +348,7 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
       {
         VL_CHECK( cur_shader_uniform_set && cur_shader_uniform_set->uniforms().size() );
         VL_CHECK( shader->getRenderStateSet()->glslProgram() && shader->getRenderStateSet()->glslProgram()->handle() )
-        cur_glsl_program->applyUniformSet( cur_shader_uniform_set );
+        cur_glsl_program->applyUniformSet( cur_shader_uniform_set, opengl_context );
       }
 
       VL_CHECK_OGL()
@@ -315,7 +358,7 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
       {
         VL_CHECK( cur_actor_uniform_set && cur_actor_uniform_set->uniforms().size() );
         VL_CHECK( shader->getRenderStateSet()->glslProgram() && shader->getRenderStateSet()->glslProgram()->handle() )
-        cur_glsl_program->applyUniformSet( cur_actor_uniform_set );
+        cur_glsl_program->applyUniformSet( cur_actor_uniform_set, opengl_context );
       }
 
       VL_CHECK_OGL()
@@ -341,6 +384,18 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
     }
   }
 
+  if ( record ) {
+    mCommandListValid = true;
+    ++mCommandListRecordCount;
+  }
+
+  resetRenderingStates( opengl_context );
+
+  return render_queue;
+}
+//------------------------------------------------------------------------------
+void Renderer::resetRenderingStates(OpenGLContext* opengl_context)
+{
   // clear enables
   opengl_context->applyEnables( mDummyEnables.get() ); VL_CHECK_OGL();
 
@@ -348,18 +403,162 @@ const RenderQueue* Renderer::renderRaw(const RenderQueue* render_queue, Camera*
   opengl_context->applyRenderStates( mDummyStateSet.get(), NULL ); VL_CHECK_OGL();
 
   // enabled texture unit #0
-  glActiveTexture( GL_TEXTURE0 ); VL_CHECK_OGL();
+  opengl_context->activeTexture( 0 );
   if ( Has_Fixed_Function_Pipeline ) {
     glClientActiveTexture( GL_TEXTURE0 ); VL_CHECK_OGL();
   }
 
   // disable scissor test
-  glDisable( GL_SCISSOR_TEST ); VL_CHECK_OGL();
+  opengl_context->mGL._glDisable( GL_SCISSOR_TEST ); VL_CHECK_OGL();
 
   // disable all vertex arrays, note this also calls "glBindBuffer(GL_ARRAY_BUFFER, 0)"
   opengl_context->bindVAS( NULL, false, false ); VL_CHECK_OGL();
+}
+//------------------------------------------------------------------------------
+void Renderer::placeUniformBlocks(const RenderQueue* render_queue, OpenGLContext* opengl_context)
+{
+  UniformBufferRing* ring = uniformBufferRing();
+  ring->beginFrame();
+  for(int itok=0; itok < render_queue->size(); ++itok)
+  {
+    const Actor* actor = render_queue->at(itok)->mActor;
+    if ( isEnabled( actor ) && actor->getUniformSet() && actor->getUniformSet()->storage() == USS_UniformBlock ) {
+      ring->place( actor->getUniformSet() );
+    }
+  }
+  ring->upload( opengl_context );
+}
+//------------------------------------------------------------------------------
+bool Renderer::commandListValid(const RenderQueue* render_queue, const Camera* camera) const
+{
+  if ( ! mCommandListValid || render_queue != mCommandListQueue || render_queue->updateTick() != mCommandListQueueTick ||
+       camera != mCommandListCamera || enableMask() != mCommandListEnableMask ||
+       mShaderOverrideMask.size() != mCommandListOverrides.size() )
+    return false;
 
-  return render_queue;
+  size_t iovr = 0;
+  for( std::map< unsigned int, ref<Shader> >::const_iterator it = mShaderOverrideMask.begin(); it != mShaderOverrideMask.end(); ++it, ++iovr )
+  {
+    if ( it->first != mCommandListOverrides[iovr].first || it->second.get() != mCommandListOverrides[iovr].second )
+      return false;
+  }
+
+  for( size_t i = 0; i < mCommandListShaders.size(); ++i )
+  {
+    if ( mCommandListShaders[i].first->updateTick() != mCommandListShaders[i].second )
+      return false;
+  }
+
+  // the enable state selects the recorded Actors and the enable mask their shader overrides
+  for( int itok = 0; itok < render_queue->size(); ++itok )
+  {
+    const RenderToken* tok = render_queue->at(itok);
+    const Actor* actor = tok->mActor;
+    if ( ( actor->isEnabled() ? actor->enableMask() : 0 ) != mCommandListActorMasks[itok] )
+      return false;
+    if ( ( actor->scissor() ? actor->scissor() : tok->mShader->scissor() ) != mCommandListScissors[itok] )
+      return false;
+  }
+
+  // the commands refer to these objects: they must not have been replaced by Actor::setUniformSet(), setTransform() etc.
+  for( size_t i = 0; i < mCommandList.size(); ++i )
+  {
+    const RenderCommand& cmd = mCommandList[i];
+    if ( cmd.mActor->transform() != cmd.mTransform )
+      return false;
+
+    const GLSLProgram* glsl = cmd.mShader->glslProgram();
+    if ( ! glsl || ! glsl->handle() || ! glsl->linked() )
+      glsl = NULL;
+    if ( glsl != cmd.mGLSLProgram )
+      return false;
+
+    if ( glsl )
+    {
+      if ( activeUniformSet( glsl->getUniformSet() )           != cmd.mActiveUniformSets[0] ||
+           activeUniformSet( cmd.mShader->getUniformSet() )    != cmd.mActiveUniformSets[1] ||
+           activeUniformSet( cmd.mActor->getUniformSet() )     != cmd.mActiveUniformSets[2] )
+        return false;
+    }
+  }
+
+  return true;
+}
+//------------------------------------------------------------------------------
+void Renderer::beginCommandList(const RenderQueue* render_queue, const Camera* camera)
+{
+  mCommandListValid      = false;
+  mCommandListQueue      = render_queue;
+  mCommandListQueueTick  = render_queue->updateTick();
+  mCommandListCamera     = camera;
+  mCommandListEnableMask = enableMask();
+
+  mCommandListOverrides.clear();
+  for( std::map< unsigned int, ref<Shader> >::const_iterator it = mShaderOverrideMask.begin(); it != mShaderOverrideMask.end(); ++it ) {
+    mCommandListOverrides.push_back( std::make_pair( it->first, (const Shader*)it->second.get() ) );
+  }
+
+  mCommandListActorMasks.resize( render_queue->size() );
+  mCommandListScissors.resize( render_queue->size() );
+  for( int itok = 0; itok < render_queue->size(); ++itok )
+  {
+    const Actor* actor = render_queue->at(itok)->mActor;
+    mCommandListActorMasks[itok] = actor->isEnabled() ? actor->enableMask() : 0;
+    mCommandListScissors[itok] = actor->scissor() ? actor->scissor() : render_queue->at(itok)->mShader->scissor();
+  }
+
+  // the memory is reused across recordings
+  mCommandList.clear();
+  mCommandListShaders.clear();
+}
+//------------------------------------------------------------------------------
+void Renderer::replayCommandList(OpenGLContext* opengl_context, Camera* camera, real frame_clock)
+{
+  const RenderCommand* cmd = mCommandList.empty() ? NULL : &mCommandList[0];
+  const RenderCommand* end = cmd + mCommandList.size();
+  for( ; cmd != end; ++cmd )
+  {
+    VL_CHECK_OGL()
+
+    if ( cmd->mFlags & RC_Scissor )
+    {
+      if (cmd->mScissor) {
+        cmd->mScissor->enable(camera->viewport());
+      } else {
+        opengl_context->mGL._glScissor(camera->viewport()->x(), camera->viewport()->y(), camera->viewport()->width(), camera->viewport()->height());
+      }
+    }
+
+    if ( cmd->mFlags & RC_RenderStates ) {
+      opengl_context->applyRenderStates( cmd->mRenderStateSet, camera );
+    }
+
+    if ( cmd->mFlags & RC_Enables ) {
+      opengl_context->applyEnables( cmd->mEnableSet );
+    }
+
+    Actor* actor = cmd->mActor;
+    actor->dispatchOnActorRenderStarted( frame_clock, camera, cmd->mRenderable, cmd->mShader, cmd->mPass );
+
+    if ( cmd->mFlags & ( RC_UpdateCamera | RC_UpdateTransform ) ) {
+      projViewTransfCallback()->updateMatrices( ( cmd->mFlags & RC_UpdateCamera ) != 0, ( cmd->mFlags & RC_UpdateTransform ) != 0, cmd->mGLSLProgram, camera, cmd->mTransform );
+    }
+
+    for( int i = 0; i < 3; ++i )
+    {
+      if ( cmd->mUniformSets[i] ) {
+        cmd->mGLSLProgram->applyUniformSet( cmd->mUniformSets[i], opengl_context );
+      }
+    }
+
+    // plain Geometry objects with up to date buffers skip the virtual render_Implementation()
+    const Geometry* geom = cmd->mGeometry;
+    if ( geom && ! geom->isDisplayListEnabled() && ! ( geom->isBufferObjectEnabled() && geom->isBufferObjectDirty() ) ) {
+      geom->renderGeometry( opengl_context );
+    } else {
+      cmd->mRenderable->render( actor, cmd->mShader, camera, opengl_context );
+    }
+  }
 }
 //------------------------------------------------------------------------------
 const RenderQueue* Renderer::render(const RenderQueue* render_queue, Camera* camera, real frame_clock)
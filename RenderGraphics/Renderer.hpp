@@ -37,10 +37,13 @@
 #include <vlGraphics/ProjViewTransfCallback.hpp>
 #include <vlGraphics/Shader.hpp>
 #include <vlGraphics/Actor.hpp>
+#include <vlGraphics/UniformBufferRing.hpp>
 #include <map>
 
 namespace vl
 {
+  class Geometry;
+
   //-----------------------------------------------------------------------------
   // Renderer
   //-----------------------------------------------------------------------------
@@ -102,6 +105,191 @@ namespace vl
     /** The Framebuffer on which the rendering is performed. */
     FramebufferObject* framebuffer() { return mFramebuffer.get(); }
 
+    /** When enabled renderRaw() records the state changes and the draw invocations it performs into a flat command list which
+      * is replayed by the following renderRaw() calls without re-deriving the render state, enable, scissor and uniform set changes.
+      *
+      * The command list is recorded again when the RenderQueue or its RenderQueue::updateTick(), the camera, the enable mask,
+      * the shader override mask, the Shader::updateTick() of the rendered Shaders, the Actor::isEnabled() and
+      * Actor::enableMask() of the queued Actor[s] or the Transform, Scissor, GLSLProgram and non empty UniformSet[s]
+      * used by each recorded pass change. Other changes affecting the rendering of the recorded Actor[s], such as
+      * switching the UniformSet::storage() of a used UniformSet, require a call to invalidateCommandList(). Plain Geometry objects are replayed without going through the virtual
+      * Renderable::render_Implementation(), see Geometry::renderGeometry(). Default is false.
+      *
+      * \sa Rendering::setRenderQueueCacheEnabled() */
+    void setCommandListEnabled(bool enabled) { mCommandListEnabled = enabled; invalidateCommandList(); }
+
+    /** Whether renderRaw() records and replays a command list, see setCommandListEnabled(). */
+    bool commandListEnabled() const { return mCommandListEnabled; }
+
+    /** Forces the next renderRaw() to record the command list again. */
+    void invalidateCommandList() { mCommandListValid = false; }
+
+    /** Number of renderRaw() calls that replayed the command list. */
+    long long commandListReplayCount() const { return mCommandListReplayCount; }
+
+    /** Number of renderRaw() calls that recorded the command list. */
+    long long commandListRecordCount() const { return mCommandListRecordCount; }
+
+    /** When set, at the beginning of renderRaw() the Actor uniform sets using the USS_UniformBlock storage are packed together
+      * in \p ring and uploaded with a single call, each draw then binds its own range of the ring. Default is NULL.
+      * \sa UniformSet::setStorage() */
+    void setUniformBufferRing(UniformBufferRing* ring) { mUniformBufferRing = ring; }
+
+    /** The UniformBufferRing used for the Actor uniform sets, see setUniformBufferRing(). */
+    UniformBufferRing* uniformBufferRing() { return mUniformBufferRing.get(); }
+
+    /** The UniformBufferRing used for the Actor uniform sets, see setUniformBufferRing(). */
+    const UniformBufferRing* uniformBufferRing() const { return mUniformBufferRing.get(); }
+
+  protected:
+    //! The flags of a RenderCommand.
+    typedef enum
+    {
+      RC_Scissor         = 0x01,
+      RC_RenderStates    = 0x02,
+      RC_Enables         = 0x04,
+      RC_UpdateCamera    = 0x08,
+      RC_UpdateTransform = 0x10
+    } ERenderCommandFlag;
+
+    //! A rendering pass recorded by renderRaw(): the state changes to be performed before rendering the Renderable, see setCommandListEnabled().
+    struct RenderCommand
+    {
+      RenderCommand(): mActor(NULL), mRenderable(NULL), mGeometry(NULL), mShader(NULL), mScissor(NULL), mRenderStateSet(NULL), mEnableSet(NULL),
+                       mGLSLProgram(NULL), mTransform(NULL), mPass(0), mFlags(0)
+      {
+        mUniformSets[0] = mUniformSets[1] = mUniformSets[2] = NULL;
+        mActiveUniformSets[0] = mActiveUniformSets[1] = mActiveUniformSets[2] = NULL;
+      }
+
+      Actor* mActor;
+      Renderable* mRenderable;
+      // the Renderable if it is a plain Geometry, rendered without virtual calls
+      const Geometry* mGeometry;
+      const Shader* mShader;
+      const Scissor* mScissor;
+      const RenderStateSet* mRenderStateSet;
+      const EnableSet* mEnableSet;
+      const GLSLProgram* mGLSLProgram;
+      const Transform* mTransform;
+      // the GLSLProgram, Shader and Actor uniform sets to be applied, NULL if unchanged
+      const UniformSet* mUniformSets[3];
+      // the GLSLProgram, Shader and Actor uniform sets in use, NULL if empty: checked by commandListValid()
+      const UniformSet* mActiveUniformSets[3];
+      int mPass;
+      unsigned int mFlags;
+    };
+
+    bool commandListValid(const RenderQueue* render_queue, const Camera* camera) const;
+    void beginCommandList(const RenderQueue* render_queue, const Camera* camera);
+    void replayCommandList(OpenGLContext* opengl_context, Camera* camera, real frame_clock);
+    void resetRenderingStates(OpenGLContext* opengl_context);
+    void placeUniformBlocks(const RenderQueue* render_queue, OpenGLContext* opengl_context);
+
+  protected:
+    //! The uniform sets, transform and camera last applied to a GLSLProgram during renderRaw().
+    struct GLSLProgState
+    {
+      GLSLProgState(): mCamera(NULL), mTransform(NULL), mGLSLProgUniformSet(NULL), mShaderUniformSet(NULL), mActorUniformSet(NULL) {}
+
+      const Camera* mCamera;
+      const Transform* mTransform;
+      const UniformSet* mGLSLProgUniformSet;
+      const UniformSet* mShaderUniformSet;
+      const UniformSet* mActorUniformSet;
+    };
+
+    /** Open addressing hash map from GLSLProgram (including the NULL one) to GLSLProgState used by renderRaw().
+      * clear() runs in constant time and keeps the allocated slots so that in steady state no memory is allocated. */
+    class GLSLProgStateCache
+    {
+    public:
+      GLSLProgStateCache(): mGeneration(1), mSize(0) {}
+
+      //! Logically removes all the entries without releasing memory.
+      void clear()
+      {
+        mSize = 0;
+        if ( ++mGeneration == 0 )
+        {
+          // very unlikely wrap around: invalidate the slots explicitly
+          for( size_t i = 0; i < mSlots.size(); ++i ) {
+            mSlots[i].mGeneration = 0;
+          }
+          mGeneration = 1;
+        }
+      }
+
+      //! Returns the state associated to \p glsl, creating a default one if not present in which case \p created is set to \p true.
+      GLSLProgState* find(const GLSLProgram* glsl, bool& created)
+      {
+        if ( ( mSize + 1 ) * 2 > (int)mSlots.size() ) {
+          grow();
+        }
+
+        const size_t mask = mSlots.size() - 1;
+        for( size_t i = hash( glsl ) & mask; ; i = ( i + 1 ) & mask )
+        {
+          Slot& slot = mSlots[i];
+          if ( slot.mGeneration != mGeneration )
+          {
+            slot.mGeneration = mGeneration;
+            slot.mKey = glsl;
+            slot.mState = GLSLProgState();
+            ++mSize;
+            created = true;
+            return &slot.mState;
+          }
+          if ( slot.mKey == glsl )
+          {
+            created = false;
+            return &slot.mState;
+          }
+        }
+      }
+
+      //! Number of entries since the last clear().
+      int size() const { return mSize; }
+
+    private:
+      struct Slot
+      {
+        Slot(): mKey(NULL), mGeneration(0) {}
+        const GLSLProgram* mKey;
+        unsigned int mGeneration;
+        GLSLProgState mState;
+      };
+
+      static size_t hash(const GLSLProgram* glsl)
+      {
+        size_t h = (size_t)glsl >> 4;
+        return h ^ ( h >> 9 ) ^ ( h >> 17 );
+      }
+
+      void grow()
+      {
+        std::vector<Slot> old_slots;
+        old_slots.swap( mSlots );
+        mSlots.resize( old_slots.empty() ? 16 : old_slots.size() * 2 );
+        const size_t mask = mSlots.size() - 1;
+        for( size_t j = 0; j < old_slots.size(); ++j )
+        {
+          if ( old_slots[j].mGeneration != mGeneration ) {
+            continue;
+          }
+          size_t i = hash( old_slots[j].mKey ) & mask;
+          while( mSlots[i].mGeneration == mGeneration ) {
+            i = ( i + 1 ) & mask;
+          }
+          mSlots[i] = old_slots[j];
+        }
+      }
+
+      std::vector<Slot> mSlots;
+      unsigned int mGeneration;
+      int mSize;
+    };
+
   protected:
     ref<FramebufferObject> mFramebuffer;
 
@@ -114,6 +302,25 @@ namespace vl
     std::vector<RenderStateSlot> mOverriddenDefaultRenderStates;
 
     ref<ProjViewTransfCallback> mProjViewTransfCallback;
+    ref<UniformBufferRing> mUniformBufferRing;
+
+    // per-renderRaw() GLSLProgram state tracking
+    GLSLProgStateCache mGLSLProgStates;
+
+    // recorded command list and the inputs it was recorded from
+    std::vector<RenderCommand> mCommandList;
+    std::vector< std::pair<const Shader*, long long> > mCommandListShaders;
+    std::vector< std::pair<unsigned int, const Shader*> > mCommandListOverrides;
+    std::vector<unsigned int> mCommandListActorMasks; // enableMask() of the queued Actors, 0 if disabled
+    std::vector<const Scissor*> mCommandListScissors; // Scissor used by the queued Actors
+    bool mCommandListEnabled;
+    bool mCommandListValid;
+    const RenderQueue* mCommandListQueue;
+    long long mCommandListQueueTick;
+    const Camera* mCommandListCamera;
+    unsigned int mCommandListEnableMask;
+    long long mCommandListReplayCount;
+    long long mCommandListRecordCount;
   };
   //------------------------------------------------------------------------------
 }
@@ -37,21 +37,29 @@
 #include <vlGraphics/GLSL.hpp>
 #include <vlCore/Log.hpp>
 #include <vlCore/Say.hpp>
+#include <vlCore/Time.hpp>
 
 using namespace vl;
 
 //------------------------------------------------------------------------------
 Rendering::Rendering():
   mAutomaticResourceInit(true),
+  mRenderQueueCacheEnabled(false),
   mCullingEnabled(true),
   mEvaluateLOD(true),
   mShaderAnimationEnabled(true),
-  mNearFarClippingPlanesOptimized(false)
+  mNearFarClippingPlanesOptimized(false),
+  mParallelCullingDepth(4),
+  mParallelRenderQueueThreshold(2048),
+  mStageTimingEnabled(false)
 {
   VL_DEBUG_SET_OBJECT_NAME()
+  for(int i=0; i<RSG_StageCount; ++i)
+    mStageTime[i] = 0;
   mRenderQueueSorter  = new RenderQueueSorterStandard;
   mActorQueue         = new ActorCollection;
   mRenderQueue        = new RenderQueue;
+  mRenderQueueCache   = new RenderQueueCache;
   mSceneManagers      = new Collection<SceneManager>;
   mCamera             = new Camera;
   mTransform          = new Transform;
@@ -64,10 +72,15 @@ Rendering& Rendering::operator=(const Rendering& other)
 
   mEnableMask               = other.mEnableMask;
   mAutomaticResourceInit    = other.mAutomaticResourceInit;
+  mRenderQueueCacheEnabled  = other.mRenderQueueCacheEnabled;
+  mRenderQueueCache->invalidate();
   mCullingEnabled    = other.mCullingEnabled;
   mEvaluateLOD              = other.mEvaluateLOD;
   mShaderAnimationEnabled   = other.mShaderAnimationEnabled;
   mNearFarClippingPlanesOptimized = other.mNearFarClippingPlanesOptimized;
+  mParallelCullingDepth     = other.mParallelCullingDepth;
+  mParallelRenderQueueThreshold = other.mParallelRenderQueueThreshold;
+  mStageTimingEnabled       = other.mStageTimingEnabled;
 
   mRenderQueueSorter   = other.mRenderQueueSorter;
   /*mActorQueue        = other.mActorQueue;*/
@@ -76,6 +89,8 @@ Rendering& Rendering::operator=(const Rendering& other)
   mRenderers           = other.mRenderers;
   mCamera              = other.mCamera;
   mTransform           = other.mTransform;
+  mCullingThreadPool   = other.mCullingThreadPool;
+  mRenderQueueThreadPool = other.mRenderQueueThreadPool;
 
   return *this;
 }
@@ -169,6 +184,8 @@ void Rendering::render()
   if (!camera()->viewport())
     return;
 
+  double stage_start = stageTimingEnabled() ? Time::currentTime() : 0;
+
   // transform
 
   if (transform() != NULL)
@@ -181,67 +198,139 @@ void Rendering::render()
 
   VL_CHECK_OGL()
 
-  // culling & actor queue filling
-
-  camera()->computeFrustumPlanes();
+  // render queue cache: reuse the whole render queue if nothing changed, or the tokens if only the camera changed
 
-  // if near/far clipping planes optimization is enabled don't perform far-culling
-  if (nearFarClippingPlanesOptimized())
+  bool reuse_queue  = false;
+  bool reuse_tokens = false;
+  if ( renderQueueCacheEnabled() )
   {
-    // perform only near culling with plane at distance 0
-    camera()->frustum().planes().resize(5);
-    camera()->frustum().planes()[4] = Plane( camera()->modelingMatrix().getT(),
-                                             camera()->modelingMatrix().getZ());
+    if ( mRenderQueueCache->valid() && ! mRenderQueueCache->sceneChanged(this) )
+    {
+      reuse_queue  = ! mRenderQueueCache->cameraChanged( camera() );
+      reuse_tokens = ! mRenderQueueCache->cameraDependentLOD();
+    }
   }
 
-  actorQueue()->clear();
-  for(size_t i = 0; i < sceneManagers()->size(); ++i )
+  bool tokens_reused = reuse_queue;
+  if ( ! reuse_queue )
   {
-    if ( isEnabled( sceneManagers()->at(i)->enableMask() ) )
+    // culling & actor queue filling
+
+    camera()->computeFrustumPlanes();
+
+    // if near/far clipping planes optimization is enabled don't perform far-culling
+    if (nearFarClippingPlanesOptimized())
     {
-      if ( cullingEnabled() && sceneManagers()->at(i)->cullingEnabled() )
+      // perform only near culling with plane at distance 0
+      camera()->frustum().planes().resize(5);
+      camera()->frustum().planes()[4] = Plane( camera()->modelingMatrix().getT(),
+                                               camera()->modelingMatrix().getZ());
+    }
+
+    actorQueue()->clear();
+    for(size_t i = 0; i < sceneManagers()->size(); ++i )
+    {
+      if ( isEnabled( sceneManagers()->at(i)->enableMask() ) )
       {
-        if ( sceneManagers()->at(i)->boundsDirty() ) {
-          sceneManagers()->at(i)->computeBounds();
-        }
+        if ( cullingEnabled() && sceneManagers()->at(i)->cullingEnabled() )
+        {
+          if ( sceneManagers()->at(i)->boundsDirty() ) {
+            sceneManagers()->at(i)->computeBounds();
+          }
 
-        // try to cull the scene with both bsphere and bbox
-        if ( camera()->frustum().cull( sceneManagers()->at(i)->boundingSphere() ) ||
-             camera()->frustum().cull( sceneManagers()->at(i)->boundingBox() ) ) {
-          continue;
-        } else {
-          sceneManagers()->at(i)->extractVisibleActors( *actorQueue(), camera() );
+          // try to cull the scene with both bsphere and bbox
+          if ( camera()->frustum().cull( sceneManagers()->at(i)->boundingSphere() ) ||
+               camera()->frustum().cull( sceneManagers()->at(i)->boundingBox() ) ) {
+            continue;
+          } else if ( cullingThreadPool() ) {
+            sceneManagers()->at(i)->extractVisibleActorsParallel( *actorQueue(), camera(), cullingThreadPool(), parallelCullingDepth() );
+          } else {
+            sceneManagers()->at(i)->extractVisibleActors( *actorQueue(), camera() );
+          }
+        }
+        else {
+          sceneManagers()->at(i)->extractVisibleActors( *actorQueue(), NULL );
         }
-      }
-      else {
-        sceneManagers()->at(i)->extractVisibleActors( *actorQueue(), NULL );
       }
     }
-  }
 
-  // collect near/far clipping planes optimization information
-  if (nearFarClippingPlanesOptimized())
-  {
-    Sphere world_bounding_sphere;
-    for(size_t i=0; i<actorQueue()->size(); ++i)
-      world_bounding_sphere += actorQueue()->at(i)->boundingSphere();
+    // collect near/far clipping planes optimization information
+    if (nearFarClippingPlanesOptimized())
+    {
+      Sphere world_bounding_sphere;
+      for(size_t i=0; i<actorQueue()->size(); ++i)
+        world_bounding_sphere += actorQueue()->at(i)->boundingSphere();
 
-    // compute the optimized
-    camera()->computeNearFarOptimizedProjMatrix(world_bounding_sphere);
+      // compute the optimized
+      camera()->computeNearFarOptimizedProjMatrix(world_bounding_sphere);
 
-    // recompute frustum planes to account for new near/far values
-    camera()->computeFrustumPlanes();
-  }
+      // recompute frustum planes to account for new near/far values
+      camera()->computeFrustumPlanes();
+    }
 
-  // render queue filling
+    if (stageTimingEnabled())
+      stage_start = lapStageTime(RSG_Culling, stage_start);
 
-  renderQueue()->clear();
-  fillRenderQueue( actorQueue() );
+    // render queue filling and sorting, skipped if the culled actors did not change
 
-  // sort the rendering queue according to this renderer sorting algorithm
+    if ( reuse_tokens && ! mRenderQueueCache->visibleActorsChanged( actorQueue() ) )
+    {
+      if (stageTimingEnabled())
+        stage_start = lapStageTime(RSG_FillRenderQueue, stage_start);
+
+      // the camera distances might have changed
+      if ( renderQueueSorter() && renderQueueSorter()->mightNeedZCameraDistance() )
+        renderQueue()->sort( renderQueueSorter(), camera() );
+
+      tokens_reused = true;
+      mRenderQueueCache->countCullHit();
+    }
+    else
+    {
+      renderQueue()->clear();
+      fillRenderQueue( actorQueue() );
+
+      if (stageTimingEnabled())
+        stage_start = lapStageTime(RSG_FillRenderQueue, stage_start);
+
+      // sort the rendering queue according to this renderer sorting algorithm
+
+      if (renderQueueSorter())
+        renderQueue()->sort( renderQueueSorter(), camera() );
+
+      if ( renderQueueCacheEnabled() )
+      {
+        mRenderQueueCache->storeScene( this, actorQueue() );
+        mRenderQueueCache->countMiss();
+      }
+    }
 
-  if (renderQueueSorter())
-    renderQueue()->sort( renderQueueSorter(), camera() );
+    if (stageTimingEnabled())
+      stage_start = lapStageTime(RSG_SortRenderQueue, stage_start);
+  }
+  else
+  {
+    if (stageTimingEnabled())
+    {
+      stage_start = lapStageTime(RSG_Culling, stage_start);
+      stage_start = lapStageTime(RSG_FillRenderQueue, stage_start);
+      stage_start = lapStageTime(RSG_SortRenderQueue, stage_start);
+    }
+    mRenderQueueCache->countHit();
+  }
+
+  // store the camera as used by this rendering: with the near/far optimization its projection matrix has just been modified,
+  // storing it before would make an idle camera look changed at every rendering
+  if ( renderQueueCacheEnabled() )
+    mRenderQueueCache->storeCamera( camera() );
+
+  // the shaders of a reused render queue are still animated at every rendering
+
+  if ( tokens_reused )
+  {
+    std::set<Shader*> shader_set;
+    prepareShaders( renderQueue(), 0, shader_set );
+  }
 
   // --- RENDER THE QUEUE: loop through the renderers, feeding the output of one as input for the next ---
 
@@ -269,9 +358,19 @@ void Rendering::render()
     }
   }
 
+  if (stageTimingEnabled())
+    lapStageTime(RSG_Render, stage_start);
+
   VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
+double Rendering::lapStageTime(ERenderingStage stage, double start)
+{
+  double now = Time::currentTime();
+  mStageTime[stage] = now - start;
+  return now;
+}
+//------------------------------------------------------------------------------
 void Rendering::fillRenderQueue( ActorCollection* actor_list )
 {
   if (actor_list == NULL)
@@ -286,75 +385,138 @@ void Rendering::fillRenderQueue( ActorCollection* actor_list )
   if (enableMask() == 0)
     return;
 
+  if ( renderQueueThreadPool() && (int)actor_list->size() >= parallelRenderQueueThreshold() )
+  {
+    fillRenderQueueParallel( actor_list );
+    return;
+  }
+
   RenderQueue* list = renderQueue();
   std::set<Shader*> shader_set;
 
   // iterate actor list
 
   for(size_t iactor=0; iactor < actor_list->size(); iactor++)
+  {
+    const int first_token = list->size();
+    fillActorTokens( list, actor_list->at(iactor), false );
+    prepareShaders( list, first_token, shader_set );
+  }
+}
+//------------------------------------------------------------------------------
+void Rendering::fillRenderQueueParallel( ActorCollection* actor_list )
+{
+  ThreadPool* thread_pool = renderQueueThreadPool();
+  const int actor_count = (int)actor_list->size();
+
+  // the lazy bounds computation of a Renderable shared by several Actor[s] is not thread-safe, update them upfront
+  for(int iactor=0; iactor < actor_count; ++iactor)
   {
     Actor* actor = actor_list->at(iactor);
+    if ( actor->lod(0) && actor->lod(0)->boundsDirty() )
+      actor->lod(0)->computeBounds();
+  }
 
-    VL_CHECK(actor->lod(0))
+  // a few contiguous ranges of actors per thread to balance the load, each one filling its own arena
 
-    if ( ! isEnabled(actor) )
-      continue;
+  const int range_count = ThreadPool::rangeCount( thread_pool, actor_count, 256 );
 
-    // update the Actor's bounds
-    actor->computeBounds();
+  if ( (int)mRenderQueueArenas.size() < range_count )
+    mRenderQueueArenas.resize( range_count );
+  for(int i=0; i<range_count; ++i)
+  {
+    if ( ! mRenderQueueArenas[i] )
+      mRenderQueueArenas[i] = new RenderQueue;
+    mRenderQueueArenas[i]->clear();
+  }
 
-    Effect* effect = actor->effect();
-    VL_CHECK(effect)
+  ThreadPool::parallelFor( thread_pool, actor_count, range_count, [this, actor_list](int irange, int begin, int end) {
+    RenderQueue* arena = mRenderQueueArenas[irange].get();
+    for(int iactor=begin; iactor < end; ++iactor)
+      fillActorTokens( arena, actor_list->at(iactor), true );
+  });
 
-    // effect override: select the first that matches
+  // concatenate the arenas in actor order and initialize the shaders on the thread owning the OpenGL context
 
-    for( std::map< unsigned int, ref<Effect> >::iterator eom_it = mEffectOverrideMask.begin();
-         eom_it != mEffectOverrideMask.end();
-         ++eom_it )
-    {
-      if (eom_it->first & actor->enableMask())
-      {
-        effect = eom_it->second.get();
-        break;
-      }
-    }
+  RenderQueue* list = renderQueue();
+  const int first_token = list->size();
+  for(int i=0; i<range_count; ++i)
+    list->append( mRenderQueueArenas[i].get() );
 
-    if ( !isEnabled(effect->enableMask()) )
-      continue;
+  std::set<Shader*> shader_set;
+  prepareShaders( list, first_token, shader_set );
+}
+//------------------------------------------------------------------------------
+void Rendering::fillActorTokens( RenderQueue* list, Actor* actor, bool parallel )
+{
+  VL_CHECK(actor->lod(0))
 
-    // --------------- LOD evaluation ---------------
+  if ( ! isEnabled(actor) )
+    return;
 
-    int effect_lod = effect->evaluateLOD( actor, camera() );
+  // update the Actor's bounds
+  actor->computeBounds();
 
-    int geometry_lod = 0;
-    if ( evaluateLOD() )
-      geometry_lod = actor->evaluateLOD( camera() );
+  Effect* effect = actor->effect();
+  VL_CHECK(effect)
 
-    // --------------- M U L T I   P A S S I N G ---------------
+  // effect override: select the first that matches
 
-    RenderToken* prev_pass = NULL;
-    const int pass_count = effect->lod(effect_lod)->size();
-    for(int ipass=0; ipass<pass_count; ++ipass)
+  for( std::map< unsigned int, ref<Effect> >::iterator eom_it = mEffectOverrideMask.begin();
+       eom_it != mEffectOverrideMask.end();
+       ++eom_it )
+  {
+    if (eom_it->first & actor->enableMask())
     {
-      // setup the shader to be used for this pass
+      effect = eom_it->second.get();
+      break;
+    }
+  }
 
-      Shader* shader = effect->lod(effect_lod)->at(ipass);
+  if ( !isEnabled(effect->enableMask()) )
+    return;
 
-      // --------------- fill render token ---------------
+  // --------------- LOD evaluation ---------------
 
-      // create a render token
-      RenderToken* tok = list->newToken(prev_pass != NULL);
+  // Effect::evaluateLOD() stores the active lod in the Effect which might be shared by Actor[s] processed by other threads
+  int effect_lod = 0;
+  if ( parallel )
+    effect_lod = effect->lodEvaluator() ? effect->lodEvaluator()->evaluate( actor, camera() ) : effect->activeLod();
+  else
+    effect_lod = effect->evaluateLOD( actor, camera() );
+  VL_CHECK( effect_lod >= 0 && effect_lod < VL_MAX_EFFECT_LOD )
 
-      // multipass chain: implemented as a linked list
-      if ( prev_pass != NULL )
-        prev_pass->mNextPass = tok;
-      prev_pass = tok;
-      tok->mNextPass = NULL;
-      // track the current state
-      tok->mActor = actor;
-      tok->mRenderable = actor->lod(geometry_lod);
-      // set the shader used (multipassing shader or effect->shader())
-      tok->mShader = shader;
+  int geometry_lod = 0;
+  if ( evaluateLOD() )
+    geometry_lod = actor->evaluateLOD( camera() );
+
+  // --------------- M U L T I   P A S S I N G ---------------
+
+  const int pass_count = effect->lod(effect_lod)->size();
+  for(int ipass=0; ipass<pass_count; ++ipass)
+  {
+    // --------------- fill render token ---------------
+
+    // create a render token, the passes after the first are chained to the previous one by the RenderQueue
+    RenderToken* tok = list->newToken(ipass > 0);
+
+    // track the current state
+    tok->mActor = actor;
+    tok->mRenderable = actor->lod(geometry_lod);
+    // set the shader used (multipassing shader or effect->shader())
+    tok->mShader = effect->lod(effect_lod)->at(ipass);
+    tok->mEffectRenderRank = effect->renderRank();
+  }
+}
+//------------------------------------------------------------------------------
+void Rendering::prepareShaders( RenderQueue* list, int first_token, std::set<Shader*>& shader_set )
+{
+  for(int itok=first_token; itok < list->size(); ++itok)
+  {
+    for( const RenderToken* tok = list->at(itok); tok; tok = list->nextPass(tok) )
+    {
+      // the token's shader comes from a non-const Effect, see fillActorTokens()
+      Shader* shader = const_cast<Shader*>( tok->mShader );
 
       if ( shaderAnimationEnabled() )
       {
@@ -405,8 +567,6 @@ void Rendering::fillRenderQueue( ActorCollection* actor_list )
           }
         }
       }
-
-      tok->mEffectRenderRank = effect->renderRank();
     }
   }
 }
@@ -36,14 +36,27 @@
 #include <vlGraphics/RenderQueueSorter.hpp>
 #include <vlGraphics/Actor.hpp>
 #include <vlGraphics/RenderQueue.hpp>
+#include <vlGraphics/RenderQueueCache.hpp>
 #include <vlGraphics/Renderer.hpp>
 #include <vlGraphics/Camera.hpp>
 #include <vlGraphics/SceneManager.hpp>
+#include <vlGraphics/ThreadPool.hpp>
 #include <vlCore/Transform.hpp>
 #include <vlCore/Collection.hpp>
+#include <set>
 
 namespace vl
 {
+  //! The stages of Rendering::render() whose CPU time can be measured, see Rendering::setStageTimingEnabled().
+  typedef enum
+  {
+    RSG_Culling,          //!< Transform update, culling and actor queue filling.
+    RSG_FillRenderQueue,  //!< Render queue filling.
+    RSG_SortRenderQueue,  //!< Render queue sorting.
+    RSG_Render,           //!< Renderer[s] execution, i.e. the OpenGL command submission.
+    RSG_StageCount
+  } ERenderingStage;
+
   /** The Rendering class collects all the information to perform the rendering of a scene.
   The Rendering class performs the following steps:
   -# activates the appropriate OpenGLContext
@@ -172,6 +185,49 @@ namespace vl
     /** Whether the installed SceneManager[s] should perform Actor culling or not in order to maximize the rendering performances. */
     bool cullingEnabled() const { return mCullingEnabled; }
 
+    /** If not NULL the installed SceneManager[s] extract the visible Actor[s] in parallel using the given ThreadPool, see SceneManager::extractVisibleActorsParallel().
+      * The resulting actor queue is the same as the one produced by the serial culling. Default is NULL. */
+    void setCullingThreadPool(ThreadPool* thread_pool) { mCullingThreadPool = thread_pool; }
+
+    /** The ThreadPool used for parallel culling, NULL if culling is performed serially. */
+    ThreadPool* cullingThreadPool() { return mCullingThreadPool.get(); }
+
+    /** The tree depth below which the subtrees are culled in parallel, see ActorTreeAbstract::extractVisibleActorsParallel(). Default is 4. */
+    void setParallelCullingDepth(int depth) { mParallelCullingDepth = depth; }
+
+    /** The tree depth below which the subtrees are culled in parallel, see ActorTreeAbstract::extractVisibleActorsParallel(). Default is 4. */
+    int parallelCullingDepth() const { return mParallelCullingDepth; }
+
+    /** If not NULL the render queue is filled in parallel using the given ThreadPool when the visible Actor[s] are more than parallelRenderQueueThreshold().
+      * Each worker fills its own RenderQueue with a contiguous range of Actor[s], the queues are then concatenated in order and the
+      * shader animation and automatic resource initialization are performed serially, so that the resulting render queue is the same as the serial one.
+      * \note
+      * In the parallel path Effect::activeLod() is not updated and the LODEvaluator[s] installed in the Actor[s] and Effect[s] must be thread-safe. Default is NULL. */
+    void setRenderQueueThreadPool(ThreadPool* thread_pool) { mRenderQueueThreadPool = thread_pool; }
+
+    /** The ThreadPool used to fill the render queue in parallel, NULL if the render queue is filled serially. */
+    ThreadPool* renderQueueThreadPool() { return mRenderQueueThreadPool.get(); }
+
+    /** The minimum number of visible Actor[s] for which the render queue is filled in parallel, see setRenderQueueThreadPool(). Default is 2048. */
+    void setParallelRenderQueueThreshold(int actor_count) { mParallelRenderQueueThreshold = actor_count; }
+
+    /** The minimum number of visible Actor[s] for which the render queue is filled in parallel, see setRenderQueueThreadPool(). Default is 2048. */
+    int parallelRenderQueueThreshold() const { return mParallelRenderQueueThreshold; }
+
+    /** Whether render() should reuse the culled Actor[s] and the sorted render queue of the previous rendering when its inputs have not changed, see RenderQueueCache.
+      * When only the camera has changed the scene is culled again and the render queue is reused if the culled Actor[s] are the same and no LODEvaluator is installed.
+      * Shader animation is performed at every rendering. Default is false. */
+    void setRenderQueueCacheEnabled(bool enabled) { mRenderQueueCacheEnabled = enabled; mRenderQueueCache->invalidate(); }
+
+    /** Whether render() should reuse the culled Actor[s] and the sorted render queue of the previous rendering when its inputs have not changed. */
+    bool renderQueueCacheEnabled() const { return mRenderQueueCacheEnabled; }
+
+    /** The RenderQueueCache used when renderQueueCacheEnabled() is true, exposes the hit/miss counters. */
+    RenderQueueCache* renderQueueCache() { return mRenderQueueCache.get(); }
+
+    /** The RenderQueueCache used when renderQueueCacheEnabled() is true, exposes the hit/miss counters. */
+    const RenderQueueCache* renderQueueCache() const { return mRenderQueueCache.get(); }
+
     /** Whether OpenGL resources such as textures and GLSL programs should be automatically initialized when first used.
       * Enabling this features forces VL to keep track of which resources are used for each rendering, which might slighly impact the
       * rendering time, thus to obtain the maximum performances disable this option and manually initialize your textures and GLSL shaders. */
@@ -201,30 +257,52 @@ namespace vl
         See also vl::Actor::enableMask() and vl::Renderer::shaderOverrideMask(). */
     std::map<unsigned int, ref<Effect> >& effectOverrideMask() { return mEffectOverrideMask; }
 
+    /** Whether render() should measure the CPU time spent in each of its stages, see stageTime(). Default is false. */
+    void setStageTimingEnabled(bool enabled) { mStageTimingEnabled = enabled; }
+
+    /** Whether render() should measure the CPU time spent in each of its stages, see stageTime(). Default is false. */
+    bool stageTimingEnabled() const { return mStageTimingEnabled; }
+
+    /** The CPU time in seconds spent by the last render() in the given stage, valid only if stageTimingEnabled() is true. */
+    double stageTime(ERenderingStage stage) const { return mStageTime[stage]; }
+
   protected:
     // mic fixme: it would be nice to have a mechanism to request the visible actors at will and to
     // compile and save the render-queue for later renderings to be reused without recomputing the culling.
     // The user could be able to install actor-list or render-queue and use the flags READ|WRITE|TERMINATE
     // to define wether the list should be used for reading, filled, cleaned up after rendering.
     void fillRenderQueue( ActorCollection* actor_list );
+    void fillRenderQueueParallel( ActorCollection* actor_list );
+    void fillActorTokens( RenderQueue* list, Actor* actor, bool parallel );
+    void prepareShaders( RenderQueue* list, int first_token, std::set<Shader*>& shader_set );
     RenderQueue* renderQueue() { return mRenderQueue.get(); }
     ActorCollection* actorQueue() { return mActorQueue.get(); }
+    double lapStageTime(ERenderingStage stage, double start);
 
   protected:
     ref<RenderQueueSorter> mRenderQueueSorter;
     ref<ActorCollection> mActorQueue;
     ref<RenderQueue> mRenderQueue;
+    ref<RenderQueueCache> mRenderQueueCache;
     Collection<Renderer> mRenderers;
     ref<Camera> mCamera;
     ref<Transform> mTransform;
     ref<Collection<SceneManager> > mSceneManagers;
     std::map<unsigned int, ref<Effect> > mEffectOverrideMask;
+    ref<ThreadPool> mCullingThreadPool;
+    int mParallelCullingDepth;
+    ref<ThreadPool> mRenderQueueThreadPool;
+    std::vector< ref<RenderQueue> > mRenderQueueArenas;
+    int mParallelRenderQueueThreshold;
 
     bool mAutomaticResourceInit;
+    bool mRenderQueueCacheEnabled;
     bool mCullingEnabled;
     bool mEvaluateLOD;
     bool mShaderAnimationEnabled;
     bool mNearFarClippingPlanesOptimized;
+    bool mStageTimingEnabled;
+    double mStageTime[RSG_StageCount];
   };
 }
 
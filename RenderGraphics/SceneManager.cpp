@@ -44,6 +44,7 @@ SceneManager::SceneManager()
 {
   VL_DEBUG_SET_OBJECT_NAME()
   // mActors = new ActorCollection;
+  mUpdateTick = 0;
   mBoundsDirty = true;
   mCullingEnabled = true;
   mEnableMask = 0xFFFFFFFF;
@@ -41,6 +41,7 @@ namespace vl
   class Actor;
   class ActorCollection;
   class Camera;
+  class ThreadPool;
 
 //-------------------------------------------------------------------------------------------------------------------------------------------
 // SceneManager
@@ -84,6 +85,14 @@ namespace vl
     //! \see SceneManager::enableMask(), Actor::enableMask(), Actor::isEnabled(), ActorTreeAbstract::isEnabled()
     virtual void extractVisibleActors(ActorCollection& list, const Camera* camera) = 0;
 
+    //! Same as extractVisibleActors() but allowed to spread the work across the given ThreadPool.
+    //! The default implementation simply calls extractVisibleActors().
+    //! \see ActorTreeAbstract::extractVisibleActorsParallel()
+    virtual void extractVisibleActorsParallel(ActorCollection& list, const Camera* camera, ThreadPool* /*thread_pool*/, int /*split_depth*/)
+    {
+      extractVisibleActors( list, camera );
+    }
+
     //! Computes the bounding box and bounding sphere of the scene manager and of all the Actors contained in the SceneManager.
     virtual void computeBounds();
 
@@ -98,18 +107,18 @@ namespace vl
     const AABB& boundingBox() const { return mAABB; }
 
     //! Flags a scene manager's bounding box and bounding sphere as dirty. The bounds will be recomputed using computeBounds() at the next rendering frame.
-    void setBoundsDirty(bool dirty) { mBoundsDirty = dirty; }
+    void setBoundsDirty(bool dirty) { mBoundsDirty = dirty; if (dirty) ++mUpdateTick; }
     //! Returns true if the scene manager's bounds should be recomputed at the next rendering frame.
     bool boundsDirty() const { return mBoundsDirty; }
 
     //! Used to enable or disable frustum culling or whichever culling system the scene manager implements.
-    void setCullingEnabled(bool enable) { mCullingEnabled = enable; }
+    void setCullingEnabled(bool enable) { mCullingEnabled = enable; ++mUpdateTick; }
     //! Used to enable or disable frustum culling or whichever culling system the scene manager implements.
     bool cullingEnabled() const { return mCullingEnabled; }
 
     //! The enable mask to be used by extractVisibleActors()
     //! \see \see Actor::enableMask(), Actor::isEnabled(), ActorTreeAbstract::isEnabled(), SceneManager::enableMask(), Rendering::enableMask(), Rendering::effectOverrideMask(), Renderer::enableMask(), Renderer::shaderOverrideMask().
-    void setEnableMask(unsigned int enabled) { mEnableMask = enabled; }
+    void setEnableMask(unsigned int enabled) { mEnableMask = enabled; ++mUpdateTick; }
     //! The enable mask to be used by extractVisibleActors()
     //! \see \see Actor::enableMask(), Actor::isEnabled(), ActorTreeAbstract::isEnabled(), SceneManager::enableMask(), Rendering::enableMask(), Rendering::effectOverrideMask(), Renderer::enableMask(), Renderer::shaderOverrideMask().
     unsigned int enableMask() const { return mEnableMask; }
@@ -117,10 +126,18 @@ namespace vl
     //! Returns \p true if \p "a->enableMask() & enableMask()) != 0"
     bool isEnabled(Actor*a) const;
 
+    //! Incremented by setBoundsDirty(true), setEnableMask(), setCullingEnabled() and incrementUpdateTick(), used by Rendering to validate its render queue cache.
+    //! SceneManagerBVH also reflects the changes of its tree, see ActorTreeAbstract::updateTick().
+    virtual long long updateTick() const { return mUpdateTick; }
+
+    //! Flags the scene manager as modified, to be called after adding or removing Actors not tracked by updateTick(), see Rendering::setRenderQueueCacheEnabled().
+    void incrementUpdateTick() { ++mUpdateTick; }
+
   protected:
     Sphere mSphere;
     AABB mAABB;
     unsigned int mEnableMask;
+    long long mUpdateTick;
     bool mBoundsDirty;
     bool mCullingEnabled;
   };
@@ -0,0 +1,65 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef SceneManagerActorLBVH_INCLUDE_ONCE
+#define SceneManagerActorLBVH_INCLUDE_ONCE
+
+#include <vlGraphics/SceneManagerBVH.hpp>
+#include <vlGraphics/ActorLBVH.hpp>
+
+namespace vl
+{
+  /**
+   * A SceneManagerBVH that implements its spatial partitioning strategy using an ActorLBVH.
+   *
+   * \sa
+   * - Actor
+   * - ActorLBVH
+   * - SceneManager
+   * - SceneManagerBVH
+   * - SceneManagerActorKdTree
+   * - SceneManagerActorTree
+  */
+  class VLGRAPHICS_EXPORT SceneManagerActorLBVH: public SceneManagerBVH<ActorLBVH>
+  {
+    VL_INSTRUMENT_CLASS(vl::SceneManagerActorLBVH, SceneManagerBVH<ActorLBVH>)
+
+  public:
+    SceneManagerActorLBVH()
+    {
+      VL_DEBUG_SET_OBJECT_NAME()
+      mBoundingVolumeTree = new ActorLBVH;
+    }
+  };
+}
+
+#endif
@@ -58,12 +58,21 @@ namespace vl
 
   public:
     //! Sets the tree to be used by the scene manager.
-    void setTree(T* bbh) { mBoundingVolumeTree = bbh; }
+    void setTree(T* bbh)
+    {
+      // keeps updateTick() increasing whatever the tick of the new tree
+      long long tick = updateTick() + 1;
+      mBoundingVolumeTree = bbh;
+      mUpdateTick = tick - treeUpdateTick();
+    }
     //! Returns the tree used by the scene manager.
     const T* tree() const { return mBoundingVolumeTree.get(); }
     //! Returns the tree used by the scene manager.
     T* tree() { return mBoundingVolumeTree.get(); }
 
+    //! Also changes when Actors are added to or removed from the tree, see ActorTreeAbstract::updateTick() and ActorLBVH::updateTick().
+    virtual long long updateTick() const { return mUpdateTick + treeUpdateTick(); }
+
     virtual void extractVisibleActors(ActorCollection& list, const Camera* camera)
     {
       // extracts Actors from the hierarchical volume tree
@@ -75,12 +84,25 @@ namespace vl
       }
     }
 
+    virtual void extractVisibleActorsParallel(ActorCollection& list, const Camera* camera, ThreadPool* thread_pool, int split_depth)
+    {
+      if ( cullingEnabled() ) {
+        tree()->extractVisibleActorsParallel( list, camera, enableMask(), split_depth, thread_pool );
+      }
+      else {
+        extractActors(list);
+      }
+    }
+
     virtual void extractActors(ActorCollection& list)
     {
       // extracts Actors from the hierarchical volume tree
       tree()->extractActors( list );
     }
 
+  protected:
+    long long treeUpdateTick() const { return tree() ? tree()->updateTick() : 0; }
+
   protected:
     ref<T> mBoundingVolumeTree;
   };
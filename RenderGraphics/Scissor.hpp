@@ -61,18 +61,18 @@ namespace vl
     void enable(const Viewport* viewport) const
     {
       RectI r = viewport->rect().intersected(scissorRect());
-      glEnable(GL_SCISSOR_TEST);
+      GL_Functions._glEnable(GL_SCISSOR_TEST);
       if (r.isNull())
-        glScissor(0,0,0,0);
+        GL_Functions._glScissor(0,0,0,0);
       else
-        glScissor(r.x(), r.y(), r.width(), r.height());
+        GL_Functions._glScissor(r.x(), r.y(), r.width(), r.height());
     }
     /**
      * Disables the scissor test.
      */
     void disable()
     {
-      glDisable(GL_SCISSOR_TEST);
+      GL_Functions._glDisable(GL_SCISSOR_TEST);
     }
 
     /**
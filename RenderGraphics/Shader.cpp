@@ -46,6 +46,7 @@ Shader::Shader()
 {
   VL_DEBUG_SET_OBJECT_NAME()
   mLastUpdateTime = 0;
+  mUpdateTick = 0;
   // shader user data
   #ifdef VL_USER_DATA_SHADER
     mShaderUserData = NULL;
@@ -178,152 +179,152 @@ TextureMatrix* Shader::gocTextureMatrix(int unit_index) { GET_OR_CREATE_IDX(Text
 //------------------------------------------------------------------------------
 // PixelTransfer
 //------------------------------------------------------------------------------
-void PixelTransfer::apply(int, const Camera*, OpenGLContext*) const
+void PixelTransfer::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glPixelTransferi(GL_MAP_COLOR, mapColor() ? GL_TRUE : GL_FALSE);
-  glPixelTransferi(GL_MAP_STENCIL, mapStencil() ? GL_TRUE : GL_FALSE);
-  glPixelTransferi(GL_INDEX_SHIFT, indexShift() );
-  glPixelTransferi(GL_INDEX_OFFSET, indexOffset() );
-  glPixelTransferf(GL_RED_SCALE, redScale() );
-  glPixelTransferf(GL_GREEN_SCALE, greenScale() );
-  glPixelTransferf(GL_BLUE_SCALE, blueScale() );
-  glPixelTransferf(GL_ALPHA_SCALE, alphaScale() );
-  glPixelTransferf(GL_DEPTH_SCALE, depthScale() );
-  glPixelTransferf(GL_RED_BIAS, redBias() );
-  glPixelTransferf(GL_GREEN_BIAS, greenBias() );
-  glPixelTransferf(GL_BLUE_BIAS, blueBias() );
-  glPixelTransferf(GL_ALPHA_BIAS, alphaBias() );
-  glPixelTransferf(GL_DEPTH_BIAS, depthBias() );
+  ctx->mGL._glPixelTransferi(GL_MAP_COLOR, mapColor() ? GL_TRUE : GL_FALSE);
+  ctx->mGL._glPixelTransferi(GL_MAP_STENCIL, mapStencil() ? GL_TRUE : GL_FALSE);
+  ctx->mGL._glPixelTransferi(GL_INDEX_SHIFT, indexShift() );
+  ctx->mGL._glPixelTransferi(GL_INDEX_OFFSET, indexOffset() );
+  ctx->mGL._glPixelTransferf(GL_RED_SCALE, redScale() );
+  ctx->mGL._glPixelTransferf(GL_GREEN_SCALE, greenScale() );
+  ctx->mGL._glPixelTransferf(GL_BLUE_SCALE, blueScale() );
+  ctx->mGL._glPixelTransferf(GL_ALPHA_SCALE, alphaScale() );
+  ctx->mGL._glPixelTransferf(GL_DEPTH_SCALE, depthScale() );
+  ctx->mGL._glPixelTransferf(GL_RED_BIAS, redBias() );
+  ctx->mGL._glPixelTransferf(GL_GREEN_BIAS, greenBias() );
+  ctx->mGL._glPixelTransferf(GL_BLUE_BIAS, blueBias() );
+  ctx->mGL._glPixelTransferf(GL_ALPHA_BIAS, alphaBias() );
+  ctx->mGL._glPixelTransferf(GL_DEPTH_BIAS, depthBias() );
   VL_CHECK_OGL()
   if (Has_GL_ARB_imaging)
   {
-    glPixelTransferf(GL_POST_COLOR_MATRIX_RED_SCALE, postColorMatrixRedScale() );
-    glPixelTransferf(GL_POST_COLOR_MATRIX_GREEN_SCALE, postColorMatrixGreenScale() );
-    glPixelTransferf(GL_POST_COLOR_MATRIX_BLUE_SCALE, postColorMatrixBlueScale() );
-    glPixelTransferf(GL_POST_COLOR_MATRIX_ALPHA_SCALE, postColorMatrixAlphaScale() );
-    glPixelTransferf(GL_POST_COLOR_MATRIX_RED_BIAS, postColorMatrixRedBias() );
-    glPixelTransferf(GL_POST_COLOR_MATRIX_GREEN_BIAS, postColorMatrixGreenBias() );
-    glPixelTransferf(GL_POST_COLOR_MATRIX_BLUE_BIAS, postColorMatrixBlueBias() );
-    glPixelTransferf(GL_POST_COLOR_MATRIX_ALPHA_BIAS, postColorMatrixAlphaBias() );
-    glPixelTransferf(GL_POST_CONVOLUTION_RED_SCALE, postConvolutionRedScale() );
-    glPixelTransferf(GL_POST_CONVOLUTION_GREEN_SCALE, postConvolutionGreenScale() );
-    glPixelTransferf(GL_POST_CONVOLUTION_BLUE_SCALE, postConvolutionBlueScale() );
-    glPixelTransferf(GL_POST_CONVOLUTION_ALPHA_SCALE, postConvolutionAlphaScale() );
-    glPixelTransferf(GL_POST_CONVOLUTION_RED_BIAS, postConvolutionRedBias() );
-    glPixelTransferf(GL_POST_CONVOLUTION_GREEN_BIAS, postConvolutionGreenBias() );
-    glPixelTransferf(GL_POST_CONVOLUTION_BLUE_BIAS, postConvolutionBlueBias() );
-    glPixelTransferf(GL_POST_CONVOLUTION_ALPHA_BIAS, postConvolutionAlphaBias() );
+    ctx->mGL._glPixelTransferf(GL_POST_COLOR_MATRIX_RED_SCALE, postColorMatrixRedScale() );
+    ctx->mGL._glPixelTransferf(GL_POST_COLOR_MATRIX_GREEN_SCALE, postColorMatrixGreenScale() );
+    ctx->mGL._glPixelTransferf(GL_POST_COLOR_MATRIX_BLUE_SCALE, postColorMatrixBlueScale() );
+    ctx->mGL._glPixelTransferf(GL_POST_COLOR_MATRIX_ALPHA_SCALE, postColorMatrixAlphaScale() );
+    ctx->mGL._glPixelTransferf(GL_POST_COLOR_MATRIX_RED_BIAS, postColorMatrixRedBias() );
+    ctx->mGL._glPixelTransferf(GL_POST_COLOR_MATRIX_GREEN_BIAS, postColorMatrixGreenBias() );
+    ctx->mGL._glPixelTransferf(GL_POST_COLOR_MATRIX_BLUE_BIAS, postColorMatrixBlueBias() );
+    ctx->mGL._glPixelTransferf(GL_POST_COLOR_MATRIX_ALPHA_BIAS, postColorMatrixAlphaBias() );
+    ctx->mGL._glPixelTransferf(GL_POST_CONVOLUTION_RED_SCALE, postConvolutionRedScale() );
+    ctx->mGL._glPixelTransferf(GL_POST_CONVOLUTION_GREEN_SCALE, postConvolutionGreenScale() );
+    ctx->mGL._glPixelTransferf(GL_POST_CONVOLUTION_BLUE_SCALE, postConvolutionBlueScale() );
+    ctx->mGL._glPixelTransferf(GL_POST_CONVOLUTION_ALPHA_SCALE, postConvolutionAlphaScale() );
+    ctx->mGL._glPixelTransferf(GL_POST_CONVOLUTION_RED_BIAS, postConvolutionRedBias() );
+    ctx->mGL._glPixelTransferf(GL_POST_CONVOLUTION_GREEN_BIAS, postConvolutionGreenBias() );
+    ctx->mGL._glPixelTransferf(GL_POST_CONVOLUTION_BLUE_BIAS, postConvolutionBlueBias() );
+    ctx->mGL._glPixelTransferf(GL_POST_CONVOLUTION_ALPHA_BIAS, postConvolutionAlphaBias() );
     VL_CHECK_OGL()
   }
 }
 //------------------------------------------------------------------------------
 // Hint
 //------------------------------------------------------------------------------
-void Hint::apply(int, const Camera*, OpenGLContext*) const
+void Hint::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   VL_CHECK_OGL()
 
   if( Has_Fixed_Function_Pipeline )
   {
-    glHint( GL_PERSPECTIVE_CORRECTION_HINT, mPerspectiveCorrectionHint ); VL_CHECK_OGL()
+    ctx->mGL._glHint( GL_PERSPECTIVE_CORRECTION_HINT, mPerspectiveCorrectionHint ); VL_CHECK_OGL()
 
-    glHint( GL_FOG_HINT, mFogHint ); VL_CHECK_OGL()
+    ctx->mGL._glHint( GL_FOG_HINT, mFogHint ); VL_CHECK_OGL()
 
     if (Has_GL_GENERATE_MIPMAP)
     {
-      glHint( GL_GENERATE_MIPMAP_HINT, mGenerateMipmapHint ); VL_CHECK_OGL()
+      ctx->mGL._glHint( GL_GENERATE_MIPMAP_HINT, mGenerateMipmapHint ); VL_CHECK_OGL()
     }
   }
 
-  glHint( GL_POLYGON_SMOOTH_HINT, mPolygonSmoothHint ); VL_CHECK_OGL()
-  glHint( GL_LINE_SMOOTH_HINT, mLineSmoothHint ); VL_CHECK_OGL()
+  ctx->mGL._glHint( GL_POLYGON_SMOOTH_HINT, mPolygonSmoothHint ); VL_CHECK_OGL()
+  ctx->mGL._glHint( GL_LINE_SMOOTH_HINT, mLineSmoothHint ); VL_CHECK_OGL()
 
       if ( Has_GL_Version_1_1 )
   {
-    glHint( GL_POINT_SMOOTH_HINT, mPointSmoothHint ); VL_CHECK_OGL()
+    ctx->mGL._glHint( GL_POINT_SMOOTH_HINT, mPointSmoothHint ); VL_CHECK_OGL()
   }
 }
 //------------------------------------------------------------------------------
 // CullFace
 //------------------------------------------------------------------------------
-void CullFace::apply(int, const Camera*, OpenGLContext*) const
+void CullFace::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glCullFace(mFaceMode); VL_CHECK_OGL()
+  ctx->mGL._glCullFace(mFaceMode); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // FrontFace
 //------------------------------------------------------------------------------
-void FrontFace::apply(int, const Camera*, OpenGLContext*) const
+void FrontFace::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glFrontFace(mFrontFace); VL_CHECK_OGL()
+  ctx->mGL._glFrontFace(mFrontFace); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // DepthFunc
 //------------------------------------------------------------------------------
-void DepthFunc::apply(int, const Camera*, OpenGLContext*) const
+void DepthFunc::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glDepthFunc(mDepthFunc); VL_CHECK_OGL()
+  ctx->mGL._glDepthFunc(mDepthFunc); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // DepthMask
 //------------------------------------------------------------------------------
-void DepthMask::apply(int, const Camera*, OpenGLContext*) const
+void DepthMask::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glDepthMask(mDepthMask?GL_TRUE:GL_FALSE); VL_CHECK_OGL()
+  ctx->mGL._glDepthMask(mDepthMask?GL_TRUE:GL_FALSE); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // PolygonMode
 //------------------------------------------------------------------------------
-void PolygonMode::apply(int, const Camera*, OpenGLContext*) const
+void PolygonMode::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   // required by GL 3.1 CORE
   if ( mFrontFace == mBackFace )
   {
-    glPolygonMode(GL_FRONT_AND_BACK, mFrontFace); VL_CHECK_OGL()
+    ctx->mGL._glPolygonMode(GL_FRONT_AND_BACK, mFrontFace); VL_CHECK_OGL()
   }
   else
   {
-    glPolygonMode(GL_FRONT, mFrontFace); VL_CHECK_OGL()
-    glPolygonMode(GL_BACK, mBackFace); VL_CHECK_OGL()
+    ctx->mGL._glPolygonMode(GL_FRONT, mFrontFace); VL_CHECK_OGL()
+    ctx->mGL._glPolygonMode(GL_BACK, mBackFace); VL_CHECK_OGL()
   }
 }
 //------------------------------------------------------------------------------
 // ShadeModel
 //------------------------------------------------------------------------------
-void ShadeModel::apply(int, const Camera*, OpenGLContext*) const
+void ShadeModel::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glShadeModel(mShadeModel); VL_CHECK_OGL()
+  ctx->mGL._glShadeModel(mShadeModel); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // BlendFunc
 //------------------------------------------------------------------------------
-void BlendFunc::apply(int, const Camera*, OpenGLContext*) const
+void BlendFunc::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   if (Has_GL_EXT_blend_func_separate||Has_GL_Version_1_4||Has_GL_Version_3_0||Has_GL_Version_4_0)
   {
-    glBlendFuncSeparate(mSrcRGB, mDstRGB, mSrcAlpha, mDstAlpha); VL_CHECK_OGL()
+    ctx->mGL._glBlendFuncSeparate(mSrcRGB, mDstRGB, mSrcAlpha, mDstAlpha); VL_CHECK_OGL()
   }
   else
   {
-    glBlendFunc(mSrcRGB, mDstRGB); VL_CHECK_OGL() // modifies rgb and alpha
+    ctx->mGL._glBlendFunc(mSrcRGB, mDstRGB); VL_CHECK_OGL() // modifies rgb and alpha
   }
 }
 //------------------------------------------------------------------------------
 // BlendEquation
 //------------------------------------------------------------------------------
-void BlendEquation::apply(int, const Camera*, OpenGLContext*) const
+void BlendEquation::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   if (Has_GL_Version_2_0||Has_GL_EXT_blend_equation_separate)
-    { glBlendEquationSeparate(mModeRGB, mModeAlpha); VL_CHECK_OGL() }
+    { ctx->mGL._glBlendEquationSeparate(mModeRGB, mModeAlpha); VL_CHECK_OGL() }
   else
-    { glBlendEquation(mModeRGB); VL_CHECK_OGL() }
+    { ctx->mGL._glBlendEquation(mModeRGB); VL_CHECK_OGL() }
 }
 //------------------------------------------------------------------------------
 // AlphaFunc
 //------------------------------------------------------------------------------
-void AlphaFunc::apply(int, const Camera*, OpenGLContext*) const
+void AlphaFunc::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glAlphaFunc(mAlphaFunc, mRefValue); VL_CHECK_OGL()
+  ctx->mGL._glAlphaFunc(mAlphaFunc, mRefValue); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // Material
@@ -422,7 +423,7 @@ void Material::setFlatColor(const fvec4& color)
   setBackFlatColor(color);
 }
 //------------------------------------------------------------------------------
-void Material::apply(int, const Camera*, OpenGLContext*) const
+void Material::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   VL_CHECK_OGL();
 
@@ -430,62 +431,62 @@ void Material::apply(int, const Camera*, OpenGLContext*) const
 
   if (mColorMaterialEnabled)
   {
-    glColorMaterial(colorMaterialFace(), colorMaterial()); VL_CHECK_OGL();
-    glEnable(GL_COLOR_MATERIAL); VL_CHECK_OGL();
+    ctx->mGL._glColorMaterial(colorMaterialFace(), colorMaterial()); VL_CHECK_OGL();
+    ctx->mGL._glEnable(GL_COLOR_MATERIAL); VL_CHECK_OGL();
   }
   else
   {
-    glDisable(GL_COLOR_MATERIAL); VL_CHECK_OGL();
+    ctx->mGL._glDisable(GL_COLOR_MATERIAL); VL_CHECK_OGL();
   }
 
   if ( mFrontAmbient == mBackAmbient )
   {
-    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mFrontAmbient.ptr());
+    ctx->mGL._glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mFrontAmbient.ptr());
   }
   else
   {
-    glMaterialfv(GL_FRONT, GL_AMBIENT, mFrontAmbient.ptr());
-    glMaterialfv(GL_BACK, GL_AMBIENT, mBackAmbient.ptr());
+    ctx->mGL._glMaterialfv(GL_FRONT, GL_AMBIENT, mFrontAmbient.ptr());
+    ctx->mGL._glMaterialfv(GL_BACK, GL_AMBIENT, mBackAmbient.ptr());
   }
 
   if ( mFrontDiffuse == mBackDiffuse )
   {
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mFrontDiffuse.ptr());
+    ctx->mGL._glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mFrontDiffuse.ptr());
   }
   else
   {
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, mFrontDiffuse.ptr());
-    glMaterialfv(GL_BACK, GL_DIFFUSE, mBackDiffuse.ptr());
+    ctx->mGL._glMaterialfv(GL_FRONT, GL_DIFFUSE, mFrontDiffuse.ptr());
+    ctx->mGL._glMaterialfv(GL_BACK, GL_DIFFUSE, mBackDiffuse.ptr());
   }
 
   if ( mFrontSpecular == mBackSpecular )
   {
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mFrontSpecular.ptr());
+    ctx->mGL._glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mFrontSpecular.ptr());
   }
   else
   {
-    glMaterialfv(GL_FRONT, GL_SPECULAR, mFrontSpecular.ptr());
-    glMaterialfv(GL_BACK, GL_SPECULAR, mBackSpecular.ptr());
+    ctx->mGL._glMaterialfv(GL_FRONT, GL_SPECULAR, mFrontSpecular.ptr());
+    ctx->mGL._glMaterialfv(GL_BACK, GL_SPECULAR, mBackSpecular.ptr());
   }
 
   if ( mFrontEmission == mBackEmission )
   {
-    glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, mFrontEmission.ptr());
+    ctx->mGL._glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, mFrontEmission.ptr());
   }
   else
   {
-    glMaterialfv(GL_FRONT, GL_EMISSION, mFrontEmission.ptr());
-    glMaterialfv(GL_BACK, GL_EMISSION, mBackEmission.ptr());
+    ctx->mGL._glMaterialfv(GL_FRONT, GL_EMISSION, mFrontEmission.ptr());
+    ctx->mGL._glMaterialfv(GL_BACK, GL_EMISSION, mBackEmission.ptr());
   }
 
   if ( mFrontShininess == mBackShininess )
   {
-    glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, mFrontShininess); VL_CHECK_OGL();
+    ctx->mGL._glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, mFrontShininess); VL_CHECK_OGL();
   }
   else
   {
-    glMaterialf(GL_FRONT, GL_SHININESS, mFrontShininess); VL_CHECK_OGL();
-    glMaterialf(GL_BACK, GL_SHININESS, mBackShininess); VL_CHECK_OGL();
+    ctx->mGL._glMaterialf(GL_FRONT, GL_SHININESS, mFrontShininess); VL_CHECK_OGL();
+    ctx->mGL._glMaterialf(GL_BACK, GL_SHININESS, mBackShininess); VL_CHECK_OGL();
   }
 
 
@@ -499,18 +500,18 @@ void Material::apply(int, const Camera*, OpenGLContext*) const
       Log::error("OpenGL ES 1.x supports only CM_AMBIENT_AND_DIFFUSE color material mode!\n");
       VL_TRAP();
     }
-    glEnable(GL_COLOR_MATERIAL); VL_CHECK_OGL();
+    ctx->mGL._glEnable(GL_COLOR_MATERIAL); VL_CHECK_OGL();
   }
   else
   {
-    glDisable(GL_COLOR_MATERIAL); VL_CHECK_OGL();
+    ctx->mGL._glDisable(GL_COLOR_MATERIAL); VL_CHECK_OGL();
   }
 
-  glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mFrontAmbient.ptr());
-  glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mFrontDiffuse.ptr());
-  glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mFrontSpecular.ptr());
-  glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, mFrontEmission.ptr());
-  glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, mFrontShininess); VL_CHECK_OGL();
+  ctx->mGL._glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, mFrontAmbient.ptr());
+  ctx->mGL._glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, mFrontDiffuse.ptr());
+  ctx->mGL._glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, mFrontSpecular.ptr());
+  ctx->mGL._glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION, mFrontEmission.ptr());
+  ctx->mGL._glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, mFrontShininess); VL_CHECK_OGL();
 
 #endif
 
@@ -519,66 +520,66 @@ void Material::apply(int, const Camera*, OpenGLContext*) const
 //------------------------------------------------------------------------------
 // LightModel
 //------------------------------------------------------------------------------
-void LightModel::apply(int, const Camera*, OpenGLContext*) const
+void LightModel::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   if (Has_GL_Version_1_2||Has_GL_EXT_separate_specular_color)
   {
-    glLightModelf(GL_LIGHT_MODEL_COLOR_CONTROL, (float)mColorControl); VL_CHECK_OGL()
+    ctx->mGL._glLightModelf(GL_LIGHT_MODEL_COLOR_CONTROL, (float)mColorControl); VL_CHECK_OGL()
   }
 
   if (Has_GL_Version_1_1)
-    glLightModelf(GL_LIGHT_MODEL_LOCAL_VIEWER, mLocalViewer ? 1.0f : 0.0f ); VL_CHECK_OGL()
+    ctx->mGL._glLightModelf(GL_LIGHT_MODEL_LOCAL_VIEWER, mLocalViewer ? 1.0f : 0.0f ); VL_CHECK_OGL()
 
   // Supported by GLES 1.x as well.
-  glLightModelfv(GL_LIGHT_MODEL_AMBIENT, mAmbientColor.ptr()); VL_CHECK_OGL()
-  glLightModelf(GL_LIGHT_MODEL_TWO_SIDE, mTwoSide ? 1.0f : 0.0f ); VL_CHECK_OGL()
+  ctx->mGL._glLightModelfv(GL_LIGHT_MODEL_AMBIENT, mAmbientColor.ptr()); VL_CHECK_OGL()
+  ctx->mGL._glLightModelf(GL_LIGHT_MODEL_TWO_SIDE, mTwoSide ? 1.0f : 0.0f ); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // Fog
 //------------------------------------------------------------------------------
-void Fog::apply(int, const Camera*, OpenGLContext*) const
+void Fog::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glFogf(GL_FOG_MODE, (float)mMode); VL_CHECK_OGL()
-  glFogf(GL_FOG_DENSITY, mDensity); VL_CHECK_OGL()
-  glFogf(GL_FOG_START, mStart); VL_CHECK_OGL()
-  glFogf(GL_FOG_END, mEnd); VL_CHECK_OGL()
-  glFogfv(GL_FOG_COLOR, mColor.ptr()); VL_CHECK_OGL()
+  ctx->mGL._glFogf(GL_FOG_MODE, (float)mMode); VL_CHECK_OGL()
+  ctx->mGL._glFogf(GL_FOG_DENSITY, mDensity); VL_CHECK_OGL()
+  ctx->mGL._glFogf(GL_FOG_START, mStart); VL_CHECK_OGL()
+  ctx->mGL._glFogf(GL_FOG_END, mEnd); VL_CHECK_OGL()
+  ctx->mGL._glFogfv(GL_FOG_COLOR, mColor.ptr()); VL_CHECK_OGL()
 }
 
 //------------------------------------------------------------------------------
 // PolygonOffset
 //------------------------------------------------------------------------------
-void PolygonOffset::apply(int, const Camera*, OpenGLContext*) const
+void PolygonOffset::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glPolygonOffset(mFactor, mUnits); VL_CHECK_OGL()
+  ctx->mGL._glPolygonOffset(mFactor, mUnits); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // LogicOp
 //------------------------------------------------------------------------------
-void LogicOp::apply(int, const Camera*, OpenGLContext*) const
+void LogicOp::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glLogicOp(mLogicOp); VL_CHECK_OGL()
+  ctx->mGL._glLogicOp(mLogicOp); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // DepthRange
 //------------------------------------------------------------------------------
-void DepthRange::apply(int, const Camera*, OpenGLContext*) const
+void DepthRange::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glDepthRange(mZNear, mZFar); VL_CHECK_OGL()
+  ctx->mGL._glDepthRange(mZNear, mZFar); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // LineWidth
 //------------------------------------------------------------------------------
-void LineWidth::apply(int, const Camera*, OpenGLContext*) const
+void LineWidth::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glLineWidth(mLineWidth); VL_CHECK_OGL()
+  ctx->mGL._glLineWidth(mLineWidth); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // PointSize
 //------------------------------------------------------------------------------
-void PointSize::apply(int, const Camera*, OpenGLContext*) const
+void PointSize::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glPointSize(mPointSize); VL_CHECK_OGL()
+  ctx->mGL._glPointSize(mPointSize); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // PolygonStipple
@@ -600,95 +601,95 @@ void PolygonStipple::set(const unsigned char* mask)
   memcpy(mMask, mask, sizeof(unsigned char)*32*32/8);
 }
 //------------------------------------------------------------------------------
-void PolygonStipple::apply(int, const Camera*, OpenGLContext*) const
+void PolygonStipple::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glPolygonStipple(mask()); VL_CHECK_OGL()
+  ctx->mGL._glPolygonStipple(mask()); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // LineStipple
 //------------------------------------------------------------------------------
-void LineStipple::apply(int, const Camera*, OpenGLContext*) const
+void LineStipple::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glLineStipple(mFactor, mPattern); VL_CHECK_OGL()
+  ctx->mGL._glLineStipple(mFactor, mPattern); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // PointParameter
 //------------------------------------------------------------------------------
-void PointParameter::apply(int, const Camera*, OpenGLContext*) const
+void PointParameter::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   if (Has_GL_Version_1_4)
   {
-    glPointParameterf(GL_POINT_SIZE_MIN, mSizeMin); VL_CHECK_OGL()
-    glPointParameterf(GL_POINT_SIZE_MAX, mSizeMax); VL_CHECK_OGL()
-    glPointParameterfv(GL_POINT_DISTANCE_ATTENUATION, (const float*)mDistanceAttenuation.ptr()); VL_CHECK_OGL()
+    ctx->mGL._glPointParameterf(GL_POINT_SIZE_MIN, mSizeMin); VL_CHECK_OGL()
+    ctx->mGL._glPointParameterf(GL_POINT_SIZE_MAX, mSizeMax); VL_CHECK_OGL()
+    ctx->mGL._glPointParameterfv(GL_POINT_DISTANCE_ATTENUATION, (const float*)mDistanceAttenuation.ptr()); VL_CHECK_OGL()
   }
   if (Has_GL_Version_1_4||Has_GL_Version_3_0||Has_GL_Version_4_0)
   {
-    glPointParameterf(GL_POINT_FADE_THRESHOLD_SIZE, mFadeThresholdSize); VL_CHECK_OGL()
+    ctx->mGL._glPointParameterf(GL_POINT_FADE_THRESHOLD_SIZE, mFadeThresholdSize); VL_CHECK_OGL()
   }
   if (Has_GL_Version_2_0||Has_GL_Version_3_0||Has_GL_Version_4_0)
   {
-    glPointParameteri(GL_POINT_SPRITE_COORD_ORIGIN, mPointSpriteCoordOrigin); VL_CHECK_OGL()
+    ctx->mGL._glPointParameteri(GL_POINT_SPRITE_COORD_ORIGIN, mPointSpriteCoordOrigin); VL_CHECK_OGL()
   }
 }
 //------------------------------------------------------------------------------
 // StencilFunc
 //------------------------------------------------------------------------------
-void StencilFunc::apply(int, const Camera*, OpenGLContext*) const
+void StencilFunc::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   if(Has_GL_Version_2_0)
   {
-    glStencilFuncSeparate(GL_FRONT, mFunction_Front, mRefValue_Front, mMask_Front); VL_CHECK_OGL()
-    glStencilFuncSeparate(GL_BACK,  mFunction_Back,  mRefValue_Back,  mMask_Back);  VL_CHECK_OGL()
+    ctx->mGL._glStencilFuncSeparate(GL_FRONT, mFunction_Front, mRefValue_Front, mMask_Front); VL_CHECK_OGL()
+    ctx->mGL._glStencilFuncSeparate(GL_BACK,  mFunction_Back,  mRefValue_Back,  mMask_Back);  VL_CHECK_OGL()
   }
   else
   {
-    glStencilFunc(mFunction_Front, mRefValue_Front, mMask_Front); VL_CHECK_OGL()
+    ctx->mGL._glStencilFunc(mFunction_Front, mRefValue_Front, mMask_Front); VL_CHECK_OGL()
   }
 }
 //------------------------------------------------------------------------------
 // StencilOp
 //------------------------------------------------------------------------------
-void StencilOp::apply(int, const Camera*, OpenGLContext*) const
+void StencilOp::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   if(Has_GL_Version_2_0)
   {
-    glStencilOpSeparate(GL_FRONT, mSFail_Front, mDpFail_Front, mDpPass_Front); VL_CHECK_OGL()
-    glStencilOpSeparate(GL_BACK,  mSFail_Back,  mDpFail_Back,  mDpPass_Back);  VL_CHECK_OGL()
+    ctx->mGL._glStencilOpSeparate(GL_FRONT, mSFail_Front, mDpFail_Front, mDpPass_Front); VL_CHECK_OGL()
+    ctx->mGL._glStencilOpSeparate(GL_BACK,  mSFail_Back,  mDpFail_Back,  mDpPass_Back);  VL_CHECK_OGL()
   }
   else
   {
-    glStencilOp(mSFail_Front, mDpFail_Front, mDpPass_Front); VL_CHECK_OGL()
+    ctx->mGL._glStencilOp(mSFail_Front, mDpFail_Front, mDpPass_Front); VL_CHECK_OGL()
   }
 }
 //------------------------------------------------------------------------------
 // StencilMask
 //------------------------------------------------------------------------------
-void StencilMask::apply(int, const Camera*, OpenGLContext*) const
+void StencilMask::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   if(Has_GL_Version_2_0)
   {
-    glStencilMaskSeparate(GL_FRONT, mMask_Front); VL_CHECK_OGL()
-    glStencilMaskSeparate(GL_BACK,  mMask_Back);  VL_CHECK_OGL()
+    ctx->mGL._glStencilMaskSeparate(GL_FRONT, mMask_Front); VL_CHECK_OGL()
+    ctx->mGL._glStencilMaskSeparate(GL_BACK,  mMask_Back);  VL_CHECK_OGL()
   }
   else
   {
-    glStencilMask(mMask_Front); VL_CHECK_OGL()
+    ctx->mGL._glStencilMask(mMask_Front); VL_CHECK_OGL()
   }
 }
 //------------------------------------------------------------------------------
 // BlendColor
 //------------------------------------------------------------------------------
-void BlendColor::apply(int, const Camera*, OpenGLContext*) const
+void BlendColor::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glBlendColor(mBlendColor.r(), mBlendColor.g(), mBlendColor.b(), mBlendColor.a()); VL_CHECK_OGL()
+  ctx->mGL._glBlendColor(mBlendColor.r(), mBlendColor.g(), mBlendColor.b(), mBlendColor.a()); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // VertexAttrib
 //------------------------------------------------------------------------------
 void VertexAttrib::apply(int index, const Camera*, OpenGLContext* ctx) const
 {
-  glVertexAttrib4fv( index, mValue.ptr() ); VL_CHECK_OGL()
+  ctx->mGL._glVertexAttrib4fv( index, mValue.ptr() ); VL_CHECK_OGL()
   ctx->mVertexAttribValue[index] = mValue;
 }
 //------------------------------------------------------------------------------
@@ -697,7 +698,7 @@ void VertexAttrib::apply(int index, const Camera*, OpenGLContext* ctx) const
 void Color::apply(int, const Camera*, OpenGLContext* ctx) const
 {
   VL_CHECK( ctx );
-  glColor4f( mColor.r(), mColor.g(), mColor.b(), mColor.a() ); VL_CHECK_OGL()
+  ctx->mGL._glColor4f( mColor.r(), mColor.g(), mColor.b(), mColor.a() ); VL_CHECK_OGL()
   ctx->mColor = mColor;
 }
 //------------------------------------------------------------------------------
@@ -705,7 +706,7 @@ void Color::apply(int, const Camera*, OpenGLContext* ctx) const
 //------------------------------------------------------------------------------
 void SecondaryColor::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glSecondaryColor3f( mSecondaryColor.r(), mSecondaryColor.g(), mSecondaryColor.b() ); VL_CHECK_OGL()
+  ctx->mGL._glSecondaryColor3f( mSecondaryColor.r(), mSecondaryColor.g(), mSecondaryColor.b() ); VL_CHECK_OGL()
   ctx->mSecondaryColor = mSecondaryColor;
 }
 //------------------------------------------------------------------------------
@@ -713,22 +714,22 @@ void SecondaryColor::apply(int, const Camera*, OpenGLContext* ctx) const
 //------------------------------------------------------------------------------
 void Normal::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glNormal3f( mNormal.x(), mNormal.y(), mNormal.z() ); VL_CHECK_OGL()
+  ctx->mGL._glNormal3f( mNormal.x(), mNormal.y(), mNormal.z() ); VL_CHECK_OGL()
   ctx->mNormal = mNormal;
 }
 //------------------------------------------------------------------------------
 // ColorMask
 //------------------------------------------------------------------------------
-void ColorMask::apply(int, const Camera*, OpenGLContext*) const
+void ColorMask::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glColorMask(mRed?GL_TRUE:GL_FALSE, mGreen?GL_TRUE:GL_FALSE, mBlue?GL_TRUE:GL_FALSE, mAlpha?GL_TRUE:GL_FALSE); VL_CHECK_OGL()
+  ctx->mGL._glColorMask(mRed?GL_TRUE:GL_FALSE, mGreen?GL_TRUE:GL_FALSE, mBlue?GL_TRUE:GL_FALSE, mAlpha?GL_TRUE:GL_FALSE); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // SampleCoverage
 //------------------------------------------------------------------------------
-void SampleCoverage::apply(int, const Camera*, OpenGLContext*) const
+void SampleCoverage::apply(int, const Camera*, OpenGLContext* ctx) const
 {
-  glSampleCoverage(mValue, mInvert?GL_TRUE:GL_FALSE); VL_CHECK_OGL()
+  ctx->mGL._glSampleCoverage(mValue, mInvert?GL_TRUE:GL_FALSE); VL_CHECK_OGL()
 }
 //------------------------------------------------------------------------------
 // TexParameter
@@ -771,7 +772,7 @@ void TexParameter::setMagFilter(ETexParamFilter magfilter)
   }
 }
 //------------------------------------------------------------------------------
-void TexParameter::apply(ETextureDimension dimension, OpenGLContext* ) const
+void TexParameter::apply(ETextureDimension dimension, OpenGLContext* ctx) const
 {
   VL_CHECK_OGL()
 
@@ -817,27 +818,27 @@ void TexParameter::apply(ETextureDimension dimension, OpenGLContext* ) const
   if (dimension != TD_TEXTURE_BUFFER && dimension != TD_TEXTURE_2D_MULTISAMPLE && dimension != TD_TEXTURE_2D_MULTISAMPLE_ARRAY)
   {
 #if defined(VL_OPENGL)
-    glTexParameterfv(dimension, GL_TEXTURE_BORDER_COLOR, borderColor().ptr()); VL_CHECK_OGL()
+    ctx->mGL._glTexParameterfv(dimension, GL_TEXTURE_BORDER_COLOR, borderColor().ptr()); VL_CHECK_OGL()
 #endif
-    glTexParameteri(dimension, GL_TEXTURE_MIN_FILTER, minFilter()); VL_CHECK_OGL()
-    glTexParameteri(dimension, GL_TEXTURE_MAG_FILTER, magFilter()); VL_CHECK_OGL()
-    glTexParameteri(dimension, GL_TEXTURE_WRAP_S, wrapS()); VL_CHECK_OGL()
-    glTexParameteri(dimension, GL_TEXTURE_WRAP_T, wrapT()); VL_CHECK_OGL()
+    ctx->mGL._glTexParameteri(dimension, GL_TEXTURE_MIN_FILTER, minFilter()); VL_CHECK_OGL()
+    ctx->mGL._glTexParameteri(dimension, GL_TEXTURE_MAG_FILTER, magFilter()); VL_CHECK_OGL()
+    ctx->mGL._glTexParameteri(dimension, GL_TEXTURE_WRAP_S, wrapS()); VL_CHECK_OGL()
+    ctx->mGL._glTexParameteri(dimension, GL_TEXTURE_WRAP_T, wrapT()); VL_CHECK_OGL()
     if (Has_Texture_3D)
-      glTexParameteri(dimension, GL_TEXTURE_WRAP_R, wrapR()); VL_CHECK_OGL()
+      ctx->mGL._glTexParameteri(dimension, GL_TEXTURE_WRAP_R, wrapR()); VL_CHECK_OGL()
 
     if (Has_GL_EXT_texture_filter_anisotropic)
-      glTexParameterf( dimension, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy() ); VL_CHECK_OGL()
+      ctx->mGL._glTexParameterf( dimension, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy() ); VL_CHECK_OGL()
 
     if (Has_GL_GENERATE_MIPMAP && dimension != TD_TEXTURE_RECTANGLE)
-      glTexParameteri(dimension, GL_GENERATE_MIPMAP, generateMipmap() ? GL_TRUE : GL_FALSE); VL_CHECK_OGL()
+      ctx->mGL._glTexParameteri(dimension, GL_GENERATE_MIPMAP, generateMipmap() ? GL_TRUE : GL_FALSE); VL_CHECK_OGL()
 
     if (Has_GL_ARB_shadow||Has_GL_Version_1_4||Has_GL_Version_3_0||Has_GL_Version_4_0)
     {
-      glTexParameteri(dimension, GL_TEXTURE_COMPARE_MODE, compareMode() ); VL_CHECK_OGL()
-      glTexParameteri(dimension, GL_TEXTURE_COMPARE_FUNC, compareFunc() ); VL_CHECK_OGL()
+      ctx->mGL._glTexParameteri(dimension, GL_TEXTURE_COMPARE_MODE, compareMode() ); VL_CHECK_OGL()
+      ctx->mGL._glTexParameteri(dimension, GL_TEXTURE_COMPARE_FUNC, compareFunc() ); VL_CHECK_OGL()
       if(Has_GL_Version_1_4)
-        glTexParameteri(dimension, GL_DEPTH_TEXTURE_MODE, depthTextureMode() ); VL_CHECK_OGL()
+        ctx->mGL._glTexParameteri(dimension, GL_DEPTH_TEXTURE_MODE, depthTextureMode() ); VL_CHECK_OGL()
     }
   }
 
@@ -885,54 +886,54 @@ void TexEnv::apply(int index, const Camera*, OpenGLContext* ctx) const
   VL_CHECK(index < ctx->textureCoordCount())
 
   // if this fails probably you requested a texture unit index not supported by your OpenGL implementation.
-  glActiveTexture( GL_TEXTURE0 + index ); VL_CHECK_OGL();
+  ctx->activeTexture( index );
 
-  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, mode()); VL_CHECK_OGL()
+  ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, mode()); VL_CHECK_OGL()
 
   // red book 1.4 p411
   if (mode() == TEM_BLEND)
   {
-    glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, color().ptr()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, color().ptr()); VL_CHECK_OGL()
   }
 
   // combiner settings
   // red book 1.4 p438
   if (mode() == TEM_COMBINE && (Has_GL_EXT_texture_env_combine || Has_GL_Version_1_3))
   {
-    glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, rgbScale()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, combineRGB()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, source0RGB()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, source1RGB()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, operand0RGB()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_RGB, operand1RGB()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, rgbScale()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, combineRGB()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, source0RGB()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB, source1RGB()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, operand0RGB()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_RGB, operand1RGB()); VL_CHECK_OGL()
     if (combineRGB() == TEM_INTERPOLATE)
     {
-      glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE2_RGB, source2RGB()); VL_CHECK_OGL()
-      glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND2_RGB, operand2RGB()); VL_CHECK_OGL()
+      ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE2_RGB, source2RGB()); VL_CHECK_OGL()
+      ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND2_RGB, operand2RGB()); VL_CHECK_OGL()
     }
 
-    glTexEnvf(GL_TEXTURE_ENV, GL_ALPHA_SCALE, alphaScale()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, combineAlpha()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, source0Alpha()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, source1Alpha()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, operand0Alpha()); VL_CHECK_OGL()
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, operand1Alpha()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvf(GL_TEXTURE_ENV, GL_ALPHA_SCALE, alphaScale()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, combineAlpha()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, source0Alpha()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, source1Alpha()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, operand0Alpha()); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, operand1Alpha()); VL_CHECK_OGL()
     if (combineAlpha() == TEM_INTERPOLATE)
     {
-      glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE2_ALPHA, source2Alpha()); VL_CHECK_OGL()
-      glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND2_ALPHA, operand2Alpha()); VL_CHECK_OGL()
+      ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE2_ALPHA, source2Alpha()); VL_CHECK_OGL()
+      ctx->mGL._glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND2_ALPHA, operand2Alpha()); VL_CHECK_OGL()
     }
   }
 
   // no need to do it if point sprite is disabled but we cannot know it here
   if (Has_Point_Sprite)
   {
-    glTexEnvi( GL_POINT_SPRITE_ARB, GL_COORD_REPLACE_ARB, mPointSpriteCoordReplace ? GL_TRUE : GL_FALSE ); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvi( GL_POINT_SPRITE_ARB, GL_COORD_REPLACE_ARB, mPointSpriteCoordReplace ? GL_TRUE : GL_FALSE ); VL_CHECK_OGL()
   }
 
   if (Has_GL_Version_1_4||Has_GL_EXT_texture_lod_bias)
   {
-    glTexEnvf(GL_TEXTURE_FILTER_CONTROL, GL_TEXTURE_LOD_BIAS, mLodBias); VL_CHECK_OGL()
+    ctx->mGL._glTexEnvf(GL_TEXTURE_FILTER_CONTROL, GL_TEXTURE_LOD_BIAS, mLodBias); VL_CHECK_OGL()
   }
 }
 //-----------------------------------------------------------------------------
@@ -965,59 +966,58 @@ void TexGen::apply(int index, const Camera*, OpenGLContext* ctx) const
   VL_CHECK(index < VL_MAX_LEGACY_TEXTURE_UNITS)
   VL_CHECK(index < ctx->textureCoordCount())
 
-  glActiveTexture( GL_TEXTURE0 + index );
   // if this fails probably you requested a texture unit index not supported by your OpenGL implementation.
-  VL_CHECK_OGL();
+  ctx->activeTexture( index );
 
   if (genModeS() || genModeT() || genModeR() || genModeQ())
   {
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
+    ctx->mGL._glMatrixMode(GL_MODELVIEW);
+    ctx->mGL._glPushMatrix();
+    ctx->mGL._glLoadIdentity();
 
     if (genModeS())
     {
-      glEnable(GL_TEXTURE_GEN_S);
-      glTexGeni( GL_S, GL_TEXTURE_GEN_MODE, genModeS());
+      ctx->mGL._glEnable(GL_TEXTURE_GEN_S);
+      ctx->mGL._glTexGeni( GL_S, GL_TEXTURE_GEN_MODE, genModeS());
       // Note: these are not supported by OpenGL ES
-      if (genModeS() == TGM_OBJECT_LINEAR) glTexGenfv(GL_S, GL_OBJECT_PLANE, objectPlaneS().ptr());
-      if (genModeS() == TGM_EYE_LINEAR)    glTexGenfv(GL_S, GL_EYE_PLANE,       eyePlaneS().ptr());
+      if (genModeS() == TGM_OBJECT_LINEAR) ctx->mGL._glTexGenfv(GL_S, GL_OBJECT_PLANE, objectPlaneS().ptr());
+      if (genModeS() == TGM_EYE_LINEAR)    ctx->mGL._glTexGenfv(GL_S, GL_EYE_PLANE,       eyePlaneS().ptr());
     }
 
     VL_CHECK_OGL();
 
     if (genModeT())
     {
-      glEnable(GL_TEXTURE_GEN_T);
-      glTexGeni( GL_T, GL_TEXTURE_GEN_MODE, genModeT());
+      ctx->mGL._glEnable(GL_TEXTURE_GEN_T);
+      ctx->mGL._glTexGeni( GL_T, GL_TEXTURE_GEN_MODE, genModeT());
       // Note: these are not supported by OpenGL ES
-      if (genModeT() == TGM_OBJECT_LINEAR) glTexGenfv(GL_T, GL_OBJECT_PLANE, objectPlaneT().ptr());
-      if (genModeT() == TGM_EYE_LINEAR)    glTexGenfv(GL_T, GL_EYE_PLANE,       eyePlaneT().ptr());
+      if (genModeT() == TGM_OBJECT_LINEAR) ctx->mGL._glTexGenfv(GL_T, GL_OBJECT_PLANE, objectPlaneT().ptr());
+      if (genModeT() == TGM_EYE_LINEAR)    ctx->mGL._glTexGenfv(GL_T, GL_EYE_PLANE,       eyePlaneT().ptr());
     }
 
     VL_CHECK_OGL();
 
     if (genModeR())
     {
-      glEnable(GL_TEXTURE_GEN_R);
-      glTexGeni( GL_R, GL_TEXTURE_GEN_MODE, genModeR());
+      ctx->mGL._glEnable(GL_TEXTURE_GEN_R);
+      ctx->mGL._glTexGeni( GL_R, GL_TEXTURE_GEN_MODE, genModeR());
       // Note: these are not supported by OpenGL ES
-      if (genModeR() == TGM_OBJECT_LINEAR) glTexGenfv(GL_R, GL_OBJECT_PLANE, objectPlaneR().ptr());
-      if (genModeR() == TGM_EYE_LINEAR)    glTexGenfv(GL_R, GL_EYE_PLANE,       eyePlaneR().ptr());
+      if (genModeR() == TGM_OBJECT_LINEAR) ctx->mGL._glTexGenfv(GL_R, GL_OBJECT_PLANE, objectPlaneR().ptr());
+      if (genModeR() == TGM_EYE_LINEAR)    ctx->mGL._glTexGenfv(GL_R, GL_EYE_PLANE,       eyePlaneR().ptr());
     }
 
     VL_CHECK_OGL();
 
     if (genModeQ())
     {
-      glEnable(GL_TEXTURE_GEN_Q);
-      glTexGeni( GL_Q, GL_TEXTURE_GEN_MODE, genModeQ());
+      ctx->mGL._glEnable(GL_TEXTURE_GEN_Q);
+      ctx->mGL._glTexGeni( GL_Q, GL_TEXTURE_GEN_MODE, genModeQ());
       // Note: these are not supported by OpenGL ES
-      if (genModeQ() == TGM_OBJECT_LINEAR) glTexGenfv(GL_Q, GL_OBJECT_PLANE, objectPlaneQ().ptr());
-      if (genModeQ() == TGM_EYE_LINEAR)    glTexGenfv(GL_Q, GL_EYE_PLANE,    eyePlaneQ().ptr());
+      if (genModeQ() == TGM_OBJECT_LINEAR) ctx->mGL._glTexGenfv(GL_Q, GL_OBJECT_PLANE, objectPlaneQ().ptr());
+      if (genModeQ() == TGM_EYE_LINEAR)    ctx->mGL._glTexGenfv(GL_Q, GL_EYE_PLANE,    eyePlaneQ().ptr());
     }
 
-    glPopMatrix();
+    ctx->mGL._glPopMatrix();
   }
 
   // these needs to be done here to apply a TexGen which has all components disabled
@@ -1026,16 +1026,16 @@ void TexGen::apply(int index, const Camera*, OpenGLContext* ctx) const
   VL_CHECK_OGL();
 
   if (!genModeS())
-    glDisable(GL_TEXTURE_GEN_S);
+    ctx->mGL._glDisable(GL_TEXTURE_GEN_S);
 
   if (!genModeT())
-    glDisable(GL_TEXTURE_GEN_T);
+    ctx->mGL._glDisable(GL_TEXTURE_GEN_T);
 
   if (!genModeR())
-    glDisable(GL_TEXTURE_GEN_R);
+    ctx->mGL._glDisable(GL_TEXTURE_GEN_R);
 
   if (!genModeQ())
-    glDisable(GL_TEXTURE_GEN_Q);
+    ctx->mGL._glDisable(GL_TEXTURE_GEN_Q);
 }
 //-----------------------------------------------------------------------------
 // TextureMatrix
@@ -1046,14 +1046,14 @@ void TextureMatrix::apply(int index, const Camera* camera, OpenGLContext* ctx) c
   VL_CHECK(index < VL_MAX_LEGACY_TEXTURE_UNITS)
   VL_CHECK(index < ctx->textureCoordCount())
 
-  glActiveTexture( GL_TEXTURE0 + index ); VL_CHECK_OGL();
+  ctx->activeTexture( index );
 
-  glMatrixMode(GL_TEXTURE); VL_CHECK_OGL();
+  ctx->mGL._glMatrixMode(GL_TEXTURE); VL_CHECK_OGL();
   if (useCameraRotationInverse()) {
-    VL_glLoadMatrix( ((mat4)matrix()*camera->modelingMatrix().as3x3()).ptr() ); VL_CHECK_OGL();
+    ctx->mGL._glLoadMatrixf( ((fmat4)((mat4)matrix()*camera->modelingMatrix().as3x3())).ptr() ); VL_CHECK_OGL();
   }
   else {
-    VL_glLoadMatrix( ((mat4)matrix()).ptr() ); VL_CHECK_OGL();
+    ctx->mGL._glLoadMatrixf( matrix().ptr() ); VL_CHECK_OGL();
   }
 }
 //-----------------------------------------------------------------------------
@@ -1071,14 +1071,14 @@ void TextureImageUnit::apply(int index, const Camera*, OpenGLContext* ctx) const
   VL_CHECK(index < ctx->textureImageUnitCount())
 
   // activate the appropriate texture unit
-  glActiveTexture( GL_TEXTURE0 + index ); VL_CHECK_OGL()
+  ctx->activeTexture( index );
 
-  // disable and unbind previous active texture target on this texture unit.
+  // disable and unbind previous active texture target on this texture unit, unless we are about to rebind the same target.
   vl::ETextureDimension prev_tex_target = ctx->texUnitBinding( index );
-  if (prev_tex_target)
+  if (prev_tex_target && (!hasTexture() || texture()->dimension() != prev_tex_target))
   {
     // this is not strictly necessary, it also avoids interaction witht FBOs etc.
-    glBindTexture( prev_tex_target, 0 ); VL_CHECK_OGL()
+    ctx->bindTexture( prev_tex_target, 0 );
 
     /* GL_TEXTURE_1D_ARRAY and GL_TEXTURE_2D_ARRAY are not supported by the OpenGL fixed function pipeline */
     if (Has_Fixed_Function_Pipeline)
@@ -1092,15 +1092,17 @@ void TextureImageUnit::apply(int index, const Camera*, OpenGLContext* ctx) const
         case TD_TEXTURE_BUFFER:
           break;
         default:
-          glDisable( prev_tex_target ); VL_CHECK_OGL()
+          ctx->mGL._glDisable( prev_tex_target ); VL_CHECK_OGL()
       }
     }
+
+    ctx->setTexUnitBinding( index, TD_TEXTURE_UNKNOWN );
   }
 
   if (hasTexture())
   {
     // bind the texture
-    glBindTexture( texture()->dimension(), texture()->handle() ); VL_CHECK_OGL()
+    ctx->bindTexture( texture()->dimension(), texture()->handle() );
 
     // if we request mipmapped filtering then we must have a mip-mapped texture.
 #if !defined(NDEBUG) && defined(VL_OPENGL) // glGetTexLevelParameter* is not supported under OpenGL ES
@@ -1108,7 +1110,7 @@ void TextureImageUnit::apply(int index, const Camera*, OpenGLContext* ctx) const
     {
       GLint width = 0;
       ETextureDimension tex_target = texture()->dimension() == vl::TD_TEXTURE_CUBE_MAP ? (ETextureDimension)GL_TEXTURE_CUBE_MAP_POSITIVE_X : texture()->dimension();
-      glGetTexLevelParameteriv( tex_target, 1, GL_TEXTURE_WIDTH, &width );
+      ctx->mGL._glGetTexLevelParameteriv( tex_target, 1, GL_TEXTURE_WIDTH, &width );
       VL_CHECK_OGL()
       if ( !width )
       {
@@ -1144,7 +1146,7 @@ void TextureImageUnit::apply(int index, const Camera*, OpenGLContext* ctx) const
         case TD_TEXTURE_BUFFER:
           break;
         default:
-          glEnable( texture()->dimension() ); VL_CHECK_OGL()
+          ctx->mGL._glEnable( texture()->dimension() ); VL_CHECK_OGL()
       }
     }
 
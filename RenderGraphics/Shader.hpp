@@ -1858,6 +1858,7 @@ namespace vl
 
       // we don't copy the update time
       // mLastUpdateTime = other.mLastUpdateTime;
+      ++mUpdateTick;
 
       if (other.mRenderStateSet.get())
       {
@@ -1912,6 +1913,7 @@ namespace vl
 
       // we don't copy the update time
       // mLastUpdateTime = other.mLastUpdateTime;
+      ++mUpdateTick;
 
       if (other.mRenderStateSet.get())
       {
@@ -2155,23 +2157,23 @@ namespace vl
 
     // enable methods
 
-    void enable(EEnable capability)  { gocEnableSet()->enable(capability); }
+    void enable(EEnable capability)  { gocEnableSet()->enable(capability); ++mUpdateTick; }
 
-    void disable(EEnable capability) { gocEnableSet()->disable(capability); }
+    void disable(EEnable capability) { gocEnableSet()->disable(capability); ++mUpdateTick; }
 
     const std::vector<EEnable>& enables() const { return getEnableSet()->enables(); }
 
     int isEnabled(EEnable capability) const { if (!getEnableSet()) return false; return getEnableSet()->isEnabled(capability); }
 
-    void disableAll() { if (getEnableSet()) getEnableSet()->disableAll(); }
+    void disableAll() { if (getEnableSet()) getEnableSet()->disableAll(); ++mUpdateTick; }
 
     bool isBlendingEnabled() const { if (!getEnableSet()) return false; return getEnableSet()->isBlendingEnabled(); }
 
     // render states methods
 
-    void setRenderState(RenderStateNonIndexed* renderstate) { gocRenderStateSet()->setRenderState(renderstate, -1); }
+    void setRenderState(RenderStateNonIndexed* renderstate) { gocRenderStateSet()->setRenderState(renderstate, -1); ++mUpdateTick; }
 
-    void setRenderState(RenderState* renderstate, int index) { gocRenderStateSet()->setRenderState(renderstate, index); }
+    void setRenderState(RenderState* renderstate, int index) { gocRenderStateSet()->setRenderState(renderstate, index); ++mUpdateTick; }
 
     const RenderState* renderState( ERenderState type, int index=0 ) const { if (!getRenderStateSet()) return NULL; return getRenderStateSet()->renderState(type, index); }
 
@@ -2184,11 +2186,11 @@ namespace vl
     RenderStateSlot* renderStates() { return getRenderStateSet()->renderStates(); }
 
     //! If index == -1 all the renderstates of the given type are removed regardless of their binding index.
-    void eraseRenderState(ERenderState type, int index=-1) { gocRenderStateSet()->eraseRenderState(type, index); }
+    void eraseRenderState(ERenderState type, int index=-1) { gocRenderStateSet()->eraseRenderState(type, index); ++mUpdateTick; }
 
-    void eraseRenderState(RenderState* rs, int index) { if (rs) gocRenderStateSet()->eraseRenderState(rs->type(), index); }
+    void eraseRenderState(RenderState* rs, int index) { if (rs) gocRenderStateSet()->eraseRenderState(rs->type(), index); ++mUpdateTick; }
 
-    void eraseAllRenderStates() { if(getRenderStateSet()) getRenderStateSet()->eraseAllRenderStates(); }
+    void eraseAllRenderStates() { if(getRenderStateSet()) getRenderStateSet()->eraseAllRenderStates(); ++mUpdateTick; }
 
     //! Returns the GLSLProgram associated to a Shader (if any)
     const GLSLProgram* glslProgram() const { if (!getRenderStateSet()) return NULL; return getRenderStateSet()->glslProgram(); }
@@ -2272,9 +2274,9 @@ namespace vl
     */
     const UniformSet* getUniformSet() const { return mUniformSet.get(); }
 
-    void setEnableSet(EnableSet* es) { mEnableSet = es; }
+    void setEnableSet(EnableSet* es) { mEnableSet = es; ++mUpdateTick; }
 
-    void setRenderStateSet(RenderStateSet* rss) { mRenderStateSet = rss; }
+    void setRenderStateSet(RenderStateSet* rss) { mRenderStateSet = rss; ++mUpdateTick; }
 
     /**
      * Installs a new UniformSet
@@ -2332,6 +2334,13 @@ namespace vl
     //! Used internally.
     void setLastUpdateTime(real time) { mLastUpdateTime = time; }
 
+    /** Incremented every time the enables or the render states are modified through the Shader's methods, used by Rendering to validate its render queue cache.
+      * Call incrementUpdateTick() after modifying the EnableSet or the RenderStateSet directly. */
+    long long updateTick() const { return mUpdateTick; }
+
+    /** Flags the Shader as modified, see updateTick(). */
+    void incrementUpdateTick() { ++mUpdateTick; }
+
 #ifdef VL_USER_DATA_SHADER
   public:
     const Object* shaderUserData() const { return mShaderUserData.get(); }
@@ -2349,6 +2358,7 @@ namespace vl
     ref<Scissor> mScissor;
     ref<ShaderAnimator> mShaderAnimator;
     real mLastUpdateTime;
+    long long mUpdateTick;
   };
 }
 
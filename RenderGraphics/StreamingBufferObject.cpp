@@ -0,0 +1,238 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+#include <vlGraphics/StreamingBufferObject.hpp>
+#include <vlGraphics/Array.hpp>
+#include <cstring>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+// StreamingBufferObject
+//-----------------------------------------------------------------------------
+StreamingBufferObject::StreamingBufferObject(int segment_size, int segment_count)
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+  VL_CHECK( segment_size > 0 && segment_count > 0 )
+  mFences.resize( segment_count, NULL );
+  mSegmentRegions.resize( segment_count );
+  mMappedPtr = NULL;
+  mSegmentSize  = segment_size;
+  mSegmentCount = segment_count;
+  mSegment = 0;
+  mHead = 0;
+  mFrameCount = 0;
+  mBytesStreamed = 0;
+  mLastFrameBytesStreamed = 0;
+  mTotalBytesStreamed = 0;
+  mFenceWaitCount = 0;
+  mOverflowCount = 0;
+  mPersistentMappingEnabled = true;
+  mFrameStarted = false;
+}
+//-----------------------------------------------------------------------------
+StreamingBufferObject::~StreamingBufferObject()
+{
+  releaseStorage();
+}
+//-----------------------------------------------------------------------------
+bool StreamingBufferObject::isStreamingSupported()
+{
+  return Has_BufferObject && ( Has_GL_Version_3_2 || Has_GL_Version_4_0 );
+}
+//-----------------------------------------------------------------------------
+bool StreamingBufferObject::createStorage()
+{
+  if ( handle() )
+    return true;
+
+  if ( !isStreamingSupported() )
+    return false;
+
+  VL_CHECK_OGL()
+  createBufferObject();
+  const GLsizeiptr byte_count = (GLsizeiptr)mSegmentSize * mSegmentCount;
+  glBindBuffer( GL_COPY_WRITE_BUFFER, handle() ); VL_CHECK_OGL()
+  forgetBufferTarget( GL_COPY_WRITE_BUFFER );
+  if ( mPersistentMappingEnabled && Has_GL_Version_4_4 )
+  {
+    glBufferStorage( GL_COPY_WRITE_BUFFER, byte_count, NULL, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT ); VL_CHECK_OGL()
+    mMappedPtr = glMapBufferRange( GL_COPY_WRITE_BUFFER, 0, byte_count, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT ); VL_CHECK_OGL()
+    VL_CHECK( mMappedPtr )
+  }
+  else
+  {
+    glBufferData( GL_COPY_WRITE_BUFFER, byte_count, NULL, GL_STREAM_DRAW ); VL_CHECK_OGL()
+  }
+  glBindBuffer( GL_COPY_WRITE_BUFFER, 0 ); VL_CHECK_OGL()
+  mByteCountBufferObject = byte_count;
+  mUsage = BU_STREAM_DRAW;
+  mSegment = 0;
+  mHead = 0;
+  return true;
+}
+//-----------------------------------------------------------------------------
+void StreamingBufferObject::releaseStorage()
+{
+  for( size_t i = 0; i < mFences.size(); ++i )
+  {
+    if ( mFences[i] ) {
+      glDeleteSync( mFences[i] );
+      mFences[i] = NULL;
+    }
+  }
+  // detach the arrays still referring to the storage, their next stream() or setBufferData() gives them a valid buffer
+  for( size_t i = 0; i < mSegmentRegions.size(); ++i )
+  {
+    for( size_t j = 0; j < mSegmentRegions[i].size(); ++j )
+    {
+      BufferObject* buffer = mSegmentRegions[i][j].get();
+      if ( handle() && buffer->isHandleShared() && buffer->handle() == handle() )
+        buffer->deleteBufferObject();
+    }
+    mSegmentRegions[i].clear();
+  }
+  if ( mMappedPtr )
+  {
+    glBindBuffer( GL_COPY_WRITE_BUFFER, handle() );
+    forgetBufferTarget( GL_COPY_WRITE_BUFFER );
+    glUnmapBuffer( GL_COPY_WRITE_BUFFER );
+    glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+    mMappedPtr = NULL;
+  }
+  deleteBufferObject();
+  mFrameStarted = false;
+}
+//-----------------------------------------------------------------------------
+void StreamingBufferObject::beginFrame()
+{
+  VL_CHECK( !mFrameStarted )
+  mFrameStarted = true;
+  ++mFrameCount;
+  mBytesStreamed = 0;
+  mHead = 0;
+
+  if ( !createStorage() )
+    return;
+
+  mSegment = ( mSegment + 1 ) % mSegmentCount;
+
+  // wait for the GPU to finish reading the segment written segmentCount() frames ago
+  GLsync& fence = mFences[mSegment];
+  if ( fence )
+  {
+    GLenum result = glClientWaitSync( fence, 0, 0 ); VL_CHECK_OGL()
+    if ( result == GL_TIMEOUT_EXPIRED )
+    {
+      ++mFenceWaitCount;
+      do {
+        result = glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000 ); VL_CHECK_OGL()
+      } while ( result == GL_TIMEOUT_EXPIRED );
+    }
+    glDeleteSync( fence );
+    fence = NULL;
+  }
+
+  // the regions of the segment are being recycled
+  mSegmentRegions[mSegment].clear();
+}
+//-----------------------------------------------------------------------------
+void StreamingBufferObject::endFrame()
+{
+  VL_CHECK( mFrameStarted )
+  if ( !mFrameStarted )
+    return;
+  mFrameStarted = false;
+  mLastFrameBytesStreamed = mBytesStreamed;
+
+  if ( handle() && mHead )
+  {
+    VL_CHECK( mFences[mSegment] == NULL )
+    mFences[mSegment] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 ); VL_CHECK_OGL()
+  }
+}
+//-----------------------------------------------------------------------------
+GLintptr StreamingBufferObject::stream(const void* data, GLsizeiptr byte_count)
+{
+  VL_CHECK( mFrameStarted )
+  if ( !mFrameStarted || !handle() || !data || byte_count <= 0 )
+    return -1;
+
+  const GLintptr local = ( mHead + RegionAlignment - 1 ) / RegionAlignment * RegionAlignment;
+  if ( local + byte_count > mSegmentSize )
+  {
+    ++mOverflowCount;
+    return -1;
+  }
+  const GLintptr offset = (GLintptr)mSegment * mSegmentSize + local;
+
+  glBindBuffer( GL_COPY_WRITE_BUFFER, handle() ); VL_CHECK_OGL()
+  forgetBufferTarget( GL_COPY_WRITE_BUFFER );
+  if ( mMappedPtr )
+  {
+    memcpy( (unsigned char*)mMappedPtr + offset, data, byte_count );
+    glFlushMappedBufferRange( GL_COPY_WRITE_BUFFER, offset, byte_count ); VL_CHECK_OGL()
+  }
+  else
+  {
+    // the fences guarantee that the GPU is not reading this segment anymore
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+    void* ptr = glMapBufferRange( GL_COPY_WRITE_BUFFER, offset, byte_count, access ); VL_CHECK_OGL()
+    if ( !ptr )
+    {
+      glBindBuffer( GL_COPY_WRITE_BUFFER, 0 ); VL_CHECK_OGL()
+      return -1;
+    }
+    memcpy( ptr, data, byte_count );
+    glFlushMappedBufferRange( GL_COPY_WRITE_BUFFER, 0, byte_count ); VL_CHECK_OGL()
+    glUnmapBuffer( GL_COPY_WRITE_BUFFER ); VL_CHECK_OGL()
+  }
+  glBindBuffer( GL_COPY_WRITE_BUFFER, 0 ); VL_CHECK_OGL()
+
+  mHead = local + byte_count;
+  mBytesStreamed += byte_count;
+  mTotalBytesStreamed += byte_count;
+  return offset;
+}
+//-----------------------------------------------------------------------------
+bool StreamingBufferObject::stream(ArrayAbstract* array)
+{
+  VL_CHECK( array && array->bufferObject() )
+  const GLsizeiptr byte_count = (GLsizeiptr)array->bytesUsed();
+  GLintptr offset = stream( array->ptr(), byte_count );
+  if ( offset < 0 )
+    return false;
+  array->bufferObject()->setSharedRegion( handle(), offset, byte_count );
+  mSegmentRegions[mSegment].push_back( array->bufferObject() );
+  array->setBufferObjectDirty( false );
+  return true;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,202 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+#ifndef StreamingBufferObject_INCLUDE_ONCE
+#define StreamingBufferObject_INCLUDE_ONCE
+
+#include <vlGraphics/BufferObject.hpp>
+#include <vlGraphics/RenderEventCallback.hpp>
+#include <vector>
+
+namespace vl
+{
+  class ArrayAbstract;
+
+  //-----------------------------------------------------------------------------
+  // StreamingBufferObject
+  //-----------------------------------------------------------------------------
+  /**
+   * A BufferObject used as a ring of per-frame regions to stream dynamic vertex data to the GPU.
+   *
+   * The buffer is split in segmentCount() segments of segmentSize() bytes, one per frame in flight. beginFrame() moves
+   * to the next segment and waits for the fence inserted by the endFrame() that last used it, stream() then suballocates
+   * and writes regions of the current segment. The data of an array streamed with stream(ArrayAbstract*) is referenced
+   * by its BufferObject as a shared region (see BufferObject::setSharedRegion()), so dynamic geometry is uploaded without
+   * reallocating or orphaning GPU storage and without synchronizing with the frames still being rendered.
+   *
+   * When persistent mapping is enabled and OpenGL 4.4 is available the buffer is created with glBufferStorage() and mapped
+   * once, otherwise every stream() maps its region with GL_MAP_UNSYNCHRONIZED_BIT and GL_MAP_FLUSH_EXPLICIT_BIT.
+   * Requires OpenGL 3.2 (sync objects), when not available stream() fails and the callers fall back to BufferObject::setBufferData().
+   *
+   * \note The buffer is written through the GL_COPY_WRITE_BUFFER binding point so the vertex array bindings are not touched.
+   * \note releaseStorage() detaches the arrays streamed during the last segmentCount() frames, which must then be streamed or uploaded again.
+   * \sa StreamingBufferFrameCallback, MorphingCallback::setStreamingBuffer()
+   */
+  class VLGRAPHICS_EXPORT StreamingBufferObject: public BufferObject
+  {
+    VL_INSTRUMENT_CLASS(vl::StreamingBufferObject, BufferObject)
+
+  public:
+    //! Alignment in bytes of the regions returned by stream().
+    enum { RegionAlignment = 64 };
+
+  public:
+    StreamingBufferObject(int segment_size = 4*1024*1024, int segment_count = 3);
+
+    ~StreamingBufferObject();
+
+    //! Returns true if the current OpenGL context supports the streaming, see the class description.
+    static bool isStreamingSupported();
+
+    //! Moves to the next segment waiting for the GPU to finish reading it. Creates the storage on first use.
+    void beginFrame();
+
+    //! Inserts the fence protecting the segment written since beginFrame().
+    void endFrame();
+
+    //! Writes \p byte_count bytes to a new region of the current segment.
+    //! \return The offset of the region inside the buffer object or -1 if the data does not fit in the segment or the streaming is not available.
+    GLintptr stream(const void* data, GLsizeiptr byte_count);
+
+    //! Streams the local data of \p array and makes its BufferObject refer to the written region.
+    //! \return false if the data could not be streamed, in which case the BufferObject of \p array is left untouched.
+    bool stream(ArrayAbstract* array);
+
+    //! Deletes the fences and the buffer object and resets the BufferObject of the arrays still referring to one of its regions.
+    //! The storage is created again by the next beginFrame().
+    void releaseStorage();
+
+    //! Whether glBufferStorage() + persistent mapping is used when available. Must be set before the storage is created. Default is true.
+    void setPersistentMappingEnabled(bool enabled) { mPersistentMappingEnabled = enabled; }
+
+    //! Whether glBufferStorage() + persistent mapping is used when available. Must be set before the storage is created. Default is true.
+    bool isPersistentMappingEnabled() const { return mPersistentMappingEnabled; }
+
+    //! Whether the storage is currently persistently mapped.
+    bool isPersistentlyMapped() const { return mMappedPtr != NULL; }
+
+    //! Size in bytes of a segment, i.e. the maximum amount of data that can be streamed per frame.
+    int segmentSize() const { return mSegmentSize; }
+
+    //! Number of segments, i.e. the number of frames that can be in flight.
+    int segmentCount() const { return mSegmentCount; }
+
+    //! The segment currently written.
+    int currentSegment() const { return mSegment; }
+
+    //! Number of beginFrame() calls. Regions streamed during a frame are valid until segmentCount() frames later.
+    long long frameCount() const { return mFrameCount; }
+
+    //! Bytes streamed since the last beginFrame().
+    long long bytesStreamed() const { return mBytesStreamed; }
+
+    //! Bytes streamed during the last completed frame, i.e. between the last beginFrame() / endFrame() pair.
+    long long lastFrameBytesStreamed() const { return mLastFrameBytesStreamed; }
+
+    //! Bytes streamed since the creation of the object.
+    long long totalBytesStreamed() const { return mTotalBytesStreamed; }
+
+    //! Number of beginFrame() calls that had to wait for the GPU to release a segment.
+    long long fenceWaitCount() const { return mFenceWaitCount; }
+
+    //! Number of stream() calls that failed because the segment was full.
+    long long overflowCount() const { return mOverflowCount; }
+
+  protected:
+    bool createStorage();
+
+  protected:
+    std::vector<GLsync> mFences;
+    std::vector< std::vector< ref<BufferObject> > > mSegmentRegions; // BufferObjects streamed to each segment
+    void* mMappedPtr;
+    int mSegmentSize;
+    int mSegmentCount;
+    int mSegment;
+    GLintptr mHead;
+    long long mFrameCount;
+    long long mBytesStreamed;
+    long long mLastFrameBytesStreamed;
+    long long mTotalBytesStreamed;
+    long long mFenceWaitCount;
+    long long mOverflowCount;
+    bool mPersistentMappingEnabled;
+    bool mFrameStarted;
+  };
+
+  //-----------------------------------------------------------------------------
+  // StreamingBufferFrameCallback
+  //-----------------------------------------------------------------------------
+  /**
+   * Calls StreamingBufferObject::beginFrame() and StreamingBufferObject::endFrame() when a Rendering starts and finishes.
+   * Install the same callback in both RenderingAbstract::onStartedCallbacks() and RenderingAbstract::onFinishedCallbacks().
+   */
+  class StreamingBufferFrameCallback: public RenderEventCallback
+  {
+    VL_INSTRUMENT_CLASS(vl::StreamingBufferFrameCallback, RenderEventCallback)
+
+  public:
+    StreamingBufferFrameCallback(StreamingBufferObject* buffer=NULL): mStreamingBuffer(buffer)
+    {
+      VL_DEBUG_SET_OBJECT_NAME()
+    }
+
+    virtual bool onRenderingStarted(const RenderingAbstract*)
+    {
+      if ( !streamingBuffer() )
+        return false;
+      streamingBuffer()->beginFrame();
+      return true;
+    }
+
+    virtual bool onRenderingFinished(const RenderingAbstract*)
+    {
+      if ( !streamingBuffer() )
+        return false;
+      streamingBuffer()->endFrame();
+      return true;
+    }
+
+    virtual bool onRendererStarted(const RendererAbstract*) { return false; }
+
+    virtual bool onRendererFinished(const RendererAbstract*) { return false; }
+
+    void setStreamingBuffer(StreamingBufferObject* buffer) { mStreamingBuffer = buffer; }
+
+    StreamingBufferObject* streamingBuffer() { return mStreamingBuffer.get(); }
+
+    const StreamingBufferObject* streamingBuffer() const { return mStreamingBuffer.get(); }
+
+  protected:
+    ref<StreamingBufferObject> mStreamingBuffer;
+  };
+}
+
+#endif
@@ -52,6 +52,13 @@ void Text::render_Implementation(const Actor* actor, const Shader*, const Camera
   if ( text().empty() )
     return;
 
+  // creates the missing glyphs binding their textures through the OpenGLContext
+  for( int i=0; i<text().length(); ++i )
+  {
+    if ( text()[i] != '\n' )
+      font()->glyph( text()[i], gl_context );
+  }
+
   // Lighting can be enabled or disabled.
   // glDisable(GL_LIGHTING);
 
@@ -89,17 +96,17 @@ void Text::render_Implementation(const Actor* actor, const Shader*, const Camera
 
   // shadow render
   if (shadowEnabled())
-    renderText( actor, camera, shadowColor(), shadowVector() );
+    renderText( actor, camera, shadowColor(), shadowVector(), gl_context );
   // outline render
   if (outlineEnabled())
   {
-    renderText( actor, camera, outlineColor(), fvec2(-1,0) );
-    renderText( actor, camera, outlineColor(), fvec2(+1,0) );
-    renderText( actor, camera, outlineColor(), fvec2(0,-1) );
-    renderText( actor, camera, outlineColor(), fvec2(0,+1) );
+    renderText( actor, camera, outlineColor(), fvec2(-1,0), gl_context );
+    renderText( actor, camera, outlineColor(), fvec2(+1,0), gl_context );
+    renderText( actor, camera, outlineColor(), fvec2(0,-1), gl_context );
+    renderText( actor, camera, outlineColor(), fvec2(0,+1), gl_context );
   }
   // text render
-  renderText( actor, camera, color(), fvec2(0,0) );
+  renderText( actor, camera, color(), fvec2(0,0), gl_context );
 
   // Pass #2
   // fills the z-buffer (not the stencil buffer): approximated to the text bbox
@@ -142,7 +149,7 @@ void Text::render_Implementation(const Actor* actor, const Shader*, const Camera
   glNormal3fv( gl_context->normal().ptr() );
 }
 //-----------------------------------------------------------------------------
-void Text::renderText(const Actor* actor, const Camera* camera, const fvec4& color, const fvec2& offset) const
+void Text::renderText(const Actor* actor, const Camera* camera, const fvec4& color, const fvec2& offset, OpenGLContext* gl_context) const
 {
   if(!mFont)
   {
@@ -200,7 +207,7 @@ void Text::renderText(const Actor* actor, const Camera* camera, const fvec4& col
   fvec2 pen(0,0);
 
   float texc[] = { 0,0, 0,0, 0,0, 0,0 };
-  glActiveTexture( GL_TEXTURE0 );
+  gl_context->activeTexture( 0 );
   glEnable(GL_TEXTURE_2D);
   glClientActiveTexture( GL_TEXTURE0 );
   glEnableClientState( GL_TEXTURE_COORD_ARRAY );
@@ -366,7 +373,7 @@ void Text::renderText(const Actor* actor, const Camera* camera, const fvec4& col
 
       if (glyph->textureHandle())
       {
-        glBindTexture( GL_TEXTURE_2D, glyph->textureHandle() );
+        gl_context->bindTexture( TD_TEXTURE_2D, glyph->textureHandle() );
 
         texc[0] = glyph->s0();
         texc[1] = glyph->t1();
@@ -568,7 +575,7 @@ void Text::renderText(const Actor* actor, const Camera* camera, const fvec4& col
   }
 
   glDisable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D,0);
+  gl_context->bindTexture( TD_TEXTURE_2D, 0 );
 }
 //-----------------------------------------------------------------------------
 // returns the raw bounding box of the string, i.e. without alignment, margin and matrix transform.
@@ -141,7 +141,7 @@ namespace vl
     virtual void deleteBufferObject() {}
 
   protected:
-    void renderText(const Actor*, const Camera* camera, const fvec4& color, const fvec2& offset) const;
+    void renderText(const Actor*, const Camera* camera, const fvec4& color, const fvec2& offset, OpenGLContext* gl_context) const;
     void renderBackground(const Actor* actor, const Camera* camera) const;
     void renderBorder(const Actor* actor, const Camera* camera) const;
     AABB rawboundingRect(const String& text) const;
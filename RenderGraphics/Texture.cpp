@@ -356,6 +356,7 @@ void Texture::destroyTexture()
 {
   if ( mHandle && mManaged ) {
     glDeleteTextures( 1, &mHandle ); VL_CHECK_OGL();
+    forgetTextureBindings( mHandle );
   }
 
   reset();
@@ -722,6 +723,7 @@ bool Texture::createTexture(ETextureDimension tex_dimension, ETextureFormat tex_
     // the buffer object must not be empty!
     GLint buffer_size = 0;
     glBindBuffer(GL_TEXTURE_BUFFER, buffer_object->handle());
+    forgetBufferTarget(GL_TEXTURE_BUFFER);
     glGetBufferParameteriv(GL_TEXTURE_BUFFER, GL_BUFFER_SIZE, &buffer_size);
     glBindBuffer(GL_TEXTURE_BUFFER, 0);
     if ( buffer_size == 0 )
@@ -757,6 +759,7 @@ bool Texture::createTexture(ETextureDimension tex_dimension, ETextureFormat tex_
   mSamples = samples;
   mFixedSamplesLocation = fixedsamplelocations;
   glBindTexture(tex_dimension, mHandle); VL_CHECK_OGL();
+  forgetActiveTextureUnit();
 
   int default_format = getDefaultFormat(tex_format);
   int default_type   = getDefaultType(tex_format);
@@ -864,6 +867,7 @@ bool Texture::setMipLevel(int mip_level, const Image* img, bool gen_mipmaps)
   glPixelStorei( GL_UNPACK_ALIGNMENT, img->byteAlignment() ); VL_CHECK_OGL()
 
   glBindTexture( dimension(), mHandle ); VL_CHECK_OGL()
+  forgetActiveTextureUnit();
 
   int w = width()  + (border()?2:0);
   int h = height() + (border()?2:0);
@@ -0,0 +1,218 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include <vlGraphics/ThreadPool.hpp>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+ThreadPool::ThreadPool(int thread_count): mQueuedTasks(0), mQuit(false)
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+
+  if ( thread_count <= 0 ) {
+    thread_count = (int)std::thread::hardware_concurrency() - 1;
+  }
+
+  for( int i = 0; i < thread_count + 1; ++i ) {
+    mQueues.push_back( new TaskQueue );
+  }
+
+  for( int i = 0; i < thread_count; ++i ) {
+    mThreads.push_back( std::thread( &ThreadPool::workerLoop, this, i ) );
+  }
+}
+//-----------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock( mWakeMutex );
+    mQuit = true;
+  }
+  mWake.notify_all();
+
+  for( size_t i = 0; i < mThreads.size(); ++i ) {
+    mThreads[i].join();
+  }
+
+  for( size_t i = 0; i < mQueues.size(); ++i ) {
+    delete mQueues[i];
+  }
+}
+//-----------------------------------------------------------------------------
+ThreadPool* ThreadPool::defaultThreadPool()
+{
+  static ref<ThreadPool> pool = new ThreadPool;
+  return pool.get();
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& func)
+{
+  if ( count <= 0 ) {
+    return;
+  }
+
+  // nothing to distribute
+  if ( mThreads.empty() || count == 1 )
+  {
+    for( int i = 0; i < count; ++i ) {
+      func(i);
+    }
+    return;
+  }
+
+  Batch batch;
+  batch.mFunction = &func;
+  batch.mPending  = count;
+
+  // deal the tasks round robin, the last queue belongs to the calling thread
+  for( int i = 0; i < count; ++i )
+  {
+    TaskQueue* queue = mQueues[ i % mQueues.size() ];
+    std::lock_guard<std::mutex> lock( queue->mMutex );
+    queue->mTasks.push_back( Task( &batch, i ) );
+  }
+
+  {
+    std::lock_guard<std::mutex> lock( mWakeMutex );
+    mQueuedTasks += count;
+  }
+  mWake.notify_all();
+
+  // help out until there is nothing left to steal
+  Task task;
+  while( popTask( (int)mQueues.size() - 1, task ) ) {
+    runTask( task );
+  }
+
+  // wait for the tasks still running on the workers
+  std::unique_lock<std::mutex> lock( batch.mMutex );
+  while( batch.mPending != 0 ) {
+    batch.mDone.wait( lock );
+  }
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::parallelFor(ThreadPool* thread_pool, int count, int range_count, const std::function<void(int range, int begin, int end)>& func)
+{
+  if ( count <= 0 ) {
+    return;
+  }
+
+  if ( ! thread_pool || range_count <= 1 )
+  {
+    func( 0, 0, count );
+    return;
+  }
+
+  thread_pool->parallelFor( range_count, [&func, count, range_count](int range) {
+    func( range, (int)( (long long)count * range / range_count ), (int)( (long long)count * ( range + 1 ) / range_count ) );
+  } );
+}
+//-----------------------------------------------------------------------------
+int ThreadPool::rangeCount(const ThreadPool* thread_pool, int count, int min_range_size)
+{
+  if ( ! thread_pool || thread_pool->threadCount() == 0 ) {
+    return 1;
+  }
+
+  // a few ranges per thread to balance the load
+  int range_count = ( thread_pool->threadCount() + 1 ) * 4;
+  if ( min_range_size > 0 && range_count > count / min_range_size ) {
+    range_count = count / min_range_size;
+  }
+  return range_count < 1 ? 1 : range_count;
+}
+//-----------------------------------------------------------------------------
+bool ThreadPool::popTask(int queue_index, Task& task)
+{
+  // own queue first, LIFO
+  {
+    TaskQueue* queue = mQueues[queue_index];
+    std::lock_guard<std::mutex> lock( queue->mMutex );
+    if ( ! queue->mTasks.empty() )
+    {
+      task = queue->mTasks.back();
+      queue->mTasks.pop_back();
+      --mQueuedTasks;
+      return true;
+    }
+  }
+
+  // steal from the others, FIFO
+  for( size_t i = 1; i < mQueues.size(); ++i )
+  {
+    TaskQueue* queue = mQueues[ ( queue_index + i ) % mQueues.size() ];
+    std::lock_guard<std::mutex> lock( queue->mMutex );
+    if ( ! queue->mTasks.empty() )
+    {
+      task = queue->mTasks.front();
+      queue->mTasks.pop_front();
+      --mQueuedTasks;
+      return true;
+    }
+  }
+
+  return false;
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::runTask(const Task& task)
+{
+  (*task.mBatch->mFunction)( task.mIndex );
+
+  // notify under lock so that the Batch cannot go out of scope before we are done with it
+  std::lock_guard<std::mutex> lock( task.mBatch->mMutex );
+  if ( --task.mBatch->mPending == 0 ) {
+    task.mBatch->mDone.notify_all();
+  }
+}
+//-----------------------------------------------------------------------------
+void ThreadPool::workerLoop(int queue_index)
+{
+  for(;;)
+  {
+    Task task;
+    if ( popTask( queue_index, task ) )
+    {
+      runTask( task );
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock( mWakeMutex );
+    while( ! mQuit && mQueuedTasks == 0 ) {
+      mWake.wait( lock );
+    }
+    if ( mQuit ) {
+      return;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
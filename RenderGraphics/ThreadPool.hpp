@@ -0,0 +1,130 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef ThreadPool_INCLUDE_ONCE
+#define ThreadPool_INCLUDE_ONCE
+
+#include <vlGraphics/link_config.hpp>
+#include <vlCore/Object.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vl
+{
+  /**
+   * The ThreadPool class implements a simple work-stealing pool of worker threads used to parallelize CPU side work such as culling.
+   *
+   * Each worker owns a task queue: it pops tasks from the back of its own queue and, when it runs out of work,
+   * steals tasks from the front of the other queues. The thread calling parallelFor() takes part to the execution
+   * of the tasks and returns only when all of them have been completed.
+   *
+   * \note
+   * Tasks must not call parallelFor() on the same pool.
+   */
+  class VLGRAPHICS_EXPORT ThreadPool: public Object
+  {
+    VL_INSTRUMENT_CLASS(vl::ThreadPool, Object)
+
+  public:
+    /** Constructor.
+      * \param thread_count The number of worker threads, if 0 or negative one less than the number of hardware threads is used. */
+    ThreadPool(int thread_count=0);
+
+    ~ThreadPool();
+
+    //! The number of worker threads, not including the thread calling parallelFor().
+    int threadCount() const { return (int)mThreads.size(); }
+
+    //! Calls \p func(i) for every \p i in [0, \p count) distributing the calls across the worker threads and the calling thread.
+    //! Returns when all the calls have completed.
+    void parallelFor(int count, const std::function<void(int)>& func);
+
+    //! Splits [0, \p count) into \p range_count contiguous ranges of nearly equal size and calls \p func(range, begin, end) for each of them,
+    //! distributing the calls as parallelFor(int, func) does. Returns when all the calls have completed.
+    //! If \p thread_pool is NULL or \p range_count is 1 \p func(0, 0, count) is called on the calling thread.
+    static void parallelFor(ThreadPool* thread_pool, int count, int range_count, const std::function<void(int range, int begin, int end)>& func);
+
+    //! The number of ranges parallelFor(thread_pool, count, range_count, func) should split \p count items into:
+    //! a few per thread of \p thread_pool, none smaller than \p min_range_size items. Returns 1 if \p thread_pool is NULL.
+    static int rangeCount(const ThreadPool* thread_pool, int count, int min_range_size);
+
+    //! Returns a lazily created ThreadPool shared by the whole library.
+    static ThreadPool* defaultThreadPool();
+
+  private:
+    struct Batch
+    {
+      Batch(): mFunction(NULL), mPending(0) {}
+      const std::function<void(int)>* mFunction;
+      int mPending;
+      std::mutex mMutex;
+      std::condition_variable mDone;
+    };
+
+    struct Task
+    {
+      Task(): mBatch(NULL), mIndex(0) {}
+      Task(Batch* batch, int index): mBatch(batch), mIndex(index) {}
+      Batch* mBatch;
+      int mIndex;
+    };
+
+    struct TaskQueue
+    {
+      std::mutex mMutex;
+      std::deque<Task> mTasks;
+    };
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void workerLoop(int queue_index);
+    bool popTask(int queue_index, Task& task);
+    static void runTask(const Task& task);
+
+  private:
+    std::vector<std::thread> mThreads;
+    // one queue per worker plus one for the threads calling parallelFor()
+    std::vector<TaskQueue*> mQueues;
+    std::atomic<int> mQueuedTasks;
+    std::mutex mWakeMutex;
+    std::condition_variable mWake;
+    bool mQuit;
+  };
+}
+
+#endif
@@ -113,7 +113,8 @@ namespace vl
       mEven = true;
       mIndex0 = start;
       mEnd    = end;
-      if (mArray->size())
+      // runs too short to make a triangle are empty
+      if ( end - start >= ( mPrimType == PT_TRIANGLES_ADJACENCY ? 5 : 3 ) )
       {
         switch(mPrimType)
         {
@@ -187,13 +188,18 @@ namespace vl
 
       case PT_TRIANGLES:
         mCurrentIndex += 3;
-        // check for the end
-        if ( mCurrentIndex >= mEnd )
+        // check for the end, a trailing incomplete triangle is skipped
+        if ( mCurrentIndex + 2 >= mEnd )
           mCurrentIndex = mEnd;
         else
         if ( isPrimRestart(mCurrentIndex) )
         {
           mCurrentIndex += 1;
+          if ( mCurrentIndex + 2 >= mEnd )
+          {
+            mCurrentIndex = mEnd;
+            break;
+          }
           mA = mArray->at(mCurrentIndex + 0);
           mB = mArray->at(mCurrentIndex + 1);
           mC = mArray->at(mCurrentIndex + 2);
@@ -208,13 +214,18 @@ namespace vl
 
       case PT_TRIANGLES_ADJACENCY:
         mCurrentIndex += 6;
-        // check for the end
-        if ( mCurrentIndex >= mEnd )
+        // check for the end, a trailing incomplete triangle is skipped
+        if ( mCurrentIndex + 4 >= mEnd )
           mCurrentIndex = mEnd;
         else
         if ( isPrimRestart(mCurrentIndex) )
         {
           mCurrentIndex += 1;
+          if ( mCurrentIndex + 4 >= mEnd )
+          {
+            mCurrentIndex = mEnd;
+            break;
+          }
           mA = mArray->at(mCurrentIndex + 0);
           mB = mArray->at(mCurrentIndex + 2);
           mC = mArray->at(mCurrentIndex + 4);
@@ -236,6 +247,11 @@ namespace vl
         if ( isPrimRestart(mCurrentIndex + 2) )
         {
           mCurrentIndex += 3;
+          if ( mCurrentIndex + 2 >= mEnd )
+          {
+            mCurrentIndex = mEnd;
+            break;
+          }
           mEven = true;
           mA = mArray->at(mCurrentIndex + 0);
           mB = mArray->at(mCurrentIndex + 1);
@@ -271,6 +287,11 @@ namespace vl
         {
           mIndex0 = mCurrentIndex + 2;
           mCurrentIndex = mIndex0 + 1;
+          if ( mCurrentIndex + 1 >= mEnd )
+          {
+            mCurrentIndex = mEnd;
+            break;
+          }
           mA = mArray->at(mIndex0);
           mB = mArray->at(mCurrentIndex + 0);
           mC = mArray->at(mCurrentIndex + 1);
@@ -290,17 +311,21 @@ namespace vl
           mCurrentIndex = mEnd;
         }
         else
-        if ( isPrimRestart(mCurrentIndex) )
         {
-          mCurrentIndex += 1;
-          mEven = true;
-          mA = mArray->at(mCurrentIndex+0);
-          mB = mArray->at(mCurrentIndex+1);
-          mC = mArray->at(mCurrentIndex+2);
-        }
-        else
-        {
-          mEven = !mEven;
+          if ( isPrimRestart(mCurrentIndex) )
+          {
+            mCurrentIndex += 1;
+            mEven = true;
+          }
+          else
+            mEven = !mEven;
+
+          // a trailing incomplete quad is skipped
+          if ( mCurrentIndex + ( mEven ? 2 : 1 ) >= mEnd )
+          {
+            mCurrentIndex = mEnd;
+          }
+          else
           if ( mEven )
           {
             mA = mArray->at(mCurrentIndex+0);
@@ -385,6 +410,9 @@ namespace vl
       mCurrentIndex = mEnd = end;
       mA = mB = mC = -1;
       mEven = true;
+      // runs too short to make a triangle are empty
+      if ( end - start < ( mPrimType == PT_TRIANGLES_ADJACENCY ? 5 : 3 ) )
+        return;
       switch(mPrimType)
       {
       case PT_TRIANGLES:
@@ -394,6 +422,12 @@ namespace vl
         mB = start + 1;
         mC = start + 2;
         break;
+      case PT_TRIANGLES_ADJACENCY:
+        mCurrentIndex = start;
+        mA = start + 0;
+        mB = start + 2;
+        mC = start + 4;
+        break;
       case PT_TRIANGLE_STRIP:
         mCurrentIndex = start;
         mA = start + 0;
@@ -437,8 +471,8 @@ namespace vl
 
       case PT_TRIANGLES:
         mCurrentIndex += 3;
-        // check for the end
-        if ( mCurrentIndex >= mEnd )
+        // check for the end, a trailing incomplete triangle is skipped
+        if ( mCurrentIndex + 2 >= mEnd )
           mCurrentIndex = mEnd;
         else
         {
@@ -448,6 +482,19 @@ namespace vl
         }
         break;
 
+      case PT_TRIANGLES_ADJACENCY:
+        mCurrentIndex += 6;
+        // the adjacency vertices are skipped
+        if ( mCurrentIndex + 4 >= mEnd )
+          mCurrentIndex = mEnd;
+        else
+        {
+          mA = mCurrentIndex + 0;
+          mB = mCurrentIndex + 2;
+          mC = mCurrentIndex + 4;
+        }
+        break;
+
       case PT_QUAD_STRIP:
       case PT_TRIANGLE_STRIP:
         mCurrentIndex += 1;
@@ -495,6 +542,12 @@ namespace vl
         else
         {
           mEven = !mEven;
+          // a trailing incomplete quad is skipped
+          if ( mCurrentIndex + ( mEven ? 2 : 1 ) >= mEnd )
+          {
+            mCurrentIndex = mEnd;
+          }
+          else
           if ( mEven )
           {
             mA = mCurrentIndex+0;
@@ -543,26 +596,39 @@ namespace vl
     VL_INSTRUMENT_CLASS(vl::TriangleIteratorMulti<class TArray>, TriangleIteratorIndexed<TArray>)
 
   public:
-    TriangleIteratorMulti( const std::vector<GLint>* p_base_vertices, const std::vector<GLsizei>* p_count_vector, const TArray* idx_array, EPrimitiveType prim_type, bool prim_restart_on, int prim_restart_idx)
+    /** If \p p_first_indices is NULL the primitives are packed one after the other in the index buffer, otherwise each primitive starts at its own first index. */
+    TriangleIteratorMulti( const std::vector<GLint>* p_base_vertices, const std::vector<GLsizei>* p_count_vector, const TArray* idx_array, EPrimitiveType prim_type, bool prim_restart_on, int prim_restart_idx, const std::vector<GLint>* p_first_indices = NULL)
     :TriangleIteratorIndexed<TArray>( idx_array, prim_type, 0, prim_restart_on, prim_restart_idx)
     {
       VL_DEBUG_SET_OBJECT_NAME()
       mpBaseVertices  = p_base_vertices;
       mpCountVector   = p_count_vector;
+      mpFirstIndices  = p_first_indices;
       mStart   = 0;
       mCurPrim = 0;
     }
 
     void initialize()
     {
-      VL_CHECK( mpBaseVertices->size() == mpCountVector->size() )
-      if ( (*mpBaseVertices).size() )
-        TriangleIteratorIndexed<TArray>::setBaseVertex( (*mpBaseVertices)[mCurPrim] );
-      int end = mStart + (*mpCountVector)[mCurPrim];
-      TriangleIteratorIndexed<TArray>::initialize( mStart, end );
-      // abort if could not initialize (primitive not supported)
-      if ( !TriangleIteratorIndexed<TArray>::hasNext() )
-        mCurPrim = (int)(*mpCountVector).size()-1;
+      VL_CHECK( mpBaseVertices->empty() || mpBaseVertices->size() == mpCountVector->size() )
+      VL_CHECK( !mpFirstIndices || mpFirstIndices->empty() || mpFirstIndices->size() == mpCountVector->size() )
+      if ( mpCountVector->empty() )
+      {
+        TriangleIteratorIndexed<TArray>::initialize( 0, 0 );
+        return;
+      }
+      // the runs without triangles are skipped
+      for( ; ; ++mCurPrim )
+      {
+        if ( mpFirstIndices && (*mpFirstIndices).size() )
+          mStart = (*mpFirstIndices)[mCurPrim];
+        TriangleIteratorIndexed<TArray>::setBaseVertex( (*mpBaseVertices).size() ? (*mpBaseVertices)[mCurPrim] : 0 );
+        int end = mStart + (*mpCountVector)[mCurPrim];
+        TriangleIteratorIndexed<TArray>::initialize( mStart, end );
+        if ( TriangleIteratorIndexed<TArray>::hasNext() || mCurPrim == (int)(*mpCountVector).size()-1 )
+          return;
+        mStart = end;
+      }
     }
 
     bool next()
@@ -575,23 +641,18 @@ namespace vl
         mStart += (*mpCountVector)[mCurPrim];
         mCurPrim++;
         initialize();
-        return true;
+        return TriangleIteratorIndexed<TArray>::hasNext();
       }
       else
         return false;
     }
 
-    bool hasNext() const
-    {
-      if ( !TriangleIteratorIndexed<TArray>::hasNext() && mCurPrim == (int)(*mpCountVector).size()-1 )
-        return false;
-      else
-        return true;
-    }
+    bool hasNext() const { return TriangleIteratorIndexed<TArray>::hasNext(); }
 
   protected:
     const std::vector<GLint>* mpBaseVertices;
     const std::vector<GLsizei>* mpCountVector;
+    const std::vector<GLint>* mpFirstIndices;
     int mCurPrim;
     int mStart;
   };
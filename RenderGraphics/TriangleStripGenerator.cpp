@@ -54,11 +54,7 @@ namespace
 
     indices.reserve( 1000 );
 
-    for(TriangleIterator trit = dc->triangleIterator(); trit.hasNext(); trit.next())
-    {
-      int a = trit.a();
-      int b = trit.b();
-      int c = trit.c();
+    dc->forEachTriangle( [&](int a, int b, int c) {
       // skip degenerate triangles
       if (a != b && b != c)
       {
@@ -66,7 +62,7 @@ namespace
         indices.push_back(b);
         indices.push_back(c);
       }
-    }
+    } );
   }
 }
 
@@ -44,6 +44,15 @@
 
 namespace vl
 {
+  //! Returns the unique ID associated to the given uniform name.
+  //! The same name always maps to the same ID for the whole lifetime of the application, IDs are small consecutive integers starting from 0.
+  //! This is used by GLSLProgram to resolve uniform locations with an indexed lookup instead of a glGetUniformLocation() call.
+  VLGRAPHICS_EXPORT int uniformNameID(const char* name);
+
+  //! Returns a new value from a global, monotonically increasing counter, used to version the values of the Uniform objects.
+  //! Since versions are never reused two Uniform objects share the same version only if one has been copied from the other.
+  VLGRAPHICS_EXPORT unsigned long long nextUniformVersion();
+
   //------------------------------------------------------------------------------
   // Uniform
   //------------------------------------------------------------------------------
@@ -64,12 +73,12 @@ namespace vl
 
   public:
 
-    Uniform(): mType(UT_NONE)
+    Uniform(): mType(UT_NONE), mNameID(-1), mVersion(0)
     {
       VL_DEBUG_SET_OBJECT_NAME()
     }
 
-    Uniform(const char* name): mType(UT_NONE)
+    Uniform(const char* name): mType(UT_NONE), mNameID(-1), mVersion(0)
     {
       VL_DEBUG_SET_OBJECT_NAME()
       mName = name;
@@ -86,13 +95,17 @@ namespace vl
     const std::string& name() const { return mName; }
 
     //! Returns the name of the uniform variable
+    //! \note Use setName() to rename the uniform: modifying the returned string does not update nameID().
     std::string& name() { return mName; }
 
     //! Sets the name of the uniform variable
-    void setName(const char* name) { mName = name; }
+    void setName(const char* name) { mName = name; mNameID = -1; }
 
     //! Sets the name of the uniform variable
-    void setName(const std::string& name) { mName = name; }
+    void setName(const std::string& name) { mName = name; mNameID = -1; }
+
+    //! Returns the interned ID of the uniform's name, see vl::uniformNameID().
+    int nameID() const { if (mNameID == -1) mNameID = uniformNameID(mName.c_str()); return mNameID; }
 
     // generic array setters
 
@@ -258,6 +271,10 @@ namespace vl
 
     EUniformType type() const { return mType; }
 
+    //! The version of the uniform's value, updated by every setUniform*() call and by rawData().
+    //! Used by GLSLProgram::applyUniformSet() to avoid re-sending values that the GLSL program already holds.
+    unsigned long long version() const { return mVersion; }
+
     int count() const
     {
       if (mData.empty())
@@ -313,14 +330,15 @@ namespace vl
       }
     }
 
-    void* rawData() { if (mData.empty()) return NULL; else return &mData[0]; }
+    //! Returns a writable pointer to the uniform's data. Also updates the uniform's version() as the data is likely to be modified.
+    void* rawData() { mVersion = nextUniformVersion(); if (mData.empty()) return NULL; else return &mData[0]; }
 
     const void* rawData() const { if (mData.empty()) return NULL; else return &mData[0]; }
 
   protected:
     VL_COMPILE_TIME_CHECK( sizeof(int) == sizeof(float) )
-    void initData(int count) { mData.resize(count); }
-    void initDouble(int count) { mData.resize(count*2); }
+    void initData(int count) { mData.resize(count); mVersion = nextUniformVersion(); }
+    void initDouble(int count) { mData.resize(count*2); mVersion = nextUniformVersion(); }
     int singleCount() const { return (int)mData.size(); }
     int doubleCount() const { VL_CHECK((mData.size() & 0x1) == 0 ); return (int)(mData.size() >> 1); }
     const double* doubleData() const { VL_CHECK(!mData.empty()); VL_CHECK((mData.size() & 0x1) == 0 ); return (double*)&mData[0]; }
@@ -331,6 +349,8 @@ namespace vl
     EUniformType mType;
     std::vector<int> mData;
     std::string mName;
+    mutable int mNameID;
+    unsigned long long mVersion;
   };
 }
 
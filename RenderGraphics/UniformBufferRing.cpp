@@ -0,0 +1,125 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+#include <vlGraphics/UniformBufferRing.hpp>
+#include <vlGraphics/OpenGLContext.hpp>
+#include <cstring>
+#include <algorithm>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+UniformBufferRing::UniformBufferRing(int capacity)
+{
+  VL_DEBUG_SET_OBJECT_NAME()
+  mBuffer    = new BufferObject;
+  mFrame     = 0;
+  mCapacity  = capacity;
+  mAllocated = 0;
+  mHead      = 0;
+  mBase      = 0;
+  mAlignment = 0;
+  mUploaded  = false;
+}
+//-----------------------------------------------------------------------------
+void UniformBufferRing::beginFrame()
+{
+  VL_CHECK( Has_GL_Version_3_1 || Has_GL_Version_4_0 )
+  if ( !mAlignment )
+  {
+    GLint alignment = 0;
+    glGetIntegerv( GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment ); VL_CHECK_OGL()
+    mAlignment = alignment > 0 ? alignment : 256;
+  }
+  ++mFrame;
+  mStaging.clear();
+  mUploaded = false;
+}
+//-----------------------------------------------------------------------------
+bool UniformBufferRing::place(const UniformSet* uniforms)
+{
+  VL_CHECK( !mUploaded )
+  if ( uniforms->storage() != USS_UniformBlock )
+    return false;
+  if ( uniforms->mRing == this && uniforms->mRingFrame == mFrame )
+    return true;
+
+  uniforms->updateBlockData();
+  if ( uniforms->blockData().empty() )
+    return false;
+
+  const size_t offset = ( mStaging.size() + mAlignment - 1 ) / mAlignment * mAlignment;
+  mStaging.resize( offset + uniforms->blockData().size() );
+  memcpy( &mStaging[offset], &uniforms->blockData()[0], uniforms->blockData().size() );
+
+  uniforms->mRing        = this;
+  uniforms->mRingFrame   = mFrame;
+  uniforms->mRingOffset  = (int)offset;
+  uniforms->mRingVersion = uniforms->mBlockDataVersion;
+  return true;
+}
+//-----------------------------------------------------------------------------
+void UniformBufferRing::upload(OpenGLContext* gl_context)
+{
+  VL_CHECK_OGL()
+  mUploaded = true;
+  if ( mStaging.empty() )
+    return;
+
+  mBuffer->createBufferObject();
+  if (gl_context)
+  {
+    gl_context->bindBuffer( GL_UNIFORM_BUFFER, mBuffer->handle() );
+  }
+  else
+  {
+    glBindBuffer( GL_UNIFORM_BUFFER, mBuffer->handle() );
+    forgetBufferTarget( GL_UNIFORM_BUFFER );
+  }
+  VL_CHECK_OGL()
+
+  const int size = (int)mStaging.size();
+  if ( size > mCapacity )
+    mCapacity = std::max( mCapacity * 2, size );
+
+  // orphan the buffer when the frame does not fit in the remaining space
+  if ( mAllocated != mCapacity || mHead + size > mCapacity )
+  {
+    glBufferData( GL_UNIFORM_BUFFER, mCapacity, NULL, GL_STREAM_DRAW ); VL_CHECK_OGL()
+    mAllocated = mCapacity;
+    mHead = 0;
+  }
+
+  glBufferSubData( GL_UNIFORM_BUFFER, mHead, size, &mStaging[0] ); VL_CHECK_OGL()
+  mBase = mHead;
+  mHead = ( mHead + size + mAlignment - 1 ) / mAlignment * mAlignment;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,106 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+#ifndef UniformBufferRing_INCLUDE_ONCE
+#define UniformBufferRing_INCLUDE_ONCE
+
+#include <vlGraphics/UniformSet.hpp>
+#include <vlGraphics/BufferObject.hpp>
+
+namespace vl
+{
+  class OpenGLContext;
+
+  //------------------------------------------------------------------------------
+  // UniformBufferRing
+  //------------------------------------------------------------------------------
+  /**
+   * A uniform buffer object shared by many UniformSet using the USS_UniformBlock storage.
+   *
+   * Every rendering the Renderer calls beginFrame(), place() for each Actor's uniform set and upload(): the packed uniforms
+   * are gathered in one contiguous CPU buffer, each set at an offset aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, and
+   * sent with a single glBufferSubData(). Each draw then only binds its own range with glBindBufferRange().
+   * Consecutive frames are written one after the other, the buffer is orphaned only when the ring wraps around so that
+   * the CPU never waits for the GPU to finish reading the previous frames.
+   *
+   * \sa Renderer::setUniformBufferRing(), UniformSet::setStorage()
+   */
+  class VLGRAPHICS_EXPORT UniformBufferRing: public Object
+  {
+    VL_INSTRUMENT_CLASS(vl::UniformBufferRing, Object)
+
+  public:
+    /** Constructor, \p capacity is the size in bytes of the buffer object, grown automatically if a frame does not fit. */
+    UniformBufferRing(int capacity = 1024*1024);
+
+    /** Starts a new frame: the sets placed during the previous frames are not valid anymore. */
+    void beginFrame();
+
+    /** Packs \p uniforms into the current frame, returns \p false if the set does not use the USS_UniformBlock storage.
+      * Placing the same set twice in a frame has no effect. */
+    bool place(const UniformSet* uniforms);
+
+    /** Sends the sets placed in the current frame with a single glBufferSubData().
+      * If \p gl_context is NULL the buffer is bound directly, without going through the OpenGLContext state shadow. */
+    void upload(OpenGLContext* gl_context);
+
+    /** The frame counter incremented by beginFrame(). */
+    long long frame() const { return mFrame; }
+
+    /** Whether the current frame has been uploaded. */
+    bool uploaded() const { return mUploaded; }
+
+    /** The OpenGL handle of the buffer object. */
+    GLuint handle() const { return mBuffer->handle(); }
+
+    /** The offset in the buffer object of the current frame, valid after upload(). */
+    int baseOffset() const { return mBase; }
+
+    /** The number of bytes placed in the current frame. */
+    int stagedBytes() const { return (int)mStaging.size(); }
+
+    /** The size in bytes of the buffer object. */
+    int capacity() const { return mCapacity; }
+
+  protected:
+    std::vector<unsigned char> mStaging;
+    ref<BufferObject> mBuffer;
+    long long mFrame;
+    int mCapacity;
+    int mAllocated;
+    int mHead;
+    int mBase;
+    int mAlignment;
+    bool mUploaded;
+  };
+}
+
+#endif
@@ -30,18 +30,121 @@
 /**************************************************************************************/
 
 #include <vlGraphics/UniformSet.hpp>
+#include <vlGraphics/UniformBufferRing.hpp>
+#include <vlGraphics/OpenGLContext.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+#include <mutex>
+#include <atomic>
 
 using namespace vl;
 
+//-----------------------------------------------------------------------------
+int vl::uniformNameID(const char* name)
+{
+  // uniforms can be created and renamed from any thread
+  static std::mutex name_mutex;
+  static std::map<std::string, int> name_ids;
+
+  std::lock_guard<std::mutex> lock(name_mutex);
+  std::map<std::string, int>::iterator it = name_ids.find(name);
+  if (it != name_ids.end())
+    return it->second;
+  int id = (int)name_ids.size();
+  name_ids[name] = id;
+  return id;
+}
+//-----------------------------------------------------------------------------
+unsigned long long vl::nextUniformVersion()
+{
+  // 0 is reserved for uniforms that have never been set
+  static std::atomic<unsigned long long> version(0);
+  return ++version;
+}
+
+namespace
+{
+  //! Size in bytes of the scalar type, number of rows and number of columns of a uniform type, false if the type can't be part of a uniform block.
+  bool std140TypeInfo(EUniformType type, int& scalar, int& rows, int& cols)
+  {
+    scalar = 4;
+    cols = 1;
+    switch(type)
+    {
+      case UT_INT:          case UT_UNSIGNED_INT:          case UT_FLOAT:      rows = 1; return true;
+      case UT_INT_VEC2:     case UT_UNSIGNED_INT_VEC2:     case UT_FLOAT_VEC2: rows = 2; return true;
+      case UT_INT_VEC3:     case UT_UNSIGNED_INT_VEC3:     case UT_FLOAT_VEC3: rows = 3; return true;
+      case UT_INT_VEC4:     case UT_UNSIGNED_INT_VEC4:     case UT_FLOAT_VEC4: rows = 4; return true;
+
+      // matCxR: C columns of R rows
+      case UT_FLOAT_MAT2:   cols = 2; rows = 2; return true;
+      case UT_FLOAT_MAT3:   cols = 3; rows = 3; return true;
+      case UT_FLOAT_MAT4:   cols = 4; rows = 4; return true;
+      case UT_FLOAT_MAT2x3: cols = 2; rows = 3; return true;
+      case UT_FLOAT_MAT3x2: cols = 3; rows = 2; return true;
+      case UT_FLOAT_MAT2x4: cols = 2; rows = 4; return true;
+      case UT_FLOAT_MAT4x2: cols = 4; rows = 2; return true;
+      case UT_FLOAT_MAT3x4: cols = 3; rows = 4; return true;
+      case UT_FLOAT_MAT4x3: cols = 4; rows = 3; return true;
+
+      default: break;
+    }
+
+    scalar = 8;
+    switch(type)
+    {
+      case UT_DOUBLE:        rows = 1; return true;
+      case UT_DOUBLE_VEC2:   rows = 2; return true;
+      case UT_DOUBLE_VEC3:   rows = 3; return true;
+      case UT_DOUBLE_VEC4:   rows = 4; return true;
+
+      case UT_DOUBLE_MAT2:   cols = 2; rows = 2; return true;
+      case UT_DOUBLE_MAT3:   cols = 3; rows = 3; return true;
+      case UT_DOUBLE_MAT4:   cols = 4; rows = 4; return true;
+      case UT_DOUBLE_MAT2x3: cols = 2; rows = 3; return true;
+      case UT_DOUBLE_MAT3x2: cols = 3; rows = 2; return true;
+      case UT_DOUBLE_MAT2x4: cols = 2; rows = 4; return true;
+      case UT_DOUBLE_MAT4x2: cols = 4; rows = 2; return true;
+      case UT_DOUBLE_MAT3x4: cols = 3; rows = 4; return true;
+      case UT_DOUBLE_MAT4x3: cols = 4; rows = 3; return true;
+
+      default: return false;
+    }
+  }
+
+  size_t roundUp(size_t value, size_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+}
 //-----------------------------------------------------------------------------
 UniformSet& UniformSet::deepCopyFrom(const UniformSet& other)
 {
-  mUniforms = other.mUniforms;
+  shallowCopyFrom(other);
   for(size_t i=0; i<mUniforms.size(); ++i)
     mUniforms[i] = mUniforms[i]->clone();
   return *this;
 }
 //-----------------------------------------------------------------------------
+UniformSet& UniformSet::shallowCopyFrom(const UniformSet& other)
+{
+  Object::operator=(other);
+  mUniforms     = other.mUniforms;
+  mStorage      = other.mStorage;
+  mBlockName    = other.mBlockName;
+  mBlockBinding = other.mBlockBinding;
+
+  // the packed data and the GPU buffers are never shared
+  mBlockData.clear();
+  mBlockVersions.clear();
+  mBlockDataVersion   = 0;
+  mBlockBuffer        = NULL;
+  mBlockBufferVersion = 0;
+  mBlockBufferSize    = 0;
+  mRing        = NULL;
+  mRingFrame   = -1;
+  mRingOffset  = 0;
+  mRingVersion = 0;
+  return *this;
+}
+//-----------------------------------------------------------------------------
 void UniformSet::setUniform(Uniform* uniform, bool check_for_doubles)
 {
   VL_CHECK(uniform)
@@ -108,3 +211,126 @@ const Uniform* UniformSet::getUniform(const char* name) const
   return NULL;
 }
 //-----------------------------------------------------------------------------
+bool UniformSet::updateBlockData() const
+{
+  // repack only if a uniform has been added, removed, replaced or modified
+  bool changed = mBlockVersions.size() != mUniforms.size() || mBlockDataVersion == 0;
+  for(size_t i=0; i<mUniforms.size() && !changed; ++i)
+    changed = mBlockVersions[i] != mUniforms[i]->version();
+  if (!changed)
+    return false;
+
+  mBlockVersions.resize( mUniforms.size() );
+  for(size_t i=0; i<mUniforms.size(); ++i)
+    mBlockVersions[i] = mUniforms[i]->version();
+
+  mBlockData.clear();
+  ++mBlockDataVersion;
+  size_t offset = 0;
+  for(size_t i=0; i<mUniforms.size(); ++i)
+  {
+    const Uniform* uniform = mUniforms[i].get();
+
+    // skipping the uniform would shift the following ones: leave the block empty, and so unbound, instead
+    int scalar = 0, rows = 0, cols = 0;
+    if ( !std140TypeInfo(uniform->type(), scalar, rows, cols) )
+    {
+      Log::error( Say("UniformSet::updateBlockData(): uniform '%s' can't be stored in a uniform block!\n") << uniform->name() );
+      mBlockData.clear();
+      return true;
+    }
+
+    // std140: vec3 is aligned as vec4, arrays and matrix columns are aligned and strided as vec4
+    const int vectors = cols * uniform->count();
+    const size_t vec_size = rows * scalar;
+    const size_t vec_align = ( rows == 1 ? 1 : rows == 2 ? 2 : 4 ) * scalar;
+    const bool array_like = vectors > 1;
+    const size_t stride = array_like ? roundUp(vec_align, 16) : vec_size;
+
+    offset = roundUp( offset, array_like ? stride : vec_align );
+    mBlockData.resize( offset + stride * vectors );
+    const unsigned char* src = (const unsigned char*)uniform->rawData();
+    for(int v=0; v<vectors; ++v)
+      memcpy( &mBlockData[offset + v*stride], src + v*vec_size, vec_size );
+    offset += stride * vectors;
+  }
+
+  // the size of a block is rounded up to the alignment of a vec4
+  mBlockData.resize( roundUp(offset, 16) );
+  return true;
+}
+//-----------------------------------------------------------------------------
+void UniformSet::bindBlock(OpenGLContext* gl_context) const
+{
+  VL_CHECK_OGL()
+  VL_CHECK( Has_GL_Version_3_1 || Has_GL_Version_4_0 )
+  updateBlockData();
+  if ( mBlockData.empty() )
+    return;
+
+  GLuint handle = 0;
+  GLintptr offset = 0;
+  if ( mRing && mRingFrame == mRing->frame() && mRing->uploaded() )
+  {
+    // packed in the ring this frame: refresh the slot if an ActorEventCallback changed the uniforms after the upload
+    handle = mRing->handle();
+    offset = mRing->baseOffset() + mRingOffset;
+    if ( mRingVersion != mBlockDataVersion )
+    {
+      VL_CHECK( mRingOffset + (int)mBlockData.size() <= mRing->stagedBytes() )
+      if (gl_context)
+      {
+        gl_context->bindBuffer( GL_UNIFORM_BUFFER, handle );
+      }
+      else
+      {
+        glBindBuffer( GL_UNIFORM_BUFFER, handle );
+        forgetBufferTarget( GL_UNIFORM_BUFFER );
+      }
+      VL_CHECK_OGL()
+      glBufferSubData( GL_UNIFORM_BUFFER, offset, mBlockData.size(), &mBlockData[0] ); VL_CHECK_OGL()
+      mRingVersion = mBlockDataVersion;
+    }
+  }
+  else
+  {
+    if ( !mBlockBuffer )
+      mBlockBuffer = new BufferObject;
+    mBlockBuffer->createBufferObject();
+    handle = mBlockBuffer->handle();
+    if ( mBlockBufferVersion != mBlockDataVersion )
+    {
+      if (gl_context)
+      {
+        gl_context->bindBuffer( GL_UNIFORM_BUFFER, handle );
+      }
+      else
+      {
+        glBindBuffer( GL_UNIFORM_BUFFER, handle );
+        forgetBufferTarget( GL_UNIFORM_BUFFER );
+      }
+      VL_CHECK_OGL()
+      if ( mBlockBufferSize != (int)mBlockData.size() )
+      {
+        mBlockBufferSize = (int)mBlockData.size();
+        glBufferData( GL_UNIFORM_BUFFER, mBlockBufferSize, &mBlockData[0], GL_DYNAMIC_DRAW ); VL_CHECK_OGL()
+      }
+      else
+      {
+        glBufferSubData( GL_UNIFORM_BUFFER, 0, mBlockBufferSize, &mBlockData[0] ); VL_CHECK_OGL()
+      }
+      mBlockBufferVersion = mBlockDataVersion;
+    }
+  }
+
+  if (gl_context)
+  {
+    gl_context->bindUniformBufferRange( mBlockBinding, handle, offset, mBlockData.size() );
+  }
+  else
+  {
+    glBindBufferRange( GL_UNIFORM_BUFFER, mBlockBinding, handle, offset, mBlockData.size() ); VL_CHECK_OGL()
+    forgetBufferTarget( GL_UNIFORM_BUFFER );
+  }
+}
+//-----------------------------------------------------------------------------
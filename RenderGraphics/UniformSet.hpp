@@ -35,9 +35,20 @@
 #include <vlGraphics/link_config.hpp>
 #include <vlCore/Object.hpp>
 #include <vlGraphics/Uniform.hpp>
+#include <vlGraphics/BufferObject.hpp>
 
 namespace vl
 {
+  class OpenGLContext;
+  class UniformBufferRing;
+
+  //! How a UniformSet sends its uniforms to the GLSLProgram, see UniformSet::setStorage().
+  typedef enum
+  {
+    USS_Uniforms,    //!< Each Uniform is sent with its own glUniform*() call.
+    USS_UniformBlock //!< The uniforms are packed in a std140 uniform block stored in a uniform buffer object.
+  } EUniformSetStorage;
+
   //------------------------------------------------------------------------------
   // UniformSet
   //------------------------------------------------------------------------------
@@ -51,15 +62,22 @@ namespace vl
   {
     VL_INSTRUMENT_CLASS(vl::UniformSet, Object)
 
+    friend class UniformBufferRing;
+
   public:
-    UniformSet()
+    UniformSet(): mStorage(USS_Uniforms), mBlockBinding(0), mBlockDataVersion(0), mBlockBufferVersion(0), mBlockBufferSize(0),
+                  mRing(NULL), mRingFrame(-1), mRingOffset(0), mRingVersion(0)
     {
       VL_DEBUG_SET_OBJECT_NAME()
     }
 
+    UniformSet(const UniformSet& other): Object(other) { shallowCopyFrom(other); }
+
+    UniformSet& operator=(const UniformSet& other) { return shallowCopyFrom(other); }
+
     UniformSet& deepCopyFrom(const UniformSet& other);
 
-    UniformSet& shallowCopyFrom(const UniformSet& other) { *this = other; return *this; }
+    UniformSet& shallowCopyFrom(const UniformSet& other);
 
     // uniform getters and setters
 
@@ -81,8 +99,73 @@ namespace vl
 
     const Uniform* getUniform(const char* name) const;
 
+    // uniform block storage
+
+    /**
+     * How the uniforms are sent to the GLSLProgram (default = USS_Uniforms).
+     *
+     * With USS_UniformBlock the uniforms are packed, in the order they appear in uniforms() and following the std140 layout rules,
+     * into one contiguous buffer. The buffer is uploaded into a uniform buffer object with a single glBufferSubData() when any
+     * of the uniforms changes and bound with glBindBufferRange() to blockBinding(). The GLSL uniform block must declare the same
+     * uniforms, with the same types and array sizes, in the same order and with the \p std140 layout qualifier.
+     * Boolean and sampler uniforms can't be stored in a uniform block: if the set contains any, an error is logged and the block is not bound.
+     * If a Renderer has a UniformBufferRing the Actor's uniform sets are instead packed together in the ring once per rendering.
+     * Requires OpenGL 3.1.
+     *
+     * \sa setUniformBlock(), GLSLProgram::bindUniformBlock(), UniformBufferRing
+     */
+    void setStorage(EUniformSetStorage storage) { mStorage = storage; }
+
+    //! How the uniforms are sent to the GLSLProgram, see setStorage().
+    EUniformSetStorage storage() const { return mStorage; }
+
+    //! Sets the storage to USS_UniformBlock, the uniform block binding point and optionally the name of the GLSL uniform block.
+    //! If \p block_name is not NULL the GLSLProgram maps the block to \p binding automatically the first time the set is applied.
+    void setUniformBlock(const char* block_name, int binding)
+    {
+      mStorage = USS_UniformBlock;
+      mBlockName = block_name ? block_name : "";
+      mBlockBinding = binding;
+    }
+
+    //! The name of the GLSL uniform block, can be empty, see setUniformBlock().
+    const std::string& blockName() const { return mBlockName; }
+
+    //! The uniform block binding point, see setUniformBlock().
+    int blockBinding() const { return mBlockBinding; }
+
+    //! Packs the uniforms into blockData() if any of them changed since the last call. Returns \p true if blockData() changed.
+    bool updateBlockData() const;
+
+    //! The std140 packed uniforms, updated by updateBlockData().
+    const std::vector<unsigned char>& blockData() const { return mBlockData; }
+
+    //! Uploads blockData() if needed and binds it to blockBinding(). Used by GLSLProgram::applyUniformSet().
+    //! If \p gl_context is NULL the buffers are bound directly, without going through the OpenGLContext state shadow.
+    void bindBlock(OpenGLContext* gl_context) const;
+
   protected:
     std::vector< ref<Uniform> > mUniforms;
+
+    EUniformSetStorage mStorage;
+    std::string mBlockName;
+    int mBlockBinding;
+
+    // std140 packed uniforms and the Uniform::version() they were packed from
+    mutable std::vector<unsigned char> mBlockData;
+    mutable std::vector<unsigned long long> mBlockVersions;
+    mutable long long mBlockDataVersion;
+
+    // the uniform buffer used when the set is not placed in a UniformBufferRing
+    mutable ref<BufferObject> mBlockBuffer;
+    mutable long long mBlockBufferVersion;
+    mutable int mBlockBufferSize;
+
+    // placement in a UniformBufferRing, valid only for the ring's current frame
+    mutable const UniformBufferRing* mRing;
+    mutable long long mRingFrame;
+    mutable int mRingOffset;
+    mutable long long mRingVersion;
   };
 }
 
@@ -73,6 +73,9 @@ void Viewport::activate() const
 {
   VL_CHECK_OGL()
 
+  // no OpenGLContext at hand: go through the table of the last initialized one
+  const OpenGLFunctions& gl = GL_Functions;
+
   // viewport
   int x = mX;
   int y = mY;
@@ -82,7 +85,7 @@ void Viewport::activate() const
   if (w < 1) w = 1;
   if (h < 1) h = 1;
 
-  glViewport( x, y, w, h );
+  gl._glViewport( x, y, w, h );
 
   // clear viewport
   if ( mClearFlags )
@@ -104,46 +107,46 @@ void Viewport::activate() const
 
     // save writemask status to be restored later
     GLboolean color_write_mask[4] = {0,0,0,0};
-    glGetBooleanv( GL_COLOR_WRITEMASK, color_write_mask);
+    gl._glGetBooleanv( GL_COLOR_WRITEMASK, color_write_mask);
 
     GLboolean depth_write_mask = 0;
-    glGetBooleanv( GL_DEPTH_WRITEMASK, &depth_write_mask );
+    gl._glGetBooleanv( GL_DEPTH_WRITEMASK, &depth_write_mask );
 
     GLboolean stencil_write_mask = 0;
-    glGetBooleanv( GL_STENCIL_WRITEMASK, &stencil_write_mask );
+    gl._glGetBooleanv( GL_STENCIL_WRITEMASK, &stencil_write_mask );
 
     // make sure we clear everything
-    glColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE );
-    glDepthMask( GL_TRUE );
-    glStencilMask( GL_TRUE );
+    gl._glColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE );
+    gl._glDepthMask( GL_TRUE );
+    gl._glStencilMask( GL_TRUE );
 
     // enable scissor
     if ( mScissorEnabled )
     {
-      glEnable( GL_SCISSOR_TEST );
-      glScissor( x, y, w, h );
+      gl._glEnable( GL_SCISSOR_TEST );
+      gl._glScissor( x, y, w, h );
     }
     else {
-      glDisable( GL_SCISSOR_TEST );
+      gl._glDisable( GL_SCISSOR_TEST );
     }
 
     switch( clearColorMode() )
     {
-      case CCM_Float: glClearColor(        mClearColor.r(),     mClearColor.g(),     mClearColor.b(),     mClearColor.a()    );  break;
-      case CCM_Int:   glClearColorIiEXT(   mClearColorInt.r(),  mClearColorInt.g(),  mClearColorInt.b(),  mClearColorInt.a() );  break;
-      case CCM_UInt:  glClearColorIuiEXT(  mClearColorUInt.r(), mClearColorUInt.g(), mClearColorUInt.b(), mClearColorUInt.a() ); break;
+      case CCM_Float: gl._glClearColor(        mClearColor.r(),     mClearColor.g(),     mClearColor.b(),     mClearColor.a()    );  break;
+      case CCM_Int:   gl._glClearColorIiEXT(   mClearColorInt.r(),  mClearColorInt.g(),  mClearColorInt.b(),  mClearColorInt.a() );  break;
+      case CCM_UInt:  gl._glClearColorIuiEXT(  mClearColorUInt.r(), mClearColorUInt.g(), mClearColorUInt.b(), mClearColorUInt.a() ); break;
     }
 
-    glClearDepth( mClearDepth );
+    gl._glClearDepth( mClearDepth );
 
-    glClearStencil( mClearStencil );
+    gl._glClearStencil( mClearStencil );
 
-    glClear( mClearFlags );
+    gl._glClear( mClearFlags );
 
     // restore writemasks
-    glColorMask( color_write_mask[0], color_write_mask[1], color_write_mask[2], color_write_mask[3] );
-    glDepthMask( depth_write_mask );
-    glStencilMask( stencil_write_mask );
+    gl._glColorMask( color_write_mask[0], color_write_mask[1], color_write_mask[2], color_write_mask[3] );
+    gl._glDepthMask( depth_write_mask );
+    gl._glStencilMask( stencil_write_mask );
 
     VL_CHECK_OGL()
   }
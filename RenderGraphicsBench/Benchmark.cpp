@@ -0,0 +1,170 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/SceneManagerActorTree.hpp>
+#include <vlGraphics/GeometryPrimitives.hpp>
+#include <vlGraphics/Renderer.hpp>
+#include <vlGraphics/GLSL.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+#include <cmath>
+
+using namespace vl;
+
+namespace
+{
+  const char* vertex_source =
+    "#version 150\n"
+    "uniform mat4 vl_ModelViewProjectionMatrix;\n"
+    "in vec4 vl_Position;\n"
+    "void main() { gl_Position = vl_ModelViewProjectionMatrix * vl_Position; }\n";
+
+  const char* fragment_source =
+    "#version 150\n"
+    "uniform vec4 tint;\n"
+    "uniform vec4 color;\n"
+    "out vec4 frag_color;\n"
+    "void main() { frag_color = tint * color; }\n";
+}
+//-----------------------------------------------------------------------------
+// Benchmark
+//-----------------------------------------------------------------------------
+void Benchmark::begin(const char* name)
+{
+  Log::print( Say("\n[%s]%s\n") << name << (quick() ? " (quick)" : "") );
+}
+//-----------------------------------------------------------------------------
+void Benchmark::report(const char* label, double value, const char* unit)
+{
+  Log::print( Say("  %s: %.3n %s\n") << label << value << unit );
+}
+//-----------------------------------------------------------------------------
+void Benchmark::reportSpeedup(const char* label, double before, double after)
+{
+  Log::print( Say("  %s: %.2nx\n") << label << (after > 0 ? before / after : 0.0) );
+}
+//-----------------------------------------------------------------------------
+bool Benchmark::check(bool ok, const char* what)
+{
+  if (!ok)
+  {
+    Log::error( Say("  FAILED: %s\n") << what );
+    ++mFailures;
+  }
+  return ok;
+}
+//-----------------------------------------------------------------------------
+RecordingOpenGLContext* Benchmark::context()
+{
+  if (!mContext)
+  {
+    mContext = new RecordingOpenGLContext(1920, 1080);
+    mContext->initGLContext(false);
+    // appending to the command stream allocates, the benchmarks that inspect it enable it explicitly
+    mContext->setCommandStreamEnabled(false);
+  }
+  mContext->makeCurrent();
+  return mContext.get();
+}
+//-----------------------------------------------------------------------------
+// BenchScene
+//-----------------------------------------------------------------------------
+BenchScene::BenchScene(Benchmark& bench, int actor_count, int effect_count, int geometry_count, SceneManager* scene_manager)
+{
+  RecordingOpenGLContext* context = bench.context();
+
+  mRendering = new Rendering;
+  mRendering->renderer()->setFramebuffer( context->framebuffer() );
+  mRendering->camera()->viewport()->set( 0, 0, context->framebuffer()->width(), context->framebuffer()->height() );
+
+  mEffects.resize(effect_count);
+  for(int i = 0; i < effect_count; ++i)
+  {
+    mEffects[i] = new Effect;
+    Shader* shader = mEffects[i]->shader();
+    shader->enable(EN_DEPTH_TEST);
+    shader->gocGLSLProgram()->attachShader( new GLSLVertexShader(vertex_source) );
+    shader->gocGLSLProgram()->attachShader( new GLSLFragmentShader(fragment_source) );
+    shader->gocUniform("tint")->setUniform( fvec4(1, (float)i / effect_count, 1, 1) );
+  }
+
+  std::vector< ref<Geometry> > geometries(geometry_count);
+  for(int i = 0; i < geometry_count; ++i)
+    geometries[i] = makeBox( vec3(0,0,0), 1 + (real)i / geometry_count, 1, 1, false );
+
+  mSide = 1;
+  while(mSide * mSide * mSide < actor_count)
+    ++mSide;
+
+  real offset = (mSide - 1) * spacing() / 2;
+  mActors.resize(actor_count);
+  for(int i = 0; i < actor_count; ++i)
+  {
+    int x = i % mSide;
+    int y = (i / mSide) % mSide;
+    int z = i / (mSide * mSide);
+    ref<Transform> transform = new Transform( mat4::getTranslation(x * spacing() - offset, y * spacing() - offset, z * spacing() - offset) );
+    mRendering->transform()->addChild( transform.get() );
+
+    // consecutive Actors use different Effects, so that the render queue sorting does real work
+    mActors[i] = new Actor( geometries[(i / effect_count) % geometry_count].get(), mEffects[i % effect_count].get(), transform.get() );
+    mActors[i]->setUniformSet( new UniformSet );
+    mActors[i]->gocUniform("color")->setUniform( fvec4((float)x / mSide, (float)y / mSide, (float)z / mSide, 1) );
+  }
+
+  if (!scene_manager)
+  {
+    ref<SceneManagerActorTree> tree = new SceneManagerActorTree;
+    for(int i = 0; i < actor_count; ++i)
+      tree->tree()->addActor( mActors[i].get() );
+    scene_manager = tree.get();
+  }
+  mRendering->sceneManagers()->push_back( scene_manager );
+
+  // the benchmarks that cull or build trees without rendering need the Actors' world matrices
+  mRendering->transform()->computeWorldMatrixRecursive();
+
+  // look at the whole grid from outside
+  real radius = (offset + 1) * (real)std::sqrt(3.0);
+  mRendering->camera()->setProjectionPerspective( 60, radius * 0.1f, radius * 4 );
+  mRendering->camera()->setViewMatrixLookAt( vec3(0, 0, radius * 2), vec3(0,0,0), vec3(0,1,0) );
+}
+//-----------------------------------------------------------------------------
+void BenchScene::setCullingCamera()
+{
+  Camera* camera = mRendering->camera();
+  camera->setProjectionPerspective( 60, 0.1f, mSide * spacing() );
+  camera->setViewMatrixLookAt( vec3(0,0,0), vec3(0,0,-1), vec3(0,1,0) );
+  camera->computeFrustumPlanes();
+}
+//-----------------------------------------------------------------------------
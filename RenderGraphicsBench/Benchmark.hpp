@@ -0,0 +1,150 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#ifndef Benchmark_INCLUDE_ONCE
+#define Benchmark_INCLUDE_ONCE
+
+#include <vlGraphics/RecordingOpenGLContext.hpp>
+#include <vlGraphics/Rendering.hpp>
+#include <vlGraphics/Actor.hpp>
+#include <vlCore/Time.hpp>
+#include <string>
+#include <vector>
+
+namespace vl
+{
+  //! Number of global operator new calls since the start of the program, counted by the replacement operator new of main.cpp.
+  unsigned long long allocationCount();
+
+  //-----------------------------------------------------------------------------
+  // Benchmark
+  //-----------------------------------------------------------------------------
+  /**
+   * State shared by the benchmarks of the RenderGraphicsBench executable: timing, reporting and the checks that make the
+   * executable return a failure code.
+   *
+   * Every benchmark runs on the headless RecordingOpenGLContext returned by context(), so the numbers measure the CPU side of
+   * VL only. The benchmarks also verify the invariants their optimization relies on (identical results, zero steady state
+   * allocations etc.) with check().
+   */
+  class Benchmark
+  {
+  public:
+    Benchmark(bool quick): mQuick(quick), mFailures(0) {}
+
+    //! When true the benchmarks use smaller inputs and fewer repetitions, used to run them as a test.
+    bool quick() const { return mQuick; }
+
+    //! Returns \p full normally and \p reduced if quick() is true.
+    int size(int full, int reduced) const { return mQuick ? reduced : full; }
+
+    //! Prints the title of a benchmark.
+    void begin(const char* name);
+
+    //! Prints a measured value.
+    void report(const char* label, double value, const char* unit);
+
+    //! Prints the ratio between two measured values as "<label>: <before/after>x".
+    void reportSpeedup(const char* label, double before, double after);
+
+    //! Records a failure if \p ok is false.
+    bool check(bool ok, const char* what);
+
+    //! Number of failed check()s.
+    int failures() const { return mFailures; }
+
+    //! Calls \p fn \p repeats times and returns the fastest run in seconds.
+    template<class Fn>
+    double time(int repeats, Fn fn) const
+    {
+      double best = 0;
+      for(int i = 0; i < repeats; ++i)
+      {
+        double start = Time::currentTime();
+        fn();
+        double elapsed = Time::currentTime() - start;
+        if (i == 0 || elapsed < best)
+          best = elapsed;
+      }
+      return best;
+    }
+
+    //! The headless context shared by all the benchmarks, created and made current on first use.
+    RecordingOpenGLContext* context();
+
+  protected:
+    ref<RecordingOpenGLContext> mContext;
+    bool mQuick;
+    int mFailures;
+  };
+
+  //-----------------------------------------------------------------------------
+  // BenchScene
+  //-----------------------------------------------------------------------------
+  /**
+   * Synthetic scene used by the rendering benchmarks: \p actor_count boxes laid on a cubic grid centered in the origin,
+   * sharing \p geometry_count Geometries and \p effect_count Effects. Every Effect has its own GLSLProgram and every Actor
+   * its own Transform and "color" uniform, so that the render queue is sorted by program and uploads per-actor uniforms.
+   *
+   * The Rendering targets Benchmark::context() and looks at the grid from outside, so that all the Actors are visible.
+   * The Actors are added to a SceneManagerActorTree, unless \p scene_manager is given, in which case the caller fills it with actors().
+   */
+  class BenchScene: public Object
+  {
+  public:
+    BenchScene(Benchmark& bench, int actor_count, int effect_count=16, int geometry_count=8, SceneManager* scene_manager=NULL);
+
+    Rendering* rendering() { return mRendering.get(); }
+
+    ActorCollection& actors() { return mActors; }
+
+    const std::vector< ref<Effect> >& effects() const { return mEffects; }
+
+    //! Distance between the centers of two neighbouring Actors.
+    real spacing() const { return 2; }
+
+    //! Number of Actors along each side of the grid.
+    int side() const { return mSide; }
+
+    //! Moves the camera to the center of the grid looking down the negative Z axis, so that most Actors are culled, and
+    //! computes its frustum planes. Used by the culling benchmarks.
+    void setCullingCamera();
+
+  protected:
+    ref<Rendering> mRendering;
+    ActorCollection mActors;
+    std::vector< ref<Effect> > mEffects;
+    int mSide;
+  };
+}
+
+#endif
@@ -0,0 +1,132 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/ActorBoundsStore.hpp>
+#include <vlGraphics/SceneManagerActorLBVH.hpp>
+#include <vlGraphics/Camera.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+// user-005: ActorBoundsStore culls the SoA bounding spheres and boxes 4 or 8 at a time. Measures the throughput of the
+// kernels against Frustum::cull() called per object and checks that they never cull an object Frustum::cull() keeps.
+//-----------------------------------------------------------------------------
+void vl::benchBatchCulling(Benchmark& bench)
+{
+  const int count = bench.size(1000000, 100000);
+  const int repeats = bench.size(10, 3);
+
+  ref<BenchScene> scene = new BenchScene(bench, 8);
+  scene->setCullingCamera();
+  const Frustum& frustum = scene->rendering()->camera()->frustum();
+
+  // random bounds around the camera, about half of them inside the frustum
+  std::vector<AABB> boxes(count);
+  std::vector<Sphere> spheres(count);
+  ActorBoundsStore store;
+  store.resize(count);
+  unsigned int seed = 1;
+  for(int i = 0; i < count; ++i)
+  {
+    vec3 center;
+    for(int c = 0; c < 3; ++c)
+    {
+      seed = seed * 1664525u + 1013904223u;
+      center[c] = ( (real)( seed >> 8 ) / (1 << 24) * 2 - 1 ) * 100;
+    }
+    boxes[i] = AABB( center - vec3(1, 2, 0.5f), center + vec3(1, 2, 0.5f) );
+    spheres[i] = Sphere( boxes[i] );
+    store.setBounds( i, boxes[i], spheres[i] );
+  }
+
+  std::vector<unsigned int> visible;
+  double sphere_time = bench.time(repeats, [&]() { store.cullSpheres( frustum, visible ); });
+  double box_time    = bench.time(repeats, [&]() { store.cullBoxes( frustum, visible ); });
+  double both_time   = bench.time(repeats, [&]() { store.cull( frustum, visible ); });
+
+  std::vector<char> reference(count);
+  double scalar_time = bench.time(repeats, [&]()
+  {
+    for(int i = 0; i < count; ++i)
+      reference[i] = ! frustum.cull( spheres[i] ) && ! frustum.cull( boxes[i] );
+  });
+
+  int visible_count = 0;
+  int culled_kept = 0;
+  int kept_culled = 0;
+  for(int i = 0; i < count; ++i)
+  {
+    bool batch = ActorBoundsStore::isVisible( visible, i );
+    visible_count += batch;
+    culled_kept += batch && ! reference[i];
+    kept_culled += ! batch && reference[i];
+  }
+
+  Log::print( Say("  SIMD path: %s\n") << ActorBoundsStore::simdPath() );
+  bench.report("objects", count, "");
+  bench.report("visible", visible_count, "");
+  bench.report("Frustum::cull() spheres and boxes", count / scalar_time * 1e-6, "M objects/s");
+  bench.report("ActorBoundsStore::cullSpheres()", count / sphere_time * 1e-6, "M objects/s");
+  bench.report("ActorBoundsStore::cullBoxes()", count / box_time * 1e-6, "M objects/s");
+  bench.report("ActorBoundsStore::cull()", count / both_time * 1e-6, "M objects/s");
+  bench.reportSpeedup("cull() speedup", scalar_time, both_time);
+  bench.report("kept within the rounding margin", culled_kept, "");
+  bench.check(kept_culled == 0, "the batch culling never culls an object kept by Frustum::cull()");
+
+  // the leaf tests of the hierarchies use the store
+  const int actor_count = bench.size(200000, 20000);
+  ref<SceneManagerActorLBVH> scene_manager = new SceneManagerActorLBVH;
+  ref<BenchScene> actor_scene = new BenchScene(bench, actor_count, 16, 8, scene_manager.get());
+  scene_manager->tree()->build( actor_scene->actors() );
+  actor_scene->setCullingCamera();
+  const Camera* camera = actor_scene->rendering()->camera();
+
+  ActorCollection list;
+  double lbvh_time = bench.time(repeats, [&]()
+  {
+    list.clear();
+    scene_manager->tree()->extractVisibleActors( list, camera );
+  });
+
+  ActorCollection& actors = actor_scene->actors();
+  int expected = 0;
+  for(int i = 0; i < actors.size(); ++i)
+    expected += ! camera->frustum().cull( actors[i]->boundingSphere() ) && ! camera->frustum().cull( actors[i]->boundingBox() );
+
+  bench.report("ActorLBVH actors", actor_count, "");
+  bench.report("ActorLBVH culling", lbvh_time * 1000, "ms");
+  bench.check(list.size() >= expected, "ActorLBVH keeps every Actor kept by Frustum::cull()");
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/Renderer.hpp>
+#include <vlGraphics/Scissor.hpp>
+
+using namespace vl;
+
+namespace
+{
+  // Renders a frame and returns the GL calls it performed.
+  std::vector<unsigned long long> frameStream(Benchmark& bench, Rendering* rendering)
+  {
+    bench.context()->clearCommandStream();
+    bench.context()->setCommandStreamEnabled(true);
+    rendering->render();
+    bench.context()->setCommandStreamEnabled(false);
+    return bench.context()->commandStream();
+  }
+
+  // After an Actor change: the next frame must record the command list again and perform the same GL calls as renderRaw().
+  void checkRecordedAgain(Benchmark& bench, Rendering* rendering, const char* what)
+  {
+    Renderer* renderer = rendering->renderer();
+    long long record_count = renderer->commandListRecordCount();
+    std::vector<unsigned long long> recorded = frameStream(bench, rendering);
+    bench.check(renderer->commandListRecordCount() == record_count + 1, what);
+
+    renderer->setCommandListEnabled(false);
+    std::vector<unsigned long long> reference = frameStream(bench, rendering);
+    renderer->setCommandListEnabled(true);
+    bench.check(recorded == reference, what);
+
+    // back to replaying
+    rendering->render();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// user-015: the command list recorded by Renderer::renderRaw() is replayed while the render queue does not change. Checks
+// that recording and replaying perform the same GL calls as renderRaw() without the command list, that replacing an
+// Actor's UniformSet, Transform or Scissor records the list again instead of replaying freed objects, and times a
+// replayed frame against a renderRaw() frame.
+//-----------------------------------------------------------------------------
+void vl::benchCommandList(Benchmark& bench)
+{
+  const int actor_count = bench.size(100000, 5000);
+  const int frames = bench.size(20, 4);
+
+  ref<BenchScene> scene = new BenchScene(bench, actor_count);
+  Rendering* rendering = scene->rendering();
+  Renderer* renderer = rendering->renderer();
+
+  // the command list is only replayed while the render queue is unchanged
+  rendering->setRenderQueueCacheEnabled(true);
+
+  // record vs replay vs renderRaw()
+  renderer->setCommandListEnabled(false);
+  rendering->render();
+  std::vector<unsigned long long> reference = frameStream(bench, rendering);
+
+  renderer->setCommandListEnabled(true);
+  long long record_count = renderer->commandListRecordCount();
+  long long replay_count = renderer->commandListReplayCount();
+  std::vector<unsigned long long> recorded = frameStream(bench, rendering);
+  std::vector<unsigned long long> replayed = frameStream(bench, rendering);
+  bench.check(renderer->commandListRecordCount() == record_count + 1 && renderer->commandListReplayCount() == replay_count + 1, "the first frame records and the second replays");
+  bench.check(recorded == reference, "recording performs the same GL calls as renderRaw()");
+  bench.check(replayed == reference, "replaying performs the same GL calls as renderRaw()");
+  bench.report("recorded GL call words per frame", (double)reference.size(), "");
+
+  // replaced objects are not replayed
+  Actor* actor = scene->actors()[0].get();
+
+  actor->setUniformSet( new UniformSet );
+  actor->gocUniform("color")->setUniform( fvec4(1, 0, 0, 1) );
+  checkRecordedAgain(bench, rendering, "a replaced UniformSet records the command list again");
+
+  ref<Transform> old_transform = actor->transform();
+  ref<Transform> transform = new Transform( old_transform->localMatrix() );
+  rendering->transform()->addChild( transform.get() );
+  rendering->transform()->eraseChild( old_transform.get() );
+  actor->setTransform( transform.get() );
+  old_transform = NULL;
+  checkRecordedAgain(bench, rendering, "a replaced Transform records the command list again");
+
+  const Viewport* viewport = rendering->camera()->viewport();
+  actor->setScissor( new Scissor( viewport->x(), viewport->y(), viewport->width() / 2, viewport->height() / 2 ) );
+  checkRecordedAgain(bench, rendering, "a new Scissor records the command list again");
+
+  actor->setScissor( NULL );
+  checkRecordedAgain(bench, rendering, "a removed Scissor records the command list again");
+
+  // replay vs renderRaw()
+  renderer->setCommandListEnabled(false);
+  rendering->render();
+  double raw_time = bench.time(frames, [&]() { rendering->render(); });
+
+  renderer->setCommandListEnabled(true);
+  rendering->render();
+  replay_count = renderer->commandListReplayCount();
+  double replay_time = bench.time(frames, [&]() { rendering->render(); });
+  bench.check(renderer->commandListReplayCount() == replay_count + frames, "an unchanged scene replays the command list");
+
+  bench.report("frame with renderRaw()", raw_time * 1000, "ms");
+  bench.report("frame replaying the command list", replay_time * 1000, "ms");
+  bench.reportSpeedup("speedup", raw_time, replay_time);
+
+  renderer->setCommandListEnabled(false);
+}
+//-----------------------------------------------------------------------------
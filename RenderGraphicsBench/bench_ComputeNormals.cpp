@@ -0,0 +1,170 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/Geometry.hpp>
+#include <vlGraphics/DrawElements.hpp>
+#include <vlGraphics/ThreadPool.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace vl;
+
+namespace
+{
+  // A side x side vertices sphere without the poles, so that no triangle is degenerate.
+  ref<Geometry> makeSphere(int side)
+  {
+    ref<ArrayFloat3> vertices  = new ArrayFloat3;
+    ref<ArrayFloat2> texcoords = new ArrayFloat2;
+    vertices->resize( side * side );
+    texcoords->resize( side * side );
+    for(int y = 0; y < side; ++y)
+    {
+      for(int x = 0; x < side; ++x)
+      {
+        float theta = 3.14159265f * (y + 0.5f) / side;
+        float phi   = 2 * 3.14159265f * x / (side - 1);
+        vertices->at(y * side + x)  = fvec3( std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) );
+        texcoords->at(y * side + x) = fvec2( (float)x / side, (float)y / side );
+      }
+    }
+
+    ref<DrawElementsUInt> de = new DrawElementsUInt( PT_TRIANGLES );
+    de->indexBuffer()->resize( (side - 1) * (side - 1) * 6 );
+    u32* idx = de->indexBuffer()->begin();
+    for(int y = 0; y < side - 1; ++y)
+    {
+      for(int x = 0; x < side - 1; ++x)
+      {
+        u32 a = y * side + x, b = a + 1, c = a + side, d = c + 1;
+        *idx++ = a; *idx++ = c; *idx++ = b;
+        *idx++ = b; *idx++ = c; *idx++ = d;
+      }
+    }
+
+    ref<Geometry> geom = new Geometry;
+    geom->setVertexArray( vertices.get() );
+    geom->setTexCoordArray( 0, texcoords.get() );
+    geom->drawCalls().push_back( de.get() );
+    return geom;
+  }
+
+  // The original tangent space loop accumulating the face directions in per vertex arrays.
+  void referenceTangents(u32 vert_count, const fvec3* vertex, const fvec3* normal, const fvec2* texcoord, const DrawCall* prim, fvec3* tangent)
+  {
+    std::vector<fvec3> tan1( vert_count );
+    prim->forEachTriangle( [&](int a, int b, int c) {
+      const fvec3& v1 = vertex[a];
+      const fvec3& v2 = vertex[b];
+      const fvec3& v3 = vertex[c];
+      const fvec2& w1 = texcoord[a];
+      const fvec2& w2 = texcoord[b];
+      const fvec2& w3 = texcoord[c];
+      float x1 = v2.x() - v1.x(), x2 = v3.x() - v1.x();
+      float y1 = v2.y() - v1.y(), y2 = v3.y() - v1.y();
+      float z1 = v2.z() - v1.z(), z2 = v3.z() - v1.z();
+      float s1 = w2.x() - w1.x(), s2 = w3.x() - w1.x();
+      float t1 = w2.y() - w1.y(), t2 = w3.y() - w1.y();
+      float r = 1.0F / (s1 * t2 - s2 * t1);
+      fvec3 sdir( (t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r );
+      tan1[a] += sdir;
+      tan1[b] += sdir;
+      tan1[c] += sdir;
+    } );
+    for(u32 i = 0; i < vert_count; ++i)
+      tangent[i] = ( tan1[i] - normal[i] * dot( normal[i], tan1[i] ) ).normalize();
+  }
+
+  float maxDifference(const fvec3* a, const fvec3* b, size_t count)
+  {
+    float max_diff = 0;
+    for(size_t i = 0; i < count; ++i)
+      max_diff = std::max( max_diff, (a[i] - b[i]).length() );
+    return max_diff;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// user-023: Geometry::computeNormals() and computeTangentSpace() compute the face normals and directions with SIMD and
+// gather them per vertex through a vertex -> triangle adjacency, in parallel on a ThreadPool. Times them against the
+// scalar paths and checks that the results match within tolerance.
+//-----------------------------------------------------------------------------
+void vl::benchComputeNormals(Benchmark& bench)
+{
+  const int side = bench.size(1000, 200);
+  const int repeats = bench.size(3, 1);
+  ref<Geometry> geom = makeSphere( side );
+  ref<ThreadPool> thread_pool = new ThreadPool;
+  bench.report("triangles", (double)geom->drawCalls().at(0)->countTriangles(), "");
+
+  // the verbose path is the scalar one, it only logs the degenerate triangles and the sphere has none
+  double scalar_time = bench.time(repeats, [&]() { geom->computeNormals( true ); });
+  ref<ArrayFloat3> scalar_normals = cast<ArrayFloat3>( geom->normalArray() );
+
+  double simd_time = bench.time(repeats, [&]() { geom->computeNormals(); });
+  ref<ArrayFloat3> simd_normals = cast<ArrayFloat3>( geom->normalArray() );
+
+  double parallel_time = bench.time(repeats, [&]() { geom->computeNormals( false, thread_pool.get() ); });
+  ref<ArrayFloat3> parallel_normals = cast<ArrayFloat3>( geom->normalArray() );
+
+  bench.report("computeNormals() scalar", scalar_time * 1000, "ms");
+  bench.report("computeNormals() SIMD", simd_time * 1000, "ms");
+  bench.report("computeNormals() SIMD + thread pool", parallel_time * 1000, "ms");
+  bench.reportSpeedup("computeNormals() SIMD speedup", scalar_time, simd_time);
+  bench.reportSpeedup("computeNormals() SIMD + thread pool speedup", scalar_time, parallel_time);
+  const size_t vert_count = scalar_normals->size();
+  bench.check( maxDifference( scalar_normals->begin(), simd_normals->begin(), vert_count ) < 1e-4f, "the SIMD normals match the scalar ones" );
+  bench.check( maxDifference( simd_normals->begin(), parallel_normals->begin(), vert_count ) == 0, "the thread pool does not change the normals" );
+
+  // tangent space
+  const fvec3* vertex   = cast<ArrayFloat3>( geom->vertexArray() )->begin();
+  const fvec3* normal   = parallel_normals->begin();
+  const fvec2* texcoord = cast<ArrayFloat2>( geom->texCoordArray(0) )->begin();
+  const DrawCall* prim  = geom->drawCalls().at(0);
+  std::vector<fvec3> reference( vert_count ), tangents( vert_count ), parallel_tangents( vert_count ), bitangents( vert_count );
+
+  double reference_time = bench.time(repeats, [&]() { referenceTangents( (u32)vert_count, vertex, normal, texcoord, prim, &reference[0] ); });
+  double tangent_time = bench.time(repeats, [&]() { Geometry::computeTangentSpace( (u32)vert_count, vertex, normal, texcoord, prim, &tangents[0], &bitangents[0] ); });
+  double parallel_tangent_time = bench.time(repeats, [&]() {
+    Geometry::computeTangentSpace( (u32)vert_count, vertex, normal, texcoord, prim, &parallel_tangents[0], &bitangents[0], thread_pool.get() );
+  });
+
+  bench.report("computeTangentSpace() scalar", reference_time * 1000, "ms");
+  bench.report("computeTangentSpace() SIMD", tangent_time * 1000, "ms");
+  bench.report("computeTangentSpace() SIMD + thread pool", parallel_tangent_time * 1000, "ms");
+  bench.reportSpeedup("computeTangentSpace() SIMD speedup", reference_time, tangent_time);
+  bench.reportSpeedup("computeTangentSpace() SIMD + thread pool speedup", reference_time, parallel_tangent_time);
+  bench.check( maxDifference( &reference[0], &tangents[0], vert_count ) < 1e-3f, "the SIMD tangents match the scalar ones" );
+  bench.check( maxDifference( &tangents[0], &parallel_tangents[0], vert_count ) == 0, "the thread pool does not change the tangents" );
+}
+//-----------------------------------------------------------------------------
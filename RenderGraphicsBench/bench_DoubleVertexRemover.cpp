@@ -0,0 +1,155 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/DoubleVertexRemover.hpp>
+#include <vlGraphics/DrawArrays.hpp>
+
+using namespace vl;
+
+namespace
+{
+  // A side x side grid of quads as a triangle soup, so that every grid vertex is repeated up to 6 times.
+  ref<Geometry> makeSoup(int side)
+  {
+    ref<ArrayFloat3> vertices  = new ArrayFloat3;
+    ref<ArrayFloat3> normals   = new ArrayFloat3;
+    ref<ArrayFloat2> texcoords = new ArrayFloat2;
+    vertices->resize( side * side * 6 );
+    normals->resize( side * side * 6 );
+    texcoords->resize( side * side * 6 );
+    const int corners[] = { 0,0, 1,0, 1,1, 0,0, 1,1, 0,1 };
+    int ivert = 0;
+    for(int y = 0; y < side; ++y)
+    {
+      for(int x = 0; x < side; ++x)
+      {
+        for(int c = 0; c < 6; ++c, ++ivert)
+        {
+          const int vx = x + corners[c*2];
+          const int vy = y + corners[c*2+1];
+          vertices->at(ivert)  = fvec3( (float)vx, (float)vy, (float)((vx * 7 + vy * 13) % 5) );
+          normals->at(ivert)   = fvec3( 0, 0, 1 );
+          texcoords->at(ivert) = fvec2( (float)vx / side, (float)vy / side );
+        }
+      }
+    }
+
+    ref<Geometry> geom = new Geometry;
+    geom->setVertexArray( vertices.get() );
+    geom->setNormalArray( normals.get() );
+    geom->setTexCoordArray( 0, texcoords.get() );
+    geom->drawCalls().push_back( new DrawArrays( PT_TRIANGLES, 0, (int)vertices->size() ) );
+    return geom;
+  }
+
+  // Runs removeDoubles() on a new soup repeats times and returns the fastest run in seconds, keeping the last result in \p geom.
+  double timeRemoveDoubles(DoubleVertexRemover& dvr, int side, int repeats, ref<Geometry>& geom)
+  {
+    double best = 0;
+    for(int i = 0; i < repeats; ++i)
+    {
+      geom = makeSoup( side );
+      double start = Time::currentTime();
+      dvr.removeDoubles( geom.get() );
+      double elapsed = Time::currentTime() - start;
+      if (i == 0 || elapsed < best)
+        best = elapsed;
+    }
+    return best;
+  }
+
+  // Every old vertex must be mapped to a new vertex with the same attributes.
+  bool sameAttributes(const Geometry* soup, const Geometry* welded, const std::vector<u32>& map_old_to_new)
+  {
+    const ArrayFloat3* old_vertices  = cast_const<ArrayFloat3>( soup->vertexArray() );
+    const ArrayFloat2* old_texcoords = cast_const<ArrayFloat2>( soup->texCoordArray(0) );
+    const ArrayFloat3* new_vertices  = cast_const<ArrayFloat3>( welded->vertexArray() );
+    const ArrayFloat2* new_texcoords = cast_const<ArrayFloat2>( welded->texCoordArray(0) );
+    if ( map_old_to_new.size() != old_vertices->size() )
+      return false;
+    for(size_t i = 0; i < map_old_to_new.size(); ++i)
+    {
+      if ( old_vertices->at(i) != new_vertices->at( map_old_to_new[i] ) || old_texcoords->at(i) != new_texcoords->at( map_old_to_new[i] ) )
+        return false;
+    }
+    return true;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// user-021: DoubleVertexRemover welding a triangle soup with position, normal and texture coordinates. Times the DVR_Sort
+// method against DVR_Hash, single threaded and on a ThreadPool, and checks that all of them weld the same vertices.
+//-----------------------------------------------------------------------------
+void vl::benchDoubleVertexRemover(Benchmark& bench)
+{
+  const int side = bench.size(400, 60);
+  const int repeats = bench.size(3, 1);
+  const int unique_count = (side + 1) * (side + 1);
+  ref<Geometry> soup = makeSoup( side );
+  bench.report("vertices", (double)soup->vertexArray()->size(), "");
+
+  DoubleVertexRemover sort_dvr;
+  sort_dvr.setMethod( DVR_Sort );
+  ref<Geometry> sorted;
+  double sort_time = timeRemoveDoubles( sort_dvr, side, repeats, sorted );
+
+  DoubleVertexRemover hash_dvr;
+  hash_dvr.setMethod( DVR_Hash );
+  ref<Geometry> hashed;
+  double hash_time = timeRemoveDoubles( hash_dvr, side, repeats, hashed );
+
+  DoubleVertexRemover parallel_dvr;
+  parallel_dvr.setMethod( DVR_Hash );
+  parallel_dvr.setThreadPool( new ThreadPool );
+  ref<Geometry> parallel;
+  double parallel_time = timeRemoveDoubles( parallel_dvr, side, repeats, parallel );
+
+  bench.report("DVR_Sort", sort_time * 1000, "ms");
+  bench.report("DVR_Hash", hash_time * 1000, "ms");
+  bench.report("DVR_Hash + thread pool", parallel_time * 1000, "ms");
+  bench.reportSpeedup("DVR_Hash speedup", sort_time, hash_time);
+  bench.reportSpeedup("DVR_Hash + thread pool speedup", sort_time, parallel_time);
+
+  bench.check( (int)sort_dvr.mapNewToOld().size() == unique_count, "DVR_Sort welds the soup to the grid vertices" );
+  bench.check( hash_dvr.mapNewToOld().size() == sort_dvr.mapNewToOld().size(), "DVR_Hash welds as many vertices as DVR_Sort" );
+  bench.check( parallel_dvr.mapNewToOld() == hash_dvr.mapNewToOld() && parallel_dvr.mapOldToNew() == hash_dvr.mapOldToNew(), "DVR_Hash welds the same way with and without a thread pool" );
+  bench.check( sameAttributes( soup.get(), sorted.get(), sort_dvr.mapOldToNew() ), "DVR_Sort maps the vertices to identical ones" );
+  bench.check( sameAttributes( soup.get(), hashed.get(), hash_dvr.mapOldToNew() ), "DVR_Hash maps the vertices to identical ones" );
+
+  // first occurrence order
+  bool first_occurrence = true;
+  for(size_t i = 1; i < hash_dvr.mapNewToOld().size(); ++i)
+    first_occurrence &= hash_dvr.mapNewToOld()[i-1] < hash_dvr.mapNewToOld()[i];
+  bench.check( first_occurrence, "DVR_Hash keeps the order of the first occurrences" );
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,82 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/RenderQueueCache.hpp>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+// user-014: with the RenderQueueCache an idle camera over an unchanged scene reuses the culled actors and the sorted render
+// queue. Times idle frames with and without the cache, with and without the near/far clipping planes optimization, and
+// verifies that every idle frame after the first one is a cache hit.
+//-----------------------------------------------------------------------------
+void vl::benchIdleCamera(Benchmark& bench)
+{
+  const int actor_count = bench.size(100000, 5000);
+  const int frames = bench.size(20, 4);
+
+  ref<BenchScene> scene = new BenchScene(bench, actor_count);
+  Rendering* rendering = scene->rendering();
+
+  for(int near_far = 0; near_far < 2; ++near_far)
+  {
+    rendering->setNearFarClippingPlanesOptimized( near_far != 0 );
+
+    rendering->setRenderQueueCacheEnabled(false);
+    rendering->render();
+    double uncached_time = bench.time(frames, [&]() { rendering->render(); });
+
+    rendering->setRenderQueueCacheEnabled(true);
+    rendering->render();
+    rendering->renderQueueCache()->resetCounters();
+    double cached_time = bench.time(frames, [&]() { rendering->render(); });
+    const RenderQueueCache* cache = rendering->renderQueueCache();
+
+    bench.report(near_far ? "near/far optimized, idle frame without cache" : "idle frame without cache", uncached_time * 1000, "ms");
+    bench.report(near_far ? "near/far optimized, idle frame with cache" : "idle frame with cache", cached_time * 1000, "ms");
+    bench.reportSpeedup(near_far ? "near/far optimized, speedup" : "speedup", uncached_time, cached_time);
+    bench.report("cache hits", (double)cache->hitCount(), "");
+    bench.report("cache misses", (double)(cache->cullHitCount() + cache->missCount()), "");
+    bench.check(cache->hitCount() == frames, near_far ? "an idle camera hits the cache with the near/far optimization" : "an idle camera hits the cache");
+
+    // moving the camera must miss
+    rendering->renderQueueCache()->resetCounters();
+    Camera* camera = rendering->camera();
+    camera->setViewMatrix( mat4::getTranslation(0, 0, -1) * camera->viewMatrix() );
+    rendering->render();
+    bench.check(cache->hitCount() == 0, "a moved camera misses the cache");
+    camera->setViewMatrix( mat4::getTranslation(0, 0, 1) * camera->viewMatrix() );
+  }
+  rendering->setNearFarClippingPlanesOptimized(false);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,160 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/DrawArrays.hpp>
+#include <vlGraphics/DrawElements.hpp>
+#include <vlGraphics/MultiDrawElements.hpp>
+#include <random>
+#include <tuple>
+
+using namespace vl;
+
+namespace
+{
+  typedef std::vector< std::tuple<int, int, int> > Triangles;
+
+  // Compares DrawCall::forEachTriangle() and forEachIndex() against triangleIterator() and indexIterator().
+  bool sameTraversal(const DrawCall* dc)
+  {
+    Triangles spans_triangles, iterator_triangles;
+    dc->forEachTriangle( [&](int a, int b, int c) { spans_triangles.push_back( std::make_tuple(a, b, c) ); } );
+    for( TriangleIterator it = dc->triangleIterator(); it.hasNext(); it.next() )
+      iterator_triangles.push_back( std::make_tuple( it.a(), it.b(), it.c() ) );
+
+    std::vector<int> spans_indices, iterator_indices;
+    dc->forEachIndex( [&](int i) { spans_indices.push_back(i); } );
+    for( IndexIterator it = dc->indexIterator(); it.hasNext(); it.next() )
+      iterator_indices.push_back( it.index() );
+
+    return spans_triangles == iterator_triangles && spans_indices == iterator_indices;
+  }
+
+  // Random indices, some of which are primitive restart indices if \p restart is true.
+  void fillIndices(ArrayUInt1* indices, int count, bool restart, std::mt19937& rng)
+  {
+    indices->resize( count );
+    for(int i = 0; i < count; ++i)
+      indices->at(i) = restart && rng() % 5 == 0 ? DrawElementsUInt::primitive_restart_index : rng() % 100;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// user-022: DrawCall::forEachTriangle() and forEachIndex() read the raw indices described by DrawCall::indexSpans() instead
+// of going through a virtual iterator per element. Compares them with triangleIterator() and indexIterator() on random
+// draw calls, including primitive restart, base vertices, empty and short MultiDrawElements runs, indices past the last
+// run and incomplete primitives, and times both traversals on a large mesh.
+//-----------------------------------------------------------------------------
+void vl::benchIndexSpans(Benchmark& bench)
+{
+  const EPrimitiveType types[] = { PT_TRIANGLES, PT_TRIANGLE_STRIP, PT_TRIANGLE_FAN, PT_QUADS, PT_QUAD_STRIP, PT_POLYGON, PT_TRIANGLES_ADJACENCY };
+  const int type_count = sizeof(types) / sizeof(types[0]);
+  const int tests = bench.size(20000, 2000);
+  std::mt19937 rng(1);
+
+  int de_failures = 0, da_failures = 0, mde_failures = 0;
+  for(int i = 0; i < tests; ++i)
+  {
+    const EPrimitiveType prim_type = types[ rng() % type_count ];
+    const bool restart = rng() % 2 != 0;
+
+    ref<DrawElementsUInt> de = new DrawElementsUInt( prim_type );
+    fillIndices( de->indexBuffer(), rng() % 20, restart, rng );
+    de->setBaseVertex( rng() % 5 );
+    de->setPrimitiveRestartEnabled( restart );
+    de_failures += sameTraversal( de.get() ) ? 0 : 1;
+
+    ref<DrawArrays> da = new DrawArrays( prim_type, rng() % 4, rng() % 20 );
+    da_failures += sameTraversal( da.get() ) ? 0 : 1;
+
+    // runs of any size, including empty ones, and a few indices past the last one
+    ref<MultiDrawElementsUInt> mde = new MultiDrawElementsUInt( prim_type );
+    std::vector<GLsizei> counts;
+    std::vector<GLint> base_vertices;
+    const int runs = 1 + rng() % 4;
+    int total = 0;
+    for(int r = 0; r < runs; ++r)
+    {
+      counts.push_back( rng() % 3 == 0 ? rng() % 3 : rng() % 12 );
+      base_vertices.push_back( rng() % 7 );
+      total += counts.back();
+    }
+    fillIndices( mde->indexBuffer(), total + rng() % 4, restart, rng );
+    mde->setCountVector( counts );
+    if ( rng() % 3 != 0 )
+      mde->setBaseVertices( base_vertices );
+    mde->setPrimitiveRestartEnabled( restart );
+    mde_failures += sameTraversal( mde.get() ) ? 0 : 1;
+  }
+  bench.report("random draw calls compared", (double)tests * 3, "");
+  bench.check( de_failures == 0, "DrawElements spans and iterators yield the same triangles and indices" );
+  bench.check( da_failures == 0, "DrawArrays spans and iterators yield the same triangles and indices" );
+  bench.check( mde_failures == 0, "MultiDrawElements spans and iterators yield the same triangles and indices" );
+
+  // traversal speed on a large triangle list
+  const int triangle_count = bench.size(2000000, 100000);
+  const int repeats = bench.size(5, 2);
+  ref<DrawElementsUInt> mesh = new DrawElementsUInt( PT_TRIANGLES );
+  mesh->indexBuffer()->resize( triangle_count * 3 );
+  for(int i = 0; i < triangle_count * 3; ++i)
+    mesh->indexBuffer()->at(i) = rng() % (triangle_count / 2);
+
+  long long iterator_sum = 0, spans_sum = 0;
+  double iterator_time = bench.time(repeats, [&]() {
+    iterator_sum = 0;
+    for( TriangleIterator it = mesh->triangleIterator(); it.hasNext(); it.next() )
+      iterator_sum += it.a() + it.b() + it.c();
+  });
+  double spans_time = bench.time(repeats, [&]() {
+    spans_sum = 0;
+    mesh->forEachTriangle( [&](int a, int b, int c) { spans_sum += a + b + c; } );
+  });
+  bench.report("triangleIterator()", iterator_time * 1000, "ms");
+  bench.report("forEachTriangle()", spans_time * 1000, "ms");
+  bench.reportSpeedup("triangle traversal speedup", iterator_time, spans_time);
+  bench.check( iterator_sum == spans_sum, "the large mesh yields the same triangles" );
+
+  double index_iterator_time = bench.time(repeats, [&]() {
+    iterator_sum = 0;
+    for( IndexIterator it = mesh->indexIterator(); it.hasNext(); it.next() )
+      iterator_sum += it.index();
+  });
+  double index_spans_time = bench.time(repeats, [&]() {
+    spans_sum = 0;
+    mesh->forEachIndex( [&](int i) { spans_sum += i; } );
+  });
+  bench.report("indexIterator()", index_iterator_time * 1000, "ms");
+  bench.report("forEachIndex()", index_spans_time * 1000, "ms");
+  bench.reportSpeedup("index traversal speedup", index_iterator_time, index_spans_time);
+  bench.check( iterator_sum == spans_sum, "the large mesh yields the same indices" );
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,113 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/SceneManagerActorKdTree.hpp>
+#include <vlGraphics/ThreadPool.hpp>
+#include <vlGraphics/Camera.hpp>
+#include <algorithm>
+
+using namespace vl;
+
+namespace
+{
+  // sorted list of the visible Actors, the two builders visit them in different orders
+  std::vector<Actor*> visibleActors(ActorKdTree* tree, const Camera* camera)
+  {
+    ActorCollection list;
+    tree->extractVisibleActors( list, camera );
+    std::vector<Actor*> actors( list.size() );
+    for(int i = 0; i < list.size(); ++i)
+      actors[i] = list[i];
+    std::sort( actors.begin(), actors.end() );
+    return actors;
+  }
+}
+//-----------------------------------------------------------------------------
+// user-006: the KDB_SAH build mode of ActorKdTree bins the Actors with a surface area heuristic in O(n log n).
+// Compares its build time and the cost of culling the resulting tree against the KDB_Median builder on 500k Actors.
+//-----------------------------------------------------------------------------
+void vl::benchKdTreeBuild(Benchmark& bench)
+{
+  const int actor_count = bench.size(500000, 20000);
+  const int repeats = bench.size(5, 2);
+
+  // the trees are built standalone, the scene manager of the scene stays empty
+  ref<BenchScene> scene = new BenchScene(bench, actor_count, 16, 8, new SceneManagerActorKdTree);
+  scene->setCullingCamera();
+  const Camera* camera = scene->rendering()->camera();
+  ref<ThreadPool> thread_pool = new ThreadPool;
+
+  ref<ActorKdTree> median;
+  double median_time = bench.time(repeats, [&]()
+  {
+    median = new ActorKdTree;
+    median->setBuildMode( KDB_Median );
+    median->buildKdTree( scene->actors() );
+  });
+
+  ref<ActorKdTree> sah;
+  double sah_time = bench.time(repeats, [&]()
+  {
+    sah = new ActorKdTree;
+    sah->setBuildMode( KDB_SAH );
+    sah->buildKdTree( scene->actors() );
+  });
+
+  ref<ActorKdTree> sah_parallel;
+  double sah_parallel_time = bench.time(repeats, [&]()
+  {
+    sah_parallel = new ActorKdTree;
+    sah_parallel->setBuildMode( KDB_SAH );
+    sah_parallel->setBuildThreadPool( thread_pool.get() );
+    sah_parallel->buildKdTree( scene->actors() );
+  });
+
+  ActorCollection list;
+  double median_cull_time = bench.time(repeats, [&]() { list.clear(); median->extractVisibleActors( list, camera ); });
+  double sah_cull_time    = bench.time(repeats, [&]() { list.clear(); sah->extractVisibleActors( list, camera ); });
+
+  bench.report("actors", actor_count, "");
+  bench.report("KDB_Median build", median_time * 1000, "ms");
+  bench.report("KDB_SAH build", sah_time * 1000, "ms");
+  bench.report("KDB_SAH parallel build", sah_parallel_time * 1000, "ms");
+  bench.reportSpeedup("build speedup", median_time, sah_time);
+  bench.reportSpeedup("parallel build speedup", median_time, sah_parallel_time);
+  bench.report("KDB_Median cull", median_cull_time * 1000, "ms");
+  bench.report("KDB_SAH cull", sah_cull_time * 1000, "ms");
+  bench.reportSpeedup("cull speedup", median_cull_time, sah_cull_time);
+
+  std::vector<Actor*> median_visible = visibleActors( median.get(), camera );
+  bench.check(visibleActors( sah.get(), camera ) == median_visible, "the KDB_SAH tree culls the same Actors as the KDB_Median one");
+  bench.check(visibleActors( sah_parallel.get(), camera ) == median_visible, "the parallel KDB_SAH tree culls the same Actors as the KDB_Median one");
+}
+//-----------------------------------------------------------------------------
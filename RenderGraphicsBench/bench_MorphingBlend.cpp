@@ -0,0 +1,196 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/MorphingCallback.hpp>
+#include <vlGraphics/DrawArrays.hpp>
+#include <vlGraphics/Shader.hpp>
+#include <vlCore/ResourceDatabase.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+#include <cmath>
+
+using namespace vl;
+
+namespace
+{
+  // A morphing animation of frame_count frames of a vertex_count vertices wobbling sphere.
+  ref<ResourceDatabase> makeAnimation(int vertex_count, int frame_count)
+  {
+    ref<ResourceDatabase> res_db = new ResourceDatabase;
+    ref<Geometry> geometry = new Geometry;
+    geometry->setBufferObjectEnabled(false);
+    geometry->drawCalls().push_back( new DrawArrays(PT_POINTS, 0, vertex_count) );
+    res_db->resources().push_back( geometry.get() );
+
+    for(int f = 0; f < frame_count; ++f)
+    {
+      ref<ArrayFloat3> vertices = new ArrayFloat3;
+      ref<ArrayFloat3> normals  = new ArrayFloat3;
+      vertices->setObjectName("vertex_frame");
+      normals->setObjectName("normal_frame");
+      vertices->resize(vertex_count);
+      normals->resize(vertex_count);
+      for(int i = 0; i < vertex_count; ++i)
+      {
+        float theta = 3.14159265f * (i + 0.5f) / vertex_count;
+        float phi   = 2.39996323f * i;
+        fvec3 n( std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) );
+        normals->at(i)  = n;
+        vertices->at(i) = n * ( 1.0f + 0.1f * std::sin( phi + f * 0.7f ) );
+      }
+      res_db->resources().push_back( vertices.get() );
+      res_db->resources().push_back( normals.get() );
+    }
+    return res_db;
+  }
+
+  // The original fvec3 blending loop.
+  void blendScalar(ArrayFloat3* out, const ArrayFloat3* a, const ArrayFloat3* b, float t)
+  {
+    const float ha = 1 - t;
+    const float hb = t;
+    for(size_t i = 0; i < out->size(); ++i)
+      out->at(i) = a->at(i) * ha + b->at(i) * hb;
+  }
+
+  // Renders one frame of the characters: every callback blends its frames on the CPU.
+  void animate(const std::vector< ref<MorphingCallback> >& characters, const Shader* shader, real frame_clock)
+  {
+    for(size_t i = 0; i < characters.size(); ++i)
+      characters[i]->onActorRenderStarted( NULL, frame_clock, NULL, characters[i]->geometry(), shader, 0 );
+  }
+}
+
+//-----------------------------------------------------------------------------
+// user-019: CPU vertex blending of a crowd of morph-animated characters. Times a frame of 500 characters of 5k vertices with
+// the original fvec3 loop, the SIMD kernel, the SIMD kernel split across a ThreadPool and with a MorphingBlendCache sharing
+// the blending among characters at the same stage of the animation, and checks the kernel against the fvec3 loop.
+//-----------------------------------------------------------------------------
+void vl::benchMorphingBlend(Benchmark& bench)
+{
+  const int character_count = bench.size(500, 50);
+  const int vertex_count = 5000;
+  const int frame_count = 16;
+  const int frames = bench.size(10, 3);
+
+  ref<ResourceDatabase> res_db = makeAnimation(vertex_count, frame_count);
+  ref<MorphingCallback> source = new MorphingCallback;
+  source->init( res_db.get() );
+  ref<Shader> shader = new Shader; // no GLSLProgram: CPU blending
+
+  std::vector< ref<ArrayFloat3> > vertex_frames, normal_frames;
+  for(int i = 0; i < (int)res_db->count<ArrayAbstract>(); ++i)
+  {
+    ArrayFloat3* array = cast<ArrayFloat3>( res_db->get<ArrayAbstract>(i) );
+    ( array->objectName() == "vertex_frame" ? vertex_frames : normal_frames ).push_back( array );
+  }
+
+  Log::print( Say("  SIMD path: %s\n") << MorphingCallback::blendSimdPath() );
+
+  // the characters start the animation at different times, so that each one blends different frames
+  ref<ThreadPool> thread_pool = new ThreadPool;
+  std::vector< ref<MorphingCallback> > characters( character_count );
+  for(int i = 0; i < character_count; ++i)
+  {
+    characters[i] = new MorphingCallback;
+    characters[i]->initFrom( source.get() );
+    characters[i]->geometry()->setBufferObjectEnabled(false);
+    characters[i]->setAnimation( 0, frame_count - 1, 1.0f );
+    characters[i]->startAnimation( -(real)i / character_count );
+  }
+  real frame_clock = 0;
+
+  // SIMD kernel vs the fvec3 loop
+  animate( characters, shader.get(), frame_clock );
+  characters[0]->blendFrames( 3, 4, 0.25f );
+  ref<ArrayFloat3> expected_vertices = new ArrayFloat3;
+  ref<ArrayFloat3> expected_normals  = new ArrayFloat3;
+  expected_vertices->resize( vertex_count );
+  expected_normals->resize( vertex_count );
+  blendScalar( expected_vertices.get(), vertex_frames[3].get(), vertex_frames[4].get(), 0.25f );
+  blendScalar( expected_normals.get(),  normal_frames[3].get(), normal_frames[4].get(), 0.25f );
+  const ArrayFloat3* blended_vertices = cast_const<ArrayFloat3>( characters[0]->geometry()->vertexArray() );
+  const ArrayFloat3* blended_normals  = cast_const<ArrayFloat3>( characters[0]->geometry()->normalArray() );
+  float max_error = 0;
+  for(int i = 0; i < vertex_count; ++i)
+  {
+    max_error = std::max( max_error, (blended_vertices->at(i) - expected_vertices->at(i)).length() );
+    max_error = std::max( max_error, (blended_normals->at(i)  - expected_normals->at(i)).length() );
+  }
+  bench.check( max_error < 1e-5f, "the SIMD blending matches the fvec3 loop" );
+
+  // original loop, one blending per character
+  ref<ArrayFloat3> out_vertices = new ArrayFloat3;
+  ref<ArrayFloat3> out_normals  = new ArrayFloat3;
+  out_vertices->resize( vertex_count );
+  out_normals->resize( vertex_count );
+  double scalar_time = bench.time(frames, [&]() {
+    for(int i = 0; i < character_count; ++i)
+    {
+      const int a = i % frame_count;
+      const int b = (a + 1) % frame_count;
+      const float t = (float)i / character_count;
+      blendScalar( out_vertices.get(), vertex_frames[a].get(), vertex_frames[b].get(), t );
+      blendScalar( out_normals.get(),  normal_frames[a].get(), normal_frames[b].get(), t );
+    }
+  });
+
+  // each frame advances the clock past the 30 fps CPU update period
+  double simd_time = bench.time(frames, [&]() { frame_clock += 0.04f; animate( characters, shader.get(), frame_clock ); });
+
+  for(int i = 0; i < character_count; ++i)
+  {
+    characters[i]->setThreadPool( thread_pool.get() );
+    characters[i]->setParallelBlendThreshold( vertex_count );
+  }
+  double parallel_time = bench.time(frames, [&]() { frame_clock += 0.04f; animate( characters, shader.get(), frame_clock ); });
+
+  for(int i = 0; i < character_count; ++i)
+    characters[i]->setThreadPool( NULL );
+  ref<MorphingBlendCache> cache = new MorphingBlendCache( character_count, 8 );
+  for(int i = 0; i < character_count; ++i)
+    characters[i]->setBlendCache( cache.get() );
+  double cached_time = bench.time(frames, [&]() { frame_clock += 0.04f; animate( characters, shader.get(), frame_clock ); });
+
+  bench.report("fvec3 loop", scalar_time * 1000, "ms");
+  bench.report("SIMD", simd_time * 1000, "ms");
+  bench.report("SIMD + thread pool", parallel_time * 1000, "ms");
+  bench.report("SIMD + blend cache", cached_time * 1000, "ms");
+  bench.reportSpeedup("SIMD speedup", scalar_time, simd_time);
+  bench.reportSpeedup("thread pool speedup", scalar_time, parallel_time);
+  bench.reportSpeedup("blend cache speedup", scalar_time, cached_time);
+  bench.report("blend cache hits", (double)cache->hitCount(), "");
+  bench.report("blend cache misses", (double)cache->missCount(), "");
+  bench.check( cache->missCount() <= (long long)frames * frame_count * (cache->interpolationSteps() + 1), "the blend cache blends each frame pair and step at most once per frame" );
+}
+//-----------------------------------------------------------------------------
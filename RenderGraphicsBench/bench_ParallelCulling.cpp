@@ -0,0 +1,90 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/SceneManagerActorKdTree.hpp>
+#include <vlGraphics/ThreadPool.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+#include <thread>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+// user-004: ActorTreeAbstract::extractVisibleActorsParallel() culls the subtrees below the split depth on a ThreadPool.
+// Compares it against the serial traversal on a 200k Actor ActorKdTree for an increasing number of threads.
+//-----------------------------------------------------------------------------
+void vl::benchParallelCulling(Benchmark& bench)
+{
+  const int actor_count = bench.size(200000, 20000);
+  const int repeats = bench.size(10, 3);
+
+  ref<SceneManagerActorKdTree> scene_manager = new SceneManagerActorKdTree;
+  ref<BenchScene> scene = new BenchScene(bench, actor_count, 16, 8, scene_manager.get());
+  scene_manager->tree()->buildKdTree( scene->actors() );
+  scene->setCullingCamera();
+  const Camera* camera = scene->rendering()->camera();
+  ActorKdTree* tree = scene_manager->tree();
+
+  ActorCollection serial;
+  double serial_time = bench.time(repeats, [&]()
+  {
+    serial.clear();
+    tree->extractVisibleActors( serial, camera );
+  });
+  bench.report("actors", actor_count, "");
+  bench.report("visible", serial.size(), "");
+  bench.report("serial", serial_time * 1000, "ms");
+
+  int hardware_threads = (int)std::thread::hardware_concurrency();
+  if (hardware_threads < 2)
+    hardware_threads = 2;
+  for(int threads = 2; threads <= hardware_threads; threads *= 2)
+  {
+    // the calling thread takes part to the culling
+    ref<ThreadPool> thread_pool = new ThreadPool(threads - 1);
+    ActorCollection parallel;
+    double parallel_time = bench.time(repeats, [&]()
+    {
+      parallel.clear();
+      tree->extractVisibleActorsParallel( parallel, camera, 0xFFFFFFFF, 4, thread_pool.get() );
+    });
+
+    bool identical = parallel.size() == serial.size();
+    for(int i = 0; identical && i < serial.size(); ++i)
+      identical = parallel[i] == serial[i];
+    bench.check(identical, "the parallel culling returns the same Actors in the same order as the serial one");
+
+    Log::print( Say("  %n threads: %.3n ms, %.2nx\n") << threads << parallel_time * 1000 << serial_time / parallel_time );
+  }
+}
+//-----------------------------------------------------------------------------
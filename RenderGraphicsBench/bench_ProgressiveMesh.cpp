@@ -0,0 +1,252 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/PolygonSimplifier.hpp>
+#include <vlGraphics/ProgressiveMesh.hpp>
+#include <vlGraphics/ThreadPool.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <set>
+
+using namespace vl;
+
+namespace
+{
+  // A side x side noisy patch of a sphere plus an isolated vertex.
+  void makeSurface(int side, std::vector<fvec3>& verts, std::vector<int>& tris)
+  {
+    std::mt19937 rng( 7 );
+    std::uniform_real_distribution<float> noise( -0.002f, 0.002f );
+    for(int y = 0; y < side; ++y)
+    {
+      for(int x = 0; x < side; ++x)
+      {
+        float u = x / (float)(side - 1) * 3.1f;
+        float v = y / (float)(side - 1) * 6.2f;
+        verts.push_back( fvec3( std::sin(u) * std::cos(v) + noise(rng), std::sin(u) * std::sin(v) + noise(rng), std::cos(u) + noise(rng) ) );
+      }
+    }
+    for(int y = 0; y < side - 1; ++y)
+    {
+      for(int x = 0; x < side - 1; ++x)
+      {
+        int a = y * side + x, b = a + 1, c = a + side, d = c + 1;
+        tris.push_back(a); tris.push_back(b); tris.push_back(d);
+        tris.push_back(a); tris.push_back(d); tris.push_back(c);
+      }
+    }
+    verts.push_back( fvec3( 9, 9, 9 ) );
+  }
+
+  typedef std::array<float, 9> TriangleKey;
+
+  // The triangles as positions rotated to start from their smallest corner, comparable across different vertex orders.
+  template<class T_Index>
+  std::multiset<TriangleKey> triangleSet(const fvec3* pos, const T_Index* idx, int index_count)
+  {
+    std::multiset<TriangleKey> tris;
+    for(int i = 0; i < index_count; i += 3)
+    {
+      int first = 0;
+      for(int k = 1; k < 3; ++k)
+      {
+        const fvec3& p = pos[ idx[i + k] ];
+        const fvec3& m = pos[ idx[i + first] ];
+        if ( p.x() < m.x() || ( p.x() == m.x() && ( p.y() < m.y() || ( p.y() == m.y() && p.z() < m.z() ) ) ) )
+          first = k;
+      }
+      TriangleKey key;
+      for(int k = 0; k < 3; ++k)
+      {
+        const fvec3& p = pos[ idx[ i + ( first + k ) % 3 ] ];
+        key[k*3+0] = p.x();
+        key[k*3+1] = p.y();
+        key[k*3+2] = p.z();
+      }
+      tris.insert( key );
+    }
+    return tris;
+  }
+
+  const fvec3* positions(Geometry* geom) { return cast<ArrayFloat3>( geom->vertexArray() )->begin(); }
+
+  DrawElementsUInt* triangles(Geometry* geom) { return cast<DrawElementsUInt>( geom->drawCalls().at(0) ); }
+
+  // The discrete LODs must match exactly, whether or not the setup ran on a ThreadPool.
+  bool sameOutput(PolygonSimplifier& a, PolygonSimplifier& b)
+  {
+    if ( a.output().size() != b.output().size() )
+      return false;
+    for(size_t i = 0; i < a.output().size(); ++i)
+    {
+      const ArrayFloat3* va = cast<ArrayFloat3>( a.output()[i]->vertexArray() );
+      const ArrayFloat3* vb = cast<ArrayFloat3>( b.output()[i]->vertexArray() );
+      const DrawElementsUInt::index_type* ia = triangles( a.output()[i].get() )->indexBuffer()->begin();
+      const DrawElementsUInt::index_type* ib = triangles( b.output()[i].get() )->indexBuffer()->begin();
+      const size_t index_count = triangles( a.output()[i].get() )->indexBuffer()->size();
+      if ( va->size() != vb->size() || index_count != triangles( b.output()[i].get() )->indexBuffer()->size() )
+        return false;
+      if ( memcmp( va->ptr(), vb->ptr(), va->bytesUsed() ) != 0 || memcmp( ia, ib, index_count * sizeof(*ia) ) != 0 )
+        return false;
+    }
+    return true;
+  }
+
+  size_t geometryBytes(Geometry* geom)
+  {
+    return geom->vertexArray()->bytesUsed() + triangles( geom )->indexBuffer()->bytesUsed();
+  }
+}
+//-----------------------------------------------------------------------------
+// user-025: PolygonSimplifier::setProgressiveOutput() generates a single ProgressiveMesh, a base mesh plus an ordered list
+// of vertex splits, instead of one Geometry per target. Compares its memory against the discrete LODs, checks that its 
+// levels reproduce the input and the discrete LODs and that the simplifier output does not depend on the ThreadPool.
+//-----------------------------------------------------------------------------
+void vl::benchProgressiveMesh(Benchmark& bench)
+{
+  const int side = bench.size(220, 80);
+  std::vector<fvec3> verts;
+  std::vector<int> tris;
+  makeSurface( side, verts, tris );
+  bench.report("triangles", (double)tris.size() / 3, "");
+
+  std::vector<u32> targets;
+  targets.push_back( (u32)verts.size() * 3 / 4 );
+  targets.push_back( (u32)verts.size() / 3 );
+  targets.push_back( (u32)verts.size() / 10 );
+  targets.push_back( 60 );
+
+  // discrete LODs, serial and on a thread pool
+  ref<PolygonSimplifier> discrete = new PolygonSimplifier;
+  discrete->setVerbose( false );
+  discrete->targets() = targets;
+  double discrete_time = bench.time(1, [&]() { discrete->simplify( verts, tris ); });
+
+  ref<PolygonSimplifier> parallel = new PolygonSimplifier;
+  parallel->setVerbose( false );
+  parallel->setThreadPool( new ThreadPool );
+  parallel->targets() = targets;
+  double parallel_time = bench.time(1, [&]() { parallel->simplify( verts, tris ); });
+
+  bench.report("simplify()", discrete_time * 1000, "ms");
+  bench.report("simplify() + thread pool", parallel_time * 1000, "ms");
+  bench.reportSpeedup("simplify() thread pool speedup", discrete_time, parallel_time);
+  bench.check( sameOutput( *discrete, *parallel ), "the thread pool does not change the simplified meshes" );
+
+  // progressive mesh
+  ref<PolygonSimplifier> progressive = new PolygonSimplifier;
+  progressive->setVerbose( false );
+  progressive->setProgressiveOutput( true );
+  progressive->targets() = targets;
+  double progressive_time = bench.time(1, [&]() { progressive->simplify( verts, tris ); });
+  bench.report("simplify() progressive", progressive_time * 1000, "ms");
+
+  ProgressiveMesh* pm = progressive->progressiveMesh();
+  if ( ! bench.check( pm != NULL, "simplify() generated a ProgressiveMesh" ) )
+    return;
+  bench.report("vertex splits", pm->vertexSplitCount(), "");
+
+  size_t discrete_bytes = 0;
+  for(size_t i = 0; i < discrete->output().size(); ++i)
+    discrete_bytes += geometryBytes( discrete->output()[i].get() );
+  size_t progressive_bytes = geometryBytes( pm ) + pm->vertexSplits().size() * sizeof(ProgressiveMesh::VertexSplit) + pm->splitCorners().size() * sizeof(u32);
+  bench.report("discrete LODs memory", discrete_bytes / 1024.0, "KB");
+  bench.report("progressive mesh memory", progressive_bytes / 1024.0, "KB");
+
+  const fvec3* pm_pos = positions( pm );
+  DrawElementsUInt* pm_tris = triangles( pm );
+
+  // the full resolution level is the input mesh
+  pm->setLevel( pm->vertexSplitCount() );
+  bench.check( triangleSet( &verts[0], &tris[0], (int)tris.size() ) == triangleSet( pm_pos, pm_tris->indexBuffer()->begin(), pm_tris->count() ), "the full resolution level matches the input mesh" );
+
+  // every discrete LOD is one of the levels
+  bool levels_ok = true;
+  for(size_t i = 0; levels_ok && i < discrete->output().size(); ++i)
+  {
+    Geometry* geom = discrete->output()[i].get();
+    const int vert_count = (int)geom->vertexArray()->size();
+    int level = 0;
+    pm->setLevel( level );
+    while( level < pm->vertexSplitCount() && pm->vertexCount() != vert_count )
+      pm->setLevel( ++level );
+    DrawElementsUInt* lod_tris = triangles( geom );
+    const int index_count = (int)lod_tris->indexBuffer()->size();
+    if ( pm->vertexCount() != vert_count || pm->triangleCount() * 3 != index_count )
+    {
+      levels_ok = false;
+      break;
+    }
+    levels_ok = triangleSet( positions( geom ), lod_tris->indexBuffer()->begin(), index_count ) == triangleSet( pm_pos, pm_tris->indexBuffer()->begin(), pm_tris->count() );
+    for(int k = 0; levels_ok && k < pm_tris->count(); ++k)
+      levels_ok = (int)pm_tris->indexBuffer()->at(k) < pm->vertexCount();
+  }
+  bench.check( levels_ok, "the discrete LODs match the progressive mesh levels" );
+
+  // jumping to a level gives the same mesh whatever the level it starts from
+  std::mt19937 rng( 11 );
+  std::vector<fvec3> level_pos;
+  std::vector<u32> level_idx;
+  bool jumps_ok = true;
+  for(int i = 0; jumps_ok && i < bench.size(200, 20); ++i)
+  {
+    const int level = rng() % ( pm->vertexSplitCount() + 1 );
+    pm->setLevel( level );
+    level_pos.assign( pm_pos, pm_pos + pm->vertexCount() );
+    level_idx.assign( pm_tris->indexBuffer()->begin(), pm_tris->indexBuffer()->begin() + pm_tris->count() );
+    pm->setLevel( 0 );
+    pm->setLevel( pm->vertexSplitCount() );
+    pm->setLevel( level );
+    jumps_ok = (int)level_idx.size() == pm_tris->count() && std::equal( level_idx.begin(), level_idx.end(), pm_tris->indexBuffer()->begin() );
+    for(size_t k = 0; jumps_ok && k < level_idx.size(); ++k)
+      jumps_ok = level_pos[ level_idx[k] ] == pm_pos[ level_idx[k] ];
+  }
+  bench.check( jumps_ok, "setLevel() gives the same mesh from any starting level" );
+
+  const int budget = (int)tris.size() / 3 / 4;
+  pm->setTriangleBudget( budget );
+  bench.check( ( pm->triangleCount() <= budget || pm->level() == 0 ) && ( pm->level() == pm->vertexSplitCount() || pm->vertexSplits()[ pm->level() ].mTriangleCount > (u32)budget ), "setTriangleBudget() picks the highest level within the budget" );
+
+  // a full sweep from the base mesh to the full resolution and back
+  double sweep_time = bench.time(bench.size(5, 1), [&]() {
+    for(int level = 0; level <= pm->vertexSplitCount(); ++level)
+      pm->setLevel( level );
+    for(int level = pm->vertexSplitCount(); level >= 0; --level)
+      pm->setLevel( level );
+  });
+  bench.report("setLevel() per vertex split", sweep_time * 1e9 / ( 2.0 * pm->vertexSplitCount() ), "ns");
+}
+//-----------------------------------------------------------------------------
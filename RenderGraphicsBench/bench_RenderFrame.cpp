@@ -0,0 +1,105 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/GLCallCounter.hpp>
+#include <vlGraphics/Effect.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+// user-011: Rendering::render() of 10k to 1M actors on the headless RecordingOpenGLContext. Reports the CPU time of each
+// stage and the per-frame counts of state changes, draw calls and uniform uploads recorded through the function table.
+//-----------------------------------------------------------------------------
+void vl::benchRenderFrame(Benchmark& bench)
+{
+  std::vector<int> actor_counts;
+  actor_counts.push_back( bench.size(10000, 1000) );
+  actor_counts.push_back( bench.size(100000, 10000) );
+  if ( ! bench.quick() )
+    actor_counts.push_back( 1000000 );
+  const int frames = bench.size(10, 3);
+
+  RecordingOpenGLContext* context = bench.context();
+
+  for(size_t c = 0; c < actor_counts.size(); ++c)
+  {
+    ref<BenchScene> scene = new BenchScene(bench, actor_counts[c]);
+    Rendering* rendering = scene->rendering();
+    rendering->setStageTimingEnabled(true);
+
+    // a few fixed function render states, applied through RenderState::apply() when the Effect changes
+    for(size_t i = 0; i < scene->effects().size(); ++i)
+    {
+      Shader* shader = scene->effects()[i]->shader();
+      shader->gocDepthFunc()->set( i % 2 ? FU_LEQUAL : FU_LESS );
+      shader->gocCullFace()->set( i % 3 ? PF_BACK : PF_FRONT );
+      shader->enable(EN_CULL_FACE);
+    }
+
+    // the first frame compiles the programs and creates the buffers
+    rendering->render();
+
+    double stage_time[RSG_StageCount] = { 0 };
+    unsigned long long issued_calls[SC_StateCallCount] = { 0 };
+    GLCallCounter::resetCounts();
+    double frame_time = bench.time(frames, [&]()
+    {
+      context->resetStateCallCounters();
+      rendering->render();
+      for(int s = 0; s < RSG_StageCount; ++s)
+        stage_time[s] += rendering->stageTime( (ERenderingStage)s );
+      for(int s = 0; s < SC_StateCallCount; ++s)
+        issued_calls[s] += context->issuedStateCalls( (EStateCall)s );
+    });
+
+    Log::print( Say("  %n actors\n") << actor_counts[c] );
+    bench.report("frame", frame_time * 1000, "ms");
+    bench.report("culling", stage_time[RSG_Culling] * 1000 / frames, "ms");
+    bench.report("fill render queue", stage_time[RSG_FillRenderQueue] * 1000 / frames, "ms");
+    bench.report("sort render queue", stage_time[RSG_SortRenderQueue] * 1000 / frames, "ms");
+    bench.report("render", stage_time[RSG_Render] * 1000 / frames, "ms");
+    bench.report("state changes per frame", (double)GLCallCounter::callCount(GLC_StateChange) / frames, "");
+    bench.report("draw calls per frame", (double)GLCallCounter::callCount(GLC_DrawCall) / frames, "");
+    bench.report("uniform uploads per frame", (double)GLCallCounter::callCount(GLC_UniformUpload) / frames, "");
+    bench.report("programs used per frame", (double)issued_calls[SC_UseProgram] / frames, "");
+    bench.report("render states applied per frame", (double)issued_calls[SC_RenderState] / frames, "");
+
+    // every actor is visible and drawn once, after the clear
+    bench.check(GLCallCounter::callCount(GLC_DrawCall) / frames >= (unsigned long long)actor_counts[c], "every Actor is drawn");
+    // the render states are applied through the context's function table and recorded
+    bench.check(GLCallCounter::callCount(GLF_glDepthFunc) > 0 && GLCallCounter::callCount(GLF_glCullFace) > 0, "RenderState::apply() is recorded");
+  }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,170 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/RenderQueue.hpp>
+#include <vlGraphics/RenderQueueSorter.hpp>
+#include <vlGraphics/Effect.hpp>
+#include <map>
+
+using namespace vl;
+
+namespace
+{
+  // Sorts by Effect render rank only and cannot encode keys, exercising the comparison sort path of RenderQueue::sort().
+  class RankSorter: public RenderQueueSorter
+  {
+  public:
+    virtual bool mightNeedZCameraDistance() const { return false; }
+    virtual bool operator()(const RenderToken* a, const RenderToken* b) const { return a->mEffectRenderRank < b->mEffectRenderRank; }
+  };
+
+  // Number of passes of the i-th Actor.
+  int passCount(int i) { return 1 + i % 3; }
+
+  // Fills the queue with one token per Actor, followed by its extra passes using pass_shaders.
+  void fillQueue(RenderQueue* queue, ActorCollection& actors, const std::vector< ref<Shader> >& pass_shaders, bool ranked)
+  {
+    queue->clear();
+    for(int i = 0; i < actors.size(); ++i)
+    {
+      Actor* actor = actors[i].get();
+      for(int p = 0; p < passCount(i); ++p)
+      {
+        RenderToken* tok = queue->newToken(p > 0);
+        tok->mActor = actor;
+        tok->mRenderable = actor->lod(0);
+        tok->mShader = p == 0 ? actor->effect()->shader() : pass_shaders[p - 1].get();
+        tok->mEffectRenderRank = ranked ? actors.size() - i : 0;
+      }
+    }
+  }
+
+  // Returns the number of tokens whose pass chain does not match the one filled by fillQueue().
+  int checkPasses(const RenderQueue* queue, const std::map<const Actor*, int>& actor_index, const std::vector< ref<Shader> >& pass_shaders)
+  {
+    int bad = 0;
+    for(int i = 0; i < queue->size(); ++i)
+    {
+      const RenderToken* first = queue->at(i);
+      const int passes = passCount( actor_index.find(first->mActor)->second );
+      int p = 1;
+      for(const RenderToken* tok = queue->nextPass(first); tok; tok = queue->nextPass(tok), ++p)
+        if ( p >= passes || tok->mActor != first->mActor || tok->mShader != pass_shaders[p - 1].get() )
+          ++bad;
+      if ( p != passes )
+        ++bad;
+    }
+    return bad;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// user-010: RenderQueue stores the tokens by value in arrays reused across frames and sorts them through an array of keys,
+// before it allocated every token and sorted an array of pointers. Times fill, sort and walk of 100k tokens, verifies that a
+// steady state frame does not allocate and that the pass chains of multipass Effects survive sorting and appendToken().
+//-----------------------------------------------------------------------------
+void vl::benchRenderQueue(Benchmark& bench)
+{
+  const int actor_count = bench.size(100000, 10000);
+  const int repeats = bench.size(10, 3);
+
+  ref<BenchScene> scene = new BenchScene(bench, actor_count);
+  ActorCollection& actors = scene->actors();
+  Camera* camera = scene->rendering()->camera();
+
+  std::vector< ref<Shader> > pass_shaders;
+  pass_shaders.push_back( new Shader );
+  pass_shaders.push_back( new Shader );
+
+  std::map<const Actor*, int> actor_index;
+  for(int i = 0; i < actors.size(); ++i)
+    actor_index[ actors[i].get() ] = i;
+
+  ref<RenderQueue> queue = new RenderQueue;
+  ref<RenderQueueSorterStandard> sorter = new RenderQueueSorterStandard;
+
+  // the first frame grows the arrays
+  fillQueue(queue.get(), actors, pass_shaders, false);
+  queue->sort(sorter.get(), camera);
+
+  // steady state frames
+  unsigned long long allocations = allocationCount();
+  double fill_time = bench.time(repeats, [&]() { fillQueue(queue.get(), actors, pass_shaders, false); });
+  double sort_time = bench.time(repeats, [&]()
+  {
+    fillQueue(queue.get(), actors, pass_shaders, false);
+    queue->sort(sorter.get(), camera);
+  }) - fill_time;
+  int walked = 0;
+  double walk_time = bench.time(repeats, [&]()
+  {
+    walked = 0;
+    for(int i = 0; i < queue->size(); ++i)
+      for(const RenderToken* tok = queue->at(i); tok; tok = queue->nextPass(tok))
+        walked += tok->mShader != NULL;
+  });
+  allocations = allocationCount() - allocations;
+
+  int shader_runs = 1;
+  for(int i = 1; i < queue->size(); ++i)
+    shader_runs += queue->at(i)->mShader != queue->at(i - 1)->mShader;
+
+  bench.report("tokens", (double)walked, "");
+  bench.report("fill", fill_time * 1000, "ms");
+  bench.report("sort", sort_time * 1000, "ms");
+  bench.report("walk", walk_time * 1000, "ms");
+  bench.report("shader runs after sorting", shader_runs, "");
+  bench.report("steady state allocations", (double)allocations, "");
+  bench.check(allocations == 0, "filling, sorting and walking the queue does not allocate");
+  bench.check(shader_runs <= (int)scene->effects().size(), "the standard sorter groups the tokens by shader");
+  bench.check(checkPasses(queue.get(), actor_index, pass_shaders) == 0, "sorting by keys preserves the pass chains");
+
+  // the comparison sort path
+  ref<RankSorter> rank_sorter = new RankSorter;
+  fillQueue(queue.get(), actors, pass_shaders, true);
+  queue->sort(rank_sorter.get(), camera);
+  bool ranked = true;
+  for(int i = 1; i < queue->size(); ++i)
+    ranked &= queue->at(i - 1)->mEffectRenderRank <= queue->at(i)->mEffectRenderRank;
+  bench.check(ranked, "the comparison sort orders the tokens");
+  bench.check(checkPasses(queue.get(), actor_index, pass_shaders) == 0, "the comparison sort preserves the pass chains");
+
+  // appendToken() and append() copy the pass chains
+  ref<RenderQueue> copy = new RenderQueue;
+  for(int i = 0; i < queue->size(); i += 2)
+    copy->appendToken(queue.get(), i);
+  copy->append(queue.get());
+  bench.check(copy->size() == (queue->size() + 1) / 2 + queue->size(), "appendToken() and append() copy all the tokens");
+  bench.check(checkPasses(copy.get(), actor_index, pass_shaders) == 0, "appendToken() and append() copy the pass chains");
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,147 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/Renderer.hpp>
+#include <vlGraphics/RenderQueue.hpp>
+#include <vlGraphics/GLSL.hpp>
+#include <map>
+
+using namespace vl;
+
+namespace
+{
+  //! Exposes the GLSLProgram state cache used by renderRaw() and captures the render queue built by Rendering.
+  class StateCacheRenderer: public Renderer
+  {
+  public:
+    typedef GLSLProgStateCache Cache;
+    typedef GLSLProgState State;
+
+    StateCacheRenderer(): mRenderQueue(NULL) {}
+
+    virtual const RenderQueue* render(const RenderQueue* render_queue, Camera* camera, real frame_clock)
+    {
+      mRenderQueue = render_queue;
+      return Renderer::render(render_queue, camera, frame_clock);
+    }
+
+    const RenderQueue* mRenderQueue;
+  };
+}
+//-----------------------------------------------------------------------------
+// user-003: renderRaw() looks up the state of the token's GLSLProgram once per token, the flat cache replaced a
+// std::map built from scratch every frame. Measures the lookups alone and the whole queue walk with 50k tokens.
+//-----------------------------------------------------------------------------
+void vl::benchRenderQueueStateCache(Benchmark& bench)
+{
+  const int token_count = bench.size(50000, 5000);
+  const int program_count = 64;
+  const int repeats = bench.size(20, 3);
+
+  // the lookups alone: the render queue is sorted by program so the tokens come in runs
+  std::vector< ref<GLSLProgram> > programs(program_count);
+  for(int i = 0; i < program_count; ++i)
+    programs[i] = new GLSLProgram;
+  std::vector<const GLSLProgram*> tokens(token_count);
+  for(int i = 0; i < token_count; ++i)
+    tokens[i] = programs[ (long long)i * program_count / token_count ].get();
+
+  int created_count = 0;
+  StateCacheRenderer::Cache cache;
+  double cache_time = bench.time(repeats, [&]()
+  {
+    cache.clear();
+    created_count = 0;
+    for(int i = 0; i < token_count; ++i)
+    {
+      bool created = false;
+      StateCacheRenderer::State* state = cache.find(tokens[i], created);
+      created_count += created;
+      state->mTransform = NULL;
+    }
+  });
+  bench.check(cache.size() == program_count && created_count == program_count, "GLSLProgStateCache holds one entry per program");
+
+  size_t map_size = 0;
+  double map_time = bench.time(repeats, [&]()
+  {
+    std::map<const GLSLProgram*, StateCacheRenderer::State> map;
+    for(int i = 0; i < token_count; ++i)
+      map[tokens[i]].mTransform = NULL;
+    map_size = map.size();
+  });
+  bench.check(map_size == (size_t)program_count, "std::map holds one entry per program");
+
+  bench.report("std::map lookups", map_time * 1000, "ms");
+  bench.report("GLSLProgStateCache lookups", cache_time * 1000, "ms");
+  bench.reportSpeedup("lookup speedup", map_time, cache_time);
+
+  unsigned long long allocations = allocationCount();
+  bench.time(repeats, [&]()
+  {
+    cache.clear();
+    for(int i = 0; i < token_count; ++i)
+    {
+      bool created = false;
+      cache.find(tokens[i], created);
+    }
+  });
+  bench.check(allocationCount() == allocations, "GLSLProgStateCache::clear() keeps its slots");
+
+  // the whole render queue walk, one token per Actor
+  ref<BenchScene> scene = new BenchScene(bench, token_count);
+  ref<StateCacheRenderer> renderer = new StateCacheRenderer;
+  renderer->setFramebuffer( bench.context()->framebuffer() );
+  renderer->setCommandListEnabled(false);
+  scene->rendering()->setRenderer( renderer.get() );
+  // links the programs, fills and sorts the render queue
+  scene->rendering()->render();
+  if ( !bench.check(renderer->mRenderQueue && renderer->mRenderQueue->size() == token_count, "the render queue has one token per Actor") )
+    return;
+
+  Camera* camera = scene->rendering()->camera();
+  renderer->renderRaw( renderer->mRenderQueue, camera, 0 );
+
+  allocations = allocationCount();
+  double walk_time = bench.time(repeats, [&]()
+  {
+    renderer->renderRaw( renderer->mRenderQueue, camera, 0 );
+  });
+  allocations = allocationCount() - allocations;
+
+  bench.report("renderRaw()", walk_time * 1000, "ms");
+  bench.report("renderRaw() per token", walk_time * 1e9 / token_count, "ns");
+  bench.report("steady state allocations", (double)allocations, "");
+  bench.check(allocations == 0, "renderRaw() does not allocate in steady state");
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,99 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/BufferObject.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+// user-012: OpenGLContext filters the redundant binding calls against its shadow of the OpenGL state. Reports the calls issued
+// and suppressed per frame and verifies that the buffer uploads binding directly do not leave the shadow stale.
+//-----------------------------------------------------------------------------
+void vl::benchStateShadow(Benchmark& bench)
+{
+  const int actor_count = bench.size(10000, 1000);
+  const int frames = bench.size(10, 3);
+
+  RecordingOpenGLContext* context = bench.context();
+  ref<BenchScene> scene = new BenchScene(bench, actor_count);
+  Rendering* rendering = scene->rendering();
+
+  // the first frame compiles the programs and creates the buffers
+  rendering->render();
+
+  unsigned long long issued[SC_StateCallCount] = { 0 };
+  unsigned long long suppressed[SC_StateCallCount] = { 0 };
+  for(int f = 0; f < frames; ++f)
+  {
+    context->resetStateCallCounters();
+    rendering->render();
+    for(int s = 0; s < SC_StateCallCount; ++s)
+    {
+      issued[s] += context->issuedStateCalls( (EStateCall)s );
+      suppressed[s] += context->suppressedStateCalls( (EStateCall)s );
+    }
+  }
+
+  const char* names[] = { "glActiveTexture", "glBindTexture", "glBindBuffer", "glBindBufferRange", "glBindFramebuffer", "glUseProgram", "glEnable/glDisable", "render states" };
+  for(int s = 0; s < SC_StateCallCount; ++s)
+    Log::print( Say("  %s per frame: %.1n issued, %.1n suppressed\n") << names[s] << (double)issued[s] / frames << (double)suppressed[s] / frames );
+  bench.check(suppressed[SC_UseProgram] > 0, "redundant glUseProgram() calls are suppressed");
+
+  // BufferObject uploads bind GL_ARRAY_BUFFER directly: the next bindBuffer() must reach OpenGL
+  ref<BufferObject> bound = new BufferObject;
+  ref<BufferObject> uploaded = new BufferObject;
+  bound->createBufferObject();
+  unsigned char data[64] = { 0 };
+
+  context->bindBuffer( GL_ARRAY_BUFFER, bound->handle() );
+  uploaded->setBufferData( sizeof(data), data, BU_STATIC_DRAW );
+  context->resetStateCallCounters();
+  context->bindBuffer( GL_ARRAY_BUFFER, bound->handle() );
+  bench.check(context->issuedStateCalls(SC_BindBuffer) == 1, "glBindBuffer() is issued after BufferObject::setBufferData()");
+
+  context->bindBuffer( GL_ARRAY_BUFFER, bound->handle() );
+  uploaded->setBufferSubData( 0, sizeof(data), data );
+  context->resetStateCallCounters();
+  context->bindBuffer( GL_ARRAY_BUFFER, bound->handle() );
+  bench.check(context->issuedStateCalls(SC_BindBuffer) == 1, "glBindBuffer() is issued after BufferObject::setBufferSubData()");
+
+  // and the bindings through the context stay filtered
+  context->resetStateCallCounters();
+  context->bindBuffer( GL_ARRAY_BUFFER, bound->handle() );
+  bench.check(context->suppressedStateCalls(SC_BindBuffer) == 1, "a redundant glBindBuffer() is suppressed");
+
+  context->bindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+//-----------------------------------------------------------------------------
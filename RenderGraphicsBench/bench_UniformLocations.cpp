@@ -0,0 +1,117 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlGraphics/GLCallCounter.hpp>
+#include <vlGraphics/GLSL.hpp>
+#include <vlGraphics/Effect.hpp>
+
+using namespace vl;
+
+//-----------------------------------------------------------------------------
+// user-001: GLSLProgram resolves the uniform locations at link time and looks them up by Uniform::nameID(), before it called
+// glGetUniformLocation() for every uniform of every token. Counts the location queries per frame and times both lookups.
+//-----------------------------------------------------------------------------
+void vl::benchUniformLocations(Benchmark& bench)
+{
+  const int actor_count = bench.size(10000, 1000);
+  const int repeats = bench.size(10, 3);
+
+  ref<BenchScene> scene = new BenchScene(bench, actor_count);
+  Rendering* rendering = scene->rendering();
+  ActorCollection& actors = scene->actors();
+
+  // the first frame links the programs and resolves their locations
+  rendering->render();
+
+  // after: the location queries issued by a steady state frame
+  GLCallCounter::resetCounts();
+  double frame_time = bench.time(repeats, [&]() { rendering->render(); });
+  unsigned long long queries_after = GLCallCounter::callCount(GLF_glGetUniformLocation) / repeats;
+
+  // per-frame uniform updates must not invalidate the interned name IDs
+  double update_time = bench.time(repeats, [&]()
+  {
+    for(int i = 0; i < actor_count; ++i)
+      actors[i]->gocUniform("color")->setUniform( fvec4(1, 1, 1, (float)i / actor_count) );
+  });
+  GLCallCounter::resetCounts();
+  rendering->render();
+  bench.check(GLCallCounter::callCount(GLF_glGetUniformLocation) == 0, "updating the uniforms does not trigger location queries");
+
+  // before vs after, the lookups alone: one per uniform of every Actor and of its Shader
+  int lookups = 0;
+  long long location_sum_before = 0;
+  GLCallCounter::resetCounts();
+  double query_time = bench.time(repeats, [&]()
+  {
+    lookups = 0;
+    location_sum_before = 0;
+    for(int i = 0; i < actor_count; ++i)
+    {
+      Shader* shader = actors[i]->effect()->shader();
+      const GLSLProgram* glsl = shader->getGLSLProgram();
+      const UniformSet* sets[] = { shader->getUniformSet(), actors[i]->getUniformSet() };
+      for(int s = 0; s < 2; ++s)
+        for(size_t u = 0; sets[s] && u < sets[s]->uniforms().size(); ++u, ++lookups)
+          location_sum_before += glsl->getUniformLocation( sets[s]->uniforms()[u]->name().c_str() );
+    }
+  });
+  unsigned long long queries_before = GLCallCounter::callCount(GLF_glGetUniformLocation) / repeats;
+
+  long long location_sum_after = 0;
+  double cached_time = bench.time(repeats, [&]()
+  {
+    location_sum_after = 0;
+    for(int i = 0; i < actor_count; ++i)
+    {
+      Shader* shader = actors[i]->effect()->shader();
+      const GLSLProgram* glsl = shader->getGLSLProgram();
+      const UniformSet* sets[] = { shader->getUniformSet(), actors[i]->getUniformSet() };
+      for(int s = 0; s < 2; ++s)
+        for(size_t u = 0; sets[s] && u < sets[s]->uniforms().size(); ++u)
+          location_sum_after += glsl->uniformLocation( sets[s]->uniforms()[u].get() );
+    }
+  });
+  bench.check(location_sum_before == location_sum_after, "cached locations match glGetUniformLocation()");
+
+  bench.report("actors", actor_count, "");
+  bench.report("frame", frame_time * 1000, "ms");
+  bench.report("gocUniform() updates", update_time * 1000, "ms");
+  bench.report("location queries per frame, before", (double)queries_before, "");
+  bench.report("location queries per frame, after", (double)queries_after, "");
+  bench.report("glGetUniformLocation() lookups", query_time * 1e9 / lookups, "ns/uniform");
+  bench.report("uniformLocation() lookups", cached_time * 1e9 / lookups, "ns/uniform");
+  bench.reportSpeedup("lookup speedup", query_time, cached_time);
+  bench.check(queries_after == 0, "a steady state frame issues no location queries");
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,163 @@
+/**************************************************************************************/
+/*                                                                                    */
+/*  Visualization Library                                                             */
+/*  http://visualizationlibrary.org                                                   */
+/*                                                                                    */
+/*  Copyright (c) 2005-2020, Michele Bosi                                             */
+/*  All rights reserved.                                                              */
+/*                                                                                    */
+/*  Redistribution and use in source and binary forms, with or without modification,  */
+/*  are permitted provided that the following conditions are met:                     */
+/*                                                                                    */
+/*  - Redistributions of source code must retain the above copyright notice, this     */
+/*  list of conditions and the following disclaimer.                                  */
+/*                                                                                    */
+/*  - Redistributions in binary form must reproduce the above copyright notice, this  */
+/*  list of conditions and the following disclaimer in the documentation and/or       */
+/*  other materials provided with the distribution.                                   */
+/*                                                                                    */
+/*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND   */
+/*  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED     */
+/*  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE            */
+/*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR  */
+/*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES    */
+/*  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;      */
+/*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON    */
+/*  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT           */
+/*  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS     */
+/*  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                      */
+/*                                                                                    */
+/**************************************************************************************/
+
+
+#include "Benchmark.hpp"
+#include <vlCore/VisualizationLibrary.hpp>
+#include <vlCore/Log.hpp>
+#include <vlCore/Say.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace vl;
+
+/*
+ * RenderGraphicsBench [--quick] [name...]
+ *
+ * Runs the benchmarks whose name contains one of the given strings, or all of them. --quick uses smaller inputs so that the
+ * executable can run as a test. Returns 1 if any of the checks performed by the benchmarks failed.
+ */
+
+//-----------------------------------------------------------------------------
+// allocation counting
+//-----------------------------------------------------------------------------
+namespace
+{
+  std::atomic<unsigned long long> allocation_count(0);
+}
+
+unsigned long long vl::allocationCount() { return allocation_count.load(std::memory_order_relaxed); }
+
+void* operator new(size_t size)
+{
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+//-----------------------------------------------------------------------------
+// benchmarks
+//-----------------------------------------------------------------------------
+namespace vl
+{
+  void benchRenderQueueStateCache(Benchmark& bench);
+  void benchUniformLocations(Benchmark& bench);
+  void benchParallelCulling(Benchmark& bench);
+  void benchBatchCulling(Benchmark& bench);
+  void benchKdTreeBuild(Benchmark& bench);
+  void benchRenderQueue(Benchmark& bench);
+  void benchRenderFrame(Benchmark& bench);
+  void benchStateShadow(Benchmark& bench);
+  void benchIdleCamera(Benchmark& bench);
+  void benchCommandList(Benchmark& bench);
+  void benchMorphingBlend(Benchmark& bench);
+  void benchDoubleVertexRemover(Benchmark& bench);
+  void benchIndexSpans(Benchmark& bench);
+  void benchComputeNormals(Benchmark& bench);
+  void benchProgressiveMesh(Benchmark& bench);
+}
+
+namespace
+{
+  struct BenchmarkEntry
+  {
+    const char* mName;
+    void (*mFunction)(Benchmark&);
+  };
+
+  const BenchmarkEntry benchmarks[] =
+  {
+    { "RenderQueueStateCache", benchRenderQueueStateCache },
+    { "UniformLocations",      benchUniformLocations },
+    { "ParallelCulling",       benchParallelCulling },
+    { "BatchCulling",          benchBatchCulling },
+    { "KdTreeBuild",           benchKdTreeBuild },
+    { "RenderQueue",           benchRenderQueue },
+    { "RenderFrame",           benchRenderFrame },
+    { "StateShadow",           benchStateShadow },
+    { "IdleCamera",            benchIdleCamera },
+    { "CommandList",           benchCommandList },
+    { "MorphingBlend",         benchMorphingBlend },
+    { "DoubleVertexRemover",   benchDoubleVertexRemover },
+    { "IndexSpans",            benchIndexSpans },
+    { "ComputeNormals",        benchComputeNormals },
+    { "ProgressiveMesh",       benchProgressiveMesh },
+  };
+}
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  VisualizationLibrary::init();
+
+  bool quick = false;
+  std::vector<const char*> filters;
+  for(int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--quick") == 0)
+      quick = true;
+    else
+      filters.push_back(argv[i]);
+  }
+
+  int failures = 0;
+  {
+    Benchmark bench(quick);
+    for(size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i)
+    {
+      bool selected = filters.empty();
+      for(size_t j = 0; j < filters.size() && !selected; ++j)
+        selected = strstr(benchmarks[i].mName, filters[j]) != NULL;
+      if (selected)
+      {
+        bench.begin(benchmarks[i].mName);
+        benchmarks[i].mFunction(bench);
+      }
+    }
+    failures = bench.failures();
+  }
+
+  if (failures)
+    Log::error( Say("\n%n check(s) failed.\n") << failures );
+
+  VisualizationLibrary::shutdown();
+
+  return failures ? 1 : 0;
+}
+//-----------------------------------------------------------------------------